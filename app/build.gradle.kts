@@ -3,6 +3,8 @@ plugins {
     alias(libs.plugins.jetbrainsKotlinAndroid)
 }
 
+val shaderAssetsDir = layout.buildDirectory.dir("generated/shaderAssets")
+
 android {
     namespace = "com.eternal.learningvulkan"
     compileSdk = 34
@@ -16,6 +18,13 @@ android {
 
         testInstrumentationRunner = "androidx.test.runner.AndroidJUnitRunner"
 
+        // Shaders are compiled by the CMake build, see cmake/CompileShaders.cmake
+        externalNativeBuild {
+            cmake {
+                arguments += "-DSHADER_OUTPUT_DIR=${shaderAssetsDir.get().asFile}/shaders"
+            }
+        }
+
         splits {
             abi {
                 isEnable = true
@@ -51,6 +60,18 @@ android {
             version = "3.22.1"
         }
     }
+    sourceSets {
+        getByName("main") {
+            assets.srcDir(shaderAssetsDir)
+        }
+    }
+}
+
+// The SPIR-V has to exist before the assets are merged into the APK
+tasks.configureEach {
+    if (name.matches(Regex("merge\\w+Assets")) && !name.contains("Test")) {
+        dependsOn(name.replace("merge", "externalNativeBuild").removeSuffix("Assets"))
+    }
 }
 
 dependencies {
@@ -5,25 +5,48 @@
 #ifndef LEARNINGVULKAN_DEBUG_HH
 #define LEARNINGVULKAN_DEBUG_HH
 
-#include <android/log.h>
 #include <cassert>
+#include <cstdlib>
+#include "Logger.hh"
+
+// Levels below LOG_MIN_LEVEL are compiled out together with their arguments: 0 keeps everything,
+// 1 drops info, 2 keeps errors only and 3 nothing. See the LOG_MIN_LEVEL CMake option.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// Queues the message for the logging thread, see utils/Logger.hh. Logcat on Android, stderr on
+// the host.
+#define LOG_PRINT(level, tag, ...) \
+  do { \
+    if constexpr (logger::isEnabled(logger::Level::level, LOG_MIN_LEVEL)) { \
+      static logger::CallSite logCallSite; \
+      logger::write(logCallSite, logger::Level::level, tag, __VA_ARGS__); \
+    } \
+  } while (false)
 
 // Android log function wrappers
 static const char *kTAG = "Native_LearningVulkan";
-#define LOGI(...) \
-  ((void)__android_log_print(ANDROID_LOG_INFO, kTAG, __VA_ARGS__))
-#define LOGW(...) \
-  ((void)__android_log_print(ANDROID_LOG_WARN, kTAG, __VA_ARGS__))
-#define LOGE(...) \
-  ((void)__android_log_print(ANDROID_LOG_ERROR, kTAG, __VA_ARGS__))
-
-// Vulkan call wrapper
+#define LOGI(...) LOG_PRINT(Info, kTAG, __VA_ARGS__)
+#define LOGW(...) LOG_PRINT(Warn, kTAG, __VA_ARGS__)
+#define LOGE(...) LOG_PRINT(Error, kTAG, __VA_ARGS__)
+
+// Writes the message synchronously and aborts, so it cannot be lost in the ring. Not affected by
+// LOG_MIN_LEVEL.
+#define LOG_FATAL(...) \
+  do { \
+    logger::writeNow(logger::Level::Error, kTAG, __VA_ARGS__); \
+    abort(); \
+  } while (false)
+
+// Vulkan call wrapper, flushes the log so the error is not lost to the assert
 #define CALL_VK(func) \
   {const auto res = (func);                    \
   if (VK_SUCCESS != res) {                                         \
-    __android_log_print(ANDROID_LOG_ERROR, "LearningVulkan ",               \
+    LOG_PRINT(Error, "LearningVulkan ",                                   \
                         "Vulkan error %d. File[%s], line[%d]", res, __FILE__, \
                         __LINE__);                                    \
+    logger::flush();                                                  \
     assert(false);                                                    \
   }\
 }
@@ -0,0 +1,258 @@
+//
+// Created by eternal on 2024/7/2.
+//
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "BindlessDescriptors.hh"
+#include "Debug.hh"
+
+bool BindlessDescriptors::isSupported(VkPhysicalDevice gpu,
+                                      const std::vector<VkExtensionProperties> &availableExtensions) {
+    for (const char *required: getRequiredExtensions()) {
+        const bool found = std::any_of(availableExtensions.begin(), availableExtensions.end(),
+                                       [required](const VkExtensionProperties &extension) {
+                                           return strcmp(required, extension.extensionName) == 0;
+                                       });
+        if (!found) {
+            return false;
+        }
+    }
+
+    if (!VK_IS_AVAILABLE(vkGetPhysicalDeviceFeatures2)) {
+        return false;
+    }
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+            .pNext = nullptr
+    };
+    VkPhysicalDeviceFeatures2 features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &indexingFeatures
+    };
+    vkGetPhysicalDeviceFeatures2(gpu, &features);
+
+    return indexingFeatures.runtimeDescriptorArray &&
+           indexingFeatures.descriptorBindingPartiallyBound &&
+           indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+           indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+           indexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+           indexingFeatures.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+std::vector<const char *> BindlessDescriptors::getRequiredExtensions() {
+    return {
+            VK_KHR_MAINTENANCE3_EXTENSION_NAME,
+            VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
+    };
+}
+
+VkPhysicalDeviceDescriptorIndexingFeaturesEXT BindlessDescriptors::getRequiredFeatures() {
+    // Instance IDs differ within a draw, hence the non-uniform indexing
+    return {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+            .pNext = nullptr,
+            .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+            .shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
+            .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+            .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+            .descriptorBindingPartiallyBound = VK_TRUE,
+            .runtimeDescriptorArray = VK_TRUE
+    };
+}
+
+bool BindlessDescriptors::init(VkPhysicalDevice gpu, VkDevice vkDevice, uint32_t maxSampledImages,
+                               uint32_t maxStorageBuffers, uint32_t framesInFlight) {
+    device = vkDevice;
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT,
+            .pNext = nullptr
+    };
+    VkPhysicalDeviceProperties2 properties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &indexingProperties
+    };
+    vkGetPhysicalDeviceProperties2(gpu, &properties);
+
+    const uint32_t imageCount = std::min({
+            maxSampledImages,
+            indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages
+    });
+    const uint32_t bufferCount = std::min({
+            maxStorageBuffers,
+            indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+            indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers
+    });
+    imageIndices = IndexAllocator(imageCount, framesInFlight);
+    bufferIndices = IndexAllocator(bufferCount, framesInFlight);
+
+    const std::array<VkDescriptorSetLayoutBinding, 2> bindings{
+            VkDescriptorSetLayoutBinding{
+                    .binding = kSampledImageBinding,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .descriptorCount = imageCount,
+                    .stageFlags = VK_SHADER_STAGE_ALL,
+                    .pImmutableSamplers = nullptr
+            },
+            VkDescriptorSetLayoutBinding{
+                    .binding = kStorageBufferBinding,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = bufferCount,
+                    .stageFlags = VK_SHADER_STAGE_ALL,
+                    .pImmutableSamplers = nullptr
+            }
+    };
+
+    // Slots are written while the set is bound and unused slots are never written
+    const VkDescriptorBindingFlagsEXT bindingFlag = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                                    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT;
+    const std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags{bindingFlag, bindingFlag};
+    const VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+            .pNext = nullptr,
+            .bindingCount = bindingFlags.size(),
+            .pBindingFlags = bindingFlags.data()
+    };
+
+    const VkDescriptorSetLayoutCreateInfo layoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = &bindingFlagsCreateInfo,
+            .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT,
+            .bindingCount = bindings.size(),
+            .pBindings = bindings.data()
+    };
+    CALL_VK(vkCreateDescriptorSetLayout(device, &layoutCreateInfo, nullptr, &setLayout))
+
+    const std::array<VkDescriptorPoolSize, 2> poolSizes{
+            VkDescriptorPoolSize{
+                    .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .descriptorCount = imageCount
+            },
+            VkDescriptorPoolSize{
+                    .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = bufferCount
+            }
+    };
+    const VkDescriptorPoolCreateInfo poolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,
+            .maxSets = 1,
+            .poolSizeCount = poolSizes.size(),
+            .pPoolSizes = poolSizes.data()
+    };
+    CALL_VK(vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &descriptorPool))
+
+    const VkDescriptorSetAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = descriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &setLayout
+    };
+    const VkResult result = vkAllocateDescriptorSets(device, &allocateInfo, &descriptorSet);
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to allocate the bindless descriptor set: %d", result);
+        return false;
+    }
+
+    LOGI("Bindless descriptors: %u sampled images, %u storage buffers", imageCount, bufferCount);
+    return true;
+}
+
+void BindlessDescriptors::teardown() {
+    // Destroying the pool frees the set
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    if (setLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        setLayout = VK_NULL_HANDLE;
+    }
+    device = VK_NULL_HANDLE;
+}
+
+VkDescriptorSetLayout BindlessDescriptors::getSetLayout() const {
+    return setLayout;
+}
+
+uint32_t BindlessDescriptors::registerImage(VkImageView imageView, VkImageLayout imageLayout) {
+    const uint32_t index = imageIndices.allocate();
+    if (index == kInvalidIndex) {
+        LOGE("Bindless descriptors: all %u image slots are in use", imageIndices.getCapacity());
+        return kInvalidIndex;
+    }
+
+    const VkDescriptorImageInfo imageInfo{
+            .sampler = VK_NULL_HANDLE,
+            .imageView = imageView,
+            .imageLayout = imageLayout
+    };
+    const VkWriteDescriptorSet descriptorWrite{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = descriptorSet,
+            .dstBinding = kSampledImageBinding,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo = &imageInfo,
+            .pBufferInfo = nullptr,
+            .pTexelBufferView = nullptr
+    };
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+    return index;
+}
+
+uint32_t BindlessDescriptors::registerBuffer(VkBuffer buffer, VkDeviceSize offset,
+                                             VkDeviceSize range) {
+    const uint32_t index = bufferIndices.allocate();
+    if (index == kInvalidIndex) {
+        LOGE("Bindless descriptors: all %u buffer slots are in use", bufferIndices.getCapacity());
+        return kInvalidIndex;
+    }
+
+    const VkDescriptorBufferInfo bufferInfo{
+            .buffer = buffer,
+            .offset = offset,
+            .range = range
+    };
+    const VkWriteDescriptorSet descriptorWrite{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = descriptorSet,
+            .dstBinding = kStorageBufferBinding,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = nullptr,
+            .pBufferInfo = &bufferInfo,
+            .pTexelBufferView = nullptr
+    };
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+    return index;
+}
+
+void BindlessDescriptors::releaseImage(uint32_t index) {
+    imageIndices.release(index);
+}
+
+void BindlessDescriptors::releaseBuffer(uint32_t index) {
+    bufferIndices.release(index);
+}
+
+void BindlessDescriptors::beginFrame() {
+    imageIndices.advanceFrame();
+    bufferIndices.advanceFrame();
+}
+
+void BindlessDescriptors::bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout,
+                               uint32_t set) const {
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, set, 1,
+                            &descriptorSet, 0, nullptr);
+}
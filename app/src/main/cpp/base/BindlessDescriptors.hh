@@ -0,0 +1,75 @@
+//
+// Created by eternal on 2024/7/2.
+//
+
+#ifndef LEARNINGVULKAN_BINDLESSDESCRIPTORS_HH
+#define LEARNINGVULKAN_BINDLESSDESCRIPTORS_HH
+
+#include <vector>
+#include "IndexAllocator.hh"
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief One descriptor set holding every sampled image and storage buffer, see shaders/bindless.glsl
+ *
+ * Based on VK_EXT_descriptor_indexing: both bindings are large, partially bound, update-after-bind
+ * arrays. Registering a resource writes it once into a free slot and returns the slot index,
+ * which shaders receive per draw or per instance (push constants, instance data) and index the
+ * arrays with. The set is bound once per frame however many materials are drawn.
+ */
+class BindlessDescriptors {
+public:
+    static constexpr uint32_t kSampledImageBinding = 0;
+
+    static constexpr uint32_t kStorageBufferBinding = 1;
+
+    static constexpr uint32_t kInvalidIndex = IndexAllocator::kInvalidIndex;
+
+    /// Whether the device supports everything init needs
+    static bool isSupported(VkPhysicalDevice gpu,
+                            const std::vector<VkExtensionProperties> &availableExtensions);
+
+    /// Extensions to enable on the device
+    static std::vector<const char *> getRequiredExtensions();
+
+    /// Features to chain into VkDeviceCreateInfo, pNext is left for the caller
+    static VkPhysicalDeviceDescriptorIndexingFeaturesEXT getRequiredFeatures();
+
+    /// The array sizes are clamped to the device limits. Released slots are reused after
+    /// framesInFlight frames.
+    bool init(VkPhysicalDevice gpu, VkDevice device, uint32_t maxSampledImages,
+              uint32_t maxStorageBuffers, uint32_t framesInFlight);
+
+    void teardown();
+
+    VkDescriptorSetLayout getSetLayout() const;
+
+    /// Returns kInvalidIndex when the array is full
+    uint32_t registerImage(VkImageView imageView, VkImageLayout imageLayout);
+
+    uint32_t registerBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+
+    void releaseImage(uint32_t index);
+
+    void releaseBuffer(uint32_t index);
+
+    /// Recycles the slots released framesInFlight frames ago
+    void beginFrame();
+
+    void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set) const;
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    IndexAllocator imageIndices{};
+
+    IndexAllocator bufferIndices{};
+};
+
+#endif //LEARNINGVULKAN_BINDLESSDESCRIPTORS_HH
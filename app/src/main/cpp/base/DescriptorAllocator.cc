@@ -0,0 +1,106 @@
+//
+// Created by eternal on 2024/6/29.
+//
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "Debug.hh"
+#include "DescriptorAllocator.hh"
+
+void DescriptorAllocator::init(VkDevice vkDevice, std::vector<PoolSizeRatio> poolSizeRatios,
+                               uint32_t initialSetsPerPage) {
+    device = vkDevice;
+    ratios = std::move(poolSizeRatios);
+    setsPerPage = std::max(initialSetsPerPage, 1u);
+}
+
+void DescriptorAllocator::teardown() {
+    // Destroying the pools frees the descriptor sets allocated from them
+    for (const auto page: readyPages) {
+        vkDestroyDescriptorPool(device, page, nullptr);
+    }
+    for (const auto page: fullPages) {
+        vkDestroyDescriptorPool(device, page, nullptr);
+    }
+    readyPages.clear();
+    fullPages.clear();
+    device = VK_NULL_HANDLE;
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout setLayout) {
+    VkDescriptorPool page = getPage();
+    VkDescriptorSetAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = page,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &setLayout
+    };
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkResult result = vkAllocateDescriptorSets(device, &allocateInfo, &descriptorSet);
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        // Retire the page and retry once on a fresh one
+        fullPages.push_back(page);
+        readyPages.pop_back();
+        allocateInfo.descriptorPool = getPage();
+        result = vkAllocateDescriptorSets(device, &allocateInfo, &descriptorSet);
+    }
+
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to allocate a descriptor set: %d", result);
+        return VK_NULL_HANDLE;
+    }
+    return descriptorSet;
+}
+
+void DescriptorAllocator::reset() {
+    for (const auto page: readyPages) {
+        vkResetDescriptorPool(device, page, 0);
+    }
+    for (const auto page: fullPages) {
+        vkResetDescriptorPool(device, page, 0);
+        readyPages.push_back(page);
+    }
+    fullPages.clear();
+}
+
+uint32_t DescriptorAllocator::getPageCount() const {
+    return static_cast<uint32_t>(readyPages.size() + fullPages.size());
+}
+
+VkDescriptorPool DescriptorAllocator::getPage() {
+    if (!readyPages.empty()) {
+        return readyPages.back();
+    }
+
+    const VkDescriptorPool page = createPage(setsPerPage);
+    setsPerPage = std::min(setsPerPage * 2, kMaxSetsPerPage);
+    readyPages.push_back(page);
+    return page;
+}
+
+VkDescriptorPool DescriptorAllocator::createPage(uint32_t setCount) const {
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (const auto &[type, ratio]: ratios) {
+        poolSizes.push_back({
+                .type = type,
+                .descriptorCount = std::max(
+                        static_cast<uint32_t>(std::ceil(ratio * static_cast<float>(setCount))), 1u)
+        });
+    }
+
+    VkDescriptorPoolCreateInfo poolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .maxSets = setCount,
+            .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+            .pPoolSizes = poolSizes.data()
+    };
+
+    VkDescriptorPool page = VK_NULL_HANDLE;
+    CALL_VK(vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &page))
+    LOGI("Descriptor allocator: new page for %u sets", setCount);
+    return page;
+}
@@ -0,0 +1,58 @@
+//
+// Created by eternal on 2024/6/29.
+//
+
+#ifndef LEARNINGVULKAN_DESCRIPTORALLOCATOR_HH
+#define LEARNINGVULKAN_DESCRIPTORALLOCATOR_HH
+
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Allocates descriptor sets from pools that grow in pages
+ *
+ * Each page is sized by descriptor type ratios per set, so the pool sizes follow the usage instead
+ * of being counted up front. When a page runs out, the next one is twice as large. Persistent
+ * sets live until teardown; an allocator used for transient sets is reset once per frame, which
+ * recycles all pages at once instead of freeing sets one by one.
+ */
+class DescriptorAllocator {
+public:
+    /// How many descriptors of a type to reserve per set
+    struct PoolSizeRatio {
+        VkDescriptorType type;
+
+        float ratio;
+    };
+
+    void init(VkDevice device, std::vector<PoolSizeRatio> ratios, uint32_t initialSetsPerPage);
+
+    void teardown();
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout setLayout);
+
+    /// Frees every set allocated so far, pages are kept for reuse
+    void reset();
+
+    uint32_t getPageCount() const;
+
+private:
+    static constexpr uint32_t kMaxSetsPerPage = 4096;
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    std::vector<PoolSizeRatio> ratios{};
+
+    uint32_t setsPerPage = 0;
+
+    /// Pages that still have room
+    std::vector<VkDescriptorPool> readyPages{};
+
+    std::vector<VkDescriptorPool> fullPages{};
+
+    VkDescriptorPool getPage();
+
+    VkDescriptorPool createPage(uint32_t setCount) const;
+};
+
+#endif //LEARNINGVULKAN_DESCRIPTORALLOCATOR_HH
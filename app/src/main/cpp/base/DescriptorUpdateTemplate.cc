@@ -0,0 +1,158 @@
+//
+// Created by eternal on 2024/6/29.
+//
+#include <cstring>
+#include "Debug.hh"
+#include "DescriptorUpdateTemplate.hh"
+
+namespace {
+    /// The writes a template with these entries makes
+    void writeDescriptorSet(VkDevice device, VkDescriptorSet descriptorSet,
+                            const std::vector<VkDescriptorUpdateTemplateEntry> &entries,
+                            const uint8_t *data) {
+        std::vector<VkDescriptorImageInfo> imageInfos;
+        std::vector<VkDescriptorBufferInfo> bufferInfos;
+        std::vector<VkBufferView> texelBufferViews;
+        for (const auto &entry: entries) {
+            for (uint32_t i = 0; i < entry.descriptorCount; ++i) {
+                const uint8_t *descriptor = data + entry.offset + i * entry.stride;
+                switch (entry.descriptorType) {
+                    case VK_DESCRIPTOR_TYPE_SAMPLER:
+                    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                        imageInfos.emplace_back();
+                        memcpy(&imageInfos.back(), descriptor, sizeof(VkDescriptorImageInfo));
+                        break;
+                    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                        texelBufferViews.emplace_back();
+                        memcpy(&texelBufferViews.back(), descriptor, sizeof(VkBufferView));
+                        break;
+                    default:
+                        bufferInfos.emplace_back();
+                        memcpy(&bufferInfos.back(), descriptor, sizeof(VkDescriptorBufferInfo));
+                        break;
+                }
+            }
+        }
+
+        // The vectors are complete, the writes can point into them
+        std::vector<VkWriteDescriptorSet> writes;
+        size_t imageIndex = 0;
+        size_t bufferIndex = 0;
+        size_t texelBufferIndex = 0;
+        for (const auto &entry: entries) {
+            VkWriteDescriptorSet write{
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .pNext = nullptr,
+                    .dstSet = descriptorSet,
+                    .dstBinding = entry.dstBinding,
+                    .dstArrayElement = entry.dstArrayElement,
+                    .descriptorCount = entry.descriptorCount,
+                    .descriptorType = entry.descriptorType,
+                    .pImageInfo = nullptr,
+                    .pBufferInfo = nullptr,
+                    .pTexelBufferView = nullptr
+            };
+            switch (entry.descriptorType) {
+                case VK_DESCRIPTOR_TYPE_SAMPLER:
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                    write.pImageInfo = imageInfos.data() + imageIndex;
+                    imageIndex += entry.descriptorCount;
+                    break;
+                case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                    write.pTexelBufferView = texelBufferViews.data() + texelBufferIndex;
+                    texelBufferIndex += entry.descriptorCount;
+                    break;
+                default:
+                    write.pBufferInfo = bufferInfos.data() + bufferIndex;
+                    bufferIndex += entry.descriptorCount;
+                    break;
+            }
+            writes.push_back(write);
+        }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                               nullptr);
+    }
+}
+
+bool DescriptorUpdateTemplate::init(VkDevice vkDevice, VkDescriptorSetLayout setLayout,
+                                    const std::vector<VkDescriptorUpdateTemplateEntry> &entries,
+                                    size_t size) {
+    device = vkDevice;
+    dataSize = size;
+
+    if (!VK_IS_AVAILABLE(vkCreateDescriptorUpdateTemplate)) {
+        LOGW("Descriptor update templates are not available, writing descriptor sets directly.");
+        fallbackEntries = entries;
+        return true;
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo createInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size()),
+            .pDescriptorUpdateEntries = entries.data(),
+            .templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+            .descriptorSetLayout = setLayout,
+            // Only used by push descriptor templates
+            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .pipelineLayout = VK_NULL_HANDLE,
+            .set = 0
+    };
+
+    const VkResult result = vkCreateDescriptorUpdateTemplate(device, &createInfo, nullptr,
+                                                             &updateTemplate);
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to create a descriptor update template: %d", result);
+        return false;
+    }
+    return true;
+}
+
+void DescriptorUpdateTemplate::teardown() {
+    if (updateTemplate != VK_NULL_HANDLE) {
+        vkDestroyDescriptorUpdateTemplate(device, updateTemplate, nullptr);
+        updateTemplate = VK_NULL_HANDLE;
+    }
+    fallbackEntries.clear();
+    writtenData.clear();
+    device = VK_NULL_HANDLE;
+}
+
+bool DescriptorUpdateTemplate::write(VkDescriptorSet descriptorSet, const void *data) {
+    auto &written = writtenData[descriptorSet];
+    if (written.size() == dataSize && memcmp(written.data(), data, dataSize) == 0) {
+        ++skippedCount;
+        return false;
+    }
+
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    if (updateTemplate != VK_NULL_HANDLE) {
+        vkUpdateDescriptorSetWithTemplate(device, descriptorSet, updateTemplate, data);
+    } else {
+        writeDescriptorSet(device, descriptorSet, fallbackEntries, bytes);
+    }
+    written.assign(bytes, bytes + dataSize);
+    ++writeCount;
+    return true;
+}
+
+void DescriptorUpdateTemplate::invalidate() {
+    writtenData.clear();
+}
+
+uint32_t DescriptorUpdateTemplate::getWriteCount() const {
+    return writeCount;
+}
+
+uint32_t DescriptorUpdateTemplate::getSkippedCount() const {
+    return skippedCount;
+}
@@ -0,0 +1,65 @@
+//
+// Created by eternal on 2024/6/29.
+//
+
+#ifndef LEARNINGVULKAN_DESCRIPTORUPDATETEMPLATE_HH
+#define LEARNINGVULKAN_DESCRIPTORUPDATETEMPLATE_HH
+
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Writes the descriptor sets of one layout through a VkDescriptorUpdateTemplate
+ *
+ * The data given to write is a struct laid out as the template entries describe, e.g. one
+ * VkDescriptorBufferInfo per buffer binding; value-initialize it so padding compares equal. A set
+ * is only written when the data differs from what it was last written with, so steady-state
+ * frames make no descriptor update calls at all.
+ *
+ * Devices below Vulkan 1.1 without VK_KHR_descriptor_update_template get the same writes through
+ * vkUpdateDescriptorSets.
+ */
+class DescriptorUpdateTemplate {
+public:
+    bool init(VkDevice device, VkDescriptorSetLayout setLayout,
+              const std::vector<VkDescriptorUpdateTemplateEntry> &entries, size_t dataSize);
+
+    void teardown();
+
+    /// Returns whether the set had to be written
+    bool write(VkDescriptorSet descriptorSet, const void *data);
+
+    template<typename T>
+    bool write(VkDescriptorSet descriptorSet, const T &data) {
+        assert(sizeof(T) == dataSize);
+        return write(descriptorSet, static_cast<const void *>(&data));
+    }
+
+    /// Forgets what the sets were written with, needed once their pool has been reset
+    void invalidate();
+
+    uint32_t getWriteCount() const;
+
+    uint32_t getSkippedCount() const;
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+
+    VkDescriptorUpdateTemplate updateTemplate = VK_NULL_HANDLE;
+
+    /// Kept for the vkUpdateDescriptorSets fallback, empty with a template
+    std::vector<VkDescriptorUpdateTemplateEntry> fallbackEntries{};
+
+    size_t dataSize = 0;
+
+    /// The data each set was last written with
+    std::unordered_map<VkDescriptorSet, std::vector<uint8_t>> writtenData{};
+
+    uint32_t writeCount = 0;
+
+    uint32_t skippedCount = 0;
+};
+
+#endif //LEARNINGVULKAN_DESCRIPTORUPDATETEMPLATE_HH
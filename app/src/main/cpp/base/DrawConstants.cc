@@ -0,0 +1,177 @@
+//
+// Created by eternal on 2024/6/3.
+//
+#include <cassert>
+#include <cstring>
+#include "Debug.hh"
+#include "DrawConstants.hh"
+#include "ResourceTracker.hh"
+#include "VulkanCommon.hh"
+
+bool DrawConstants::init(VkPhysicalDevice gpu, VkDevice vkDevice, LayoutCache *cache,
+                         uint32_t size, VkShaderStageFlags stages, uint32_t frameCount,
+                         uint32_t maxDraws) {
+    device = vkDevice;
+    layoutCache = cache;
+    payloadSize = size;
+    stageFlags = stages;
+    maxDrawsPerFrame = maxDraws;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(gpu, &properties);
+
+    if (payloadSize <= properties.limits.maxPushConstantsSize) {
+        mode = Mode::PushConstants;
+        pushConstantRanges.push_back({
+                .stageFlags = stageFlags,
+                .offset = 0,
+                .size = payloadSize
+        });
+        LOGI("Draw constants: %u bytes as push constants", payloadSize);
+        return true;
+    }
+
+    mode = Mode::DynamicUniformBuffer;
+    const VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+    alignedPayloadSize = static_cast<uint32_t>((payloadSize + alignment - 1) & ~(alignment - 1));
+    LOGI("Draw constants: %u bytes exceed maxPushConstantsSize %u, using a dynamic uniform buffer",
+         payloadSize, properties.limits.maxPushConstantsSize);
+
+    return initUniformBuffers(gpu, frameCount);
+}
+
+bool DrawConstants::initUniformBuffers(VkPhysicalDevice gpu, uint32_t frameCount) {
+    RESOURCE_SCOPE("Draw constants");
+    VkDescriptorSetLayoutBinding binding{
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = stageFlags,
+            .pImmutableSamplers = nullptr
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .bindingCount = 1,
+            .pBindings = &binding
+    };
+
+    const VkDescriptorSetLayout setLayout = layoutCache->getSetLayout(layoutCreateInfo);
+    if (setLayout == VK_NULL_HANDLE) {
+        return false;
+    }
+    setLayouts.push_back(setLayout);
+
+    descriptorAllocator.init(device, {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f}},
+                             frameCount);
+
+    const VkDescriptorUpdateTemplateEntry templateEntry{
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .offset = 0,
+            .stride = sizeof(VkDescriptorBufferInfo)
+    };
+    if (!descriptorTemplate.init(device, setLayout, {templateEntry},
+                                 sizeof(VkDescriptorBufferInfo))) {
+        return false;
+    }
+
+    const VkDeviceSize bufferSize = static_cast<VkDeviceSize>(alignedPayloadSize) * maxDrawsPerFrame;
+    frames.resize(frameCount);
+    for (auto &frame: frames) {
+        if (vulkan_common::createBuffer(gpu, device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                        &frame.buffer, &frame.memory) != VK_SUCCESS) {
+            LOGE("Failed to create the draw constants uniform buffer.");
+            return false;
+        }
+
+        // Stays mapped for the whole lifetime, the memory is host coherent
+        void *mapped;
+        CALL_VK(vkMapMemory(device, frame.memory, 0, bufferSize, 0, &mapped))
+        frame.mapped = static_cast<uint8_t *>(mapped);
+
+        frame.descriptorSet = descriptorAllocator.allocate(setLayout);
+        if (frame.descriptorSet == VK_NULL_HANDLE) {
+            return false;
+        }
+
+        // The draw is selected through the dynamic offset, so this is the only write ever needed
+        const VkDescriptorBufferInfo bufferInfo{
+                .buffer = frame.buffer,
+                .offset = 0,
+                .range = payloadSize
+        };
+        descriptorTemplate.write(frame.descriptorSet, bufferInfo);
+    }
+
+    return true;
+}
+
+void DrawConstants::teardown() {
+    for (auto &frame: frames) {
+        if (frame.memory != VK_NULL_HANDLE) {
+            vkUnmapMemory(device, frame.memory);
+            vkFreeMemory(device, frame.memory, nullptr);
+        }
+        if (frame.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, frame.buffer, nullptr);
+        }
+    }
+    frames.clear();
+
+    descriptorTemplate.teardown();
+    descriptorAllocator.teardown();
+
+    // Set layouts belong to the layout cache
+    setLayouts.clear();
+    pushConstantRanges.clear();
+
+    layoutCache = nullptr;
+    device = VK_NULL_HANDLE;
+}
+
+DrawConstants::Mode DrawConstants::getMode() const {
+    return mode;
+}
+
+const std::vector<VkPushConstantRange> &DrawConstants::getPushConstantRanges() const {
+    return pushConstantRanges;
+}
+
+const std::vector<VkDescriptorSetLayout> &DrawConstants::getSetLayouts() const {
+    return setLayouts;
+}
+
+void DrawConstants::beginFrame(uint32_t frameIndex) {
+    currentFrame = frameIndex;
+    drawIndex = 0;
+}
+
+void DrawConstants::push(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout,
+                         const void *data) {
+    if (mode == Mode::PushConstants) {
+        vkCmdPushConstants(commandBuffer, pipelineLayout, stageFlags, 0, payloadSize, data);
+        return;
+    }
+
+    if (drawIndex >= maxDrawsPerFrame) {
+        LOGE("Draw constants: more than %u draws in a frame.", maxDrawsPerFrame);
+        logger::flush();
+        assert(false);
+        return;
+    }
+
+    FrameData &frame = frames.at(currentFrame);
+    const uint32_t dynamicOffset = drawIndex * alignedPayloadSize;
+    memcpy(frame.mapped + dynamicOffset, data, payloadSize);
+    ++drawIndex;
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                            &frame.descriptorSet, 1, &dynamicOffset);
+}
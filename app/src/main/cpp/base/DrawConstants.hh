@@ -0,0 +1,96 @@
+//
+// Created by eternal on 2024/6/3.
+//
+
+#ifndef LEARNINGVULKAN_DRAWCONSTANTS_HH
+#define LEARNINGVULKAN_DRAWCONSTANTS_HH
+
+#include <cassert>
+#include <vector>
+#include "DescriptorAllocator.hh"
+#include "DescriptorUpdateTemplate.hh"
+#include "LayoutCache.hh"
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Per-draw shader constants
+ *
+ * The payload is pushed as push constants when it fits into maxPushConstantsSize. Otherwise it is
+ * written into a persistently mapped uniform buffer per frame and bound with a dynamic offset.
+ * Descriptors are only written once in init, so per-draw updates never touch descriptor sets.
+ */
+class DrawConstants {
+public:
+    enum class Mode {
+        PushConstants,
+        DynamicUniformBuffer
+    };
+
+    /// The set layout comes from layoutCache, which has to outlive this object
+    bool init(VkPhysicalDevice gpu, VkDevice device, LayoutCache *layoutCache, uint32_t payloadSize,
+              VkShaderStageFlags stageFlags, uint32_t frameCount, uint32_t maxDrawsPerFrame);
+
+    void teardown();
+
+    Mode getMode() const;
+
+    /// Push constant ranges the pipeline layout has to be created with
+    const std::vector<VkPushConstantRange> &getPushConstantRanges() const;
+
+    /// Set layouts the pipeline layout has to be created with, starting at set 0
+    const std::vector<VkDescriptorSetLayout> &getSetLayouts() const;
+
+    void beginFrame(uint32_t frameIndex);
+
+    void push(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const void *data);
+
+    template<typename T>
+    void push(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const T &data) {
+        assert(sizeof(T) == payloadSize);
+        push(commandBuffer, pipelineLayout, static_cast<const void *>(&data));
+    }
+
+private:
+    struct FrameData {
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+
+        uint8_t *mapped = nullptr;
+
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    };
+
+    Mode mode = Mode::PushConstants;
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    LayoutCache *layoutCache = nullptr;
+
+    uint32_t payloadSize = 0;
+
+    /// Payload size rounded up to minUniformBufferOffsetAlignment
+    uint32_t alignedPayloadSize = 0;
+
+    VkShaderStageFlags stageFlags = 0;
+
+    uint32_t maxDrawsPerFrame = 0;
+
+    std::vector<VkPushConstantRange> pushConstantRanges{};
+
+    std::vector<VkDescriptorSetLayout> setLayouts{};
+
+    DescriptorAllocator descriptorAllocator{};
+
+    DescriptorUpdateTemplate descriptorTemplate{};
+
+    std::vector<FrameData> frames{};
+
+    uint32_t currentFrame = 0;
+
+    uint32_t drawIndex = 0;
+
+    bool initUniformBuffers(VkPhysicalDevice gpu, uint32_t frameCount);
+};
+
+#endif //LEARNINGVULKAN_DRAWCONSTANTS_HH
@@ -0,0 +1,500 @@
+//
+// Created by eternal on 2024/7/19.
+//
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "CpuProfiler.hh"
+#include "Debug.hh"
+#include "FrameRenderer.hh"
+#include "MathUtils.hh"
+#include "ResourceTracker.hh"
+#include "VulkanCommon.hh"
+#include "shader_layouts/triangle.layout.hh"
+#include "shader_layouts/triangle_bindless.layout.hh"
+#include "shader_layouts/triangle_ubo.layout.hh"
+
+namespace {
+    /// Float form of the triangle.vert inputs, the vertex buffer holds them packed
+    struct Vertex {
+        glm::vec2 position;
+
+        glm::vec4 color;
+    };
+}
+
+bool FrameRenderer::init(const Settings &rendererSettings) {
+    settings = rendererSettings;
+
+    // Both interfaces of triangle.vert have to agree with TransformConstants
+    constexpr auto pushConstants = shader_layouts::triangle::pushConstantRanges[0];
+    constexpr auto uniformBuffer = shader_layouts::triangle_ubo::descriptorBindings[0];
+    static_assert(pushConstants.offset == 0 && pushConstants.size == sizeof(TransformConstants));
+    static_assert(uniformBuffer.set == 0 && uniformBuffer.binding == 0 &&
+                  uniformBuffer.blockSize == sizeof(TransformConstants) &&
+                  uniformBuffer.stageFlags == pushConstants.stageFlags);
+
+    if (settings.bindless != nullptr) {
+        if (!initTransformBuffers()) {
+            return false;
+        }
+    } else if (!drawConstants.init(settings.gpu, settings.device, settings.layoutCache,
+                                   sizeof(TransformConstants), pushConstants.stageFlags,
+                                   settings.frameCount, settings.maxObjectsPerFrame)) {
+        return false;
+    }
+    if (!initPipeline()) {
+        LOGE("Failed to create the triangle pipeline.");
+        return false;
+    }
+    return initQuad();
+}
+
+void FrameRenderer::teardown() {
+    drawConstants.teardown();
+
+    for (TransformBuffer &transforms: transformBuffers) {
+        if (transforms.slot != BindlessDescriptors::kInvalidIndex) {
+            settings.bindless->releaseBuffer(transforms.slot);
+        }
+        if (transforms.memory != VK_NULL_HANDLE) {
+            vkUnmapMemory(settings.device, transforms.memory);
+            vkFreeMemory(settings.device, transforms.memory, nullptr);
+        }
+        if (transforms.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(settings.device, transforms.buffer, nullptr);
+        }
+    }
+    transformBuffers.clear();
+
+    if (indexBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(settings.device, indexBuffer, nullptr);
+        vkFreeMemory(settings.device, indexMemory, nullptr);
+        indexBuffer = VK_NULL_HANDLE;
+        indexMemory = VK_NULL_HANDLE;
+    }
+
+    if (vertexBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(settings.device, vertexBuffer, nullptr);
+        vkFreeMemory(settings.device, vertexMemory, nullptr);
+        vertexBuffer = VK_NULL_HANDLE;
+        vertexMemory = VK_NULL_HANDLE;
+    }
+
+    // The pipelines stay with the pipeline manager, the layout with the layout cache
+    variants.teardown();
+    pipeline = VK_NULL_HANDLE;
+    pipelineLayout = VK_NULL_HANDLE;
+}
+
+void FrameRenderer::setVariant(ShaderVariants::Key key) {
+    variant = std::move(key);
+}
+
+ShaderVariants &FrameRenderer::getVariants() {
+    return variants;
+}
+
+FrameRenderer::Counters FrameRenderer::record(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                                              const Target &target, float time,
+                                              uint32_t objectCount, Overlay *overlay) {
+    PROFILE_FUNCTION();
+    assert(objectCount <= settings.maxObjectsPerFrame);
+    GpuProfiler &gpuProfiler = *settings.gpuProfiler;
+    Counters counters{};
+
+    const VkCommandBufferBeginInfo commandBufferBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr,
+    };
+    vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+
+    gpuProfiler.beginFrame(commandBuffer, frameIndex);
+    const uint32_t frameScope = gpuProfiler.beginScope(commandBuffer, "Frame");
+
+    if (settings.bindless == nullptr) {
+        drawConstants.beginFrame(frameIndex);
+    }
+
+    const uint32_t triangleScope = gpuProfiler.beginScope(commandBuffer, "Triangle");
+    beginRendering(commandBuffer, target);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      variants.get(variant, pipeline));
+
+    const VkViewport viewport{
+            .x = 0,
+            .y = 0,
+            .width = static_cast<float>(target.extent.width),
+            .height = static_cast<float>(target.extent.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+    };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    const VkRect2D scissor{
+            .offset {.x = 0, .y = 0},
+            .extent = target.extent
+    };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    const VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+
+    // An 800 units wide canvas centered on the origin, y pointing up
+    const float aspectRatio =
+            static_cast<float>(target.extent.width) / static_cast<float>(target.extent.height);
+    constexpr float canvasWidth = 800.0f;
+    const float canvasHeight = canvasWidth / aspectRatio;
+    const glm::mat4x4 projectionMatrix = math_utils::orthographicProjection(-canvasWidth / 2,
+                                                                            canvasHeight / 2,
+                                                                            canvasWidth / 2,
+                                                                            -canvasHeight / 2,
+                                                                            0.0, 1.0);
+
+    if (settings.bindless != nullptr) {
+        // The buffer of this frame index is no longer read, its previous submission is complete
+        const TransformBuffer &transforms = transformBuffers[frameIndex];
+        for (uint32_t object = 0; object < objectCount; ++object) {
+            transforms.matrices[object] = transform(time, object, projectionMatrix).modelMatrix;
+        }
+
+        settings.bindless->bind(commandBuffer, pipelineLayout, 0);
+        const FrameConstants constants{
+                .projectionMatrix = projectionMatrix,
+                .transformBuffer = transforms.slot
+        };
+        const auto &range = shader_layouts::triangle_bindless::pushConstantRanges[0];
+        vkCmdPushConstants(commandBuffer, pipelineLayout, range.stageFlags, range.offset,
+                           range.size, &constants);
+        vkCmdDrawIndexed(commandBuffer, 6, objectCount, 0, 0, 0);
+        ++counters.draws;
+    } else {
+        for (uint32_t object = 0; object < objectCount; ++object) {
+            drawConstants.push(commandBuffer, pipelineLayout,
+                               transform(time, object, projectionMatrix));
+            vkCmdDrawIndexed(commandBuffer, 6, 1, 0, 0, 0);
+        }
+        counters.draws += objectCount;
+    }
+    // Passes stay disjoint, the overlay is timed on its own
+    gpuProfiler.endScope(commandBuffer, triangleScope);
+
+    if (overlay != nullptr) {
+        GpuProfiler::Scope overlayScope(gpuProfiler, commandBuffer, "Overlay");
+        const auto overlayStart = std::chrono::steady_clock::now();
+        if (overlay->draw(commandBuffer, target.extent)) {
+            ++counters.draws;
+        }
+        counters.overlayMilliseconds = std::chrono::duration<float, std::milli>(
+                std::chrono::steady_clock::now() - overlayStart).count();
+    }
+
+    endRendering(commandBuffer, target);
+    gpuProfiler.endScope(commandBuffer, frameScope);
+
+    CALL_VK(vkEndCommandBuffer(commandBuffer))
+    return counters;
+}
+
+bool FrameRenderer::initTransformBuffers() {
+    RESOURCE_SCOPE("Transforms");
+    const VkDeviceSize size = sizeof(glm::mat4x4) * settings.maxObjectsPerFrame;
+    transformBuffers.resize(settings.frameCount);
+    for (TransformBuffer &transforms: transformBuffers) {
+        if (vulkan_common::createBuffer(settings.gpu, settings.device, size,
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                        &transforms.buffer, &transforms.memory) != VK_SUCCESS) {
+            return false;
+        }
+
+        void *mapped;
+        CALL_VK(vkMapMemory(settings.device, transforms.memory, 0, size, 0, &mapped))
+        transforms.matrices = static_cast<glm::mat4x4 *>(mapped);
+
+        transforms.slot = settings.bindless->registerBuffer(transforms.buffer, 0, size);
+        if (transforms.slot == BindlessDescriptors::kInvalidIndex) {
+            LOGE("No storage buffer slot left for the transforms.");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FrameRenderer::initPipeline() {
+    // The layout only carries the per-draw constants, or the bindless set and the frame constants
+    // of triangle_bindless.vert
+    constexpr auto &bindlessRanges = shader_layouts::triangle_bindless::pushConstantRanges;
+    static_assert(std::ranges::any_of(
+            shader_layouts::triangle_bindless::descriptorBindings,
+            [](const ShaderDescriptorBinding &binding) {
+                return binding.set == 0 &&
+                       binding.binding == BindlessDescriptors::kStorageBufferBinding &&
+                       binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            }));
+    static_assert(bindlessRanges.size() == 1 && bindlessRanges[0].offset == 0 &&
+                  bindlessRanges[0].size == offsetof(FrameConstants, transformBuffer) +
+                                            sizeof(FrameConstants::transformBuffer));
+
+    std::vector<VkDescriptorSetLayout> setLayouts = drawConstants.getSetLayouts();
+    std::vector<VkPushConstantRange> pushConstantRanges = drawConstants.getPushConstantRanges();
+    if (settings.bindless != nullptr) {
+        setLayouts = {settings.bindless->getSetLayout()};
+        pushConstantRanges = {bindlessRanges[0]};
+    }
+    const VkPipelineLayoutCreateInfo layoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+            .pSetLayouts = setLayouts.data(),
+            .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+            .pPushConstantRanges = pushConstantRanges.data(),
+    };
+    pipelineLayout = settings.layoutCache->getPipelineLayout(layoutCreateInfo);
+    if (pipelineLayout == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    // The vertex inputs come from the reflected shader, Vertex has to match their float form.
+    // The buffer holds them packed, the vertex fetch converts them back to floats.
+    using shader_layouts::triangle::vertexAttributes;
+    using shader_layouts::triangle::vertexStride;
+    static_assert(sizeof(Vertex) == vertexStride &&
+                  shader_layouts::triangle_ubo::vertexStride == vertexStride &&
+                  shader_layouts::triangle_bindless::vertexStride == vertexStride);
+    static_assert(vertexAttributes.size() == 2 &&
+                  vertexAttributes[0].offset == offsetof(Vertex, position) &&
+                  vertexAttributes[1].offset == offsetof(Vertex, color));
+    vertexLayout = vertex_packing::makeLayout(
+            {vertexAttributes.begin(), vertexAttributes.end()},
+            {vertex_packing::Encoding::Snorm16, vertex_packing::Encoding::Unorm8});
+    if (vertexLayout.stride == 0) {
+        return false;
+    }
+
+    // The vertex shader is built once per DrawConstants interface, plus the bindless one
+    const char *vertexShaderPath = "shaders/triangle_bindless.vert.spv";
+    if (settings.bindless == nullptr) {
+        vertexShaderPath = drawConstants.getMode() == DrawConstants::Mode::PushConstants
+                           ? "shaders/triangle.vert.spv" : "shaders/triangle.ubo.vert.spv";
+    }
+
+    const VkShaderModule vertexShader = settings.shaderModules->load(vertexShaderPath);
+    const VkShaderModule fragmentShader = settings.shaderModules->load("shaders/triangle.frag.spv");
+    if (vertexShader == VK_NULL_HANDLE || fragmentShader == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    const GraphicsPipelineState state{
+            .vertexShader = vertexShader,
+            .fragmentShader = fragmentShader,
+            .vertexBindings {
+                    {
+                            .binding = 0,
+                            .stride = vertexLayout.stride,
+                            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+                    }
+            },
+            .vertexAttributes = vertexLayout.attributes,
+            .layout = pipelineLayout,
+            .renderPass = settings.renderPass,
+            .colorFormat = settings.colorFormat
+    };
+
+    // Variants differ in the specialization constants of the triangle shaders only
+    const auto &defaults = shader_layouts::triangle::specializationDefaults;
+    variants.init(settings.pipelineManager, state, {defaults.begin(), defaults.end()});
+    variant = variants.getDefaultKey();
+
+    // Nothing can be drawn without this one. With pipeline libraries a fast-linked pipeline
+    // is ready right away, otherwise wait for the compile. It stays the fallback for pipelines
+    // requested later on while they compile in the background.
+    pipeline = variants.get(variant, VK_NULL_HANDLE);
+    if (pipeline == VK_NULL_HANDLE) {
+        pipeline = variants.request(variant).get();
+    }
+    return pipeline != VK_NULL_HANDLE;
+}
+
+bool FrameRenderer::initQuad() {
+    RESOURCE_SCOPE("Quad");
+    const Vertex vertexData[] = {
+            {.position {-100.0f, -20.0f}, .color {1.0f, 1.0f, 0.0f, 1.0f}},
+            {.position {100.0f, -60.0f}, .color {1.0f, 0.0f, 1.0f, 1.0f}},
+            {.position {30.0f, 100.0f}, .color {0.0f, 1.0f, 1.0f, 1.0f}},
+            {.position {-170.0f, 140.0f}, .color {1.0f, 1.0f, 1.0f, 1.0f}},
+    };
+    constexpr uint16_t indices[] = {
+            0, 1, 2,
+            2, 3, 0
+    };
+
+    // Positions are stored relative to the bounds of the triangles, the model transform maps
+    // them back
+    constexpr size_t vertexCount = std::size(vertexData);
+    std::vector<uint8_t> packedData(vertexCount * vertexLayout.stride);
+    const auto quantizations = vertex_packing::encode(
+            vertexLayout,
+            {{.data = &vertexData[0].position.x, .stride = sizeof(Vertex)},
+             {.data = &vertexData[0].color.x, .stride = sizeof(Vertex)}},
+            vertexCount, packedData.data());
+    positionScale = glm::vec2{quantizations[0].scale};
+    positionOffset = glm::vec2{quantizations[0].offset};
+
+    return createFilledBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, packedData.data(),
+                              packedData.size(), vertexBuffer, vertexMemory) &&
+           createFilledBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indices, sizeof(indices),
+                              indexBuffer, indexMemory);
+}
+
+bool FrameRenderer::createFilledBuffer(VkBufferUsageFlags usage, const void *data,
+                                       VkDeviceSize size, VkBuffer &buffer,
+                                       VkDeviceMemory &memory) const {
+    if (vulkan_common::createBuffer(settings.gpu, settings.device, size, usage,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                    &buffer, &memory) != VK_SUCCESS) {
+        return false;
+    }
+
+    void *mapped;
+    CALL_VK(vkMapMemory(settings.device, memory, 0, size, 0, &mapped))
+    memcpy(mapped, data, size);
+    vkUnmapMemory(settings.device, memory);
+    return true;
+}
+
+/**
+ * @brief Starts rendering into the target, either through the render pass and its framebuffer or
+ * directly from the image view with dynamic rendering
+ */
+void FrameRenderer::beginRendering(VkCommandBuffer commandBuffer, const Target &target) const {
+    const VkClearValue clearValue{
+            .color {
+                    .float32 {0.01f, 0.01f, 0.033f, 1.0f}
+            },
+    };
+
+    const VkRect2D renderArea{
+            .offset {.x = 0, .y = 0},
+            .extent = target.extent,
+    };
+
+    if (settings.renderPass != VK_NULL_HANDLE) {
+        const VkRenderPassBeginInfo renderPassBeginInfo{
+                .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+                .pNext = nullptr,
+                .renderPass = settings.renderPass,
+                .framebuffer = target.framebuffer,
+                .renderArea = renderArea,
+                .clearValueCount = 1,
+                .pClearValues = &clearValue
+        };
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    // Replaces the initial layout and the external subpass dependency of the render pass.
+    // Waiting on the color attachment output stage chains with a swapchain acquire semaphore.
+    vulkan_common::transitionImageLayout(commandBuffer, target.image,
+                                         VK_IMAGE_LAYOUT_UNDEFINED,
+                                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                         VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+                                         VK_ACCESS_2_NONE_KHR,
+                                         VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+                                         VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT_KHR |
+                                         VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR);
+
+    const VkRenderingAttachmentInfoKHR colorAttachment{
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
+            .pNext = nullptr,
+            .imageView = target.imageView,
+            .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .resolveMode = VK_RESOLVE_MODE_NONE_KHR,
+            .resolveImageView = VK_NULL_HANDLE,
+            .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            // When starting the frame, we want tiles to be cleared
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            // When ending the frame, we want tiles to be written out
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue = clearValue
+    };
+
+    const VkRenderingInfoKHR renderingInfo{
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+            .pNext = nullptr,
+            .flags = 0,
+            .renderArea = renderArea,
+            .layerCount = 1,
+            .viewMask = 0,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &colorAttachment,
+            .pDepthAttachment = nullptr,
+            .pStencilAttachment = nullptr
+    };
+    vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+}
+
+/**
+ * @brief Ends rendering into the target and leaves its image in the final layout
+ */
+void FrameRenderer::endRendering(VkCommandBuffer commandBuffer, const Target &target) const {
+    if (settings.renderPass != VK_NULL_HANDLE) {
+        vkCmdEndRenderPass(commandBuffer);
+        return;
+    }
+
+    vkCmdEndRenderingKHR(commandBuffer);
+    if (settings.finalLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
+        return;
+    }
+
+    // Replaces the final layout of the render pass. Whatever uses the image next waits for the
+    // submission, e.g. presentation on the release semaphore, so there is no destination stage.
+    vulkan_common::transitionImageLayout(commandBuffer, target.image,
+                                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                         settings.finalLayout,
+                                         VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+                                         VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR,
+                                         VK_PIPELINE_STAGE_2_NONE_KHR,
+                                         VK_ACCESS_2_NONE_KHR);
+}
+
+FrameRenderer::TransformConstants FrameRenderer::transform(
+        float time, uint32_t object, const glm::mat4x4 &projectionMatrix) const {
+    const float timestamp = time + 0.1f * static_cast<float>(object);
+
+    constexpr float pulseRate = 1.5f;
+    const float scaleFactor = 1.0f + 0.5f * std::cos(pulseRate * timestamp);
+    const glm::vec2 scale{scaleFactor, scaleFactor};
+
+    constexpr float rotationRate = 2.5f;
+    const float rotationAngle = rotationRate * timestamp;
+
+    constexpr float orbitalRadius = 200.0f;
+    const glm::vec2 translation =
+            orbitalRadius * glm::vec2{std::cos(timestamp), std::sin(timestamp)};
+
+    // Applies the dequantization first: the offset moves through the rotation and scale into the
+    // translation and the scales multiply, no matrix product per draw
+    glm::mat3x2 model = math_utils::affine2D(translation, rotationAngle, scale);
+    model[2] += model[0] * positionOffset.x + model[1] * positionOffset.y;
+    model[0] *= positionScale.x;
+    model[1] *= positionScale.y;
+
+    return {
+            .modelMatrix = math_utils::toMatrix(model),
+            .projectionMatrix = projectionMatrix
+    };
+}
@@ -0,0 +1,186 @@
+//
+// Created by eternal on 2024/7/19.
+//
+
+#ifndef LEARNINGVULKAN_FRAMERENDERER_HH
+#define LEARNINGVULKAN_FRAMERENDERER_HH
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "BindlessDescriptors.hh"
+#include "DrawConstants.hh"
+#include "GpuProfiler.hh"
+#include "LayoutCache.hh"
+#include "Overlay.hh"
+#include "PipelineManager.hh"
+#include "ShaderModuleCache.hh"
+#include "ShaderVariants.hh"
+#include "VertexPacking.hh"
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Records the frames of TriangleApp: the animated quad, once per object, and the overlay
+ *
+ * Has no window of its own. The caller owns the color images and the command buffers, waits for
+ * the previous submission of a frame index before recording it again and submits the recorded
+ * command buffer, e.g. with the semaphores of a swapchain image.
+ *
+ * With BindlessDescriptors the objects are one instanced draw: their model matrices go into a
+ * storage buffer per frame in flight, registered in the bindless set, and triangle_bindless.vert
+ * reads them by instance index. Otherwise each object is a draw of its own with DrawConstants.
+ */
+class FrameRenderer {
+public:
+    struct Settings {
+        VkPhysicalDevice gpu = VK_NULL_HANDLE;
+
+        VkDevice device = VK_NULL_HANDLE;
+
+        LayoutCache *layoutCache = nullptr;
+
+        ShaderModuleCache *shaderModules = nullptr;
+
+        PipelineManager *pipelineManager = nullptr;
+
+        GpuProfiler *gpuProfiler = nullptr;
+
+        /// Optional, the objects are drawn through its set when given
+        BindlessDescriptors *bindless = nullptr;
+
+        /// VK_NULL_HANDLE renders with VK_KHR_dynamic_rendering
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+
+        VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+
+        /// Layout the color image is left in with dynamic rendering, a render pass has its own
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        uint32_t frameCount = 0;
+
+        uint32_t maxObjectsPerFrame = 1;
+    };
+
+    /// Color attachment of a frame
+    struct Target {
+        VkImage image = VK_NULL_HANDLE;
+
+        VkImageView imageView = VK_NULL_HANDLE;
+
+        /// Only used with a render pass
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+        VkExtent2D extent{};
+    };
+
+    struct Counters {
+        uint32_t draws = 0;
+
+        /// CPU time of recording the overlay
+        float overlayMilliseconds = 0.0f;
+    };
+
+    /// The caches, the pipeline manager, the profiler and the bindless descriptors have to outlive
+    /// this object
+    bool init(const Settings &settings);
+
+    void teardown();
+
+    /// Variant drawn, e.g. with specialization::COLOR_MODE set to 1 for grayscale. It is compiled
+    /// on first use, the default pipeline is drawn meanwhile.
+    void setVariant(ShaderVariants::Key key);
+
+    ShaderVariants &getVariants();
+
+    /**
+     * @brief Records a frame into commandBuffer, from begin to end
+     * @param frameIndex Below Settings::frameCount, its previous submission has to be complete
+     * @param time Seconds since the start of the animation
+     * @param objectCount Quads drawn, at most Settings::maxObjectsPerFrame
+     * @param overlay Drawn on top when not nullptr, after its beginFrame for this frame index
+     */
+    Counters record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Target &target,
+                    float time, uint32_t objectCount, Overlay *overlay);
+
+private:
+    /// Per-draw constants, checked against the reflected DrawConstants block of triangle.vert
+    struct TransformConstants {
+        glm::mat4x4 modelMatrix;
+
+        glm::mat4x4 projectionMatrix;
+    };
+
+    /// Push constants of triangle_bindless.vert, checked against its reflected range
+    struct FrameConstants {
+        glm::mat4x4 projectionMatrix;
+
+        /// Bindless slot of the frame's TransformBuffer
+        uint32_t transformBuffer;
+    };
+
+    /// Model matrices of one frame in flight, indexed by instance
+    struct TransformBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+
+        /// Persistently mapped, maxObjectsPerFrame matrices
+        glm::mat4x4 *matrices = nullptr;
+
+        uint32_t slot = BindlessDescriptors::kInvalidIndex;
+    };
+
+    Settings settings{};
+
+    /// Without bindless descriptors only
+    DrawConstants drawConstants{};
+
+    /// With bindless descriptors only, one per frame in flight
+    std::vector<TransformBuffer> transformBuffers{};
+
+    /// Owned by the layout cache
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+    ShaderVariants variants{};
+
+    ShaderVariants::Key variant{};
+
+    /// The default variant, owned by the pipeline manager
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+
+    VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
+
+    /// Packed form of the triangle.vert inputs, Snorm16 positions and Unorm8 colors
+    vertex_packing::Layout vertexLayout{};
+
+    /// Maps the Snorm16 positions back to the ones they were encoded from, position = offset +
+    /// decoded * scale. Folded into the model transform of every draw.
+    glm::vec2 positionScale{1.0f};
+
+    glm::vec2 positionOffset{0.0f};
+
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+
+    VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+
+    bool initTransformBuffers();
+
+    bool initPipeline();
+
+    bool initQuad();
+
+    bool createFilledBuffer(VkBufferUsageFlags usage, const void *data, VkDeviceSize size,
+                            VkBuffer &buffer, VkDeviceMemory &memory) const;
+
+    void beginRendering(VkCommandBuffer commandBuffer, const Target &target) const;
+
+    void endRendering(VkCommandBuffer commandBuffer, const Target &target) const;
+
+    /// Each object runs the animation a bit further along, the model matrix includes the
+    /// dequantization of the positions
+    TransformConstants transform(float time, uint32_t object,
+                                 const glm::mat4x4 &projectionMatrix) const;
+};
+
+#endif //LEARNINGVULKAN_FRAMERENDERER_HH
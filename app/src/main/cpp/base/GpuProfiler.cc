@@ -0,0 +1,373 @@
+//
+// Created by eternal on 2024/7/14.
+//
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "CpuProfiler.hh"
+#include "Debug.hh"
+#include "GpuProfiler.hh"
+
+namespace {
+    int64_t steadyNanoseconds(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                time.time_since_epoch()).count();
+    }
+}
+
+bool GpuProfiler::init(VkPhysicalDevice gpu, VkDevice vkDevice, VkQueue queue,
+                       uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t maxScopes,
+                       bool calibrated) {
+    device = vkDevice;
+    maxScopesPerFrame = maxScopes;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, queueFamilies.data());
+
+    timestampValidBits = queueFamilies.at(queueFamilyIndex).timestampValidBits;
+    if (timestampValidBits == 0) {
+        LOGW("GPU profiler: queue family %u does not support timestamps", queueFamilyIndex);
+        return false;
+    }
+    timestampMask = timestampValidBits >= 64 ? UINT64_MAX : (1ull << timestampValidBits) - 1;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(gpu, &properties);
+    timestampPeriod = properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = frameCount * maxScopesPerFrame * 2,
+            .pipelineStatistics = 0
+    };
+    if (vkCreateQueryPool(device, &queryPoolCreateInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        LOGE("GPU profiler: failed to create a pool of %u timestamp queries",
+             queryPoolCreateInfo.queryCount);
+        queryPool = VK_NULL_HANDLE;
+        return false;
+    }
+
+    frameScopes.resize(frameCount);
+    for (auto &scopes: frameScopes) {
+        scopes.reserve(maxScopesPerFrame);
+    }
+    results.reserve(maxScopesPerFrame * 4);
+    history.resize(kHistorySize);
+
+    calibratedTimestamps = calibrated && supportsMonotonicClock(gpu) && calibrate();
+    if (!calibratedTimestamps && !calibrateWithSubmit(queue, queueFamilyIndex)) {
+        LOGW("GPU profiler: calibration failed, GPU scopes are not aligned with the CPU timeline");
+    }
+
+    LOGI("GPU profiler: %u scopes per frame, %u valid bits, %.2f ns per tick, %s",
+         maxScopesPerFrame, timestampValidBits, timestampPeriod,
+         calibratedTimestamps ? "calibrated timestamps" : "calibrated once");
+    return true;
+}
+
+void GpuProfiler::teardown() {
+    if (queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+        queryPool = VK_NULL_HANDLE;
+    }
+    frameScopes.clear();
+    currentScopes = nullptr;
+    openScopes.clear();
+    timings.clear();
+    history.clear();
+    historyNext = 0;
+}
+
+bool GpuProfiler::isEnabled() const {
+    return queryPool != VK_NULL_HANDLE;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (!isEnabled()) {
+        return;
+    }
+    assert(frameIndex < frameScopes.size());
+    assert(openScopes.empty());
+
+    readResults(frameIndex);
+
+    currentScopes = &frameScopes[frameIndex];
+    currentScopes->clear();
+    firstQuery = frameIndex * maxScopesPerFrame * 2;
+    vkCmdResetQueryPool(commandBuffer, queryPool, firstQuery, maxScopesPerFrame * 2);
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char *name) {
+    if (currentScopes == nullptr) {
+        return kInvalidScope;
+    }
+    if (currentScopes->size() >= maxScopesPerFrame) {
+        if (!overflowLogged) {
+            LOGW("GPU profiler: more than %u scopes in a frame, %s and later ones are dropped",
+                 maxScopesPerFrame, name);
+            overflowLogged = true;
+        }
+        return kInvalidScope;
+    }
+
+    const auto scope = static_cast<uint32_t>(currentScopes->size());
+    currentScopes->push_back({
+            .name = name,
+            .depth = static_cast<uint32_t>(openScopes.size())
+    });
+    openScopes.push_back(scope);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool,
+                        firstQuery + scope * 2);
+    return scope;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+    if (scope == kInvalidScope) {
+        return;
+    }
+    assert(!openScopes.empty() && openScopes.back() == scope);
+    openScopes.pop_back();
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool,
+                        firstQuery + scope * 2 + 1);
+}
+
+const std::vector<GpuProfiler::ScopeTiming> &GpuProfiler::getTimings() const {
+    return timings;
+}
+
+double GpuProfiler::getMilliseconds(std::string_view name) const {
+    double milliseconds = 0.0;
+    for (const auto &timing: timings) {
+        if (name == timing.name) {
+            milliseconds += timing.milliseconds;
+        }
+    }
+    return milliseconds;
+}
+
+double GpuProfiler::getFrameMilliseconds() const {
+    return frameMilliseconds;
+}
+
+bool GpuProfiler::writeTrace(const char *path) const {
+    FILE *file = fopen(path, "w");
+    if (file == nullptr) {
+        LOGE("GPU profiler: failed to open %s", path);
+        return false;
+    }
+
+    // Complete events on a thread of their own, timestamps are in microseconds
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, R"({"name":"thread_name","ph":"M","pid":1,"tid":0,"args":{"name":"GPU"}})");
+    for (size_t i = 0; i < history.size(); ++i) {
+        const ScopeTiming &timing = history[(historyNext + i) % history.size()];
+        if (timing.name == nullptr) {
+            continue;
+        }
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":0,"
+                      "\"ts\":%.3f,\"dur\":%.3f}",
+                timing.name, static_cast<double>(timing.beginNanoseconds) / 1000.0,
+                timing.milliseconds * 1000.0);
+    }
+    fprintf(file, "\n]}\n");
+
+    const bool written = ferror(file) == 0;
+    fclose(file);
+    return written;
+}
+
+void GpuProfiler::readResults(uint32_t frameIndex) {
+    std::vector<PendingScope> &scopes = frameScopes[frameIndex];
+    if (scopes.empty()) {
+        return;
+    }
+
+    // A value and an availability word per query. The frame's fence was waited on, so nothing
+    // should be pending, scopes that are anyway are skipped rather than waited for.
+    const auto queryCount = static_cast<uint32_t>(scopes.size() * 2);
+    results.resize(queryCount * 2);
+    const VkResult result = vkGetQueryPoolResults(
+            device, queryPool, frameIndex * maxScopesPerFrame * 2, queryCount,
+            results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        LOGW("GPU profiler: failed to read timestamps (%d)", result);
+        scopes.clear();
+        return;
+    }
+
+    // Device and host clocks drift apart, the reference is refreshed for every frame
+    if (calibratedTimestamps) {
+        calibrate();
+    }
+
+#if CPU_PROFILER_ENABLED
+    // Next to the CPU threads in cpu_profiler traces
+    static const cpu_profiler::Track gpuTrack = cpu_profiler::createTrack("GPU");
+#endif
+
+    timings.clear();
+    int64_t frameBegin = INT64_MAX;
+    int64_t frameEnd = INT64_MIN;
+    for (size_t i = 0; i < scopes.size(); ++i) {
+        const uint64_t *scope = &results[i * 4];
+        if (scope[1] == 0 || scope[3] == 0) {
+            continue;
+        }
+
+        const ScopeTiming timing{
+                .name = scopes[i].name,
+                .depth = scopes[i].depth,
+                .beginNanoseconds = toNanoseconds(scope[0]),
+                .milliseconds = static_cast<double>(ticksSince(scope[2], scope[0])) *
+                                timestampPeriod / 1e6
+        };
+        timings.push_back(timing);
+        history[historyNext] = timing;
+        historyNext = (historyNext + 1) % history.size();
+
+        const int64_t end = timing.beginNanoseconds + std::llround(timing.milliseconds * 1e6);
+        frameBegin = std::min(frameBegin, timing.beginNanoseconds);
+        frameEnd = std::max(frameEnd, end);
+#if CPU_PROFILER_ENABLED
+        cpu_profiler::recordZone(gpuTrack, timing.name, timing.beginNanoseconds, end);
+#endif
+    }
+    frameMilliseconds = timings.empty() ? 0.0 : static_cast<double>(frameEnd - frameBegin) / 1e6;
+    scopes.clear();
+}
+
+int64_t GpuProfiler::toNanoseconds(uint64_t ticks) const {
+    return referenceNanoseconds +
+           std::llround(static_cast<double>(ticksSince(ticks, referenceTicks)) * timestampPeriod);
+}
+
+int64_t GpuProfiler::ticksSince(uint64_t ticks, uint64_t reference) const {
+    uint64_t delta = (ticks - reference) & timestampMask;
+    if (timestampValidBits < 64 && (delta >> (timestampValidBits - 1)) != 0) {
+        delta |= ~timestampMask;
+    }
+    return static_cast<int64_t>(delta);
+}
+
+bool GpuProfiler::calibrate() {
+    // std::chrono::steady_clock is CLOCK_MONOTONIC on Linux and Android
+    const VkCalibratedTimestampInfoEXT timestampInfos[]{
+            {
+                    .sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT,
+                    .pNext = nullptr,
+                    .timeDomain = VK_TIME_DOMAIN_DEVICE_EXT
+            },
+            {
+                    .sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT,
+                    .pNext = nullptr,
+                    .timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT
+            }
+    };
+    uint64_t timestamps[2];
+    uint64_t maxDeviation;
+    if (vkGetCalibratedTimestampsEXT(device, 2, timestampInfos, timestamps, &maxDeviation) !=
+        VK_SUCCESS) {
+        return false;
+    }
+    referenceTicks = timestamps[0];
+    referenceNanoseconds = static_cast<int64_t>(timestamps[1]);
+    return true;
+}
+
+bool GpuProfiler::calibrateWithSubmit(VkQueue queue, uint32_t queueFamilyIndex) {
+    VkCommandPoolCreateInfo commandPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queueFamilyIndex
+    };
+    VkCommandPool commandPool;
+    if (vkCreateCommandPool(device, &commandPoolCreateInfo, nullptr, &commandPool) !=
+        VK_SUCCESS) {
+        return false;
+    }
+
+    VkCommandBufferAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+    };
+    VkCommandBuffer commandBuffer;
+    VkResult result = vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer);
+
+    if (result == VK_SUCCESS) {
+        VkCommandBufferBeginInfo beginInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .pNext = nullptr,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+                .pInheritanceInfo = nullptr
+        };
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+        result = vkEndCommandBuffer(commandBuffer);
+    }
+
+    VkSubmitInfo submitInfo{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .waitSemaphoreCount = 0,
+            .pWaitSemaphores = nullptr,
+            .pWaitDstStageMask = nullptr,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer,
+            .signalSemaphoreCount = 0,
+            .pSignalSemaphores = nullptr
+    };
+    const auto submitted = std::chrono::steady_clock::now();
+    if (result == VK_SUCCESS) {
+        result = vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+    if (result == VK_SUCCESS) {
+        result = vkQueueWaitIdle(queue);
+    }
+    const auto idle = std::chrono::steady_clock::now();
+
+    uint64_t ticks = 0;
+    if (result == VK_SUCCESS) {
+        result = vkGetQueryPoolResults(device, queryPool, 0, 1, sizeof(ticks), &ticks,
+                                       sizeof(ticks),
+                                       VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    }
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    if (result != VK_SUCCESS) {
+        return false;
+    }
+
+    // The timestamp was written somewhere between the submit and the queue going idle, so the
+    // reference is off by at most half of that round trip
+    referenceTicks = ticks;
+    referenceNanoseconds = steadyNanoseconds(submitted + (idle - submitted) / 2);
+    return true;
+}
+
+bool GpuProfiler::supportsMonotonicClock(VkPhysicalDevice gpu) {
+    if (!VK_IS_AVAILABLE(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)) {
+        return false;
+    }
+    uint32_t timeDomainCount = 0;
+    vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(gpu, &timeDomainCount, nullptr);
+    std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+    vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(gpu, &timeDomainCount, timeDomains.data());
+
+    const bool hasDevice = std::find(timeDomains.begin(), timeDomains.end(),
+                                     VK_TIME_DOMAIN_DEVICE_EXT) != timeDomains.end();
+    const bool hasMonotonic = std::find(timeDomains.begin(), timeDomains.end(),
+                                        VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT) != timeDomains.end();
+    return hasDevice && hasMonotonic;
+}
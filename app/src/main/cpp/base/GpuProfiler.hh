@@ -0,0 +1,168 @@
+//
+// Created by eternal on 2024/7/14.
+//
+
+#ifndef LEARNINGVULKAN_GPUPROFILER_HH
+#define LEARNINGVULKAN_GPUPROFILER_HH
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief GPU time of named scopes, measured with timestamp queries
+ *
+ * Every frame in flight owns a range of one query pool, a scope writes a timestamp at its begin
+ * and its end. The results of a frame are read in the next beginFrame with the same frame index,
+ * once its fence was waited on, so reading never stalls. Times are put on the CPU timeline
+ * (std::chrono::steady_clock) with VK_EXT_calibrated_timestamps when it is enabled, otherwise
+ * with a timestamp submitted once in init.
+ *
+ * Only to be used from the thread recording the frames. Scope names are not copied, they have to
+ * outlive the profiler, e.g. string literals.
+ */
+class GpuProfiler {
+public:
+    struct ScopeTiming {
+        const char *name = nullptr;
+
+        /// Number of scopes open around this one
+        uint32_t depth = 0;
+
+        /// Begin on the steady clock, in nanoseconds since its epoch
+        int64_t beginNanoseconds = 0;
+
+        double milliseconds = 0.0;
+    };
+
+    static constexpr uint32_t kInvalidScope = UINT32_MAX;
+
+    /// Closes the scope when it goes out of scope
+    class Scope {
+    public:
+        Scope(GpuProfiler &profiler, VkCommandBuffer commandBuffer, const char *name)
+                : profiler(profiler), commandBuffer(commandBuffer),
+                  scope(profiler.beginScope(commandBuffer, name)) {}
+
+        ~Scope() {
+            profiler.endScope(commandBuffer, scope);
+        }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        GpuProfiler &profiler;
+
+        VkCommandBuffer commandBuffer;
+
+        uint32_t scope;
+    };
+
+    /**
+     * @param queue Only used in init, to calibrate without VK_EXT_calibrated_timestamps
+     * @param calibratedTimestamps Whether VK_EXT_calibrated_timestamps is enabled on the device
+     * @return false if the queue family has no timestamps, scopes are no-ops then
+     */
+    bool init(VkPhysicalDevice gpu, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex,
+              uint32_t frameCount, uint32_t maxScopesPerFrame, bool calibratedTimestamps);
+
+    void teardown();
+
+    bool isEnabled() const;
+
+    /**
+     * @brief Reads the results of the last frame with this index and resets its queries
+     *
+     * Has to be recorded outside of a render pass, before the first scope of the frame.
+     */
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+    /// @return kInvalidScope once the frame ran out of queries, endScope ignores it
+    uint32_t beginScope(VkCommandBuffer commandBuffer, const char *name);
+
+    void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+    /// Scopes of the latest frame that was read back, in the order they began
+    const std::vector<ScopeTiming> &getTimings() const;
+
+    /// Sum of the scopes with this name in the latest frame that was read back
+    double getMilliseconds(std::string_view name) const;
+
+    /// From the first begin to the last end of the latest frame that was read back
+    double getFrameMilliseconds() const;
+
+    /// Writes the scopes of the last frames as a Chrome trace (chrome://tracing, Perfetto)
+    bool writeTrace(const char *path) const;
+
+private:
+    struct PendingScope {
+        const char *name;
+
+        uint32_t depth;
+    };
+
+    /// Scopes kept for writeTrace, about a second of a few passes at 60 fps
+    static constexpr size_t kHistorySize = 1024;
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+
+    uint32_t maxScopesPerFrame = 0;
+
+    double timestampPeriod = 1.0;
+
+    uint32_t timestampValidBits = 0;
+
+    uint64_t timestampMask = 0;
+
+    bool calibratedTimestamps = false;
+
+    /// A device timestamp and the steady clock at the same moment
+    uint64_t referenceTicks = 0;
+
+    int64_t referenceNanoseconds = 0;
+
+    /// Scopes recorded per frame index, until their results are read
+    std::vector<std::vector<PendingScope>> frameScopes{};
+
+    /// Scopes of the frame being recorded, nullptr before the first beginFrame
+    std::vector<PendingScope> *currentScopes = nullptr;
+
+    uint32_t firstQuery = 0;
+
+    /// Scopes of the current frame that are still open
+    std::vector<uint32_t> openScopes{};
+
+    std::vector<uint64_t> results{};
+
+    std::vector<ScopeTiming> timings{};
+
+    double frameMilliseconds = 0.0;
+
+    std::vector<ScopeTiming> history{};
+
+    size_t historyNext = 0;
+
+    bool overflowLogged = false;
+
+    bool calibrate();
+
+    bool calibrateWithSubmit(VkQueue queue, uint32_t queueFamilyIndex);
+
+    void readResults(uint32_t frameIndex);
+
+    /// Steady clock time of a device timestamp, in nanoseconds
+    int64_t toNanoseconds(uint64_t ticks) const;
+
+    /// Ticks from reference to ticks, negative if ticks is earlier. Handles the wrap around of
+    /// timestamps with less than 64 valid bits.
+    int64_t ticksSince(uint64_t ticks, uint64_t reference) const;
+
+    static bool supportsMonotonicClock(VkPhysicalDevice gpu);
+};
+
+#endif //LEARNINGVULKAN_GPUPROFILER_HH
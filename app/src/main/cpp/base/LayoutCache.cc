@@ -0,0 +1,248 @@
+//
+// Created by eternal on 2024/7/4.
+//
+#include <algorithm>
+#include <bit>
+#include <tuple>
+#include <type_traits>
+#include "Debug.hh"
+#include "HashUtils.hh"
+#include "LayoutCache.hh"
+
+namespace {
+    /// Non-dispatchable handles are pointers on 64-bit platforms and uint64_t elsewhere
+    template<typename Handle>
+    uint64_t handleBits(Handle handle) {
+        if constexpr (std::is_pointer_v<Handle>) {
+            return reinterpret_cast<uintptr_t>(handle);
+        } else {
+            return handle;
+        }
+    }
+
+    uint64_t floatBits(float value) {
+        return std::bit_cast<uint32_t>(value);
+    }
+
+    bool hasImmutableSamplers(const VkDescriptorSetLayoutBinding &binding) {
+        return binding.pImmutableSamplers != nullptr &&
+               (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    }
+
+    /// Returns false if the create info chains structures that are not understood
+    bool normalize(const VkDescriptorSetLayoutCreateInfo &createInfo, std::vector<uint64_t> &key) {
+        const VkDescriptorBindingFlagsEXT *bindingFlags = nullptr;
+        for (auto next = static_cast<const VkBaseInStructure *>(createInfo.pNext);
+             next != nullptr; next = next->pNext) {
+            constexpr auto bindingFlagsType =
+                    VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+            if (next->sType != bindingFlagsType) {
+                return false;
+            }
+            const auto flagsInfo =
+                    reinterpret_cast<const VkDescriptorSetLayoutBindingFlagsCreateInfoEXT *>(next);
+            if (flagsInfo->bindingCount != 0) {
+                bindingFlags = flagsInfo->pBindingFlags;
+            }
+        }
+
+        // Binding order in the create info has no meaning, the binding numbers do
+        std::vector<uint32_t> order(createInfo.bindingCount);
+        for (uint32_t i = 0; i < createInfo.bindingCount; ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&createInfo](uint32_t a, uint32_t b) {
+            return createInfo.pBindings[a].binding < createInfo.pBindings[b].binding;
+        });
+
+        key.push_back(createInfo.flags);
+        key.push_back(createInfo.bindingCount);
+        for (uint32_t i: order) {
+            const VkDescriptorSetLayoutBinding &binding = createInfo.pBindings[i];
+            key.push_back(binding.binding);
+            key.push_back(binding.descriptorType);
+            key.push_back(binding.descriptorCount);
+            key.push_back(binding.stageFlags);
+            key.push_back(bindingFlags != nullptr ? bindingFlags[i] : 0);
+
+            // pImmutableSamplers is ignored for the other descriptor types
+            if (hasImmutableSamplers(binding)) {
+                key.push_back(binding.descriptorCount);
+                for (uint32_t j = 0; j < binding.descriptorCount; ++j) {
+                    key.push_back(handleBits(binding.pImmutableSamplers[j]));
+                }
+            } else {
+                key.push_back(0);
+            }
+        }
+        return true;
+    }
+
+    bool normalize(const VkPipelineLayoutCreateInfo &createInfo, std::vector<uint64_t> &key) {
+        if (createInfo.pNext != nullptr) {
+            return false;
+        }
+
+        key.push_back(createInfo.flags);
+        key.push_back(createInfo.setLayoutCount);
+        for (uint32_t i = 0; i < createInfo.setLayoutCount; ++i) {
+            key.push_back(handleBits(createInfo.pSetLayouts[i]));
+        }
+
+        // Unlike set layouts, push constant ranges are unordered
+        std::vector<VkPushConstantRange> ranges(
+                createInfo.pPushConstantRanges,
+                createInfo.pPushConstantRanges + createInfo.pushConstantRangeCount);
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const VkPushConstantRange &a, const VkPushConstantRange &b) {
+                      return std::tie(a.offset, a.size, a.stageFlags) <
+                             std::tie(b.offset, b.size, b.stageFlags);
+                  });
+        key.push_back(ranges.size());
+        for (const auto &range: ranges) {
+            key.push_back(range.stageFlags);
+            key.push_back(range.offset);
+            key.push_back(range.size);
+        }
+        return true;
+    }
+
+    bool normalize(const VkSamplerCreateInfo &createInfo, std::vector<uint64_t> &key) {
+        // YCbCr conversions and custom border colors are not shared
+        if (createInfo.pNext != nullptr) {
+            return false;
+        }
+
+        const bool clampToBorder =
+                createInfo.addressModeU == VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER ||
+                createInfo.addressModeV == VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER ||
+                createInfo.addressModeW == VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+
+        // Fields that only count when the feature using them is enabled are cleared otherwise
+        key.push_back(createInfo.flags);
+        key.push_back(createInfo.magFilter);
+        key.push_back(createInfo.minFilter);
+        key.push_back(createInfo.mipmapMode);
+        key.push_back(createInfo.addressModeU);
+        key.push_back(createInfo.addressModeV);
+        key.push_back(createInfo.addressModeW);
+        key.push_back(floatBits(createInfo.mipLodBias));
+        key.push_back(createInfo.anisotropyEnable);
+        key.push_back(floatBits(createInfo.anisotropyEnable ? createInfo.maxAnisotropy : 1.0f));
+        key.push_back(createInfo.compareEnable);
+        key.push_back(createInfo.compareEnable ? createInfo.compareOp : VK_COMPARE_OP_NEVER);
+        key.push_back(floatBits(createInfo.minLod));
+        key.push_back(floatBits(createInfo.maxLod));
+        key.push_back(clampToBorder ? createInfo.borderColor : 0);
+        key.push_back(createInfo.unnormalizedCoordinates);
+        return true;
+    }
+
+    template<typename Cache, typename CreateInfo, typename Create>
+    auto lookup(Cache &cache, const CreateInfo &createInfo, Create create) {
+        typename decltype(cache.handles)::mapped_type handle = VK_NULL_HANDLE;
+
+        std::vector<uint64_t> key;
+        if (!normalize(createInfo, key)) {
+            ++cache.stats.misses;
+            if (create(&handle) == VK_SUCCESS) {
+                cache.unshared.push_back(handle);
+            }
+            return handle;
+        }
+
+        const auto found = cache.handles.find(key);
+        if (found != cache.handles.end()) {
+            ++cache.stats.hits;
+            return found->second;
+        }
+
+        ++cache.stats.misses;
+        const VkResult result = create(&handle);
+        if (result != VK_SUCCESS) {
+            LOGE("Layout cache: creation failed: %d", result);
+            return handle;
+        }
+        cache.handles.emplace(std::move(key), handle);
+        return handle;
+    }
+
+    template<typename Cache, typename Destroy>
+    void clear(Cache &cache, Destroy destroy) {
+        for (const auto &[key, handle]: cache.handles) {
+            destroy(handle);
+        }
+        for (auto handle: cache.unshared) {
+            destroy(handle);
+        }
+        cache.handles.clear();
+        cache.unshared.clear();
+        cache.stats = {};
+    }
+}
+
+size_t LayoutCache::KeyHasher::operator()(const Key &key) const {
+    return static_cast<size_t>(hash_utils::fnv1a(key.data(), key.size() * sizeof(uint64_t)));
+}
+
+void LayoutCache::init(VkDevice vkDevice) {
+    device = vkDevice;
+}
+
+void LayoutCache::teardown() {
+    std::lock_guard lock(mutex);
+
+    LOGI("Layout cache: set layouts %u hits / %u misses, pipeline layouts %u / %u, "
+         "samplers %u / %u", setLayouts.stats.hits, setLayouts.stats.misses,
+         pipelineLayouts.stats.hits, pipelineLayouts.stats.misses,
+         samplers.stats.hits, samplers.stats.misses);
+
+    // Pipeline layouts reference set layouts, which reference immutable samplers
+    clear(pipelineLayouts, [this](VkPipelineLayout layout) {
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    });
+    clear(setLayouts, [this](VkDescriptorSetLayout layout) {
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    });
+    clear(samplers, [this](VkSampler sampler) {
+        vkDestroySampler(device, sampler, nullptr);
+    });
+    device = VK_NULL_HANDLE;
+}
+
+VkDescriptorSetLayout LayoutCache::getSetLayout(const VkDescriptorSetLayoutCreateInfo &createInfo) {
+    std::lock_guard lock(mutex);
+    return lookup(setLayouts, createInfo, [this, &createInfo](VkDescriptorSetLayout *layout) {
+        return vkCreateDescriptorSetLayout(device, &createInfo, nullptr, layout);
+    });
+}
+
+VkPipelineLayout LayoutCache::getPipelineLayout(const VkPipelineLayoutCreateInfo &createInfo) {
+    std::lock_guard lock(mutex);
+    return lookup(pipelineLayouts, createInfo, [this, &createInfo](VkPipelineLayout *layout) {
+        return vkCreatePipelineLayout(device, &createInfo, nullptr, layout);
+    });
+}
+
+VkSampler LayoutCache::getSampler(const VkSamplerCreateInfo &createInfo) {
+    std::lock_guard lock(mutex);
+    return lookup(samplers, createInfo, [this, &createInfo](VkSampler *sampler) {
+        return vkCreateSampler(device, &createInfo, nullptr, sampler);
+    });
+}
+
+LayoutCache::Stats LayoutCache::getSetLayoutStats() const {
+    std::lock_guard lock(mutex);
+    return setLayouts.stats;
+}
+
+LayoutCache::Stats LayoutCache::getPipelineLayoutStats() const {
+    std::lock_guard lock(mutex);
+    return pipelineLayouts.stats;
+}
+
+LayoutCache::Stats LayoutCache::getSamplerStats() const {
+    std::lock_guard lock(mutex);
+    return samplers.stats;
+}
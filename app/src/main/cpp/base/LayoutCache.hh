@@ -0,0 +1,77 @@
+//
+// Created by eternal on 2024/7/4.
+//
+
+#ifndef LEARNINGVULKAN_LAYOUTCACHE_HH
+#define LEARNINGVULKAN_LAYOUTCACHE_HH
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Descriptor set layouts, pipeline layouts and samplers shared by their create info
+ *
+ * Create infos are normalized before hashing: bindings are ordered by binding number, push
+ * constant ranges by offset, and fields Vulkan ignores are cleared. Equal descriptions therefore
+ * get the same handle, and pipelines built from the same descriptions are layout-compatible, so
+ * descriptor sets stay bound across pipeline switches. Handles are owned by the cache and live
+ * until teardown, callers never destroy them. Create infos with extension structures the cache
+ * does not know are created without sharing. Thread-safe.
+ */
+class LayoutCache {
+public:
+    struct Stats {
+        uint32_t hits = 0;
+
+        uint32_t misses = 0;
+    };
+
+    void init(VkDevice device);
+
+    void teardown();
+
+    /// VkDescriptorSetLayoutBindingFlagsCreateInfo may be chained
+    VkDescriptorSetLayout getSetLayout(const VkDescriptorSetLayoutCreateInfo &createInfo);
+
+    VkPipelineLayout getPipelineLayout(const VkPipelineLayoutCreateInfo &createInfo);
+
+    VkSampler getSampler(const VkSamplerCreateInfo &createInfo);
+
+    Stats getSetLayoutStats() const;
+
+    Stats getPipelineLayoutStats() const;
+
+    Stats getSamplerStats() const;
+
+private:
+    /// The normalized create info, serialized into words
+    using Key = std::vector<uint64_t>;
+
+    struct KeyHasher {
+        size_t operator()(const Key &key) const;
+    };
+
+    template<typename Handle>
+    struct Cache {
+        std::unordered_map<Key, Handle, KeyHasher> handles{};
+
+        /// Created from create infos that could not be normalized
+        std::vector<Handle> unshared{};
+
+        Stats stats{};
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    mutable std::mutex mutex{};
+
+    Cache<VkDescriptorSetLayout> setLayouts{};
+
+    Cache<VkPipelineLayout> pipelineLayouts{};
+
+    Cache<VkSampler> samplers{};
+};
+
+#endif //LEARNINGVULKAN_LAYOUTCACHE_HH
@@ -0,0 +1,735 @@
+//
+// Created by eternal on 2024/7/18.
+//
+#include <algorithm>
+#include <array>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "Debug.hh"
+#include "Overlay.hh"
+#include "ResourceTracker.hh"
+#include "VulkanCommon.hh"
+#include "shader_layouts/overlay.layout.hh"
+#include "shader_layouts/overlay_bindless.layout.hh"
+
+namespace {
+    struct Glyph {
+        char character;
+
+        /// Top to bottom, the highest of the five bits is the leftmost texel
+        std::array<uint8_t, Overlay::kGlyphHeight> rows;
+    };
+
+    /// Uppercase only, the characters a performance readout needs
+    constexpr std::array<Glyph, 48> kGlyphs{{
+            {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+            {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+            {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+            {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+            {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+            {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+            {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+            {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+            {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+            {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+            {'A', {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}},
+            {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+            {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+            {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+            {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+            {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+            {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+            {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+            {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+            {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+            {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+            {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+            {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+            {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+            {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+            {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+            {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+            {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+            {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+            {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+            {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+            {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+            {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+            {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+            {'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},
+            {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+            {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},
+            {',', {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}},
+            {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+            {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+            {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+            {'+', {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}},
+            {'=', {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}},
+            {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},
+            {'(', {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}},
+            {')', {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},
+            {'_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}},
+            {'?', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}},
+    }};
+
+    /// A glyph per cell with a blank texel column and row after it, so nearest sampling at the
+    /// edges of a quad never picks up the neighbouring glyph
+    constexpr uint32_t kCellWidth = Overlay::kGlyphWidth + 1;
+
+    constexpr uint32_t kCellHeight = Overlay::kGlyphHeight + 1;
+
+    constexpr uint32_t kCellsPerRow = 16;
+
+    /// The cell after the glyphs is solid, rectangles sample its center
+    constexpr uint32_t kSolidCell = kGlyphs.size();
+
+    constexpr uint32_t kAtlasWidth = kCellsPerRow * kCellWidth;
+
+    constexpr uint32_t kAtlasHeight = (kSolidCell / kCellsPerRow + 1) * kCellHeight;
+
+    constexpr uint8_t kNoCell = 0xFF;
+
+    /// Atlas cell per ASCII character: lowercase maps to uppercase, space to kNoCell and anything
+    /// else without a glyph to '?'
+    constexpr std::array<uint8_t, 128> kCellTable = [] {
+        std::array<uint8_t, 128> table{};
+        uint8_t unknown = 0;
+        for (size_t cell = 0; cell < kGlyphs.size(); ++cell) {
+            if (kGlyphs[cell].character == '?') {
+                unknown = static_cast<uint8_t>(cell);
+            }
+        }
+        table.fill(unknown);
+        for (size_t cell = 0; cell < kGlyphs.size(); ++cell) {
+            const char character = kGlyphs[cell].character;
+            table[static_cast<size_t>(character)] = static_cast<uint8_t>(cell);
+            if (character >= 'A' && character <= 'Z') {
+                table[static_cast<size_t>(character - 'A' + 'a')] = static_cast<uint8_t>(cell);
+            }
+        }
+        table[' '] = kNoCell;
+        return table;
+    }();
+
+    constexpr std::array<float, 4> cellUvRect(uint32_t cell) {
+        return {
+                static_cast<float>(cell % kCellsPerRow * kCellWidth) / kAtlasWidth,
+                static_cast<float>(cell / kCellsPerRow * kCellHeight) / kAtlasHeight,
+                static_cast<float>(Overlay::kGlyphWidth) / kAtlasWidth,
+                static_cast<float>(Overlay::kGlyphHeight) / kAtlasHeight
+        };
+    }
+
+    constexpr std::array<std::array<float, 4>, kGlyphs.size()> kGlyphUvRects = [] {
+        std::array<std::array<float, 4>, kGlyphs.size()> rects{};
+        for (uint32_t cell = 0; cell < kGlyphs.size(); ++cell) {
+            rects[cell] = cellUvRect(cell);
+        }
+        return rects;
+    }();
+
+    /// Every fragment of a rectangle samples the same texel in the middle of the solid cell
+    constexpr std::array<float, 4> kSolidUvRect{
+            (static_cast<float>(kSolidCell % kCellsPerRow * kCellWidth) + 0.5f * kCellWidth) /
+            kAtlasWidth,
+            (static_cast<float>(kSolidCell / kCellsPerRow * kCellHeight) + 0.5f * kCellHeight) /
+            kAtlasHeight,
+            0.0f,
+            0.0f
+    };
+
+    std::vector<uint8_t> rasterizeAtlas() {
+        std::vector<uint8_t> texels(kAtlasWidth * kAtlasHeight, 0);
+        for (uint32_t cell = 0; cell < kGlyphs.size(); ++cell) {
+            const uint32_t left = cell % kCellsPerRow * kCellWidth;
+            const uint32_t top = cell / kCellsPerRow * kCellHeight;
+            for (uint32_t y = 0; y < Overlay::kGlyphHeight; ++y) {
+                for (uint32_t x = 0; x < Overlay::kGlyphWidth; ++x) {
+                    const bool set = kGlyphs[cell].rows[y] >> (Overlay::kGlyphWidth - 1 - x) & 1u;
+                    texels[(top + y) * kAtlasWidth + left + x] = set ? 0xFF : 0x00;
+                }
+            }
+        }
+
+        const uint32_t left = kSolidCell % kCellsPerRow * kCellWidth;
+        const uint32_t top = kSolidCell / kCellsPerRow * kCellHeight;
+        for (uint32_t y = 0; y < kCellHeight; ++y) {
+            memset(&texels[(top + y) * kAtlasWidth + left], 0xFF, kCellWidth);
+        }
+        return texels;
+    }
+}
+
+bool Overlay::init(VkPhysicalDevice gpu, VkDevice vkDevice, VkQueue queue,
+                   uint32_t queueFamilyIndex, LayoutCache *layoutCache,
+                   ShaderModuleCache *shaderModules, PipelineManager *pipelineManager,
+                   VkRenderPass renderPass, VkFormat colorFormat, uint32_t frames,
+                   BindlessDescriptors *bindlessDescriptors) {
+    RESOURCE_SCOPE("Overlay");
+    device = vkDevice;
+    frameCount = frames;
+    bindless = bindlessDescriptors;
+
+    if (!initAtlas(gpu, queue, queueFamilyIndex, layoutCache)) {
+        LOGE("Overlay: failed to create the glyph atlas.");
+        return false;
+    }
+
+    const VkDeviceSize bufferSize = sizeof(Quad) * kMaxQuads * frameCount;
+    if (vulkan_common::createBuffer(gpu, device, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                    &quadBuffer, &quadMemory) != VK_SUCCESS) {
+        LOGE("Overlay: failed to create the quad buffer.");
+        return false;
+    }
+
+    // Stays mapped for the whole lifetime, quads are written in place
+    void *mapped;
+    CALL_VK(vkMapMemory(device, quadMemory, 0, bufferSize, 0, &mapped))
+    mappedQuads = static_cast<Quad *>(mapped);
+
+    return initPipeline(layoutCache, shaderModules, pipelineManager, renderPass, colorFormat);
+}
+
+void Overlay::teardown() {
+    if (quadMemory != VK_NULL_HANDLE) {
+        vkUnmapMemory(device, quadMemory);
+        vkFreeMemory(device, quadMemory, nullptr);
+        quadMemory = VK_NULL_HANDLE;
+    }
+    if (quadBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, quadBuffer, nullptr);
+        quadBuffer = VK_NULL_HANDLE;
+    }
+    mappedQuads = nullptr;
+    quadCount = 0;
+
+    descriptorAllocator.teardown();
+    descriptorSet = VK_NULL_HANDLE;
+
+    if (atlasIndex != BindlessDescriptors::kInvalidIndex) {
+        bindless->releaseImage(atlasIndex);
+        atlasIndex = BindlessDescriptors::kInvalidIndex;
+    }
+    bindless = nullptr;
+
+    if (atlasView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, atlasView, nullptr);
+        atlasView = VK_NULL_HANDLE;
+    }
+    if (atlasImage != VK_NULL_HANDLE) {
+        vkDestroyImage(device, atlasImage, nullptr);
+        atlasImage = VK_NULL_HANDLE;
+    }
+    if (atlasMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, atlasMemory, nullptr);
+        atlasMemory = VK_NULL_HANDLE;
+    }
+
+    // Layouts belong to the layout cache, the pipeline to the pipeline manager
+    setLayout = VK_NULL_HANDLE;
+    pipelineLayout = VK_NULL_HANDLE;
+    pipeline = {};
+
+    device = VK_NULL_HANDLE;
+}
+
+void Overlay::beginFrame(uint32_t frameIndex) {
+    currentFrame = frameIndex % std::max(frameCount, 1u);
+    quadCount = 0;
+}
+
+void Overlay::setScale(float pixelsPerTexel) {
+    scale = pixelsPerTexel;
+}
+
+float Overlay::getLineHeight() const {
+    return static_cast<float>(kGlyphHeight + 2) * scale;
+}
+
+float Overlay::text(float x, float y, uint32_t color, const char *format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    const float advance = static_cast<float>(kGlyphWidth + 1) * scale;
+    const float width = static_cast<float>(kGlyphWidth) * scale;
+    const float height = static_cast<float>(kGlyphHeight) * scale;
+    for (const char *c = buffer; *c != '\0'; ++c, x += advance) {
+        const auto character = static_cast<unsigned char>(*c);
+        const uint8_t cell = kCellTable[character & 0x7F];
+        if (cell != kNoCell) {
+            push(x, y, width, height, kGlyphUvRects[cell].data(), color);
+        }
+    }
+    return x;
+}
+
+void Overlay::rect(float x, float y, float width, float height, uint32_t color) {
+    push(x, y, width, height, kSolidUvRect.data(), color);
+}
+
+void Overlay::graph(float x, float y, float width, float height, const float *values,
+                    size_t size, size_t count, size_t first, float maxValue, uint32_t color) {
+    rect(x, y, width, height, rgba(0, 0, 0, 128));
+    if (size == 0 || maxValue <= 0.0f) {
+        return;
+    }
+
+    const float barWidth = width / static_cast<float>(size);
+    float barX = x + width - static_cast<float>(count) * barWidth;
+    for (size_t i = 0; i < count; ++i, barX += barWidth) {
+        const float value = std::clamp(values[(first + i) % size] / maxValue, 0.0f, 1.0f);
+        const float barHeight = value * height;
+        if (barHeight >= 1.0f) {
+            rect(barX, y + height - barHeight, barWidth, barHeight, color);
+        }
+    }
+}
+
+bool Overlay::draw(VkCommandBuffer commandBuffer, VkExtent2D extent) const {
+    const VkPipeline ready = PipelineManager::getIfReady(pipeline, VK_NULL_HANDLE);
+    if (quadCount == 0 || ready == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, ready);
+
+    const VkViewport viewport{
+            .x = 0,
+            .y = 0,
+            .width = static_cast<float>(extent.width),
+            .height = static_cast<float>(extent.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+    };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    const VkRect2D scissor{
+            .offset {.x = 0, .y = 0},
+            .extent = extent
+    };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                            &descriptorSet, 0, nullptr);
+    if (bindless) {
+        bindless->bind(commandBuffer, pipelineLayout, 1);
+    }
+
+    const PushConstants constants{
+            .pixelToClip {
+                    2.0f / static_cast<float>(extent.width),
+                    2.0f / static_cast<float>(extent.height)
+            }
+    };
+    using shader_layouts::overlay::pushConstantRanges;
+    vkCmdPushConstants(commandBuffer, pipelineLayout, pushConstantRanges[0].stageFlags,
+                       pushConstantRanges[0].offset, pushConstantRanges[0].size, &constants);
+
+    const VkDeviceSize offset = sizeof(Quad) * kMaxQuads * currentFrame;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &quadBuffer, &offset);
+    vkCmdDraw(commandBuffer, 6, quadCount, 0, 0);
+    return true;
+}
+
+uint32_t Overlay::getQuadCount() const {
+    return quadCount;
+}
+
+bool Overlay::initAtlas(VkPhysicalDevice gpu, VkQueue queue, uint32_t queueFamilyIndex,
+                        LayoutCache *layoutCache) {
+    VkImageCreateInfo imageCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = VK_FORMAT_R8_UNORM,
+            .extent {.width = kAtlasWidth, .height = kAtlasHeight, .depth = 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+    if (vkCreateImage(device, &imageCreateInfo, nullptr, &atlasImage) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device, atlasImage, &memoryRequirements);
+    VkMemoryAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .allocationSize = memoryRequirements.size,
+            .memoryTypeIndex = 0
+    };
+    if (!vulkan_common::mapMemoryTypeToIndex(gpu, memoryRequirements.memoryTypeBits,
+                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                             &allocateInfo.memoryTypeIndex) ||
+        vkAllocateMemory(device, &allocateInfo, nullptr, &atlasMemory) != VK_SUCCESS ||
+        vkBindImageMemory(device, atlasImage, atlasMemory, 0) != VK_SUCCESS) {
+        return false;
+    }
+
+    if (!uploadAtlas(gpu, queue, queueFamilyIndex)) {
+        return false;
+    }
+
+    VkImageViewCreateInfo viewCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .image = atlasImage,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = VK_FORMAT_R8_UNORM,
+            .components {
+                    .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .a = VK_COMPONENT_SWIZZLE_IDENTITY
+            },
+            .subresourceRange {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1
+            }
+    };
+    if (vkCreateImageView(device, &viewCreateInfo, nullptr, &atlasView) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Texels map to whole pixels, nearest keeps the glyphs sharp at any integer scale
+    VkSamplerCreateInfo samplerCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .magFilter = VK_FILTER_NEAREST,
+            .minFilter = VK_FILTER_NEAREST,
+            .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+            .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .mipLodBias = 0.0f,
+            .anisotropyEnable = VK_FALSE,
+            .maxAnisotropy = 1.0f,
+            .compareEnable = VK_FALSE,
+            .compareOp = VK_COMPARE_OP_NEVER,
+            .minLod = 0.0f,
+            .maxLod = 0.0f,
+            .borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,
+            .unnormalizedCoordinates = VK_FALSE
+    };
+    const VkSampler sampler = layoutCache->getSampler(samplerCreateInfo);
+    if (sampler == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    // The only binding of overlay.frag. overlay_bindless.frag keeps just the sampler in set 0 and
+    // reads the atlas from the sampled images of the bindless set.
+    constexpr auto &reflected = shader_layouts::overlay::descriptorBindings;
+    static_assert(reflected.size() == 1 && reflected[0].set == 0 && reflected[0].binding == 0 &&
+                  reflected[0].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    constexpr auto &reflectedBindless = shader_layouts::overlay_bindless::descriptorBindings;
+    static_assert(reflectedBindless.size() >= 2 &&
+                  reflectedBindless[0].set == 0 && reflectedBindless[0].binding == 0 &&
+                  reflectedBindless[0].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER &&
+                  reflectedBindless[1].set == 1 &&
+                  reflectedBindless[1].binding == BindlessDescriptors::kSampledImageBinding &&
+                  reflectedBindless[1].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+    const ShaderDescriptorBinding &atlasBinding = bindless ? reflectedBindless[0] : reflected[0];
+    const VkDescriptorSetLayoutBinding binding{
+            .binding = atlasBinding.binding,
+            .descriptorType = atlasBinding.descriptorType,
+            .descriptorCount = atlasBinding.descriptorCount,
+            .stageFlags = atlasBinding.stageFlags,
+            .pImmutableSamplers = nullptr
+    };
+    const VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .bindingCount = 1,
+            .pBindings = &binding
+    };
+    setLayout = layoutCache->getSetLayout(setLayoutCreateInfo);
+    if (setLayout == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    descriptorAllocator.init(device, {{atlasBinding.descriptorType, 1.0f}}, 1);
+    descriptorSet = descriptorAllocator.allocate(setLayout);
+    if (descriptorSet == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    // The atlas never changes, this is the only write
+    const VkDescriptorImageInfo imageInfo{
+            .sampler = sampler,
+            .imageView = bindless ? VK_NULL_HANDLE : atlasView,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    const VkWriteDescriptorSet write{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = descriptorSet,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = atlasBinding.descriptorType,
+            .pImageInfo = &imageInfo,
+            .pBufferInfo = nullptr,
+            .pTexelBufferView = nullptr
+    };
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+    if (bindless) {
+        atlasIndex = bindless->registerImage(atlasView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        return atlasIndex != BindlessDescriptors::kInvalidIndex;
+    }
+    return true;
+}
+
+/**
+ * @brief Copies the rasterized font into the atlas image through a staging buffer
+ *
+ * Runs once at init and waits for the queue, so the staging buffer can go right away.
+ */
+bool Overlay::uploadAtlas(VkPhysicalDevice gpu, VkQueue queue, uint32_t queueFamilyIndex) {
+    const std::vector<uint8_t> texels = rasterizeAtlas();
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    if (vulkan_common::createBuffer(gpu, device, texels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                    &stagingBuffer, &stagingMemory) != VK_SUCCESS) {
+        return false;
+    }
+    void *mapped;
+    CALL_VK(vkMapMemory(device, stagingMemory, 0, texels.size(), 0, &mapped))
+    memcpy(mapped, texels.data(), texels.size());
+    vkUnmapMemory(device, stagingMemory);
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queueFamilyIndex
+    };
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkResult result = vkCreateCommandPool(device, &commandPoolCreateInfo, nullptr, &commandPool);
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    if (result == VK_SUCCESS) {
+        VkCommandBufferAllocateInfo allocateInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = commandPool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1
+        };
+        result = vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer);
+    }
+
+    if (result == VK_SUCCESS) {
+        VkCommandBufferBeginInfo beginInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .pNext = nullptr,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+                .pInheritanceInfo = nullptr
+        };
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        const VkImageSubresourceRange range{
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+        };
+        VkImageMemoryBarrier barrier{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .pNext = nullptr,
+                .srcAccessMask = 0,
+                .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = atlasImage,
+                .subresourceRange = range
+        };
+        // Synchronization2 is optional in this app, the atlas only needs these two barriers
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+
+        const VkBufferImageCopy region{
+                .bufferOffset = 0,
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = 0,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1
+                },
+                .imageOffset {.x = 0, .y = 0, .z = 0},
+                .imageExtent {.width = kAtlasWidth, .height = kAtlasHeight, .depth = 1}
+        };
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, atlasImage,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+        result = vkEndCommandBuffer(commandBuffer);
+    }
+
+    if (result == VK_SUCCESS) {
+        VkSubmitInfo submitInfo{
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .pNext = nullptr,
+                .waitSemaphoreCount = 0,
+                .pWaitSemaphores = nullptr,
+                .pWaitDstStageMask = nullptr,
+                .commandBufferCount = 1,
+                .pCommandBuffers = &commandBuffer,
+                .signalSemaphoreCount = 0,
+                .pSignalSemaphores = nullptr
+        };
+        result = vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+    if (result == VK_SUCCESS) {
+        result = vkQueueWaitIdle(queue);
+    }
+
+    if (commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, commandPool, nullptr);
+    }
+    vkFreeMemory(device, stagingMemory, nullptr);
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    return result == VK_SUCCESS;
+}
+
+bool Overlay::initPipeline(LayoutCache *layoutCache, ShaderModuleCache *shaderModules,
+                           PipelineManager *pipelineManager, VkRenderPass renderPass,
+                           VkFormat colorFormat) {
+    // Quad has to match the reflected instance inputs and push constants of overlay.vert. The
+    // bindless build reads the texture slot on top, the other one skips it.
+    using shader_layouts::overlay::vertexAttributes;
+    using shader_layouts::overlay::pushConstantRanges;
+    constexpr auto &bindlessAttributes = shader_layouts::overlay_bindless::vertexAttributes;
+    static_assert(sizeof(Quad) == shader_layouts::overlay_bindless::vertexStride);
+    static_assert(vertexAttributes.size() == 3 &&
+                  vertexAttributes[0].offset == offsetof(Quad, rect) &&
+                  vertexAttributes[1].offset == offsetof(Quad, uvRect) &&
+                  vertexAttributes[2].offset == offsetof(Quad, color));
+    static_assert(bindlessAttributes.size() == 4 &&
+                  bindlessAttributes[2].location == vertexAttributes[2].location &&
+                  bindlessAttributes[2].offset == offsetof(Quad, color) &&
+                  bindlessAttributes[3].offset == offsetof(Quad, texture));
+    static_assert(pushConstantRanges.size() == 1 && pushConstantRanges[0].offset == 0 &&
+                  pushConstantRanges[0].size == sizeof(PushConstants));
+    constexpr auto &bindlessRanges = shader_layouts::overlay_bindless::pushConstantRanges;
+    static_assert(bindlessRanges.size() == 1 &&
+                  bindlessRanges[0].stageFlags == pushConstantRanges[0].stageFlags &&
+                  bindlessRanges[0].size == pushConstantRanges[0].size);
+
+    const std::array<VkDescriptorSetLayout, 2> setLayouts{
+            setLayout,
+            bindless ? bindless->getSetLayout() : VK_NULL_HANDLE
+    };
+    const VkPipelineLayoutCreateInfo layoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .setLayoutCount = bindless ? 2u : 1u,
+            .pSetLayouts = setLayouts.data(),
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = pushConstantRanges.data()
+    };
+    pipelineLayout = layoutCache->getPipelineLayout(layoutCreateInfo);
+    if (pipelineLayout == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    const VkShaderModule vertexShader = shaderModules->load(
+            bindless ? "shaders/overlay_bindless.vert.spv" : "shaders/overlay.vert.spv");
+    const VkShaderModule fragmentShader = shaderModules->load(
+            bindless ? "shaders/overlay_bindless.frag.spv" : "shaders/overlay.frag.spv");
+    if (vertexShader == VK_NULL_HANDLE || fragmentShader == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> attributes{vertexAttributes.begin(),
+                                                              vertexAttributes.end()};
+    if (bindless) {
+        attributes.push_back(bindlessAttributes[3]);
+    }
+
+    const GraphicsPipelineState state{
+            .vertexShader = vertexShader,
+            .fragmentShader = fragmentShader,
+            .vertexBindings {
+                    {
+                            .binding = 0,
+                            .stride = sizeof(Quad),
+                            .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+                    }
+            },
+            .vertexAttributes = std::move(attributes),
+            .cullMode = VK_CULL_MODE_NONE,
+            .blend {
+                    .blendEnable = VK_TRUE,
+                    .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+                    .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+                    .colorBlendOp = VK_BLEND_OP_ADD,
+                    .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+                    .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+                    .alphaBlendOp = VK_BLEND_OP_ADD,
+                    .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                      VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+            },
+            .layout = pipelineLayout,
+            .renderPass = renderPass,
+            .colorFormat = colorFormat
+    };
+    // Compiles in the background, draw skips the overlay until it is ready
+    pipeline = pipelineManager->request(state);
+    return true;
+}
+
+void Overlay::push(float x, float y, float width, float height, const float *uvRect,
+                   uint32_t color) {
+    if (mappedQuads == nullptr || quadCount >= kMaxQuads) {
+        return;
+    }
+
+    Quad &quad = mappedQuads[currentFrame * kMaxQuads + quadCount++];
+    quad.rect[0] = x;
+    quad.rect[1] = y;
+    quad.rect[2] = width;
+    quad.rect[3] = height;
+    memcpy(quad.uvRect, uvRect, sizeof(quad.uvRect));
+    quad.color = color;
+    quad.texture = atlasIndex;
+}
@@ -0,0 +1,160 @@
+//
+// Created by eternal on 2024/7/18.
+//
+
+#ifndef LEARNINGVULKAN_OVERLAY_HH
+#define LEARNINGVULKAN_OVERLAY_HH
+
+#include <cstdint>
+#include "BindlessDescriptors.hh"
+#include "DescriptorAllocator.hh"
+#include "LayoutCache.hh"
+#include "PipelineManager.hh"
+#include "ShaderModuleCache.hh"
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Text, rectangles and bar graphs drawn on top of a frame in a single draw
+ *
+ * Everything is a textured quad: glyphs sample a built-in 5x7 pixel font, rectangles and graph
+ * bars a solid cell of the same atlas. Quads are written straight into a persistently mapped
+ * instance buffer, one slice per frame in flight, and drawn as instances of six vertices with one
+ * pipeline and one descriptor set. With BindlessDescriptors the atlas is a slot of the bindless
+ * set instead, which is bound as set 1 next to a set holding only the sampler, and every quad
+ * carries the slot it samples. Nothing is allocated while a frame is built.
+ *
+ * The pipeline compiles in the background, frames before it is ready are drawn without overlay.
+ * Coordinates are pixels from the top left corner of the framebuffer.
+ */
+class Overlay {
+public:
+    /// Per frame, further quads are dropped
+    static constexpr uint32_t kMaxQuads = 4096;
+
+    /// Glyph size in font texels, the advance is one texel wider
+    static constexpr uint32_t kGlyphWidth = 5;
+
+    static constexpr uint32_t kGlyphHeight = 7;
+
+    static constexpr uint32_t rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+        return static_cast<uint32_t>(r) | static_cast<uint32_t>(g) << 8 |
+               static_cast<uint32_t>(b) << 16 | static_cast<uint32_t>(a) << 24;
+    }
+
+    /**
+     * The caches and the pipeline manager have to outlive this object. Either renderPass is set,
+     * or it is VK_NULL_HANDLE and colorFormat describes the attachment for dynamic rendering.
+     * bindless is optional, the atlas gets a descriptor set of its own without it.
+     */
+    bool init(VkPhysicalDevice gpu, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex,
+              LayoutCache *layoutCache, ShaderModuleCache *shaderModules,
+              PipelineManager *pipelineManager, VkRenderPass renderPass, VkFormat colorFormat,
+              uint32_t frameCount, BindlessDescriptors *bindless = nullptr);
+
+    /// The device has to be idle
+    void teardown();
+
+    /// Starts a new set of quads in the slice of the frame, which must no longer be in flight
+    void beginFrame(uint32_t frameIndex);
+
+    /// Font texels are scaled to this many pixels
+    void setScale(float pixelsPerTexel);
+
+    float getLineHeight() const;
+
+    /// printf-style, lowercase letters are drawn as uppercase. Returns the pen position after it.
+    float text(float x, float y, uint32_t color, const char *format, ...)
+    __attribute__((format(printf, 5, 6)));
+
+    void rect(float x, float y, float width, float height, uint32_t color);
+
+    /**
+     * @brief Bars of a ring of values over a dimmed background, the newest on the right
+     * @param size Capacity of the ring, one bar each
+     * @param count Number of valid values
+     * @param first Ring index of the oldest value
+     * @param maxValue Value of a full-height bar, larger values are clamped
+     */
+    void graph(float x, float y, float width, float height, const float *values, size_t size,
+               size_t count, size_t first, float maxValue, uint32_t color);
+
+    /**
+     * @brief Records the quads of the frame, inside a render pass instance
+     *
+     * Binds its own pipeline, descriptor set, vertex buffer, viewport and scissor. Returns whether
+     * anything was drawn.
+     */
+    bool draw(VkCommandBuffer commandBuffer, VkExtent2D extent) const;
+
+    uint32_t getQuadCount() const;
+
+private:
+    /// Instance data, checked against the reflected inputs of overlay.vert and its bindless build
+    struct Quad {
+        float rect[4];
+
+        float uvRect[4];
+
+        uint32_t color;
+
+        /// Bindless image slot, only read by the bindless build
+        uint32_t texture;
+    };
+
+    /// Checked against the reflected push constants of overlay.vert
+    struct PushConstants {
+        float pixelToClip[2];
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    /// Not owned, nullptr without bindless descriptors
+    BindlessDescriptors *bindless = nullptr;
+
+    uint32_t atlasIndex = BindlessDescriptors::kInvalidIndex;
+
+    VkImage atlasImage = VK_NULL_HANDLE;
+
+    VkDeviceMemory atlasMemory = VK_NULL_HANDLE;
+
+    VkImageView atlasView = VK_NULL_HANDLE;
+
+    /// Owned by the layout cache, like the pipeline layout
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+
+    DescriptorAllocator descriptorAllocator{};
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+    PipelineManager::PipelineFuture pipeline{};
+
+    VkBuffer quadBuffer = VK_NULL_HANDLE;
+
+    VkDeviceMemory quadMemory = VK_NULL_HANDLE;
+
+    Quad *mappedQuads = nullptr;
+
+    uint32_t frameCount = 0;
+
+    uint32_t currentFrame = 0;
+
+    uint32_t quadCount = 0;
+
+    float scale = 2.0f;
+
+    bool initAtlas(VkPhysicalDevice gpu, VkQueue queue, uint32_t queueFamilyIndex,
+                   LayoutCache *layoutCache);
+
+    bool uploadAtlas(VkPhysicalDevice gpu, VkQueue queue, uint32_t queueFamilyIndex);
+
+    bool initPipeline(LayoutCache *layoutCache, ShaderModuleCache *shaderModules,
+                      PipelineManager *pipelineManager, VkRenderPass renderPass,
+                      VkFormat colorFormat);
+
+    /// uvRect is the atlas rectangle as offset and size
+    void push(float x, float y, float width, float height, const float *uvRect, uint32_t color);
+};
+
+#endif //LEARNINGVULKAN_OVERLAY_HH
@@ -0,0 +1,256 @@
+//
+// Created by eternal on 2024/6/8.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "Debug.hh"
+#include "PipelineCache.hh"
+
+bool PipelineCache::init(VkPhysicalDevice gpu, VkDevice vkDevice, std::string cachePath,
+                         bool feedback) {
+    device = vkDevice;
+    path = std::move(cachePath);
+    creationFeedback = feedback;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(gpu, &properties);
+
+    std::vector<uint8_t> initialData = readFile(path);
+    if (!initialData.empty() && !validateHeader(initialData, properties)) {
+        // Written by another driver or device, the driver would only reject it anyway
+        LOGW("Pipeline cache %s does not match this device, starting cold.", path.c_str());
+        initialData.clear();
+    }
+
+    VkPipelineCacheCreateInfo createInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .initialDataSize = initialData.size(),
+            .pInitialData = initialData.empty() ? nullptr : initialData.data()
+    };
+
+    VkResult result = vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache);
+    if (result != VK_SUCCESS && !initialData.empty()) {
+        LOGW("Driver rejected pipeline cache %s (%d), starting cold.", path.c_str(), result);
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache);
+    }
+
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to create pipeline cache: %d", result);
+        return false;
+    }
+
+    LOGI("Pipeline cache: %s start, %zu bytes loaded from %s",
+         initialData.empty() ? "cold" : "warm", initialData.size(), path.c_str());
+    return true;
+}
+
+void PipelineCache::teardown() {
+    if (pipelineCache == VK_NULL_HANDLE) {
+        return;
+    }
+
+    save();
+    logStatistics();
+
+    vkDestroyPipelineCache(device, pipelineCache, nullptr);
+    pipelineCache = VK_NULL_HANDLE;
+    device = VK_NULL_HANDLE;
+}
+
+bool PipelineCache::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pipelineCache == VK_NULL_HANDLE || !dirty) {
+        return true;
+    }
+
+    size_t dataSize = 0;
+    CALL_VK(vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr))
+    std::vector<uint8_t> data(dataSize);
+    CALL_VK(vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()))
+
+    // Write next to the destination and rename, rename() replaces the old file atomically
+    const std::string temporaryPath = path + ".tmp";
+    FILE *file = fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        LOGE("Failed to open %s for writing.", temporaryPath.c_str());
+        return false;
+    }
+
+    const bool written = fwrite(data.data(), 1, dataSize, file) == dataSize &&
+                         fflush(file) == 0 && fsync(fileno(file)) == 0;
+    fclose(file);
+
+    if (!written || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        LOGE("Failed to save pipeline cache to %s.", path.c_str());
+        unlink(temporaryPath.c_str());
+        return false;
+    }
+
+    dirty = false;
+    LOGI("Pipeline cache: saved %zu bytes to %s", dataSize, path.c_str());
+    return true;
+}
+
+VkPipelineCache PipelineCache::getHandle() const {
+    return pipelineCache;
+}
+
+VkPipelineCache PipelineCache::createWorkerCache() const {
+    std::vector<uint8_t> initialData;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t dataSize = 0;
+        CALL_VK(vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr))
+        initialData.resize(dataSize);
+        CALL_VK(vkGetPipelineCacheData(device, pipelineCache, &dataSize, initialData.data()))
+        initialData.resize(dataSize);
+    }
+
+    VkPipelineCacheCreateInfo createInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .initialDataSize = initialData.size(),
+            .pInitialData = initialData.empty() ? nullptr : initialData.data()
+    };
+
+    VkPipelineCache workerCache = VK_NULL_HANDLE;
+    CALL_VK(vkCreatePipelineCache(device, &createInfo, nullptr, &workerCache))
+    return workerCache;
+}
+
+void PipelineCache::mergeWorkerCaches(const std::vector<VkPipelineCache> &workerCaches) {
+    if (workerCaches.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t sizeBefore = 0;
+    CALL_VK(vkGetPipelineCacheData(device, pipelineCache, &sizeBefore, nullptr))
+    CALL_VK(vkMergePipelineCaches(device, pipelineCache, static_cast<uint32_t>(workerCaches.size()),
+                                  workerCaches.data()))
+    size_t sizeAfter = 0;
+    CALL_VK(vkGetPipelineCacheData(device, pipelineCache, &sizeAfter, nullptr))
+
+    // Worker caches start as a copy of the main cache and are merged again on every flush, so
+    // most merges bring nothing new
+    dirty = dirty || sizeAfter != sizeBefore;
+}
+
+VkResult PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo,
+                                               VkPipeline *pipeline, VkPipelineCache cache) {
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = createInfo;
+
+    VkPipelineCreationFeedbackEXT pipelineFeedback{};
+    std::vector<VkPipelineCreationFeedbackEXT> stageFeedbacks(createInfo.stageCount);
+    VkPipelineCreationFeedbackCreateInfoEXT feedbackCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT,
+            .pNext = createInfo.pNext,
+            .pPipelineCreationFeedback = &pipelineFeedback,
+            .pipelineStageCreationFeedbackCount = createInfo.stageCount,
+            .pPipelineStageCreationFeedbacks = stageFeedbacks.data()
+    };
+    if (creationFeedback) {
+        pipelineCreateInfo.pNext = &feedbackCreateInfo;
+    }
+
+    const bool mainCache = cache == VK_NULL_HANDLE || cache == pipelineCache;
+    std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+    if (mainCache) {
+        lock.lock();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const VkResult result = vkCreateGraphicsPipelines(
+            device, mainCache ? pipelineCache : cache, 1, &pipelineCreateInfo, nullptr, pipeline);
+    const double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    const bool hasFeedback =
+            creationFeedback && (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT);
+    const bool cacheHit = hasFeedback && (pipelineFeedback.flags &
+                                          VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT);
+
+    if (!lock.owns_lock()) {
+        lock.lock();
+    }
+    ++statistics.pipelineCount;
+    statistics.feedbackCount += hasFeedback ? 1 : 0;
+    statistics.cacheHits += cacheHit ? 1 : 0;
+    statistics.totalCreationMs += elapsedMs;
+    statistics.maxCreationMs = std::max(statistics.maxCreationMs, elapsedMs);
+    // A hit adds nothing new to the cache, anything else may have. Worker caches reach the main
+    // cache through mergeWorkerCaches, which decides for them.
+    dirty = dirty || (mainCache && !cacheHit);
+
+    LOGI("Pipeline created in %.3f ms%s", elapsedMs,
+         hasFeedback ? (cacheHit ? " (cache hit)" : " (cache miss)") : "");
+    return result;
+}
+
+PipelineCache::Statistics PipelineCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+void PipelineCache::logStatistics() const {
+    const Statistics stats = getStatistics();
+    if (stats.pipelineCount == 0) {
+        return;
+    }
+
+    LOGI("Pipeline cache: %u pipelines, %.3f ms total, %.3f ms average, %.3f ms max",
+         stats.pipelineCount, stats.totalCreationMs,
+         stats.totalCreationMs / stats.pipelineCount, stats.maxCreationMs);
+    if (stats.feedbackCount > 0) {
+        LOGI("Pipeline cache: hit rate %.1f%% (%u of %u)",
+             100.0 * stats.cacheHits / stats.feedbackCount, stats.cacheHits, stats.feedbackCount);
+    }
+}
+
+bool PipelineCache::validateHeader(const std::vector<uint8_t> &data,
+                                   const VkPhysicalDeviceProperties &properties) {
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) &&
+           header.headerSize <= data.size() &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+std::vector<uint8_t> PipelineCache::readFile(const std::string &filePath) {
+    std::vector<uint8_t> data;
+    FILE *file = fopen(filePath.c_str(), "rb");
+    if (file == nullptr) {
+        return data;
+    }
+
+    if (fseek(file, 0, SEEK_END) == 0) {
+        const long size = ftell(file);
+        if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data.resize(static_cast<size_t>(size));
+            if (fread(data.data(), 1, data.size(), file) != data.size()) {
+                data.clear();
+            }
+        }
+    }
+    fclose(file);
+    return data;
+}
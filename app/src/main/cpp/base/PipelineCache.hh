@@ -0,0 +1,97 @@
+//
+// Created by eternal on 2024/6/8.
+//
+
+#ifndef LEARNINGVULKAN_PIPELINECACHE_HH
+#define LEARNINGVULKAN_PIPELINECACHE_HH
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief On-disk persistent VkPipelineCache
+ *
+ * The blob saved by a previous run is only handed to the driver when its header matches the
+ * current device (vendor ID, device ID and pipeline cache UUID). Saving writes a temporary file
+ * and renames it over the old one, so a crash while saving never leaves a truncated cache behind.
+ */
+class PipelineCache {
+public:
+    struct Statistics {
+        uint32_t pipelineCount = 0;
+
+        /// Pipelines reported by VK_EXT_pipeline_creation_feedback as served from the cache
+        uint32_t cacheHits = 0;
+
+        /// Pipelines for which creation feedback was available at all
+        uint32_t feedbackCount = 0;
+
+        double totalCreationMs = 0.0;
+
+        double maxCreationMs = 0.0;
+    };
+
+    /**
+     * @param path File the cache is loaded from and saved to
+     * @param creationFeedback Whether VK_EXT_pipeline_creation_feedback is enabled on the device
+     */
+    bool init(VkPhysicalDevice gpu, VkDevice device, std::string path, bool creationFeedback);
+
+    /// Saves the cache if it changed and destroys it
+    void teardown();
+
+    bool save();
+
+    VkPipelineCache getHandle() const;
+
+    /// Creates a cache for a worker thread, seeded with the contents of the main cache so that
+    /// pipelines loaded from disk are hits there too. Hand it back through mergeWorkerCaches.
+    VkPipelineCache createWorkerCache() const;
+
+    /**
+     * @brief Merges the worker caches into the main cache, they stay valid
+     *
+     * The worker caches must not be used by other threads meanwhile. The cache only needs saving
+     * afterwards if the merge added anything.
+     */
+    void mergeWorkerCaches(const std::vector<VkPipelineCache> &workerCaches);
+
+    /**
+     * @brief Creates a graphics pipeline through the cache, timing it and recording cache hits
+     * @param cache Cache to create the pipeline with, the main cache if VK_NULL_HANDLE. Anything
+     * else is a worker cache, its misses reach the disk through mergeWorkerCaches.
+     */
+    VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo,
+                                    VkPipeline *pipeline, VkPipelineCache cache = VK_NULL_HANDLE);
+
+    Statistics getStatistics() const;
+
+    void logStatistics() const;
+
+    static bool validateHeader(const std::vector<uint8_t> &data,
+                               const VkPhysicalDeviceProperties &properties);
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+
+    std::string path{};
+
+    bool creationFeedback = false;
+
+    /// Set whenever the cache may hold data that is not on disk yet
+    bool dirty = false;
+
+    /// Guards the statistics and every use of the main cache handle, vkMergePipelineCaches needs
+    /// its destination externally synchronized against pipeline creation with it
+    mutable std::mutex mutex{};
+
+    Statistics statistics{};
+
+    static std::vector<uint8_t> readFile(const std::string &path);
+};
+
+#endif //LEARNINGVULKAN_PIPELINECACHE_HH
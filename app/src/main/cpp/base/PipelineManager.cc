@@ -0,0 +1,605 @@
+//
+// Created by eternal on 2024/6/12.
+//
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include "CpuProfiler.hh"
+#include "Debug.hh"
+#include "HashUtils.hh"
+#include "PipelineManager.hh"
+
+uint64_t GraphicsPipelineState::hash() const {
+    using hash_utils::combine;
+    uint64_t h = hash_utils::kFnvOffsetBasis;
+    h = combine(h, vertexShader);
+    h = combine(h, fragmentShader);
+    h = hash_utils::fnv1a(specializationValues.data(),
+                          specializationValues.size() * sizeof(uint32_t), h);
+    for (const auto &binding: vertexBindings) {
+        h = combine(h, binding.binding);
+        h = combine(h, binding.stride);
+        h = combine(h, binding.inputRate);
+    }
+    for (const auto &attribute: vertexAttributes) {
+        h = combine(h, attribute.location);
+        h = combine(h, attribute.binding);
+        h = combine(h, attribute.format);
+        h = combine(h, attribute.offset);
+    }
+    h = combine(h, topology);
+    h = combine(h, cullMode);
+    h = combine(h, frontFace);
+    h = combine(h, blend.blendEnable);
+    h = combine(h, blend.srcColorBlendFactor);
+    h = combine(h, blend.dstColorBlendFactor);
+    h = combine(h, blend.colorBlendOp);
+    h = combine(h, blend.srcAlphaBlendFactor);
+    h = combine(h, blend.dstAlphaBlendFactor);
+    h = combine(h, blend.alphaBlendOp);
+    h = combine(h, blend.colorWriteMask);
+    h = combine(h, layout);
+    h = combine(h, renderPass);
+    h = combine(h, colorFormat);
+    return h;
+}
+
+bool GraphicsPipelineState::operator==(const GraphicsPipelineState &other) const {
+    const auto bindingEquals = [](const VkVertexInputBindingDescription &a,
+                                  const VkVertexInputBindingDescription &b) {
+        return a.binding == b.binding && a.stride == b.stride && a.inputRate == b.inputRate;
+    };
+    const auto attributeEquals = [](const VkVertexInputAttributeDescription &a,
+                                    const VkVertexInputAttributeDescription &b) {
+        return a.location == b.location && a.binding == b.binding && a.format == b.format &&
+               a.offset == b.offset;
+    };
+
+    return vertexShader == other.vertexShader &&
+           fragmentShader == other.fragmentShader &&
+           specializationValues == other.specializationValues &&
+           std::equal(vertexBindings.begin(), vertexBindings.end(),
+                      other.vertexBindings.begin(), other.vertexBindings.end(), bindingEquals) &&
+           std::equal(vertexAttributes.begin(), vertexAttributes.end(),
+                      other.vertexAttributes.begin(), other.vertexAttributes.end(),
+                      attributeEquals) &&
+           topology == other.topology &&
+           cullMode == other.cullMode &&
+           frontFace == other.frontFace &&
+           blend.blendEnable == other.blend.blendEnable &&
+           blend.srcColorBlendFactor == other.blend.srcColorBlendFactor &&
+           blend.dstColorBlendFactor == other.blend.dstColorBlendFactor &&
+           blend.colorBlendOp == other.blend.colorBlendOp &&
+           blend.srcAlphaBlendFactor == other.blend.srcAlphaBlendFactor &&
+           blend.dstAlphaBlendFactor == other.blend.dstAlphaBlendFactor &&
+           blend.alphaBlendOp == other.blend.alphaBlendOp &&
+           blend.colorWriteMask == other.blend.colorWriteMask &&
+           layout == other.layout &&
+           renderPass == other.renderPass &&
+           colorFormat == other.colorFormat;
+}
+
+namespace {
+    /**
+     * @brief The create info structs of a pipeline state
+     *
+     * Shared by monolithic compilation and by the pipeline libraries, which take a subset of them.
+     * Holds pointers into itself and into the state, so it stays where it was constructed.
+     */
+    struct PipelineCreateInfos {
+        explicit PipelineCreateInfos(const GraphicsPipelineState &state);
+
+        PipelineCreateInfos(const PipelineCreateInfos &) = delete;
+
+        PipelineCreateInfos &operator=(const PipelineCreateInfos &) = delete;
+
+        /// Create info for the given VK_EXT_graphics_pipeline_library parts, 0 for all of them
+        VkGraphicsPipelineCreateInfo get(VkGraphicsPipelineLibraryFlagsEXT parts,
+                                         const void *pNext);
+
+        const GraphicsPipelineState &state;
+
+        VkPipelineVertexInputStateCreateInfo vertexInput;
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+
+        VkPipelineRasterizationStateCreateInfo rasterization;
+
+        VkPipelineColorBlendStateCreateInfo colorBlend;
+
+        VkPipelineViewportStateCreateInfo viewportState;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencilState;
+
+        VkPipelineMultisampleStateCreateInfo multisampleState;
+
+        std::array<VkDynamicState, 2> dynamics{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        VkPipelineDynamicStateCreateInfo dynamicState;
+
+        std::vector<VkSpecializationMapEntry> specializationEntries{};
+
+        VkSpecializationInfo specializationInfo;
+
+        std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+
+        VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
+    };
+
+    PipelineCreateInfos::PipelineCreateInfos(const GraphicsPipelineState &pipelineState)
+            : state(pipelineState) {
+        vertexInput = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .vertexBindingDescriptionCount = static_cast<uint32_t>(state.vertexBindings.size()),
+                .pVertexBindingDescriptions = state.vertexBindings.data(),
+                .vertexAttributeDescriptionCount =
+                static_cast<uint32_t>(state.vertexAttributes.size()),
+                .pVertexAttributeDescriptions = state.vertexAttributes.data()
+        };
+
+        inputAssembly = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .topology = state.topology,
+                .primitiveRestartEnable = VK_FALSE
+        };
+
+        rasterization = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .depthClampEnable = VK_FALSE,
+                .rasterizerDiscardEnable = VK_FALSE,
+                .polygonMode = VK_POLYGON_MODE_FILL,
+                .cullMode = state.cullMode,
+                .frontFace = state.frontFace,
+                .depthBiasEnable = VK_FALSE,
+                .depthBiasClamp = VK_FALSE,
+                .lineWidth = 1.0f
+        };
+
+        colorBlend = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .attachmentCount = 1,
+                .pAttachments = &state.blend
+        };
+
+        viewportState = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .viewportCount = 1,
+                // We will set it dynamically
+                .pViewports = nullptr,
+                .scissorCount = 1,
+                // We will set it dynamically
+                .pScissors = nullptr,
+        };
+
+        // Disable all depth testing
+        depthStencilState = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .depthTestEnable = VK_FALSE
+        };
+
+        // No multisampling
+        multisampleState = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+                .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+        };
+
+        dynamicState = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+                .dynamicStateCount = dynamics.size(),
+                .pDynamicStates = dynamics.data()
+        };
+
+        // Constant ids a stage does not declare are ignored, so both stages share one map
+        for (uint32_t i = 0; i < state.specializationValues.size(); ++i) {
+            specializationEntries.push_back({
+                    .constantID = i,
+                    .offset = static_cast<uint32_t>(i * sizeof(uint32_t)),
+                    .size = sizeof(uint32_t)
+            });
+        }
+        specializationInfo = {
+                .mapEntryCount = static_cast<uint32_t>(specializationEntries.size()),
+                .pMapEntries = specializationEntries.data(),
+                .dataSize = state.specializationValues.size() * sizeof(uint32_t),
+                .pData = state.specializationValues.data()
+        };
+        const VkSpecializationInfo *pSpecializationInfo =
+                state.specializationValues.empty() ? nullptr : &specializationInfo;
+
+        shaderStages = {
+                VkPipelineShaderStageCreateInfo{
+                        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                        .pNext = nullptr,
+                        .flags = 0,
+                        .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                        .module = state.vertexShader,
+                        .pName = "main",
+                        .pSpecializationInfo = pSpecializationInfo,
+                },
+                VkPipelineShaderStageCreateInfo{
+                        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                        .pNext = nullptr,
+                        .flags = 0,
+                        .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                        .module = state.fragmentShader,
+                        .pName = "main",
+                        .pSpecializationInfo = pSpecializationInfo
+                }
+        };
+
+        // Without a render pass the pipeline only has to know the attachment formats
+        renderingCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
+                .pNext = nullptr,
+                .viewMask = 0,
+                .colorAttachmentCount = 1,
+                .pColorAttachmentFormats = &state.colorFormat,
+                .depthAttachmentFormat = VK_FORMAT_UNDEFINED,
+                .stencilAttachmentFormat = VK_FORMAT_UNDEFINED
+        };
+    }
+
+    VkGraphicsPipelineCreateInfo
+    PipelineCreateInfos::get(VkGraphicsPipelineLibraryFlagsEXT parts, const void *pNext) {
+        const auto has = [parts](VkGraphicsPipelineLibraryFlagsEXT part) {
+            return parts == 0 || (parts & part) != 0;
+        };
+        const bool vertexInputInterface =
+                has(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+        const bool preRasterization =
+                has(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+        const bool fragmentShader = has(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+        const bool fragmentOutput =
+                has(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+        const bool usesRenderPass = preRasterization || fragmentShader || fragmentOutput;
+
+        if (state.renderPass == VK_NULL_HANDLE && usesRenderPass) {
+            renderingCreateInfo.pNext = pNext;
+            pNext = &renderingCreateInfo;
+        }
+
+        // Only the vertex stage belongs to the pre-rasterization part
+        const VkPipelineShaderStageCreateInfo *stages = nullptr;
+        uint32_t stageCount = 0;
+        if (preRasterization) {
+            stages = &shaderStages[0];
+            stageCount = fragmentShader ? 2 : 1;
+        } else if (fragmentShader) {
+            stages = &shaderStages[1];
+            stageCount = 1;
+        }
+
+        return {
+                .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                .pNext = pNext,
+                .flags = parts != 0 ? VK_PIPELINE_CREATE_LIBRARY_BIT_KHR : 0u,
+                .stageCount = stageCount,
+                .pStages = stages,
+                .pVertexInputState = vertexInputInterface ? &vertexInput : nullptr,
+                .pInputAssemblyState = vertexInputInterface ? &inputAssembly : nullptr,
+                .pViewportState = preRasterization ? &viewportState : nullptr,
+                .pRasterizationState = preRasterization ? &rasterization : nullptr,
+                .pMultisampleState = fragmentShader || fragmentOutput ? &multisampleState
+                                                                      : nullptr,
+                .pDepthStencilState = fragmentShader ? &depthStencilState : nullptr,
+                .pColorBlendState = fragmentOutput ? &colorBlend : nullptr,
+                .pDynamicState = preRasterization ? &dynamicState : nullptr,
+                .layout = preRasterization || fragmentShader ? state.layout : VK_NULL_HANDLE,
+                .renderPass = usesRenderPass ? state.renderPass : VK_NULL_HANDLE
+        };
+    }
+
+    /// A pipeline library part and the fields of the state it depends on
+    struct LibraryPart {
+        VkGraphicsPipelineLibraryFlagsEXT flag;
+
+        GraphicsPipelineState (*key)(const GraphicsPipelineState &state);
+    };
+
+    constexpr std::array<LibraryPart, 4> libraryParts{{
+            {
+                    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+                    [](const GraphicsPipelineState &state) {
+                        return GraphicsPipelineState{
+                                .vertexBindings = state.vertexBindings,
+                                .vertexAttributes = state.vertexAttributes,
+                                .topology = state.topology
+                        };
+                    }
+            },
+            {
+                    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+                    [](const GraphicsPipelineState &state) {
+                        return GraphicsPipelineState{
+                                .vertexShader = state.vertexShader,
+                                .specializationValues = state.specializationValues,
+                                .cullMode = state.cullMode,
+                                .frontFace = state.frontFace,
+                                .layout = state.layout,
+                                .renderPass = state.renderPass
+                        };
+                    }
+            },
+            {
+                    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+                    [](const GraphicsPipelineState &state) {
+                        return GraphicsPipelineState{
+                                .fragmentShader = state.fragmentShader,
+                                .specializationValues = state.specializationValues,
+                                .layout = state.layout,
+                                .renderPass = state.renderPass
+                        };
+                    }
+            },
+            {
+                    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+                    [](const GraphicsPipelineState &state) {
+                        return GraphicsPipelineState{
+                                .blend = state.blend,
+                                .renderPass = state.renderPass,
+                                .colorFormat = state.colorFormat
+                        };
+                    }
+            }
+    }};
+}
+
+bool PipelineManager::init(VkDevice vkDevice, PipelineCache *cache, uint32_t threadCount,
+                           bool pipelineLibrary) {
+    device = vkDevice;
+    pipelineCache = cache;
+    graphicsPipelineLibrary = pipelineLibrary;
+
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        workerCaches.push_back(pipelineCache->createWorkerCache());
+    }
+    workerCacheMutexes = std::make_unique<std::mutex[]>(threadCount);
+    threadPool = std::make_unique<ThreadPool>(threadCount);
+
+    LOGI("Pipeline manager: %u compile threads, fast linking %s", threadCount,
+         graphicsPipelineLibrary ? "enabled" : "disabled");
+    return true;
+}
+
+void PipelineManager::teardown() {
+    if (threadPool == nullptr) {
+        return;
+    }
+
+    // Joins the workers after the queue is drained, so every future is ready afterwards
+    threadPool.reset();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &[state, future]: pipelines) {
+        if (future.get() != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, future.get(), nullptr);
+        }
+    }
+    pipelines.clear();
+
+    std::lock_guard<std::mutex> libraryLock(libraryMutex);
+    for (const auto &[state, pipeline]: linkedPipelines) {
+        if (pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        }
+    }
+    linkedPipelines.clear();
+    for (auto &partLibraries: libraries) {
+        for (const auto &[state, library]: partLibraries) {
+            if (library.get() != VK_NULL_HANDLE) {
+                vkDestroyPipeline(device, library.get(), nullptr);
+            }
+        }
+        partLibraries.clear();
+    }
+
+    pipelineCache->mergeWorkerCaches(workerCaches);
+    for (auto workerCache: workerCaches) {
+        vkDestroyPipelineCache(device, workerCache, nullptr);
+    }
+    workerCaches.clear();
+    workerCacheMutexes.reset();
+    device = VK_NULL_HANDLE;
+}
+
+void PipelineManager::flushCaches() {
+    if (threadPool == nullptr) {
+        return;
+    }
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(workerCaches.size());
+    for (uint32_t i = 0; i < workerCaches.size(); ++i) {
+        locks.emplace_back(workerCacheMutexes[i]);
+    }
+    pipelineCache->mergeWorkerCaches(workerCaches);
+}
+
+PipelineManager::PipelineFuture PipelineManager::request(const GraphicsPipelineState &state) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto it = pipelines.find(state);
+    if (it != pipelines.end()) {
+        ++deduplicatedCount;
+        return it->second;
+    }
+
+    auto promise = std::make_shared<std::promise<VkPipeline>>();
+    PipelineFuture future = promise->get_future().share();
+    pipelines.emplace(state, future);
+
+    threadPool->enqueue([this, state, promise](uint32_t workerIndex) {
+        promise->set_value(compile(state, workerIndex));
+    });
+    return future;
+}
+
+VkPipeline PipelineManager::getIfReady(const PipelineFuture &future, VkPipeline fallback) {
+    if (!future.valid() ||
+        future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return fallback;
+    }
+    const VkPipeline pipeline = future.get();
+    return pipeline != VK_NULL_HANDLE ? pipeline : fallback;
+}
+
+VkPipeline PipelineManager::fastLink(const GraphicsPipelineState &state) {
+    if (!graphicsPipelineLibrary) {
+        return VK_NULL_HANDLE;
+    }
+
+    std::array<VkPipeline, libraryParts.size()> partLibraries{};
+    {
+        std::lock_guard<std::mutex> lock(libraryMutex);
+        const auto it = linkedPipelines.find(state);
+        if (it != linkedPipelines.end()) {
+            return it->second;
+        }
+
+        // Requests every part first, so that they build in parallel
+        std::array<PipelineFuture, libraryParts.size()> futures;
+        for (uint32_t i = 0; i < libraryParts.size(); ++i) {
+            futures[i] = requestLibrary(i, state);
+        }
+        for (uint32_t i = 0; i < libraryParts.size(); ++i) {
+            if (futures[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return VK_NULL_HANDLE;
+            }
+            partLibraries[i] = futures[i].get();
+            if (partLibraries[i] == VK_NULL_HANDLE) {
+                linkedPipelines.emplace(state, VK_NULL_HANDLE);
+                return VK_NULL_HANDLE;
+            }
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const VkPipelineLibraryCreateInfoKHR libraryCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .libraryCount = static_cast<uint32_t>(partLibraries.size()),
+            .pLibraries = partLibraries.data()
+    };
+    const VkGraphicsPipelineCreateInfo linkCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &libraryCreateInfo,
+            .flags = 0,
+            .layout = state.layout
+    };
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    const VkResult result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &linkCreateInfo,
+                                                      nullptr, &pipeline);
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to link pipeline %016llx: %d",
+             static_cast<unsigned long long>(state.hash()), result);
+        pipeline = VK_NULL_HANDLE;
+    } else {
+        const std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+        LOGI("Fast-linked pipeline %016llx in %.3f ms",
+             static_cast<unsigned long long>(state.hash()), elapsed.count());
+    }
+
+    // Another thread may have linked the same state in the meantime, the first one is kept
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    const auto [it, inserted] = linkedPipelines.emplace(state, pipeline);
+    if (!inserted && pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
+    return it->second;
+}
+
+VkPipeline PipelineManager::acquire(const GraphicsPipelineState &state, VkPipeline fallback) {
+    const VkPipeline pipeline = getIfReady(request(state), VK_NULL_HANDLE);
+    if (pipeline != VK_NULL_HANDLE) {
+        return pipeline;
+    }
+    const VkPipeline linked = fastLink(state);
+    return linked != VK_NULL_HANDLE ? linked : fallback;
+}
+
+bool PipelineManager::isGraphicsPipelineLibraryEnabled() const {
+    return graphicsPipelineLibrary;
+}
+
+uint32_t PipelineManager::getDeduplicatedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return deduplicatedCount;
+}
+
+VkPipeline PipelineManager::compile(const GraphicsPipelineState &state, uint32_t workerIndex) {
+    PROFILE_FUNCTION();
+    PipelineCreateInfos createInfos(state);
+    const VkGraphicsPipelineCreateInfo pipelineCreateInfo = createInfos.get(0, nullptr);
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result;
+    {
+        std::lock_guard<std::mutex> lock(workerCacheMutexes[workerIndex]);
+        result = pipelineCache->createGraphicsPipeline(pipelineCreateInfo, &pipeline,
+                                                       workerCaches.at(workerIndex));
+    }
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to compile pipeline %016llx: %d",
+             static_cast<unsigned long long>(state.hash()), result);
+        return VK_NULL_HANDLE;
+    }
+    return pipeline;
+}
+
+PipelineManager::PipelineFuture
+PipelineManager::requestLibrary(uint32_t partIndex, const GraphicsPipelineState &state) {
+    GraphicsPipelineState key = libraryParts[partIndex].key(state);
+    auto &partLibraries = libraries.at(partIndex);
+    const auto it = partLibraries.find(key);
+    if (it != partLibraries.end()) {
+        return it->second;
+    }
+
+    auto promise = std::make_shared<std::promise<VkPipeline>>();
+    PipelineFuture future = promise->get_future().share();
+    partLibraries.emplace(std::move(key), future);
+
+    threadPool->enqueueFront([this, partIndex, state, promise](uint32_t workerIndex) {
+        promise->set_value(createLibrary(partIndex, state, workerIndex));
+    });
+    return future;
+}
+
+VkPipeline PipelineManager::createLibrary(uint32_t partIndex, const GraphicsPipelineState &state,
+                                          uint32_t workerIndex) {
+    PROFILE_FUNCTION();
+    const VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+            .pNext = nullptr,
+            .flags = libraryParts[partIndex].flag
+    };
+    PipelineCreateInfos createInfos(state);
+    const VkGraphicsPipelineCreateInfo pipelineCreateInfo =
+            createInfos.get(libraryParts[partIndex].flag, &libraryCreateInfo);
+
+    VkPipeline library = VK_NULL_HANDLE;
+    VkResult result;
+    {
+        std::lock_guard<std::mutex> lock(workerCacheMutexes[workerIndex]);
+        result = vkCreateGraphicsPipelines(device, workerCaches.at(workerIndex), 1,
+                                           &pipelineCreateInfo, nullptr, &library);
+    }
+    if (result != VK_SUCCESS) {
+        LOGE("Failed to create pipeline library part %u: %d", partIndex, result);
+        return VK_NULL_HANDLE;
+    }
+    return library;
+}
@@ -0,0 +1,160 @@
+//
+// Created by eternal on 2024/6/12.
+//
+
+#ifndef LEARNINGVULKAN_PIPELINEMANAGER_HH
+#define LEARNINGVULKAN_PIPELINEMANAGER_HH
+
+#include <array>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "PipelineCache.hh"
+#include "ThreadPool.hh"
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Everything that goes into a graphics pipeline, in a hashable value form
+ *
+ * Viewport and scissor are always dynamic. Either renderPass is set, or it is VK_NULL_HANDLE and
+ * colorFormat describes the attachment for dynamic rendering.
+ */
+struct GraphicsPipelineState {
+    VkShaderModule vertexShader = VK_NULL_HANDLE;
+
+    VkShaderModule fragmentShader = VK_NULL_HANDLE;
+
+    /// Specialization constant values for both stages, constant_id N takes the Nth value. Each is
+    /// 32 bits wide: a VkBool32, int, uint or the bit pattern of a float. See ShaderVariants.
+    std::vector<uint32_t> specializationValues{};
+
+    std::vector<VkVertexInputBindingDescription> vertexBindings{};
+
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes{};
+
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+
+    VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+    VkPipelineColorBlendAttachmentState blend{
+            .blendEnable = VK_FALSE,
+            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                              VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+    };
+
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+
+    uint64_t hash() const;
+
+    bool operator==(const GraphicsPipelineState &other) const;
+};
+
+/**
+ * @brief Compiles graphics pipelines on a background thread pool
+ *
+ * Requests are keyed by the full pipeline state, so asking twice for the same state returns the
+ * same future and compiles once. Callers keep drawing with a fallback pipeline until the future
+ * is ready, see getIfReady. With VK_EXT_graphics_pipeline_library the fallback can instead be a
+ * pipeline fast-linked from precompiled parts, see fastLink. Shader modules are identified by
+ * handle, so they must stay alive while pipelines using them may still be requested. The manager
+ * owns every pipeline it created.
+ */
+class PipelineManager {
+public:
+    using PipelineFuture = std::shared_future<VkPipeline>;
+
+    /// graphicsPipelineLibrary tells whether VK_EXT_graphics_pipeline_library is enabled
+    bool init(VkDevice device, PipelineCache *pipelineCache, uint32_t threadCount,
+              bool graphicsPipelineLibrary = false);
+
+    /// Waits for pending compilations, destroys all pipelines and merges the worker caches
+    void teardown();
+
+    /// Merges what the workers compiled so far into the main cache, so that saving it keeps them.
+    /// Waits for the compilations running on the workers, not for queued ones.
+    void flushCaches();
+
+    PipelineFuture request(const GraphicsPipelineState &state);
+
+    /// Returns the pipeline behind the future if it is ready, the fallback otherwise
+    static VkPipeline getIfReady(const PipelineFuture &future, VkPipeline fallback);
+
+    /**
+     * @brief Links a pipeline for the state from pipeline libraries
+     *
+     * The vertex input, pre-rasterization, fragment shader and fragment output parts are created
+     * as libraries on the thread pool, ahead of queued compilations, and shared between states.
+     * Until all parts of the state are ready this returns VK_NULL_HANDLE, afterwards it links
+     * them on the calling thread, which only takes a fraction of a full compile. The result is
+     * not link-time optimized and is meant to be drawn until the pipeline from request is ready.
+     * Failed parts and links are remembered and not retried. Returns VK_NULL_HANDLE without
+     * pipeline libraries.
+     */
+    VkPipeline fastLink(const GraphicsPipelineState &state);
+
+    /// The compiled pipeline if it is ready, otherwise a fast-linked one or the fallback
+    VkPipeline acquire(const GraphicsPipelineState &state, VkPipeline fallback);
+
+    bool isGraphicsPipelineLibraryEnabled() const;
+
+    /// Number of requests answered with an already known pipeline
+    uint32_t getDeduplicatedCount() const;
+
+private:
+    struct StateHasher {
+        size_t operator()(const GraphicsPipelineState &state) const {
+            return static_cast<size_t>(state.hash());
+        }
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    PipelineCache *pipelineCache = nullptr;
+
+    std::unique_ptr<ThreadPool> threadPool{};
+
+    /// One cache per worker so that workers never contend on the main cache
+    std::vector<VkPipelineCache> workerCaches{};
+
+    /// Held by a worker while it creates a pipeline with its cache, and by flushCaches
+    std::unique_ptr<std::mutex[]> workerCacheMutexes{};
+
+    mutable std::mutex mutex{};
+
+    std::unordered_map<GraphicsPipelineState, PipelineFuture, StateHasher> pipelines{};
+
+    uint32_t deduplicatedCount = 0;
+
+    bool graphicsPipelineLibrary = false;
+
+    /// Guards the maps below, never held while a pipeline is created
+    std::mutex libraryMutex{};
+
+    /// Per library part, keyed by the part of the state it was created from. A part that failed
+    /// stays as a future of VK_NULL_HANDLE.
+    std::array<std::unordered_map<GraphicsPipelineState, PipelineFuture, StateHasher>, 4>
+            libraries{};
+
+    /// Kept until teardown, command buffers in flight may still use them. VK_NULL_HANDLE for
+    /// states that failed to link.
+    std::unordered_map<GraphicsPipelineState, VkPipeline, StateHasher> linkedPipelines{};
+
+    VkPipeline compile(const GraphicsPipelineState &state, uint32_t workerIndex);
+
+    /// The library part for the state, queued on the thread pool if it was not requested yet.
+    /// libraryMutex has to be held.
+    PipelineFuture requestLibrary(uint32_t partIndex, const GraphicsPipelineState &state);
+
+    VkPipeline createLibrary(uint32_t partIndex, const GraphicsPipelineState &state,
+                             uint32_t workerIndex);
+};
+
+#endif //LEARNINGVULKAN_PIPELINEMANAGER_HH
@@ -0,0 +1,32 @@
+//
+// Created by eternal on 2024/6/22.
+//
+
+#ifndef LEARNINGVULKAN_SHADERLAYOUT_HH
+#define LEARNINGVULKAN_SHADERLAYOUT_HH
+
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief A descriptor binding reflected from SPIR-V
+ *
+ * The generated shader_layouts/<program>.layout.hh headers describe the interface of a shader
+ * program with these and plain Vulkan structs, see cmake/CompileShaders.cmake.
+ */
+struct ShaderDescriptorBinding {
+    uint32_t set;
+
+    uint32_t binding;
+
+    VkDescriptorType descriptorType;
+
+    /// 0 for a runtime array, whose size the set layout decides
+    uint32_t descriptorCount;
+
+    VkShaderStageFlags stageFlags;
+
+    /// Size of the uniform or storage block, 0 for images and samplers
+    uint32_t blockSize;
+};
+
+#endif //LEARNINGVULKAN_SHADERLAYOUT_HH
@@ -0,0 +1,63 @@
+//
+// Created by eternal on 2024/6/16.
+//
+#include <cstring>
+#include "Debug.hh"
+#include "HashUtils.hh"
+#include "ShaderModuleCache.hh"
+#include "VulkanCommon.hh"
+
+void ShaderModuleCache::init(VkDevice vkDevice, const FileBackend *backend) {
+    device = vkDevice;
+    fileBackend = backend;
+}
+
+void ShaderModuleCache::teardown() {
+    for (const auto &[hash, module]: modules) {
+        vkDestroyShaderModule(device, module.shaderModule, nullptr);
+    }
+    modules.clear();
+    device = VK_NULL_HANDLE;
+}
+
+VkShaderModule ShaderModuleCache::load(const std::string &path) {
+    const auto file = fileBackend->open(path);
+    if (file == nullptr) {
+        LOGE("Failed to open shader %s", path.c_str());
+        return VK_NULL_HANDLE;
+    }
+
+    const VkShaderModule shaderModule = get(file->data(), file->size());
+    if (shaderModule == VK_NULL_HANDLE) {
+        LOGE("Failed to create shader module from %s", path.c_str());
+    }
+    return shaderModule;
+}
+
+VkShaderModule ShaderModuleCache::get(const void *code, size_t codeSize) {
+    // FNV-1a is not collision resistant, the hash only narrows down the candidates
+    const uint64_t hash = hash_utils::fnv1a(code, codeSize);
+    const auto [first, last] = modules.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        const std::vector<uint8_t> &moduleCode = it->second.code;
+        if (moduleCode.size() == codeSize && memcmp(moduleCode.data(), code, codeSize) == 0) {
+            ++deduplicatedCount;
+            return it->second.shaderModule;
+        }
+    }
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (vulkan_common::createShaderModule(device, code, codeSize, &shaderModule) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    const auto *bytes = static_cast<const uint8_t *>(code);
+    modules.emplace(hash, Module{
+            .code {bytes, bytes + codeSize},
+            .shaderModule = shaderModule
+    });
+    return shaderModule;
+}
+
+uint32_t ShaderModuleCache::getDeduplicatedCount() const {
+    return deduplicatedCount;
+}
@@ -0,0 +1,52 @@
+//
+// Created by eternal on 2024/6/16.
+//
+
+#ifndef LEARNINGVULKAN_SHADERMODULECACHE_HH
+#define LEARNINGVULKAN_SHADERMODULECACHE_HH
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileBackend.hh"
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Shader modules deduplicated by the content of their SPIR-V
+ *
+ * Modules are created straight from the mapped file and live until teardown, so their handles
+ * are stable keys for pipeline state hashing. A copy of the code is kept with each module, a
+ * module is only reused when the code matches byte for byte, not just its hash.
+ */
+class ShaderModuleCache {
+public:
+    void init(VkDevice device, const FileBackend *fileBackend);
+
+    void teardown();
+
+    /// Returns VK_NULL_HANDLE if the file is missing or is not SPIR-V
+    VkShaderModule load(const std::string &path);
+
+    VkShaderModule get(const void *code, size_t codeSize);
+
+    /// Number of loads answered with an existing module
+    uint32_t getDeduplicatedCount() const;
+
+private:
+    struct Module {
+        std::vector<uint8_t> code;
+
+        VkShaderModule shaderModule;
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    const FileBackend *fileBackend = nullptr;
+
+    /// Keyed by the hash of the code, colliding modules share a key
+    std::unordered_multimap<uint64_t, Module> modules{};
+
+    uint32_t deduplicatedCount = 0;
+};
+
+#endif //LEARNINGVULKAN_SHADERMODULECACHE_HH
@@ -0,0 +1,61 @@
+//
+// Created by eternal on 2024/6/25.
+//
+#include <utility>
+#include "HashUtils.hh"
+#include "ShaderVariants.hh"
+
+size_t ShaderVariants::KeyHasher::operator()(const Key &key) const {
+    return static_cast<size_t>(hash_utils::fnv1a(key.data(), key.size() * sizeof(uint32_t)));
+}
+
+void ShaderVariants::init(PipelineManager *manager, const GraphicsPipelineState &state,
+                          Key key) {
+    pipelineManager = manager;
+    baseState = state;
+    defaultKey = std::move(key);
+}
+
+void ShaderVariants::teardown() {
+    // The pipelines belong to the pipeline manager
+    std::lock_guard<std::mutex> lock(mutex);
+    variants.clear();
+    pipelineManager = nullptr;
+}
+
+const ShaderVariants::Key &ShaderVariants::getDefaultKey() const {
+    return defaultKey;
+}
+
+PipelineManager::PipelineFuture ShaderVariants::request(const Key &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto it = variants.find(key);
+    if (it != variants.end()) {
+        return it->second;
+    }
+
+    GraphicsPipelineState state = baseState;
+    state.specializationValues = key;
+    const auto future = pipelineManager->request(state);
+    variants.emplace(key, future);
+    return future;
+}
+
+VkPipeline ShaderVariants::get(const Key &key, VkPipeline fallback) {
+    const VkPipeline pipeline = PipelineManager::getIfReady(request(key), VK_NULL_HANDLE);
+    if (pipeline != VK_NULL_HANDLE || !pipelineManager->isGraphicsPipelineLibraryEnabled()) {
+        return pipeline != VK_NULL_HANDLE ? pipeline : fallback;
+    }
+
+    // Draw a fast-linked pipeline while the variant compiles
+    GraphicsPipelineState state = baseState;
+    state.specializationValues = key;
+    const VkPipeline linked = pipelineManager->fastLink(state);
+    return linked != VK_NULL_HANDLE ? linked : fallback;
+}
+
+uint32_t ShaderVariants::getVariantCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<uint32_t>(variants.size());
+}
@@ -0,0 +1,58 @@
+//
+// Created by eternal on 2024/6/25.
+//
+
+#ifndef LEARNINGVULKAN_SHADERVARIANTS_HH
+#define LEARNINGVULKAN_SHADERVARIANTS_HH
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "PipelineManager.hh"
+
+/**
+ * @brief Pipelines of one shader program specialized per variant
+ *
+ * A variant is a set of specialization constant values, constant_id N being the Nth value. Feature
+ * toggles are written as `layout(constant_id = N) const` in GLSL, so every variant is compiled with
+ * the dead branches removed while there is a single source file. Variants are requested from the
+ * PipelineManager on first use and remembered, so looking one up again is a single hash lookup.
+ */
+class ShaderVariants {
+public:
+    using Key = std::vector<uint32_t>;
+
+    /// Every variant uses baseState, only its specializationValues differ
+    void init(PipelineManager *pipelineManager, const GraphicsPipelineState &baseState,
+              Key defaultKey);
+
+    void teardown();
+
+    /// Values the shaders declare as defaults, the starting point for other variants
+    const Key &getDefaultKey() const;
+
+    PipelineManager::PipelineFuture request(const Key &key);
+
+    /// Returns the variant once it is compiled. Until then a fast-linked pipeline if pipeline
+    /// libraries are enabled, the fallback otherwise.
+    VkPipeline get(const Key &key, VkPipeline fallback);
+
+    uint32_t getVariantCount() const;
+
+private:
+    struct KeyHasher {
+        size_t operator()(const Key &key) const;
+    };
+
+    PipelineManager *pipelineManager = nullptr;
+
+    GraphicsPipelineState baseState{};
+
+    Key defaultKey{};
+
+    mutable std::mutex mutex{};
+
+    std::unordered_map<Key, PipelineManager::PipelineFuture, KeyHasher> variants{};
+};
+
+#endif //LEARNINGVULKAN_SHADERVARIANTS_HH
@@ -0,0 +1,372 @@
+//
+// Created by eternal on 2024/7/19.
+//
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <glm/gtc/packing.hpp>
+#include "Debug.hh"
+#include "VertexPacking.hh"
+
+namespace vertex_packing {
+    namespace {
+        /// Vertices converted at once, the values of a chunk stay in the L1 cache
+        constexpr size_t kChunk = 256;
+
+        uint32_t getComponentCount(VkFormat format) {
+            switch (format) {
+                case VK_FORMAT_R32_SFLOAT:
+                    return 1;
+                case VK_FORMAT_R32G32_SFLOAT:
+                    return 2;
+                case VK_FORMAT_R32G32B32_SFLOAT:
+                    return 3;
+                case VK_FORMAT_R32G32B32A32_SFLOAT:
+                    return 4;
+                default:
+                    return 0;
+            }
+        }
+
+        uint32_t getStoredComponentCount(Encoding encoding, uint32_t componentCount) {
+            return encoding != Encoding::Float32 && componentCount == 3 ? 4 : componentCount;
+        }
+
+        uint32_t getComponentSize(Encoding encoding) {
+            switch (encoding) {
+                case Encoding::Float32:
+                    return 4;
+                case Encoding::Float16:
+                case Encoding::Snorm16:
+                    return 2;
+                case Encoding::Unorm8:
+                    return 1;
+            }
+            return 0;
+        }
+
+        VkFormat getFormat(Encoding encoding, uint32_t storedComponentCount) {
+            // Every one of these supports VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT on all devices
+            constexpr VkFormat formats[][4] = {
+                    {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+                     VK_FORMAT_R32G32B32A32_SFLOAT},
+                    {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED,
+                     VK_FORMAT_R16G16B16A16_SFLOAT},
+                    {VK_FORMAT_R16_SNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_UNDEFINED,
+                     VK_FORMAT_R16G16B16A16_SNORM},
+                    {VK_FORMAT_R8_UNORM, VK_FORMAT_R8G8_UNORM, VK_FORMAT_UNDEFINED,
+                     VK_FORMAT_R8G8B8A8_UNORM},
+            };
+            return formats[static_cast<size_t>(encoding)][storedComponentCount - 1];
+        }
+
+        /// One attribute of a layout, as the conversions need it
+        struct Attribute {
+            Encoding encoding;
+
+            uint32_t componentCount;
+
+            uint32_t storedComponentCount;
+
+            /// Bytes of the packed attribute
+            uint32_t size;
+
+            uint32_t offset;
+        };
+
+        Attribute getAttribute(const Layout &layout, size_t index) {
+            const Encoding encoding = layout.encodings[index];
+            const uint32_t storedComponentCount =
+                    getStoredComponentCount(encoding, layout.componentCounts[index]);
+            return {
+                    .encoding = encoding,
+                    .componentCount = layout.componentCounts[index],
+                    .storedComponentCount = storedComponentCount,
+                    .size = storedComponentCount * getComponentSize(encoding),
+                    .offset = layout.attributes[index].offset
+            };
+        }
+
+        /// Calls run with the count as a constant, so the copies of the per vertex loops are too
+        template<typename Run>
+        void withComponentCount(uint32_t componentCount, Run run) {
+            switch (componentCount) {
+                case 1:
+                    run(std::integral_constant<uint32_t, 1>{});
+                    break;
+                case 2:
+                    run(std::integral_constant<uint32_t, 2>{});
+                    break;
+                case 3:
+                    run(std::integral_constant<uint32_t, 3>{});
+                    break;
+                default:
+                    run(std::integral_constant<uint32_t, 4>{});
+                    break;
+            }
+        }
+
+        template<uint32_t ComponentCount>
+        glm::vec4 load(const uint8_t *data) {
+            glm::vec4 value{0.0f};
+            memcpy(&value, data, ComponentCount * sizeof(float));
+            return value;
+        }
+
+        const uint8_t *getData(const Source &source, uint32_t componentCount, size_t &stride) {
+            stride = source.stride != 0 ? source.stride : componentCount * sizeof(float);
+            return reinterpret_cast<const uint8_t *>(source.data);
+        }
+
+        /// Bounds from the values, error bounds from the encoding
+        Quantization quantize(const Attribute &attribute, const Source &source, size_t count) {
+            size_t stride;
+            const uint8_t *data = getData(source, attribute.componentCount, stride);
+            glm::vec4 low{0.0f};
+            glm::vec4 high{0.0f};
+            withComponentCount(attribute.componentCount, [&](auto componentCount) {
+                low = high = load<componentCount>(data);
+                for (size_t vertex = 1; vertex < count; ++vertex) {
+                    const glm::vec4 value = load<componentCount>(data + vertex * stride);
+                    low = glm::min(low, value);
+                    high = glm::max(high, value);
+                }
+            });
+
+            Quantization quantization{};
+            for (uint32_t i = 0; i < attribute.componentCount; ++i) {
+                const float magnitude = std::max(std::abs(low[i]), std::abs(high[i]));
+                switch (attribute.encoding) {
+                    case Encoding::Float32:
+                        break;
+                    case Encoding::Float16:
+                        // Half an ULP, 2^-25 for subnormals. From 65520 on values become infinity.
+                        quantization.maxError[i] = magnitude < 65520.0f
+                                                   ? std::max(magnitude * 0x1p-11f, 0x1p-25f)
+                                                   : INFINITY;
+                        break;
+                    case Encoding::Snorm16: {
+                        // Half a step of the extent, and the float rounding of mapping to
+                        // [-1, 1] and back
+                        const float extent = (high[i] - low[i]) * 0.5f;
+                        quantization.scale[i] = extent > 0.0f ? extent : 1.0f;
+                        quantization.offset[i] = low[i] + extent;
+                        quantization.maxError[i] = quantization.scale[i] * (0.5f / 32767.0f) +
+                                                   4.0f * FLT_EPSILON * (magnitude + extent);
+                        break;
+                    }
+                    case Encoding::Unorm8:
+                        // Values outside of [0, 1] are clamped
+                        quantization.maxError[i] = 0.5f / 255.0f + FLT_EPSILON +
+                                                   std::max({0.0f, -low[i], high[i] - 1.0f});
+                        break;
+                }
+            }
+            return quantization;
+        }
+
+        /// Maps the values of count vertices into the range of the encoding, stored components each
+        template<uint32_t ComponentCount, uint32_t StoredComponentCount>
+        void gather(const uint8_t *data, size_t stride, size_t count,
+                    const Quantization &quantization, float *values) {
+            const glm::vec4 reciprocal = 1.0f / quantization.scale;
+            for (size_t vertex = 0; vertex < count; ++vertex) {
+                const glm::vec4 value =
+                        (load<ComponentCount>(data + vertex * stride) - quantization.offset) *
+                        reciprocal;
+                memcpy(values + vertex * StoredComponentCount, &value,
+                       StoredComponentCount * sizeof(float));
+            }
+        }
+
+        /// Copies count elements of Size bytes between strides
+        template<size_t Size>
+        void copy(uint8_t *destination, size_t destinationStride, const uint8_t *source,
+                  size_t sourceStride, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                memcpy(destination + i * destinationStride, source + i * sourceStride, Size);
+            }
+        }
+
+        void copy(uint8_t *destination, size_t destinationStride, const uint8_t *source,
+                  size_t sourceStride, size_t size, size_t count) {
+            switch (size) {
+                case 1:
+                    copy<1>(destination, destinationStride, source, sourceStride, count);
+                    break;
+                case 2:
+                    copy<2>(destination, destinationStride, source, sourceStride, count);
+                    break;
+                case 4:
+                    copy<4>(destination, destinationStride, source, sourceStride, count);
+                    break;
+                case 8:
+                    copy<8>(destination, destinationStride, source, sourceStride, count);
+                    break;
+                case 12:
+                    copy<12>(destination, destinationStride, source, sourceStride, count);
+                    break;
+                default:
+                    copy<16>(destination, destinationStride, source, sourceStride, count);
+                    break;
+            }
+        }
+
+        /// Room for the packed values of a chunk in any encoding, bytes covers all of it
+        union Packed {
+            float floats[kChunk * 4];
+
+            glm::uint16 halves[kChunk * 8];
+
+            glm::uint8 bytes[kChunk * 16];
+        };
+
+        /// Packs the values of one chunk, storedComponentCount per vertex
+        void pack(Encoding encoding, const float *values, size_t valueCount, Packed &out) {
+            switch (encoding) {
+                case Encoding::Float32:
+                    memcpy(out.floats, values, valueCount * sizeof(float));
+                    break;
+                case Encoding::Float16:
+                    glm::packHalfN(values, out.halves, valueCount);
+                    break;
+                case Encoding::Snorm16:
+                    glm::packSnorm16N(values, out.halves, valueCount);
+                    break;
+                case Encoding::Unorm8:
+                    glm::packUnorm8N(values, out.bytes, valueCount);
+                    break;
+            }
+        }
+
+        void unpack(Encoding encoding, const Packed &packed, size_t valueCount, float *values) {
+            switch (encoding) {
+                case Encoding::Float32:
+                    memcpy(values, packed.floats, valueCount * sizeof(float));
+                    break;
+                case Encoding::Float16:
+                    glm::unpackHalfN(packed.halves, values, valueCount);
+                    break;
+                case Encoding::Snorm16:
+                    glm::unpackSnorm16N(packed.halves, values, valueCount);
+                    break;
+                case Encoding::Unorm8:
+                    glm::unpackUnorm8N(packed.bytes, values, valueCount);
+                    break;
+            }
+        }
+    }
+
+    Layout makeLayout(const std::vector<VkVertexInputAttributeDescription> &reflected,
+                      const std::vector<Encoding> &encodings) {
+        if (reflected.size() != encodings.size()) {
+            LOGE("Vertex packing: %zu inputs but %zu encodings.", reflected.size(),
+                 encodings.size());
+            return {};
+        }
+
+        Layout layout;
+        uint32_t offset = 0;
+        for (size_t i = 0; i < reflected.size(); ++i) {
+            const uint32_t componentCount = getComponentCount(reflected[i].format);
+            if (componentCount == 0) {
+                LOGE("Vertex packing: the input at location %u is not a float vector.",
+                     reflected[i].location);
+                return {};
+            }
+            const uint32_t storedComponentCount =
+                    getStoredComponentCount(encodings[i], componentCount);
+            layout.attributes.push_back({
+                    .location = reflected[i].location,
+                    .binding = 0,
+                    .format = getFormat(encodings[i], storedComponentCount),
+                    .offset = offset
+            });
+            layout.componentCounts.push_back(componentCount);
+            layout.encodings.push_back(encodings[i]);
+
+            const uint32_t size = storedComponentCount * getComponentSize(encodings[i]);
+            offset += (size + 3) & ~3u;
+        }
+        layout.stride = offset;
+        return layout;
+    }
+
+    std::vector<Quantization> encode(const Layout &layout, const std::vector<Source> &sources,
+                                     size_t count, void *out) {
+        if (sources.size() != layout.attributes.size()) {
+            LOGE("Vertex packing: %zu sources for %zu attributes.", sources.size(),
+                 layout.attributes.size());
+            return {};
+        }
+
+        auto *vertices = static_cast<uint8_t *>(out);
+        std::vector<Quantization> quantizations;
+        float values[kChunk * 4];
+        Packed packed;
+        for (size_t index = 0; index < sources.size(); ++index) {
+            const Attribute attribute = getAttribute(layout, index);
+            const Quantization quantization = quantize(attribute, sources[index], count);
+            quantizations.push_back(quantization);
+
+            // Gather a chunk of values, convert them in one go and scatter them into the vertices
+            size_t stride;
+            const uint8_t *data = getData(sources[index], attribute.componentCount, stride);
+            for (size_t first = 0; first < count; first += kChunk) {
+                const size_t chunkSize = std::min(kChunk, count - first);
+                withComponentCount(attribute.componentCount, [&](auto componentCount) {
+                    if (attribute.storedComponentCount == componentCount) {
+                        gather<componentCount, componentCount>(
+                                data + first * stride, stride, chunkSize, quantization, values);
+                    } else {
+                        gather<componentCount, 4>(
+                                data + first * stride, stride, chunkSize, quantization, values);
+                    }
+                });
+                pack(attribute.encoding, values, chunkSize * attribute.storedComponentCount,
+                     packed);
+                copy(vertices + first * layout.stride + attribute.offset, layout.stride,
+                     packed.bytes, attribute.size, attribute.size, chunkSize);
+            }
+        }
+        return quantizations;
+    }
+
+    void decode(const Layout &layout, const std::vector<Quantization> &quantizations,
+                const void *vertices, size_t count, const std::vector<float *> &destinations) {
+        if (quantizations.size() != layout.attributes.size() ||
+            destinations.size() != layout.attributes.size()) {
+            LOGE("Vertex packing: %zu quantizations and %zu destinations for %zu attributes.",
+                 quantizations.size(), destinations.size(), layout.attributes.size());
+            return;
+        }
+
+        const auto *source = static_cast<const uint8_t *>(vertices);
+        float values[kChunk * 4];
+        Packed packed;
+        for (size_t index = 0; index < destinations.size(); ++index) {
+            const Attribute attribute = getAttribute(layout, index);
+            const Quantization &quantization = quantizations[index];
+            for (size_t first = 0; first < count; first += kChunk) {
+                const size_t chunkSize = std::min(kChunk, count - first);
+                copy(packed.bytes, attribute.size,
+                     source + first * layout.stride + attribute.offset, layout.stride,
+                     attribute.size, chunkSize);
+                unpack(attribute.encoding, packed, chunkSize * attribute.storedComponentCount,
+                       values);
+                withComponentCount(attribute.componentCount, [&](auto componentCount) {
+                    float *destination = destinations[index] + first * componentCount;
+                    for (size_t vertex = 0; vertex < chunkSize; ++vertex) {
+                        glm::vec4 value = load<componentCount>(reinterpret_cast<const uint8_t *>(
+                                values + vertex * attribute.storedComponentCount));
+                        value = quantization.offset + value * quantization.scale;
+                        memcpy(destination + vertex * componentCount, &value,
+                               componentCount * sizeof(float));
+                    }
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Created by eternal on 2024/7/19.
+//
+
+#ifndef LEARNINGVULKAN_VERTEXPACKING_HH
+#define LEARNINGVULKAN_VERTEXPACKING_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Compact vertex formats, the attribute descriptions for them and an encoder
+ *
+ * Shaders keep their float inputs, the vertex fetch converts the packed formats to floats. A
+ * Layout picks an encoding for each input of the reflected shader and lays them out in location
+ * order in binding 0, each at a multiple of 4 bytes. Three components are stored as four, the
+ * formats of three 8 or 16-bit components are optional for vertex buffers.
+ *
+ * The encoder converts whole arrays with the SIMD pack functions of glm/gtc/packing.hpp, at load
+ * time or offline, the code has no Android dependency. Snorm16 stores values relative to the
+ * bounds of the mesh, the Quantization of the attribute maps them back. For positions that is a
+ * scale and a translation the model transform can absorb, see FrameRenderer::transform.
+ */
+namespace vertex_packing {
+    enum class Encoding : uint8_t {
+        /// Unchanged 32-bit floats
+        Float32,
+
+        /// IEEE half floats, 11 significant bits and magnitudes up to 65504
+        Float16,
+
+        /// 16-bit signed normalized, relative to the bounds of the values
+        Snorm16,
+
+        /// 8-bit unsigned normalized, for values in [0, 1] such as colors
+        Unorm8,
+    };
+
+    struct Layout {
+        /// The reflected inputs with the packed formats and offsets
+        std::vector<VkVertexInputAttributeDescription> attributes{};
+
+        /// Components the shader reads, 1 to 4, for each attribute
+        std::vector<uint32_t> componentCounts{};
+
+        std::vector<Encoding> encodings{};
+
+        /// 0 if the layout could not be made
+        uint32_t stride = 0;
+    };
+
+    /**
+     * @brief The packed layout of the float inputs of a shader
+     *
+     * encodings[i] applies to reflected[i], e.g. the vertexAttributes of a shader_layouts header.
+     * Returns a layout with a stride of 0 if an input is not a 32-bit float vector or the counts
+     * differ.
+     */
+    Layout makeLayout(const std::vector<VkVertexInputAttributeDescription> &reflected,
+                      const std::vector<Encoding> &encodings);
+
+    /// Float vertex data of one attribute
+    struct Source {
+        const float *data = nullptr;
+
+        /// Bytes from one vertex to the next, 0 for tightly packed components
+        size_t stride = 0;
+    };
+
+    /// How the decoded values of an attribute map to the encoded ones, and how close they are
+    struct Quantization {
+        /// value = offset + decoded * scale, 1 and 0 unless the encoding is Snorm16
+        glm::vec4 scale{1.0f};
+
+        glm::vec4 offset{0.0f};
+
+        /// Largest difference to the source after dequantization, per component
+        glm::vec4 maxError{0.0f};
+    };
+
+    /**
+     * @brief Encodes count vertices into out, layout.stride bytes each
+     *
+     * sources[i] holds the components of attribute i. Returns the quantization of each attribute.
+     * Values have to be finite, Float16 turns magnitudes above 65504 into infinity and Unorm8
+     * clamps to [0, 1], maxError tells by how much.
+     */
+    std::vector<Quantization> encode(const Layout &layout, const std::vector<Source> &sources,
+                                     size_t count, void *out);
+
+    /// Decodes count vertices and applies the quantization, components are tightly packed
+    void decode(const Layout &layout, const std::vector<Quantization> &quantizations,
+                const void *vertices, size_t count, const std::vector<float *> &destinations);
+}
+
+#endif //LEARNINGVULKAN_VERTEXPACKING_HH
@@ -20,6 +20,10 @@ void VulkanBaseApp::updateOverlay(float deltaTime, const std::function<void()> &
 
 }
 
+void VulkanBaseApp::pause() {
+
+}
+
 void VulkanBaseApp::finish() {
 
 }
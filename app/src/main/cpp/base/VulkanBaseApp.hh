@@ -4,6 +4,7 @@
 
 #ifndef LEARNINGVULKAN_VULKANBASEAPP_HH
 #define LEARNINGVULKAN_VULKANBASEAPP_HH
+#include <functional>
 #include <string>
 #include <vector>
 #include "vulkan_wrapper.hh"
@@ -20,6 +21,9 @@ public:
 
     virtual void updateOverlay(float deltaTime, const std::function<void()> &additional_ui = [](){});
 
+    /// Called when the app goes to the background, persist anything worth keeping here
+    virtual void pause();
+
     virtual void finish();
 
     const std::string &getName() const;
@@ -2,6 +2,7 @@
 // Created by eternal on 2024/5/2.
 //
 #include <cassert>
+#include <cstring>
 #include <vector>
 #include "VulkanCommon.hh"
 
@@ -28,32 +29,39 @@ namespace vulkan_common {
         return it != surfaceFormats.end() ? *it : surfaceFormats.front();
     }
 
-    VkResult
-    loadShaderFromFile(const android_app *androidAppCtx, const VkDevice device,
-                       const char *filePath,
-                       VkShaderModule *shaderOut) {
-        assert(androidAppCtx != nullptr);
-        AAsset *assetFile = AAssetManager_open(androidAppCtx->activity->assetManager, filePath,
-                                               AASSET_MODE_BUFFER);
-        const size_t fileLength = AAsset_getLength(assetFile);
-        char *shaderCode = new char[fileLength];
+    /**
+     * @brief Creates a shader module from SPIR-V in memory, e.g. a mapped file
+     */
+    VkResult createShaderModule(VkDevice device, const void *code, size_t codeSize,
+                                VkShaderModule *shaderOut) {
+        constexpr uint32_t spirvMagic = 0x07230203;
+        if (codeSize < sizeof(uint32_t) || codeSize % sizeof(uint32_t) != 0) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        // Copied out, code may not be aligned yet
+        uint32_t magic;
+        memcpy(&magic, code, sizeof(magic));
+        if (magic != spirvMagic) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
 
-        AAsset_read(assetFile, shaderCode, fileLength);
-        AAsset_close(assetFile);
+        // pCode has to be 4-byte aligned. Mapped files always are, only inflated buffers may not be.
+        std::vector<uint32_t> alignedCode;
+        if (reinterpret_cast<uintptr_t>(code) % alignof(uint32_t) != 0) {
+            alignedCode.resize(codeSize / sizeof(uint32_t));
+            memcpy(alignedCode.data(), code, codeSize);
+            code = alignedCode.data();
+        }
 
         VkShaderModuleCreateInfo shaderModuleCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
                 .pNext = nullptr,
                 .flags = 0,
-                .codeSize = fileLength,
-                .pCode = reinterpret_cast<const uint32_t *>(shaderCode)
+                .codeSize = codeSize,
+                .pCode = static_cast<const uint32_t *>(code)
         };
 
-        VkResult result = vkCreateShaderModule(device, &shaderModuleCreateInfo, nullptr, shaderOut);
-
-        delete[] shaderCode;
-
-        return result;
+        return vkCreateShaderModule(device, &shaderModuleCreateInfo, nullptr, shaderOut);
     }
 
     bool mapMemoryTypeToIndex(VkPhysicalDevice physicalDevice, uint32_t typeBits,
@@ -69,7 +77,101 @@ namespace vulkan_common {
                     return true;
                 }
             }
+            typeBits >>= 1;
         }
         return false;
     }
+
+    /**
+     * @brief Creates an exclusive buffer and binds it to a dedicated allocation
+     */
+    VkResult createBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize bufferSize,
+                          VkBufferUsageFlags bufferUsageFlags, VkFlags requirementsMask,
+                          VkBuffer *bufferOut, VkDeviceMemory *memoryOut) {
+        VkBufferCreateInfo bufferCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .size = bufferSize,
+                .usage = bufferUsageFlags,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 0,
+                .pQueueFamilyIndices = nullptr
+        };
+
+        VkResult result = vkCreateBuffer(device, &bufferCreateInfo, nullptr, bufferOut);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(device, *bufferOut, &memoryRequirements);
+
+        uint32_t memoryTypeIndex;
+        if (!mapMemoryTypeToIndex(physicalDevice, memoryRequirements.memoryTypeBits,
+                                  requirementsMask, &memoryTypeIndex)) {
+            vkDestroyBuffer(device, *bufferOut, nullptr);
+            *bufferOut = VK_NULL_HANDLE;
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        }
+
+        VkMemoryAllocateInfo allocateInfo{
+                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .allocationSize = memoryRequirements.size,
+                .memoryTypeIndex = memoryTypeIndex
+        };
+
+        result = vkAllocateMemory(device, &allocateInfo, nullptr, memoryOut);
+        if (result != VK_SUCCESS) {
+            vkDestroyBuffer(device, *bufferOut, nullptr);
+            *bufferOut = VK_NULL_HANDLE;
+            return result;
+        }
+
+        return vkBindBufferMemory(device, *bufferOut, *memoryOut, 0);
+    }
+
+    /**
+     * @brief Records a synchronization2 layout transition of the first mip level and layer of a color image
+     */
+    void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image,
+                               VkImageLayout oldLayout, VkImageLayout newLayout,
+                               VkPipelineStageFlags2KHR srcStageMask, VkAccessFlags2KHR srcAccessMask,
+                               VkPipelineStageFlags2KHR dstStageMask, VkAccessFlags2KHR dstAccessMask) {
+        VkImageMemoryBarrier2KHR imageBarrier{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+                .pNext = nullptr,
+                .srcStageMask = srcStageMask,
+                .srcAccessMask = srcAccessMask,
+                .dstStageMask = dstStageMask,
+                .dstAccessMask = dstAccessMask,
+                .oldLayout = oldLayout,
+                .newLayout = newLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = image,
+                .subresourceRange {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .baseMipLevel = 0,
+                        .levelCount = 1,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1,
+                }
+        };
+
+        VkDependencyInfoKHR dependencyInfo{
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+                .pNext = nullptr,
+                .dependencyFlags = 0,
+                .memoryBarrierCount = 0,
+                .pMemoryBarriers = nullptr,
+                .bufferMemoryBarrierCount = 0,
+                .pBufferMemoryBarriers = nullptr,
+                .imageMemoryBarrierCount = 1,
+                .pImageMemoryBarriers = &imageBarrier
+        };
+
+        vkCmdPipelineBarrier2KHR(commandBuffer, &dependencyInfo);
+    }
 }
\ No newline at end of file
@@ -5,7 +5,6 @@
 #ifndef LEARNINGVULKAN_VULKANCOMMON_HH
 #define LEARNINGVULKAN_VULKANCOMMON_HH
 
-#include <game-activity/native_app_glue/android_native_app_glue.h>
 #include <vector>
 #include "vulkan_wrapper.hh"
 
@@ -16,12 +15,20 @@ namespace vulkan_common {
                                                     VK_FORMAT_B8G8R8A8_SRGB,
                                                     VK_FORMAT_A8B8G8R8_SRGB_PACK32}});
 
-    VkResult
-    loadShaderFromFile(const android_app *androidAppCtx, VkDevice device, const char *filePath,
-                       VkShaderModule *shaderOut);
+    VkResult createShaderModule(VkDevice device, const void *code, size_t codeSize,
+                                VkShaderModule *shaderOut);
 
     bool mapMemoryTypeToIndex(VkPhysicalDevice physicalDevice, uint32_t typeBits,
                               VkFlags requirementsMask, uint32_t *typeIndex);
+
+    VkResult createBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize bufferSize,
+                          VkBufferUsageFlags bufferUsageFlags, VkFlags requirementsMask,
+                          VkBuffer *bufferOut, VkDeviceMemory *memoryOut);
+
+    void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image,
+                               VkImageLayout oldLayout, VkImageLayout newLayout,
+                               VkPipelineStageFlags2KHR srcStageMask, VkAccessFlags2KHR srcAccessMask,
+                               VkPipelineStageFlags2KHR dstStageMask, VkAccessFlags2KHR dstAccessMask);
 }
 
 #endif //LEARNINGVULKAN_VULKANCOMMON_HH
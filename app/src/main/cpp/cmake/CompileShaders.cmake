@@ -0,0 +1,76 @@
+# Compiles GLSL to optimized SPIR-V at build time and generates a header with the pipeline
+# interface of each shader program, see tools/spirv_reflect.
+#
+#   compile_shader(<source> OUTPUT <name.spv> [DEFINES <macro>...])
+#   add_shader_program(<name> <name.spv>...)
+#
+# SPIR-V is written to SHADER_OUTPUT_DIR, which the Gradle build packages as assets/shaders.
+# Programs generate shader_layouts/<name>.layout.hh below SHADER_LAYOUT_INCLUDE_DIR. The
+# `shaders` target builds everything and the renderer targets depend on it.
+
+set(SHADER_OUTPUT_DIR "${CMAKE_BINARY_DIR}/shaders" CACHE PATH
+        "Directory the compiled SPIR-V is written to")
+set(SHADER_LAYOUT_INCLUDE_DIR "${CMAKE_BINARY_DIR}/generated")
+
+if (ANDROID)
+    # The NDK ships glslc next to its toolchains
+    file(GLOB GLSLC_HINTS "${ANDROID_NDK}/shader-tools/*")
+endif ()
+find_program(GLSLC glslc HINTS ${GLSLC_HINTS} "$ENV{VULKAN_SDK}/bin" REQUIRED)
+
+set(SPIRV_REFLECT_SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/../tools/spirv_reflect")
+if (CMAKE_CROSSCOMPILING)
+    # The reflection tool runs during the build, so it is built with the host compiler
+    include(ExternalProject)
+    set(SPIRV_REFLECT_BINARY_DIR "${CMAKE_BINARY_DIR}/spirv_reflect")
+    set(SPIRV_REFLECT "${SPIRV_REFLECT_BINARY_DIR}/spirv_reflect${CMAKE_HOST_EXECUTABLE_SUFFIX}")
+    ExternalProject_Add(spirv_reflect
+            SOURCE_DIR "${SPIRV_REFLECT_SOURCE_DIR}"
+            BINARY_DIR "${SPIRV_REFLECT_BINARY_DIR}"
+            CMAKE_ARGS -DCMAKE_BUILD_TYPE=Release
+            INSTALL_COMMAND ""
+            BUILD_BYPRODUCTS "${SPIRV_REFLECT}"
+    )
+else ()
+    add_subdirectory("${SPIRV_REFLECT_SOURCE_DIR}" spirv_reflect)
+    set(SPIRV_REFLECT $<TARGET_FILE:spirv_reflect>)
+endif ()
+
+add_custom_target(shaders ALL)
+
+function(compile_shader source)
+    cmake_parse_arguments(PARSE_ARGV 1 SHADER "" "OUTPUT" "DEFINES")
+    get_filename_component(source "${source}" ABSOLUTE)
+    set(output "${SHADER_OUTPUT_DIR}/${SHADER_OUTPUT}")
+    # Kept out of SHADER_OUTPUT_DIR, which ends up in the APK
+    set(depfile "${CMAKE_BINARY_DIR}/shader_deps/${SHADER_OUTPUT}.d")
+    list(TRANSFORM SHADER_DEFINES PREPEND "-D")
+
+    add_custom_command(
+            OUTPUT "${output}"
+            COMMAND "${CMAKE_COMMAND}" -E make_directory
+                    "${SHADER_OUTPUT_DIR}" "${CMAKE_BINARY_DIR}/shader_deps"
+            COMMAND "${GLSLC}" --target-env=vulkan1.1 -O -Werror ${SHADER_DEFINES}
+                    -MD -MF "${depfile}" -o "${output}" "${source}"
+            MAIN_DEPENDENCY "${source}"
+            DEPFILE "${depfile}"
+            COMMENT "Compiling ${SHADER_OUTPUT}"
+            VERBATIM
+    )
+    set_property(TARGET shaders APPEND PROPERTY SOURCES "${output}")
+endfunction()
+
+function(add_shader_program name)
+    set(header "${SHADER_LAYOUT_INCLUDE_DIR}/shader_layouts/${name}.layout.hh")
+    list(TRANSFORM ARGN PREPEND "${SHADER_OUTPUT_DIR}/" OUTPUT_VARIABLE stages)
+
+    add_custom_command(
+            OUTPUT "${header}"
+            COMMAND "${CMAKE_COMMAND}" -E make_directory "${SHADER_LAYOUT_INCLUDE_DIR}/shader_layouts"
+            COMMAND "${SPIRV_REFLECT}" "${name}" "${header}" ${stages}
+            DEPENDS ${stages} spirv_reflect
+            COMMENT "Reflecting shader program ${name}"
+            VERBATIM
+    )
+    set_property(TARGET shaders APPEND PROPERTY SOURCES "${header}")
+endfunction()
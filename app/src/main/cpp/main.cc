@@ -1,6 +1,7 @@
-#include <android/log.h>
 #include <game-activity/native_app_glue/android_native_app_glue.h>
+#include "Debug.hh"
 #include "samples/TriangleApp.hh"
+#include "utils/CpuProfiler.hh"
 
 void handleCmd(android_app *pApp, int32_t cmd) {
     auto *const pHelloTriangle = reinterpret_cast<TriangleApp *>(pApp->userData);
@@ -10,16 +11,23 @@ void handleCmd(android_app *pApp, int32_t cmd) {
                 pHelloTriangle->prepare(pApp->window);
             }
             break;
+        case APP_CMD_PAUSE:
+            if (pHelloTriangle != nullptr && pHelloTriangle->isReady()) {
+                pHelloTriangle->pause();
+            }
+            break;
         case APP_CMD_DESTROY:
             delete pHelloTriangle;
             break;
         default:
-            __android_log_print(ANDROID_LOG_INFO, "Learning Vulkan", "event not handled: %d", cmd);
+            LOGI("event not handled: %d", cmd);
     }
 }
 
 
 void android_main(android_app *pApp) {
+    PROFILE_THREAD_NAME("Main");
+
     auto* pTriangleApp = new TriangleApp(pApp);
     pApp->userData = pTriangleApp;
     pApp->onAppCmd = handleCmd;
@@ -1,15 +1,57 @@
 //
 // Created by eternal on 2024/5/1.
 //
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include "AssetFileBackend.hh"
+#include "CpuProfiler.hh"
 #include "Debug.hh"
-#include "MathUtils.hh"
 #include "TriangleApp.hh"
+#include "VulkanCapture.hh"
 #include "VulkanCommon.hh"
 
+namespace {
+    /// What the overlay may cost on the CPU per frame, shown in red when exceeded
+    constexpr float kOverlayBudgetMilliseconds = 0.2f;
+
+    /// Graphs are scaled so that a full bar is a 30 fps frame
+    constexpr float kGraphMaxMilliseconds = 33.3f;
+
+    /// Slots of the bindless set, clamped to the device limits
+    constexpr uint32_t kBindlessImages = 1024;
+
+    constexpr uint32_t kBindlessBuffers = 256;
+
+    float millisecondsBetween(std::chrono::steady_clock::time_point begin,
+                              std::chrono::steady_clock::time_point end) {
+        return std::chrono::duration<float, std::milli>(end - begin).count();
+    }
+
+    /// Resident set size of the process, 0 if it cannot be read
+    float readResidentMegabytes() {
+        FILE *file = fopen("/proc/self/statm", "r");
+        if (file == nullptr) {
+            return 0.0f;
+        }
+        unsigned long sizePages = 0;
+        unsigned long residentPages = 0;
+        const int read = fscanf(file, "%lu %lu", &sizePages, &residentPages);
+        fclose(file);
+        if (read != 2) {
+            return 0.0f;
+        }
+        return static_cast<float>(residentPages) * static_cast<float>(sysconf(_SC_PAGESIZE)) /
+               (1024.0f * 1024.0f);
+    }
+}
+
 TriangleApp::TriangleApp(android_app *pApp) : androidAppCtx(pApp) {}
 
 TriangleApp::~TriangleApp() {
@@ -43,17 +85,57 @@ bool TriangleApp::prepare(ANativeWindow *window) {
 
     initSwapchain();
 
-    initRenderPass();
-    initDescriptorSetLayout();
-    initPipeline();
-    initFramebuffers();
+    context.gpuProfiler.init(context.gpu, context.device, context.queue,
+                             context.graphicsQueueIndex.value(),
+                             static_cast<uint32_t>(context.perFrame.size()), 8,
+                             context.calibratedTimestamps);
 
-    initVertexBuffers();
-    initIndexBuffers();
-    initUniformBuffers();
+    if (!initPipelineCache()) {
+        return false;
+    }
 
-    initDescriptorPool();
-    initDescriptorSets();
+    // Leave the other cores to the render thread and the rest of the system
+    const uint32_t compileThreads = std::clamp(std::thread::hardware_concurrency() / 4, 1u, 2u);
+    context.pipelineManager.init(context.device, &context.pipelineCache, compileThreads,
+                                 context.graphicsPipelineLibrary);
+
+    context.fileBackend = std::make_unique<AssetFileBackend>(androidAppCtx->activity->assetManager);
+    context.shaderModules.init(context.device, context.fileBackend.get());
+    context.layoutCache.init(context.device);
+
+    // The triangles read their transforms and the overlay samples its atlas through the bindless
+    // set where the device allows it
+    const auto frameCount = static_cast<uint32_t>(context.perFrame.size());
+    if (context.bindlessDescriptors &&
+        !context.bindless.init(context.gpu, context.device, kBindlessImages, kBindlessBuffers,
+                               frameCount)) {
+        context.bindless.teardown();
+        context.bindlessDescriptors = false;
+    }
+
+    if (!context.dynamicRendering) {
+        initRenderPass();
+    }
+    if (!initRenderer()) {
+        return false;
+    }
+    if (!context.dynamicRendering) {
+        initFramebuffers();
+    }
+
+    // Drawn on top of everything else, the app keeps running without it
+    if (!context.overlay.init(context.gpu, context.device, context.queue,
+                              context.graphicsQueueIndex.value(), &context.layoutCache,
+                              &context.shaderModules, &context.pipelineManager,
+                              context.dynamicRendering ? VK_NULL_HANDLE : context.renderPass,
+                              context.swapchainDimensions.format, frameCount,
+                              context.bindlessDescriptors ? &context.bindless : nullptr)) {
+        LOGW("Overlay: disabled.");
+    }
+
+#if RESOURCE_TRACKER_ENABLED
+    preparedResources = resource_tracker::takeSnapshot();
+#endif
 
     startTimePoint = std::chrono::system_clock::now();
     isReady_ = true;
@@ -61,6 +143,13 @@ bool TriangleApp::prepare(ANativeWindow *window) {
 }
 
 void TriangleApp::update([[maybe_unused]] float deltaTime) {
+    PROFILE_FUNCTION();
+    const auto updateStart = std::chrono::steady_clock::now();
+    const bool firstUpdate = lastUpdateTimePoint == std::chrono::steady_clock::time_point{};
+    const float intervalMilliseconds =
+            firstUpdate ? 0.0f : millisecondsBetween(lastUpdateTimePoint, updateStart);
+    lastUpdateTimePoint = updateStart;
+
     uint32_t index;
 
     VkResult result = acquireNextImage(&index);
@@ -70,7 +159,26 @@ void TriangleApp::update([[maybe_unused]] float deltaTime) {
         return;
     }
 
+    // The fence of this image was waited for, so its slice of overlay quads is free again.
+    // Waits are left out of the CPU time, it covers building and recording the frame.
+    const auto cpuStart = std::chrono::steady_clock::now();
+    if (context.bindlessDescriptors) {
+        context.bindless.beginFrame();
+    }
+    context.overlay.beginFrame(index);
+    updateOverlay(intervalMilliseconds / 1000.0f, {});
+    overlayCpuMilliseconds = millisecondsBetween(cpuStart, std::chrono::steady_clock::now());
+
     renderTriangle(index);
+    const float cpuMilliseconds = millisecondsBetween(cpuStart, std::chrono::steady_clock::now());
+
+    if (!firstUpdate) {
+        frameStats.add({
+                .intervalMs = intervalMilliseconds,
+                .cpuMs = cpuMilliseconds,
+                .gpuMs = static_cast<float>(context.gpuProfiler.getFrameMilliseconds())
+        });
+    }
 
     result = presentImage(index);
 
@@ -79,10 +187,107 @@ void TriangleApp::update([[maybe_unused]] float deltaTime) {
     }
 }
 
+void TriangleApp::updateOverlay(float deltaTime, const std::function<void()> &additionalUi) {
+    PROFILE_FUNCTION();
+    Overlay &overlay = context.overlay;
+    const VkExtent2D extent = context.swapchainDimensions.extent;
+
+    // Whole pixels per font texel, about 45 characters across the shorter side
+    const auto shorterSide = static_cast<float>(std::min(extent.width, extent.height));
+    overlay.setScale(std::max(1.0f, std::floor(shorterSide / 270.0f)));
+
+    if (framesUntilStatsRefresh == 0) {
+        framePercentiles = frameStats.computeIntervalPercentiles();
+        residentMegabytes = readResidentMegabytes();
+        framesUntilStatsRefresh = 30;
+    }
+    --framesUntilStatsRefresh;
+
+    constexpr uint32_t white = Overlay::rgba(255, 255, 255);
+    constexpr uint32_t red = Overlay::rgba(255, 64, 64);
+    constexpr uint32_t cpuColor = Overlay::rgba(96, 200, 255);
+    constexpr uint32_t gpuColor = Overlay::rgba(255, 176, 64);
+
+    const float lineHeight = overlay.getLineHeight();
+    const float x = lineHeight;
+    float y = lineHeight;
+    const float graphWidth = shorterSide * 0.5f;
+    const float graphHeight = lineHeight * 3.0f;
+    const FrameStats::Sample latest = frameStats.getLatest();
+
+    overlay.text(x, y, white, "FPS %.1f  FRAME %.2f MS", frameStats.getFps(),
+                 deltaTime * 1000.0f);
+    y += lineHeight;
+    overlay.text(x, y, white, "P50 %.2f  P95 %.2f  P99 %.2f MS", framePercentiles.p50,
+                 framePercentiles.p95, framePercentiles.p99);
+    y += lineHeight;
+
+    overlay.text(x, y, cpuColor, "CPU %.2f MS", latest.cpuMs);
+    y += lineHeight;
+    overlay.graph(x, y, graphWidth, graphHeight, frameStats.getCpuTimes().data(),
+                  FrameStats::kHistorySize, frameStats.getCount(), frameStats.getFirst(),
+                  kGraphMaxMilliseconds, cpuColor);
+    y += graphHeight + lineHeight * 0.5f;
+
+    overlay.text(x, y, gpuColor, "GPU %.2f MS", latest.gpuMs);
+    y += lineHeight;
+    overlay.graph(x, y, graphWidth, graphHeight, frameStats.getGpuTimes().data(),
+                  FrameStats::kHistorySize, frameStats.getCount(), frameStats.getFirst(),
+                  kGraphMaxMilliseconds, gpuColor);
+    y += graphHeight + lineHeight * 0.5f;
+
+    overlay.text(x, y, white, "MEM %.1f MB", residentMegabytes);
+    y += lineHeight;
+    overlay.text(x, y, white, "DRAWS %u  SUBMITS %u", frameCounters.draws, frameCounters.submits);
+    y += lineHeight;
+    overlay.text(x, y, overlayCpuMilliseconds > kOverlayBudgetMilliseconds ? red : white,
+                 "OVERLAY CPU %.3f  GPU %.3f MS", overlayCpuMilliseconds,
+                 context.gpuProfiler.getMilliseconds("Overlay"));
+
+    if (additionalUi) {
+        additionalUi();
+    }
+}
+
+void TriangleApp::pause() {
+    // The app may be killed in the background without another chance to save
+    context.pipelineManager.flushCaches();
+    context.pipelineCache.save();
+
+#if CPU_PROFILER_ENABLED
+    // GPU scopes are part of it, on a track of their own
+    const std::string tracePath =
+            std::string(androidAppCtx->activity->internalDataPath) + "/trace.json";
+    if (cpu_profiler::writeTrace(tracePath.c_str())) {
+        LOGI("Trace written to %s", tracePath.c_str());
+    }
+#else
+    const std::string tracePath =
+            std::string(androidAppCtx->activity->internalDataPath) + "/gpu_trace.json";
+    if (context.gpuProfiler.isEnabled() && context.gpuProfiler.writeTrace(tracePath.c_str())) {
+        LOGI("GPU trace written to %s", tracePath.c_str());
+    }
+#endif
+
+#if RESOURCE_TRACKER_ENABLED
+    // Anything here grows with the time the app runs
+    if (!resource_tracker::logChanges(preparedResources, resource_tracker::takeSnapshot())) {
+        LOGI("No Vulkan objects created or released since prepare");
+    }
+#endif
+}
+
 void TriangleApp::teardown() {
+#if CAPTURE_FRAMES > 0
+    vulkan_capture::end();
+#endif
+
     // Don't release anything until the GPU is completely idle.
     vkDeviceWaitIdle(context.device);
 
+    context.gpuProfiler.teardown();
+    context.overlay.teardown();
+
     teardownFramebuffers();
 
     for (auto &perFrame: context.perFrame) {
@@ -95,53 +300,23 @@ void TriangleApp::teardown() {
         vkDestroySemaphore(context.device, semaphore, nullptr);
     }
 
-    if (!context.uniformBuffers.empty()) {
-        for (const auto &uniformBuffer: context.uniformBuffers) {
-            vkDestroyBuffer(context.device, uniformBuffer, nullptr);
-        }
-        context.uniformBuffers.clear();
-    }
+    // Releases its slots of the bindless set first
+    context.renderer.teardown();
+    context.bindless.teardown();
+    context.pipelineManager.teardown();
 
-    if (context.indexBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(context.device, context.indexBuffer, nullptr);
-        context.indexBuffer = VK_NULL_HANDLE;
-    }
-
-    if (context.vertexBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(context.device, context.vertexBuffer, nullptr);
-        context.vertexBuffer = VK_NULL_HANDLE;
-    }
-
-    if (context.pipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(context.device, context.pipeline, nullptr);
-        context.pipeline = VK_NULL_HANDLE;
-    }
-
-    if (context.descriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(context.device, context.descriptorSetLayout, nullptr);
-        context.descriptorSetLayout = VK_NULL_HANDLE;
-    }
+    // Pipelines are gone, their shader modules can follow
+    context.shaderModules.teardown();
 
-    if (context.pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(context.device, context.pipelineLayout, nullptr);
-        context.pipelineLayout = VK_NULL_HANDLE;
-    }
+    // Owns the pipeline layout and the draw constants set layout
+    context.layoutCache.teardown();
 
     if (context.renderPass != VK_NULL_HANDLE) {
         vkDestroyRenderPass(context.device, context.renderPass, nullptr);
         context.renderPass = VK_NULL_HANDLE;
     }
 
-    if (!context.descriptorSets.empty()) {
-        vkFreeDescriptorSets(context.device, context.descriptorPool, context.descriptorSets.size(),
-                             context.descriptorSets.data());
-        context.descriptorSets.clear();
-    }
-
-    if (context.descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(context.device, context.descriptorPool, nullptr);
-        context.descriptorPool = VK_NULL_HANDLE;
-    }
+    context.pipelineCache.teardown();
 
     for (VkImageView imageView: context.swapchainImageViews) {
         vkDestroyImageView(context.device, imageView, nullptr);
@@ -205,6 +380,7 @@ void TriangleApp::initInstance(std::vector<const char *> &&requiredInstanceExten
     };
 
     CALL_VK(vkCreateInstance(&instanceCreateInfo, nullptr, &context.instance))
+    InitVulkanInstance(context.instance, &instanceCreateInfo);
 }
 
 bool TriangleApp::initDevice(std::vector<const char *> &&requiredDeviceExtensions) {
@@ -261,6 +437,92 @@ bool TriangleApp::initDevice(std::vector<const char *> &&requiredDeviceExtension
         return false;
     }
 
+    // Prefer dynamic rendering, the render pass path is kept as the fallback
+    context.dynamicRendering = isDynamicRenderingSupported(context.gpu, availableDeviceExtensions);
+    if (context.dynamicRendering) {
+        requiredDeviceExtensions.insert(requiredDeviceExtensions.end(), {
+                VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+                VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+                VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+                VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME
+        });
+    }
+    LOGI("Rendering path: %s", context.dynamicRendering ? "dynamic rendering" : "render pass");
+
+    // Only used to report pipeline cache hits
+    context.pipelineCreationFeedback = validateExtensions(
+            {VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME}, availableDeviceExtensions);
+    if (context.pipelineCreationFeedback) {
+        requiredDeviceExtensions.emplace_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    }
+
+    // Fast-linked pipelines are drawn while the optimized ones compile
+    context.graphicsPipelineLibrary = isGraphicsPipelineLibrarySupported(
+            context.gpu, availableDeviceExtensions);
+    if (context.graphicsPipelineLibrary) {
+        requiredDeviceExtensions.insert(requiredDeviceExtensions.end(), {
+                VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+                VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME
+        });
+    }
+    LOGI("Fast pipeline linking: %s", context.graphicsPipelineLibrary ? "yes" : "no");
+
+    context.bindlessDescriptors = BindlessDescriptors::isSupported(context.gpu,
+                                                                   availableDeviceExtensions);
+    if (context.bindlessDescriptors) {
+        for (const char *extension: BindlessDescriptors::getRequiredExtensions()) {
+            requiredDeviceExtensions.emplace_back(extension);
+        }
+    }
+    LOGI("Bindless descriptors: %s", context.bindlessDescriptors ? "yes" : "no");
+
+    // Puts GPU profiler scopes on the CPU timeline without a round trip to the GPU
+    context.calibratedTimestamps = validateExtensions(
+            {VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME}, availableDeviceExtensions);
+    if (context.calibratedTimestamps) {
+        requiredDeviceExtensions.emplace_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+    }
+
+    // Descriptor update templates are core from 1.1 on, 1.0 devices may have the extension.
+    // DescriptorUpdateTemplate falls back to vkUpdateDescriptorSets without either.
+    VkPhysicalDeviceProperties gpuProperties;
+    vkGetPhysicalDeviceProperties(context.gpu, &gpuProperties);
+    if (gpuProperties.apiVersion < VK_API_VERSION_1_1 &&
+        validateExtensions({VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME},
+                           availableDeviceExtensions)) {
+        requiredDeviceExtensions.emplace_back(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+    }
+
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
+            .pNext = nullptr,
+            .synchronization2 = VK_TRUE
+    };
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+            .pNext = &synchronization2Features,
+            .dynamicRendering = VK_TRUE
+    };
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+            .pNext = context.dynamicRendering ? &dynamicRenderingFeatures : nullptr,
+            .graphicsPipelineLibrary = VK_TRUE
+    };
+
+    void *enabledFeatures = context.dynamicRendering ? &dynamicRenderingFeatures : nullptr;
+    if (context.graphicsPipelineLibrary) {
+        enabledFeatures = &graphicsPipelineLibraryFeatures;
+    }
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures =
+            BindlessDescriptors::getRequiredFeatures();
+    if (context.bindlessDescriptors) {
+        descriptorIndexingFeatures.pNext = enabledFeatures;
+        enabledFeatures = &descriptorIndexingFeatures;
+    }
+
     const float queuePriorities[]{1.0f};
 
     VkDeviceQueueCreateInfo deviceQueueCreateInfo{
@@ -274,7 +536,7 @@ bool TriangleApp::initDevice(std::vector<const char *> &&requiredDeviceExtension
 
     VkDeviceCreateInfo deviceCreateInfo{
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .pNext = nullptr,
+            .pNext = enabledFeatures,
             .flags = 0,
             .queueCreateInfoCount = 1,
             .pQueueCreateInfos = &deviceQueueCreateInfo,
@@ -286,6 +548,19 @@ bool TriangleApp::initDevice(std::vector<const char *> &&requiredDeviceExtension
     };
 
     CALL_VK(vkCreateDevice(context.gpu, &deviceCreateInfo, nullptr, &context.device))
+    InitVulkanDevice(context.gpu, context.device, &deviceCreateInfo);
+
+#if CAPTURE_FRAMES > 0
+    // Skips the first second, pipelines are compiled and caches are warm by then
+    const std::string capturePath =
+            std::string(androidAppCtx->activity->internalDataPath) + "/capture.lvtrace";
+    vulkan_capture::begin(context.gpu, &deviceCreateInfo, capturePath.c_str(), 60, CAPTURE_FRAMES);
+#endif
+
+#if RESOURCE_TRACKER_ENABLED
+    // Leaks are reported when the device is destroyed
+    resource_tracker::install(context.device);
+#endif
 
     if (context.graphicsQueueIndex.has_value()) {
         vkGetDeviceQueue(context.device, context.graphicsQueueIndex.value(), 0, &context.queue);
@@ -298,6 +573,7 @@ bool TriangleApp::initDevice(std::vector<const char *> &&requiredDeviceExtension
 }
 
 void TriangleApp::initSwapchain() {
+    RESOURCE_SCOPE("Swapchain");
     VkSurfaceCapabilitiesKHR surfaceCapabilities;
     CALL_VK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(context.gpu, context.surface,
                                                       &surfaceCapabilities))
@@ -395,6 +671,8 @@ void TriangleApp::initSwapchain() {
         initPerFrame(context.perFrame.at(i));
     }
 
+    context.swapchainImages = swapchainImages;
+
     for (uint32_t i = 0; i < imageCount; ++i) {
         VkImageViewCreateInfo imageViewCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -425,6 +703,13 @@ void TriangleApp::initSwapchain() {
     }
 }
 
+bool TriangleApp::initPipelineCache() {
+    const std::string cachePath =
+            std::string(androidAppCtx->activity->internalDataPath) + "/pipeline_cache.bin";
+    return context.pipelineCache.init(context.gpu, context.device, cachePath,
+                                      context.pipelineCreationFeedback);
+}
+
 /**
  * @brief Initialize the Vulkan render pass
  */
@@ -489,199 +774,26 @@ void TriangleApp::initRenderPass() {
     CALL_VK(vkCreateRenderPass(context.device, &renderPassCreateInfo, nullptr, &context.renderPass))
 }
 
-void TriangleApp::initDescriptorSetLayout() {
-    VkDescriptorSetLayoutBinding uboSetLayoutBinding{
-            .binding = 0,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
-            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-            .pImmutableSamplers = nullptr
-    };
-
-    VkDescriptorSetLayoutCreateInfo layoutCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .bindingCount = 1,
-            .pBindings = &uboSetLayoutBinding
-    };
-
-    CALL_VK(vkCreateDescriptorSetLayout(context.device, &layoutCreateInfo, nullptr,
-                                        &context.descriptorSetLayout))
-}
-
-void TriangleApp::initPipeline() {
-    // Create a blank pipeline layout
-    VkPipelineLayoutCreateInfo layoutCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .setLayoutCount = 1,
-            .pSetLayouts = &context.descriptorSetLayout,
-            .pushConstantRangeCount = 0,
-            .pPushConstantRanges = nullptr,
-    };
-    CALL_VK(vkCreatePipelineLayout(context.device, &layoutCreateInfo, nullptr,
-                                   &context.pipelineLayout))
-
-    VkVertexInputBindingDescription inputBinding{
-            .binding = 0,
-            .stride = sizeof(Vertex),
-            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
-    VkVertexInputAttributeDescription inputAttributes[]{
-            {
-                    .location = 0,
-                    .binding = 0,
-                    .format = VK_FORMAT_R32G32_SFLOAT,
-                    .offset = offsetof(Vertex, position)
-            },
-            {
-                    .location = 1,
-                    .binding = 0,
-                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
-                    .offset = offsetof(Vertex, color)
-            }
-    };
-
-    VkPipelineVertexInputStateCreateInfo vertexInput{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .vertexBindingDescriptionCount = 1,
-            .pVertexBindingDescriptions = &inputBinding,
-            .vertexAttributeDescriptionCount = 2,
-            .pVertexAttributeDescriptions = inputAttributes
-    };
-
-    // Specify we will use triangle lists to draw geometry.
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-            .primitiveRestartEnable = VK_FALSE
-    };
-
-    // Specify rasterization state
-    VkPipelineRasterizationStateCreateInfo rasterization{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .depthClampEnable = VK_FALSE,
-            .rasterizerDiscardEnable = VK_FALSE,
-            .polygonMode = VK_POLYGON_MODE_FILL,
-            .cullMode = VK_CULL_MODE_BACK_BIT,
-            .frontFace = VK_FRONT_FACE_CLOCKWISE,
-            .depthBiasEnable = VK_FALSE,
-            .depthBiasClamp = VK_FALSE,
-            .lineWidth = 1.0f
-    };
-
-    // Our attachment will write to all color channels, but no blending is enabled.
-    VkPipelineColorBlendAttachmentState colorBlendAttachmentState{
-            .blendEnable = VK_FALSE,
-            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-                              VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
-    };
-
-    VkPipelineColorBlendStateCreateInfo colorBlend{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .attachmentCount = 1,
-            .pAttachments = &colorBlendAttachmentState
-    };
-
-    VkPipelineViewportStateCreateInfo viewportState{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .viewportCount = 1,
-            // We will set it dynamically
-            .pViewports = nullptr,
-            .scissorCount = 1,
-            // We will set it dynamically
-            .pScissors = nullptr,
-    };
-
-    // Disable all depth testing
-    VkPipelineDepthStencilStateCreateInfo depthStencilState{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .depthTestEnable = VK_FALSE
-    };
-
-    // No multisampling
-    VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
-    };
-
-    // Specify that these states will be dynamic
-    std::array<VkDynamicState, 2> dynamics{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
-
-    VkPipelineDynamicStateCreateInfo dynamicState{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-            .dynamicStateCount = dynamics.size(),
-            .pDynamicStates = dynamics.data()
-    };
-
-    VkShaderModule vertexShader, fragmentShader;
-    vulkan_common::loadShaderFromFile(androidAppCtx, context.device,
-                                      "shaders/triangle.vert.spv",
-                                      &vertexShader);
-    vulkan_common::loadShaderFromFile(androidAppCtx, context.device,
-                                      "shaders/triangle.frag.spv",
-                                      &fragmentShader);
-    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{
-            VkPipelineShaderStageCreateInfo{
-                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-                    .pNext = nullptr,
-                    .flags = 0,
-                    .stage = VK_SHADER_STAGE_VERTEX_BIT,
-                    .module = vertexShader,
-                    .pName = "main",
-                    .pSpecializationInfo = nullptr,
-            },
-            VkPipelineShaderStageCreateInfo{
-                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-                    .pNext = nullptr,
-                    .flags = 0,
-                    .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-                    .module = fragmentShader,
-                    .pName = "main",
-                    .pSpecializationInfo = nullptr
-            }
-    };
-
-    VkGraphicsPipelineCreateInfo pipelineCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .stageCount = shaderStages.size(),
-            .pStages = shaderStages.data(),
-            .pVertexInputState = &vertexInput,
-            .pInputAssemblyState = &inputAssembly,
-            .pViewportState = &viewportState,
-            .pRasterizationState = &rasterization,
-            .pMultisampleState = &multisampleStateCreateInfo,
-            .pDepthStencilState = &depthStencilState,
-            .pColorBlendState = &colorBlend,
-            .pDynamicState = &dynamicState,
-            .layout = context.pipelineLayout,
-            .renderPass = context.renderPass
-    };
-
-    CALL_VK(vkCreateGraphicsPipelines(context.device, VK_NULL_HANDLE, 1, &pipelineCreateInfo,
-                                      nullptr, &context.pipeline))
-
-    vkDestroyShaderModule(context.device, vertexShader, nullptr);
-    vkDestroyShaderModule(context.device, fragmentShader, nullptr);
+bool TriangleApp::initRenderer() {
+    return context.renderer.init({
+            .gpu = context.gpu,
+            .device = context.device,
+            .layoutCache = &context.layoutCache,
+            .shaderModules = &context.shaderModules,
+            .pipelineManager = &context.pipelineManager,
+            .gpuProfiler = &context.gpuProfiler,
+            .bindless = context.bindlessDescriptors ? &context.bindless : nullptr,
+            .renderPass = context.dynamicRendering ? VK_NULL_HANDLE : context.renderPass,
+            .colorFormat = context.swapchainDimensions.format,
+            .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            .frameCount = static_cast<uint32_t>(context.perFrame.size()),
+            // The triangle is drawn once per frame
+            .maxObjectsPerFrame = 1
+    });
 }
 
 void TriangleApp::initFramebuffers() {
+    RESOURCE_SCOPE("Framebuffers");
     // Create framebuffer for each swapchain image view
     for (const auto &imageView: context.swapchainImageViews) {
         // Build the framebuffer
@@ -715,88 +827,6 @@ void TriangleApp::teardownFramebuffers() {
     context.swapchainFramebuffers.clear();
 }
 
-void TriangleApp::initVertexBuffers() {
-    constexpr Vertex vertexData[] = {
-            {.position {-100.0f, -20.0f}, .color {1.0f, 1.0f, 0.0f, 1.0f}},
-            {.position {100.0f, -60.0f}, .color {1.0f, 0.0f, 1.0f, 1.0f}},
-            {.position {30.0f, 100.0f}, .color {0.0f, 1.0f, 1.0f, 1.0f}},
-            {.position {-170.0f, 140.0f}, .color {1.0f, 1.0f, 1.0f, 1.0f}},
-    };
-    constexpr VkDeviceSize bufferSize = sizeof(vertexData);
-    VkDeviceMemory deviceMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 context.vertexBuffer, deviceMemory);
-
-    void *data;
-    vkMapMemory(context.device, deviceMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertexData, bufferSize);
-    vkUnmapMemory(context.device, deviceMemory);
-}
-
-void TriangleApp::initIndexBuffers() {
-    constexpr uint16_t indices[] = {
-            0, 1, 2,
-            2, 3, 0
-    };
-    constexpr VkDeviceSize bufferSize = sizeof(indices);
-    VkDeviceMemory deviceMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 context.indexBuffer, deviceMemory);
-
-    void *data;
-    vkMapMemory(context.device, deviceMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices, bufferSize);
-    vkUnmapMemory(context.device, deviceMemory);
-}
-
-void TriangleApp::initUniformBuffers() {
-    constexpr VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-    context.uniformBuffers.resize(context.perFrame.size());
-    for (auto &uniformBuffer: context.uniformBuffers) {
-        VkDeviceMemory deviceMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     uniformBuffer, deviceMemory);
-    }
-}
-
-void TriangleApp::initDescriptorPool() {
-    const uint32_t descriptorCount = context.perFrame.size();
-    VkDescriptorPoolSize poolSize{
-            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = descriptorCount,
-    };
-
-    VkDescriptorPoolCreateInfo poolCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .maxSets = descriptorCount,
-            .poolSizeCount = 1,
-            .pPoolSizes = &poolSize
-    };
-
-    CALL_VK(vkCreateDescriptorPool(context.device, &poolCreateInfo, nullptr,
-                                   &context.descriptorPool))
-}
-
-void TriangleApp::initDescriptorSets() {
-    const std::vector<VkDescriptorSetLayout> layouts(context.perFrame.size(), context.descriptorSetLayout);
-    context.descriptorSets.resize(layouts.size());
-    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .pNext = nullptr,
-            .descriptorPool = context.descriptorPool,
-            .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
-            .pSetLayouts = layouts.data()
-    };
-
-    CALL_VK(vkAllocateDescriptorSets(context.device, &descriptorSetAllocateInfo,
-                                     context.descriptorSets.data()))
-}
-
 /**
  * @brief Initializes per frame data
  * @param perFrame The data of a frame
@@ -867,76 +897,24 @@ void TriangleApp::teardownPerFrame(TriangleApp::PerFrameData &perFrame) const {
  * @param swapchainIndex The swapchain index for the image being rendered.
  */
 void TriangleApp::renderTriangle(uint32_t swapchainIndex) {
-    VkFramebuffer framebuffer = context.swapchainFramebuffers.at(swapchainIndex);
-
+    PROFILE_FUNCTION();
     VkCommandBuffer commandBuffer = context.perFrame.at(swapchainIndex).primaryCommandBuffer;
 
-    VkCommandBufferBeginInfo commandBufferBeginInfo{
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-            .pNext = nullptr,
-            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-            .pInheritanceInfo = nullptr,
-    };
-    vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
-
-    VkClearValue clearValue{
-            .color {
-                    .float32 {0.01f, 0.01f, 0.033f, 1.0f}
-            },
-    };
-
-    // Begin render pass
-    VkRenderPassBeginInfo renderPassBeginInfo{
-            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .pNext = nullptr,
-            .renderPass = context.renderPass,
-            .framebuffer = framebuffer,
-            .renderArea {
-                    .offset {.x = 0, .y = 0},
-                    .extent = context.swapchainDimensions.extent,
-            },
-            .clearValueCount = 1,
-            .pClearValues = &clearValue
-    };
-    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    updateVertexBuffer(commandBuffer);
-    updateUniformBuffer(commandBuffer, swapchainIndex);
-
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context.pipeline);
+    using namespace std::chrono;
+    const auto timestamp = static_cast<float>(duration_cast<milliseconds>(
+            system_clock::now() - startTimePoint).count()) / 1000.0f;
 
-    VkViewport viewport{
-            .x = 0,
-            .y = 0,
-            .width = static_cast<float>(context.swapchainDimensions.extent.width),
-            .height = static_cast<float>(context.swapchainDimensions.extent.height),
-            .minDepth = 0.0f,
-            .maxDepth = 1.0f,
+    const FrameRenderer::Target target{
+            .image = context.swapchainImages.at(swapchainIndex),
+            .imageView = context.swapchainImageViews.at(swapchainIndex),
+            .framebuffer = context.dynamicRendering
+                           ? VK_NULL_HANDLE : context.swapchainFramebuffers.at(swapchainIndex),
+            .extent = context.swapchainDimensions.extent
     };
-    // Set viewport dynamically
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-    VkRect2D scissor{
-            .offset {.x = 0, .y = 0},
-            .extent {
-                    .width = context.swapchainDimensions.extent.width,
-                    .height = context.swapchainDimensions.extent.height
-            }
-    };
-    // Set scissor dynamically
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-    VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &context.vertexBuffer,
-                           &offset);
-    vkCmdBindIndexBuffer(commandBuffer, context.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context.pipelineLayout,
-                            0, 1, &context.descriptorSets.at(swapchainIndex), 0, nullptr);
-    vkCmdDrawIndexed(commandBuffer, 6, 1, 0, 0, 0);
-
-    vkCmdEndRenderPass(commandBuffer);
-
-    CALL_VK(vkEndCommandBuffer(commandBuffer))
+    const FrameRenderer::Counters counters = context.renderer.record(
+            commandBuffer, swapchainIndex, target, timestamp, 1, &context.overlay);
+    frameCounters = {.draws = counters.draws};
+    overlayCpuMilliseconds += counters.overlayMilliseconds;
 
     // Submit it to the queue with a release semaphore.
     if (context.perFrame.at(swapchainIndex).swapchainReleaseSemaphore == VK_NULL_HANDLE) {
@@ -960,8 +938,10 @@ void TriangleApp::renderTriangle(uint32_t swapchainIndex) {
             .signalSemaphoreCount = 1,
             .pSignalSemaphores = &context.perFrame.at(swapchainIndex).swapchainReleaseSemaphore
     };
+    PROFILE_SCOPE("vkQueueSubmit");
     CALL_VK(vkQueueSubmit(context.queue, 1, &submitInfo,
                           context.perFrame.at(swapchainIndex).queueSubmitFence))
+    ++frameCounters.submits;
 }
 
 /**
@@ -969,6 +949,7 @@ void TriangleApp::renderTriangle(uint32_t swapchainIndex) {
  * @param[out] image
  */
 VkResult TriangleApp::acquireNextImage(uint32_t *image) {
+    PROFILE_FUNCTION();
     VkSemaphore acquireSemaphore;
     if (context.recycledSemaphores.empty()) {
         VkSemaphoreCreateInfo semaphoreCreateInfo{
@@ -980,9 +961,13 @@ VkResult TriangleApp::acquireNextImage(uint32_t *image) {
         context.recycledSemaphores.pop_back();
     }
 
-    VkResult result = vkAcquireNextImageKHR(context.device, context.swapchain,
-                                            std::numeric_limits<uint64_t>::max(), acquireSemaphore,
-                                            VK_NULL_HANDLE, image);
+    VkResult result;
+    {
+        PROFILE_SCOPE("vkAcquireNextImageKHR");
+        result = vkAcquireNextImageKHR(context.device, context.swapchain,
+                                       std::numeric_limits<uint64_t>::max(), acquireSemaphore,
+                                       VK_NULL_HANDLE, image);
+    }
 
     if (result != VK_SUCCESS) {
         context.recycledSemaphores.emplace_back(acquireSemaphore);
@@ -998,6 +983,7 @@ VkResult TriangleApp::acquireNextImage(uint32_t *image) {
     // Normally, this doesn't really block at all,
     // since we're waiting for old frames to have been completed, but just in case.
     if (context.perFrame[*image].queueSubmitFence != VK_NULL_HANDLE) {
+        PROFILE_SCOPE("vkWaitForFences");
         vkWaitForFences(context.device, 1, &context.perFrame[*image].queueSubmitFence, true,
                         std::numeric_limits<uint64_t>::max());
         vkResetFences(context.device, 1, &context.perFrame[*image].queueSubmitFence);
@@ -1022,6 +1008,7 @@ VkResult TriangleApp::acquireNextImage(uint32_t *image) {
  * @brief Presents an image to the swapchain
  */
 VkResult TriangleApp::presentImage(uint32_t index) {
+    PROFILE_FUNCTION();
     VkPresentInfoKHR presentInfo{
             .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
             .pNext = nullptr,
@@ -1035,115 +1022,73 @@ VkResult TriangleApp::presentImage(uint32_t index) {
     return vkQueuePresentKHR(context.queue, &presentInfo);
 }
 
-void TriangleApp::updateVertexBuffer(const VkCommandBuffer &commandBuffer) const {
-//    Vertex vertexData[] = {
-//            {.position {-0.5f, 0.5f}, .color {1.0f, 1.0f, 0.0f, 1.0f}},
-//            {.position {-0.5f, -0.5f}, .color {1.0f, 0.0f, 1.0f, 1.0f}},
-//            {.position {0.5f, -0.5f}, .color {0.0f, 1.0f, 1.0f, 1.0f}},
-//            {.position {0.5f, 0.5f}, .color {1.0f, 1.0f, 1.0f, 1.0f}},
-//    };
-//
-//    vkCmdUpdateBuffer(commandBuffer, context.vertexBuffer, 0, sizeof(vertexData), vertexData);
-}
 
-void
-TriangleApp::updateUniformBuffer(const VkCommandBuffer &commandBuffer, const uint32_t index) const {
-    using namespace std::chrono;
-    const auto timestamp = static_cast<float>(duration_cast<milliseconds>(
-            system_clock::now() - startTimePoint).count()) / 1000.0f;
-
-    constexpr float pulseRate = 1.5f;
-    const float scaleFactor = 1.0f + 0.5f * std::cosf(pulseRate * timestamp);
-    const glm::vec2 scale{scaleFactor, scaleFactor};
-    const glm::mat4x4 scaleMatrix = math_utils::scale2D(scale);
-
-    constexpr float rotationRate = 2.5f;
-    const float rotationAngle = rotationRate * static_cast<float>(timestamp);
-    const glm::mat4x4 rotationMatrix = math_utils::rotateZ(rotationAngle);
-
-    constexpr float orbitalRadius = 200.0f;
-    const glm::vec2 translation =
-            orbitalRadius * glm::vec2{std::cos(timestamp), std::sin(timestamp)};
-    const glm::mat4x4 translationMatrix = math_utils::translate2D(translation);
-
-    const glm::mat4x4 modelMatrix = translationMatrix * rotationMatrix * scaleMatrix;
-
-    const float aspectRatio =
-            static_cast<float>(context.swapchainDimensions.extent.width) /
-            static_cast<float>(context.swapchainDimensions.extent.height);
-    constexpr float canvasWidth = 800.0f;
-    const float canvasHeight = canvasWidth / aspectRatio;
-    const glm::mat4x4 projectionMatrix = math_utils::orthographicProjection(-canvasWidth / 2,
-                                                                            canvasHeight / 2,
-                                                                            canvasWidth / 2,
-                                                                            -canvasHeight / 2, 0.0,
-                                                                            1.0);
-
-    const UniformBufferObject ubo{
-            .modelMatrix = modelMatrix,
-            .projectionMatrix = projectionMatrix
-    };
+bool TriangleApp::isDynamicRenderingSupported(VkPhysicalDevice gpu,
+                                              const std::vector<VkExtensionProperties> &availableExtensions) {
+    if (!validateExtensions({VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+                             VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+                             VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+                             VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME}, availableExtensions)) {
+        return false;
+    }
 
-    vkCmdUpdateBuffer(commandBuffer, context.uniformBuffers.at(index), 0, sizeof(ubo), &ubo);
+    if (!VK_IS_AVAILABLE(vkGetPhysicalDeviceFeatures2)) {
+        return false;
+    }
 
-    VkDescriptorBufferInfo descriptorBufferInfo{
-            .buffer = context.uniformBuffers.at(index),
-            .offset = 0,
-            .range = sizeof(ubo)
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
+            .pNext = nullptr
     };
 
-    VkWriteDescriptorSet descriptorWrite{
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .pNext = nullptr,
-            .dstSet = context.descriptorSets.at(index),
-            .dstBinding = 0,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .pImageInfo = nullptr,
-            .pBufferInfo = &descriptorBufferInfo,
-            .pTexelBufferView = nullptr,
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+            .pNext = &synchronization2Features
     };
 
-    vkUpdateDescriptorSets(context.device, 1, &descriptorWrite, 0, nullptr);
-}
-
-void TriangleApp::createBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsageFlags,
-                               VkSharingMode sharingMode, VkFlags requirementsMask,
-                               VkBuffer &rBuffer, VkDeviceMemory &rDeviceMemory) {
-    VkBufferCreateInfo bufferCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .size = bufferSize,
-            .usage = bufferUsageFlags,
-            .sharingMode = sharingMode,
-            .queueFamilyIndexCount = 1,
-            .pQueueFamilyIndices = &context.graphicsQueueIndex.value()
+    VkPhysicalDeviceFeatures2 features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &dynamicRenderingFeatures
     };
+    vkGetPhysicalDeviceFeatures2(gpu, &features);
 
-    CALL_VK(vkCreateBuffer(context.device, &bufferCreateInfo, nullptr, &rBuffer))
-
-    VkMemoryRequirements memoryRequirements;
-    vkGetBufferMemoryRequirements(context.device, rBuffer, &memoryRequirements);
+    return dynamicRenderingFeatures.dynamicRendering && synchronization2Features.synchronization2;
+}
 
-    uint32_t memoryTypeIndex;
-    vulkan_common::mapMemoryTypeToIndex(context.gpu, memoryRequirements.memoryTypeBits,
-                                        requirementsMask, &memoryTypeIndex);
+bool TriangleApp::isGraphicsPipelineLibrarySupported(VkPhysicalDevice gpu,
+                                                     const std::vector<VkExtensionProperties> &availableExtensions) {
+    if (!validateExtensions({VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+                             VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME},
+                            availableExtensions) ||
+        !VK_IS_AVAILABLE(vkGetPhysicalDeviceFeatures2)) {
+        return false;
+    }
 
-    VkMemoryAllocateInfo allocateInfo{
-            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-            .pNext = nullptr,
-            .allocationSize = memoryRequirements.size,
-            .memoryTypeIndex = memoryTypeIndex
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+            .pNext = nullptr
+    };
+    VkPhysicalDeviceFeatures2 features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &graphicsPipelineLibraryFeatures
     };
+    vkGetPhysicalDeviceFeatures2(gpu, &features);
 
-    CALL_VK(vkAllocateMemory(context.device, &allocateInfo, nullptr, &rDeviceMemory))
+    // Without fast linking, linking may cost as much as compiling and gains nothing
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphicsPipelineLibraryProperties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT,
+            .pNext = nullptr
+    };
+    VkPhysicalDeviceProperties2 properties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &graphicsPipelineLibraryProperties
+    };
+    vkGetPhysicalDeviceProperties2(gpu, &properties);
 
-    CALL_VK(vkBindBufferMemory(context.device, rBuffer, rDeviceMemory, 0))
+    return graphicsPipelineLibraryFeatures.graphicsPipelineLibrary &&
+           graphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking;
 }
 
-
 bool TriangleApp::validateExtensions(const std::vector<const char *> &requiredExtensions,
                                      const std::vector<VkExtensionProperties> &availableExtensions) {
     for (const char *required: requiredExtensions) {
@@ -6,10 +6,22 @@
 #define LEARNINGVULKAN_TRIANGLEAPP_HH
 
 #include <chrono>
+#include <functional>
 #include <game-activity/native_app_glue/android_native_app_glue.h>
-#include <glm/glm.hpp>
+#include <memory>
 #include <optional>
 #include <utility>
+#include "BindlessDescriptors.hh"
+#include "FileBackend.hh"
+#include "FrameRenderer.hh"
+#include "FrameStats.hh"
+#include "GpuProfiler.hh"
+#include "LayoutCache.hh"
+#include "Overlay.hh"
+#include "PipelineCache.hh"
+#include "PipelineManager.hh"
+#include "ResourceTracker.hh"
+#include "ShaderModuleCache.hh"
 #include "VulkanBaseApp.hh"
 #include "vulkan_wrapper.hh"
 
@@ -38,15 +50,11 @@ class TriangleApp final : public VulkanBaseApp {
         VkSemaphore swapchainReleaseSemaphore = VK_NULL_HANDLE;
     };
 
-    struct Vertex {
-        glm::vec2 position;
-        glm::vec4 color;
-    };
-
-    struct UniformBufferObject {
-        glm::mat4x4 modelMatrix;
+    /// Recorded by renderTriangle, the overlay shows the ones of the previous frame
+    struct FrameCounters {
+        uint32_t draws = 0;
 
-        glm::mat4x4 projectionMatrix;
+        uint32_t submits = 0;
     };
 
     struct Context {
@@ -66,27 +74,54 @@ class TriangleApp final : public VulkanBaseApp {
 
         std::optional<uint32_t> graphicsQueueIndex = std::nullopt;
 
+        std::vector<VkImage> swapchainImages{};
+
         std::vector<VkImageView> swapchainImageViews{};
 
         std::vector<VkFramebuffer> swapchainFramebuffers{};
 
         VkRenderPass renderPass = VK_NULL_HANDLE;
 
-        VkPipeline pipeline = VK_NULL_HANDLE;
+        /// Render straight into the swapchain image views with VK_KHR_dynamic_rendering,
+        /// no render pass and framebuffers are created in this case
+        bool dynamicRendering = false;
+
+        /// Shares set layouts, pipeline layouts and samplers between pipelines
+        LayoutCache layoutCache{};
+
+        /// Whether VK_EXT_graphics_pipeline_library is enabled, with fast linking
+        bool graphicsPipelineLibrary = false;
+
+        /// Whether VK_EXT_pipeline_creation_feedback is enabled
+        bool pipelineCreationFeedback = false;
+
+        /// Whether VK_EXT_calibrated_timestamps is enabled
+        bool calibratedTimestamps = false;
+
+        /// Whether VK_EXT_descriptor_indexing is enabled, with the BindlessDescriptors features
+        bool bindlessDescriptors = false;
 
-        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        /// Holds the overlay's atlas, initialized only with bindlessDescriptors
+        BindlessDescriptors bindless{};
 
-        VkBuffer vertexBuffer = VK_NULL_HANDLE;
+        /// GPU time of the frame's passes
+        GpuProfiler gpuProfiler{};
 
-        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        /// Frame statistics drawn on top of the frame
+        Overlay overlay{};
 
-        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+        PipelineCache pipelineCache{};
 
-        std::vector<VkBuffer> uniformBuffers{};
+        PipelineManager pipelineManager{};
 
-        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        /// Maps shaders and other assets without copying them
+        std::unique_ptr<FileBackend> fileBackend{};
 
-        std::vector<VkDescriptorSet> descriptorSets{};
+        /// Shader modules stay alive until teardown, so pipeline states can be keyed by handle
+        ShaderModuleCache shaderModules{};
+
+        /// Records the frames, the triangle and the overlay on top
+        FrameRenderer renderer{};
 
         /// A set of semaphores that can be reused
         std::vector<VkSemaphore> recycledSemaphores{};
@@ -103,6 +138,10 @@ public:
 
     void update(float deltaTime) override;
 
+    void updateOverlay(float deltaTime, const std::function<void()> &additionalUi) override;
+
+    void pause() override;
+
 private:
     Context context;
 
@@ -110,6 +149,28 @@ private:
 
     std::chrono::time_point<std::chrono::system_clock> startTimePoint{};
 
+    /// Start of the previous update, main does not pass frame times
+    std::chrono::steady_clock::time_point lastUpdateTimePoint{};
+
+    FrameStats frameStats{};
+
+    /// Sorting the history every frame is not worth it, these are refreshed a few times a second
+    FrameStats::Percentiles framePercentiles{};
+
+    float residentMegabytes = 0.0f;
+
+    uint32_t framesUntilStatsRefresh = 0;
+
+    FrameCounters frameCounters{};
+
+    /// CPU time spent on the overlay in the previous frame, building and recording it
+    float overlayCpuMilliseconds = 0.0f;
+
+#if RESOURCE_TRACKER_ENABLED
+    /// Live Vulkan objects once prepared, pause logs what was created or released since
+    resource_tracker::Snapshot preparedResources{};
+#endif
+
     void teardown();
 
     void initInstance(std::vector<const char *> &&requiredInstanceExtensions);
@@ -118,26 +179,16 @@ private:
 
     void initSwapchain();
 
-    void initRenderPass();
+    bool initPipelineCache();
 
-    void initDescriptorSetLayout();
+    void initRenderPass();
 
-    void initPipeline();
+    bool initRenderer();
 
     void initFramebuffers();
 
     void teardownFramebuffers();
 
-    void initVertexBuffers();
-
-    void initIndexBuffers();
-
-    void initUniformBuffers();
-
-    void initDescriptorPool();
-
-    void initDescriptorSets();
-
     void initPerFrame(PerFrameData &perFrame) const;
 
     void teardownPerFrame(PerFrameData &perFrame) const;
@@ -148,16 +199,13 @@ private:
 
     VkResult presentImage(uint32_t index);
 
-    void updateVertexBuffer(const VkCommandBuffer &commandBuffer) const;
-
-    void updateUniformBuffer(const VkCommandBuffer &commandBuffer, uint32_t index) const;
+private:
+    static bool isGraphicsPipelineLibrarySupported(VkPhysicalDevice gpu,
+                                                   const std::vector<VkExtensionProperties> &availableExtensions);
 
-    /* Util functions */
-    void createBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsageFlags,
-                      VkSharingMode sharingMode, VkFlags requirementsMask, VkBuffer &rBuffer,
-                      VkDeviceMemory &rDeviceMemory);
+    static bool isDynamicRenderingSupported(VkPhysicalDevice gpu,
+                                            const std::vector<VkExtensionProperties> &availableExtensions);
 
-private:
     static bool validateExtensions(const std::vector<const char *> &requiredExtensions,
                                    const std::vector<VkExtensionProperties> &availableExtensions);
 };
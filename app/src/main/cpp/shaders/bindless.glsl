@@ -0,0 +1,15 @@
+// Resource arrays of BindlessDescriptors. Include with GL_GOOGLE_include_directive after choosing
+// the set, e.g. #define BINDLESS_SET 1, and index them with the IDs the draw or instance carries:
+//   texture(sampler2D(bindlessImages[nonuniformEXT(id)], linearSampler), uv)
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+#ifndef BINDLESS_SET
+#define BINDLESS_SET 1
+#endif
+
+layout (set = BINDLESS_SET, binding = 0) uniform texture2D bindlessImages[];
+
+layout (set = BINDLESS_SET, binding = 1) readonly buffer BindlessBuffer {
+    uint words[];
+} bindlessBuffers[];
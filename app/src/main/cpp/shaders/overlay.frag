@@ -0,0 +1,16 @@
+#version 320 es
+
+precision mediump float;
+
+layout (location = 0) in vec2 in_uv;
+layout (location = 1) in vec4 in_color;
+
+layout (location = 0) out vec4 out_color;
+
+// Coverage of the glyphs, plus a solid cell for rectangles and graphs
+layout (set = 0, binding = 0) uniform sampler2D glyphAtlas;
+
+void main()
+{
+    out_color = vec4(in_color.rgb, in_color.a * texture(glyphAtlas, in_uv).r);
+}
@@ -0,0 +1,41 @@
+#version 320 es
+
+precision mediump float;
+
+// One instance per quad, see Overlay::Quad. Rectangles are in pixels from the top left corner.
+layout (location = 0) in vec4 in_rect;
+layout (location = 1) in vec4 in_uvRect;
+layout (location = 2) in uint in_color;
+
+layout (location = 0) out vec2 out_uv;
+layout (location = 1) out vec4 out_color;
+
+// Building with -DBINDLESS (overlay_bindless.vert.spv) adds the bindless image slot of each quad,
+// passed on to overlay_bindless.frag
+#ifdef BINDLESS
+layout (location = 3) in uint in_texture;
+
+layout (location = 2) flat out uint out_texture;
+#endif
+
+layout (push_constant) uniform OverlayConstants {
+    // 2 / framebuffer size
+    vec2 scale;
+} overlay;
+
+void main()
+{
+    // Two triangles, the corners come from the vertex index so no vertex buffer is needed
+    const vec2 corners[6] = vec2[6](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0),
+                                    vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+    vec2 corner = corners[gl_VertexIndex];
+
+    vec2 position = in_rect.xy + corner * in_rect.zw;
+    gl_Position = vec4(position * overlay.scale - 1.0, 0.0, 1.0);
+
+    out_uv = in_uvRect.xy + corner * in_uvRect.zw;
+    out_color = unpackUnorm4x8(in_color);
+#ifdef BINDLESS
+    out_texture = in_texture;
+#endif
+}
@@ -0,0 +1,22 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+// overlay.frag reading the glyph atlas from the arrays of BindlessDescriptors in set 1
+#include "bindless.glsl"
+
+layout (location = 0) in vec2 in_uv;
+layout (location = 1) in vec4 in_color;
+layout (location = 2) flat in uint in_texture;
+
+layout (location = 0) out vec4 out_color;
+
+layout (set = 0, binding = 0) uniform sampler glyphSampler;
+
+void main()
+{
+    // The slot comes with the instance, quads of one draw may sample different images
+    float coverage = texture(sampler2D(bindlessImages[nonuniformEXT(in_texture)], glyphSampler),
+                             in_uv).r;
+    out_color = vec4(in_color.rgb, in_color.a * coverage);
+}
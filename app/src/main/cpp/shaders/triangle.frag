@@ -22,7 +22,15 @@ layout(location = 0) in vec4 in_color;
 
 layout(location = 0) out vec4 out_color;
 
+// Variant switch, see ShaderVariants: 0 passes the vertex color through, 1 outputs its luminance
+layout(constant_id = 0) const uint COLOR_MODE = 0u;
+
 void main()
 {
-    out_color = in_color;
+    if (COLOR_MODE == 1u) {
+        float luminance = dot(in_color.rgb, vec3(0.2126, 0.7152, 0.0722));
+        out_color = vec4(vec3(luminance), in_color.a);
+    } else {
+        out_color = in_color;
+    }
 }
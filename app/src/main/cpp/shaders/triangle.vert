@@ -22,14 +22,21 @@ layout (location = 0) in vec2 in_position;
 layout (location = 1) in vec4 in_color;
 layout (location = 0) out vec4 out_color;
 
-layout (binding = 0) uniform UniformBufferObject {
+// Per-draw constants, see DrawConstants. The default build reads them from push constants,
+// building with -DDRAW_CONSTANTS_UBO produces the dynamic uniform buffer fallback
+// (triangle.ubo.vert.spv) used when they exceed maxPushConstantsSize.
+#ifdef DRAW_CONSTANTS_UBO
+layout (set = 0, binding = 0) uniform DrawConstants {
+#else
+layout (push_constant) uniform DrawConstants {
+#endif
     mat4 model;
     mat4 projection;
-} ubo;
+} draw;
 
 void main()
 {
-    gl_Position = ubo.projection * ubo.model * vec4(in_position, 0.0, 1.0);
+    gl_Position = draw.projection * draw.model * vec4(in_position, 0.0, 1.0);
 
     out_color = in_color;
 }
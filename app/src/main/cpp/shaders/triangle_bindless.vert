@@ -0,0 +1,42 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+// triangle.vert drawing every object of a frame as one instance. The model matrices are read from
+// a storage buffer of the bindless set, which is the only set of the pipeline layout.
+#define BINDLESS_SET 0
+#include "bindless.glsl"
+
+layout (location = 0) in vec2 in_position;
+layout (location = 1) in vec4 in_color;
+layout (location = 0) out vec4 out_color;
+
+layout (push_constant) uniform FrameConstants {
+    mat4 projection;
+    // Bindless slot of this frame's model matrices, one column-major mat4 per instance
+    uint transformBuffer;
+} frame;
+
+mat4 modelMatrix(uint instance)
+{
+    // Uniform for the draw, the qualifier only selects the indexing feature BindlessDescriptors
+    // enables rather than the core dynamic indexing one
+    uint first = instance * 16u;
+    mat4 model;
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            uint word = bindlessBuffers[nonuniformEXT(frame.transformBuffer)]
+                    .words[first + uint(column * 4 + row)];
+            model[column][row] = uintBitsToFloat(word);
+        }
+    }
+    return model;
+}
+
+void main()
+{
+    gl_Position = frame.projection * modelMatrix(uint(gl_InstanceIndex)) *
+                  vec4(in_position, 0.0, 1.0);
+
+    out_color = in_color;
+}
@@ -721,6 +721,88 @@ namespace glm
 	/// @see int packUint2x16(u32vec2 const& v)
 	GLM_FUNC_DECL u32vec2 unpackUint2x32(uint64 p);
 
+	/// Converts Count floats of Source to 16-bit floating-point numbers in Dest, several at a time with SSE2, F16C or AArch64 NEON.
+	/// Unlike packHalf1x16, halfway cases round to even and NaNs turn quiet, like the F16C and NEON conversions.
+	/// Every path returns the same bits.
+	///
+	/// @see gtc_packing
+	/// @see void unpackHalfN(uint16 const* Source, float* Dest, std::size_t Count)
+	/// @see uint16 packHalf1x16(float v)
+	GLM_FUNC_DECL void packHalfN(float const* Source, uint16* Dest, std::size_t Count);
+
+	/// Converts Count 16-bit floating-point numbers of Source to floats in Dest, several at a time with SSE2, F16C or AArch64 NEON.
+	/// Unlike unpackHalf1x16, signaling NaNs turn quiet, like the F16C and NEON conversions.
+	/// Every path returns the same bits.
+	///
+	/// @see gtc_packing
+	/// @see void packHalfN(float const* Source, uint16* Dest, std::size_t Count)
+	/// @see float unpackHalf1x16(uint16 v)
+	GLM_FUNC_DECL void unpackHalfN(uint16 const* Source, float* Dest, std::size_t Count);
+
+	/// Converts Count floats of Source to 8-bit unsigned normalized integers in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of packUnorm1x8, NaNs give 0.
+	///
+	/// @see gtc_packing
+	/// @see void unpackUnorm8N(uint8 const* Source, float* Dest, std::size_t Count)
+	/// @see uint8 packUnorm1x8(float v)
+	GLM_FUNC_DECL void packUnorm8N(float const* Source, uint8* Dest, std::size_t Count);
+
+	/// Converts Count 8-bit unsigned normalized integers of Source to floats in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of unpackUnorm1x8.
+	///
+	/// @see gtc_packing
+	/// @see void packUnorm8N(float const* Source, uint8* Dest, std::size_t Count)
+	/// @see float unpackUnorm1x8(uint8 p)
+	GLM_FUNC_DECL void unpackUnorm8N(uint8 const* Source, float* Dest, std::size_t Count);
+
+	/// Converts Count floats of Source to 8-bit signed normalized integers in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of packSnorm1x8, NaNs give 0.
+	///
+	/// @see gtc_packing
+	/// @see void unpackSnorm8N(uint8 const* Source, float* Dest, std::size_t Count)
+	/// @see uint8 packSnorm1x8(float v)
+	GLM_FUNC_DECL void packSnorm8N(float const* Source, uint8* Dest, std::size_t Count);
+
+	/// Converts Count 8-bit signed normalized integers of Source to floats in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of unpackSnorm1x8.
+	///
+	/// @see gtc_packing
+	/// @see void packSnorm8N(float const* Source, uint8* Dest, std::size_t Count)
+	/// @see float unpackSnorm1x8(uint8 p)
+	GLM_FUNC_DECL void unpackSnorm8N(uint8 const* Source, float* Dest, std::size_t Count);
+
+	/// Converts Count floats of Source to 16-bit unsigned normalized integers in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of packUnorm1x16, NaNs give 0.
+	///
+	/// @see gtc_packing
+	/// @see void unpackUnorm16N(uint16 const* Source, float* Dest, std::size_t Count)
+	/// @see uint16 packUnorm1x16(float v)
+	GLM_FUNC_DECL void packUnorm16N(float const* Source, uint16* Dest, std::size_t Count);
+
+	/// Converts Count 16-bit unsigned normalized integers of Source to floats in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of unpackUnorm1x16.
+	///
+	/// @see gtc_packing
+	/// @see void packUnorm16N(float const* Source, uint16* Dest, std::size_t Count)
+	/// @see float unpackUnorm1x16(uint16 p)
+	GLM_FUNC_DECL void unpackUnorm16N(uint16 const* Source, float* Dest, std::size_t Count);
+
+	/// Converts Count floats of Source to 16-bit signed normalized integers in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of packSnorm1x16, NaNs give 0.
+	///
+	/// @see gtc_packing
+	/// @see void unpackSnorm16N(uint16 const* Source, float* Dest, std::size_t Count)
+	/// @see uint16 packSnorm1x16(float v)
+	GLM_FUNC_DECL void packSnorm16N(float const* Source, uint16* Dest, std::size_t Count);
+
+	/// Converts Count 16-bit signed normalized integers of Source to floats in Dest, several at a time with SSE2 or NEON.
+	/// Each value is the one of unpackSnorm1x16.
+	///
+	/// @see gtc_packing
+	/// @see void packSnorm16N(float const* Source, uint16* Dest, std::size_t Count)
+	/// @see float unpackSnorm1x16(uint16 p)
+	GLM_FUNC_DECL void unpackSnorm16N(uint16 const* Source, float* Dest, std::size_t Count);
+
 
 	/// @}
 }// namespace glm
@@ -7,6 +7,7 @@
 #include "../vec3.hpp"
 #include "../vec4.hpp"
 #include "../detail/type_half.hpp"
+#include "../simd/packing.h"
 #include <cstring>
 #include <limits>
 
@@ -350,6 +351,54 @@ namespace detail
 			return vec<4, float, Q>(detail::toFloat32(v.x), detail::toFloat32(v.y), detail::toFloat32(v.z), detail::toFloat32(v.w));
 		}
 	};
+
+	// IEEE 754 conversions, halfway cases round to even and NaNs turn quiet like with F16C and NEON.
+	// The SIMD paths of packHalfN and unpackHalfN return the same bits.
+	GLM_FUNC_QUALIFIER glm::uint16 float2halfNearestEven(float v)
+	{
+		glm::uint32 Bits = 0;
+		memcpy(&Bits, &v, sizeof(Bits));
+		glm::uint32 const Sign = (Bits >> 16) & 0x8000;
+		glm::uint32 const Abs = Bits & 0x7fffffff;
+
+		if(Abs > 0x7f800000) // NaN, the payload keeps its upper bits
+			return static_cast<glm::uint16>(Sign | 0x7e00 | ((Abs >> 13) & 0x03ff));
+		if(Abs >= 0x477ff000) // Rounds above 65504
+			return static_cast<glm::uint16>(Sign | 0x7c00);
+		if(Abs < 0x38800000) // Subnormal, adding 0.5 lets the float addition round at the half subnormal ULP
+		{
+			float Magic = 0.0f;
+			memcpy(&Magic, &Abs, sizeof(Magic));
+			Magic += 0.5f;
+			glm::uint32 Rounded = 0;
+			memcpy(&Rounded, &Magic, sizeof(Rounded));
+			return static_cast<glm::uint16>(Sign | (Rounded - 0x3f000000));
+		}
+
+		// Rebias the exponent and round on bit 13, a carry moves into the exponent
+		glm::uint32 const Odd = (Abs >> 13) & 1;
+		return static_cast<glm::uint16>(Sign | ((Abs - 0x37fff001 + Odd) >> 13));
+	}
+
+	GLM_FUNC_QUALIFIER float half2floatQuiet(glm::uint16 h)
+	{
+		glm::uint32 const Abs = h & 0x7fffu;
+		glm::uint32 Bits = 0;
+		if(Abs < 0x0400) // Zero or subnormal, exact as a float
+		{
+			float const Value = static_cast<float>(Abs) * 5.9604644775390625e-8f; // 2^-24
+			memcpy(&Bits, &Value, sizeof(Bits));
+		}
+		else if(Abs < 0x7c00)
+			Bits = (Abs << 13) + 0x38000000;
+		else
+			Bits = 0x7f800000 | (Abs << 13) | (Abs > 0x7c00 ? 0x00400000u : 0u);
+		Bits |= (h & 0x8000u) << 16;
+
+		float Result = 0.0f;
+		memcpy(&Result, &Bits, sizeof(Result));
+		return Result;
+	}
 }//namespace detail
 
 	GLM_FUNC_QUALIFIER uint8 packUnorm1x8(float v)
@@ -934,5 +983,237 @@ namespace detail
 		memcpy(&Unpack, &p, sizeof(Unpack));
 		return Unpack;
 	}
+	GLM_FUNC_QUALIFIER void packHalfN(float const* Source, uint16* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			for(; i + 4 <= Count; i += 4)
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(Dest + i), glm_vec4_pack_half(_mm_loadu_ps(Source + i)));
+#		elif (GLM_ARCH & GLM_ARCH_ARMV8_BIT) && defined(__aarch64__)
+			for(; i + 4 <= Count; i += 4)
+				vst1_u16(Dest + i, neon::pack_half(vld1q_f32(Source + i)));
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = detail::float2halfNearestEven(Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackHalfN(uint16 const* Source, float* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			for(; i + 4 <= Count; i += 4)
+				_mm_storeu_ps(Dest + i, glm_vec4_unpack_half(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(Source + i))));
+#		elif (GLM_ARCH & GLM_ARCH_ARMV8_BIT) && defined(__aarch64__)
+			for(; i + 4 <= Count; i += 4)
+				vst1q_f32(Dest + i, neon::unpack_half(vld1_u16(Source + i)));
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = detail::half2floatQuiet(Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packUnorm8N(float const* Source, uint8* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_f32vec4 const Scale = _mm_set1_ps(255.0f);
+			for(; i + 16 <= Count; i += 16)
+			{
+				glm_i32vec4 const A = glm_vec4_pack_unorm(_mm_loadu_ps(Source + i), Scale);
+				glm_i32vec4 const B = glm_vec4_pack_unorm(_mm_loadu_ps(Source + i + 4), Scale);
+				glm_i32vec4 const C = glm_vec4_pack_unorm(_mm_loadu_ps(Source + i + 8), Scale);
+				glm_i32vec4 const D = glm_vec4_pack_unorm(_mm_loadu_ps(Source + i + 12), Scale);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Dest + i), _mm_packus_epi16(_mm_packs_epi32(A, B), _mm_packs_epi32(C, D)));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			for(; i + 8 <= Count; i += 8)
+			{
+				uint16x4_t const Low = vmovn_u32(vreinterpretq_u32_s32(neon::pack_unorm(vld1q_f32(Source + i), 255.0f)));
+				uint16x4_t const High = vmovn_u32(vreinterpretq_u32_s32(neon::pack_unorm(vld1q_f32(Source + i + 4), 255.0f)));
+				vst1_u8(Dest + i, vmovn_u16(vcombine_u16(Low, High)));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = packUnorm1x8(isnan(Source[i]) ? 0.0f : Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackUnorm8N(uint8 const* Source, float* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_f32vec4 const Scale = _mm_set1_ps(static_cast<float>(0.0039215686274509803921568627451)); // 1 / 255
+			glm_i32vec4 const Zero = _mm_setzero_si128();
+			for(; i + 16 <= Count; i += 16)
+			{
+				glm_i32vec4 const Bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(Source + i));
+				glm_i32vec4 const Low = _mm_unpacklo_epi8(Bytes, Zero);
+				glm_i32vec4 const High = _mm_unpackhi_epi8(Bytes, Zero);
+				_mm_storeu_ps(Dest + i, glm_vec4_unpack_unorm(_mm_unpacklo_epi16(Low, Zero), Scale));
+				_mm_storeu_ps(Dest + i + 4, glm_vec4_unpack_unorm(_mm_unpackhi_epi16(Low, Zero), Scale));
+				_mm_storeu_ps(Dest + i + 8, glm_vec4_unpack_unorm(_mm_unpacklo_epi16(High, Zero), Scale));
+				_mm_storeu_ps(Dest + i + 12, glm_vec4_unpack_unorm(_mm_unpackhi_epi16(High, Zero), Scale));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			float const Scale = static_cast<float>(0.0039215686274509803921568627451); // 1 / 255
+			for(; i + 8 <= Count; i += 8)
+			{
+				uint16x8_t const Wide = vmovl_u8(vld1_u8(Source + i));
+				vst1q_f32(Dest + i, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(Wide))), Scale));
+				vst1q_f32(Dest + i + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(Wide))), Scale));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = unpackUnorm1x8(Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packSnorm8N(float const* Source, uint8* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_f32vec4 const Scale = _mm_set1_ps(127.0f);
+			for(; i + 16 <= Count; i += 16)
+			{
+				glm_i32vec4 const A = glm_vec4_pack_snorm(_mm_loadu_ps(Source + i), Scale);
+				glm_i32vec4 const B = glm_vec4_pack_snorm(_mm_loadu_ps(Source + i + 4), Scale);
+				glm_i32vec4 const C = glm_vec4_pack_snorm(_mm_loadu_ps(Source + i + 8), Scale);
+				glm_i32vec4 const D = glm_vec4_pack_snorm(_mm_loadu_ps(Source + i + 12), Scale);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Dest + i), _mm_packs_epi16(_mm_packs_epi32(A, B), _mm_packs_epi32(C, D)));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			for(; i + 8 <= Count; i += 8)
+			{
+				int16x4_t const Low = vmovn_s32(neon::pack_snorm(vld1q_f32(Source + i), 127.0f));
+				int16x4_t const High = vmovn_s32(neon::pack_snorm(vld1q_f32(Source + i + 4), 127.0f));
+				vst1_u8(Dest + i, vreinterpret_u8_s8(vmovn_s16(vcombine_s16(Low, High))));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = packSnorm1x8(isnan(Source[i]) ? 0.0f : Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackSnorm8N(uint8 const* Source, float* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_f32vec4 const Scale = _mm_set1_ps(0.00787401574803149606299212598425f); // 1.0f / 127.0f
+			for(; i + 16 <= Count; i += 16)
+			{
+				// Unpacking with itself and shifting right sign extends
+				glm_i32vec4 const Bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(Source + i));
+				glm_i32vec4 const Low = _mm_srai_epi16(_mm_unpacklo_epi8(Bytes, Bytes), 8);
+				glm_i32vec4 const High = _mm_srai_epi16(_mm_unpackhi_epi8(Bytes, Bytes), 8);
+				_mm_storeu_ps(Dest + i, glm_vec4_unpack_snorm(_mm_srai_epi32(_mm_unpacklo_epi16(Low, Low), 16), Scale));
+				_mm_storeu_ps(Dest + i + 4, glm_vec4_unpack_snorm(_mm_srai_epi32(_mm_unpackhi_epi16(Low, Low), 16), Scale));
+				_mm_storeu_ps(Dest + i + 8, glm_vec4_unpack_snorm(_mm_srai_epi32(_mm_unpacklo_epi16(High, High), 16), Scale));
+				_mm_storeu_ps(Dest + i + 12, glm_vec4_unpack_snorm(_mm_srai_epi32(_mm_unpackhi_epi16(High, High), 16), Scale));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			float const Scale = 0.00787401574803149606299212598425f; // 1.0f / 127.0f
+			for(; i + 8 <= Count; i += 8)
+			{
+				int16x8_t const Wide = vmovl_s8(vreinterpret_s8_u8(vld1_u8(Source + i)));
+				vst1q_f32(Dest + i, neon::unpack_snorm(vmovl_s16(vget_low_s16(Wide)), Scale));
+				vst1q_f32(Dest + i + 4, neon::unpack_snorm(vmovl_s16(vget_high_s16(Wide)), Scale));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = unpackSnorm1x8(Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packUnorm16N(float const* Source, uint16* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			// SSE2 only packs with signed saturation, the values move to [-32768, 32767] and back
+			glm_f32vec4 const Scale = _mm_set1_ps(65535.0f);
+			glm_i32vec4 const Bias = _mm_set1_epi32(32768);
+			for(; i + 8 <= Count; i += 8)
+			{
+				glm_i32vec4 const A = _mm_sub_epi32(glm_vec4_pack_unorm(_mm_loadu_ps(Source + i), Scale), Bias);
+				glm_i32vec4 const B = _mm_sub_epi32(glm_vec4_pack_unorm(_mm_loadu_ps(Source + i + 4), Scale), Bias);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Dest + i), _mm_xor_si128(_mm_packs_epi32(A, B), _mm_set1_epi16(-32768)));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			for(; i + 8 <= Count; i += 8)
+			{
+				uint16x4_t const Low = vmovn_u32(vreinterpretq_u32_s32(neon::pack_unorm(vld1q_f32(Source + i), 65535.0f)));
+				uint16x4_t const High = vmovn_u32(vreinterpretq_u32_s32(neon::pack_unorm(vld1q_f32(Source + i + 4), 65535.0f)));
+				vst1q_u16(Dest + i, vcombine_u16(Low, High));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = packUnorm1x16(isnan(Source[i]) ? 0.0f : Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackUnorm16N(uint16 const* Source, float* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_f32vec4 const Scale = _mm_set1_ps(1.5259021896696421759365224689097e-5f); // 1.0 / 65535.0
+			glm_i32vec4 const Zero = _mm_setzero_si128();
+			for(; i + 8 <= Count; i += 8)
+			{
+				glm_i32vec4 const Words = _mm_loadu_si128(reinterpret_cast<__m128i const*>(Source + i));
+				_mm_storeu_ps(Dest + i, glm_vec4_unpack_unorm(_mm_unpacklo_epi16(Words, Zero), Scale));
+				_mm_storeu_ps(Dest + i + 4, glm_vec4_unpack_unorm(_mm_unpackhi_epi16(Words, Zero), Scale));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			float const Scale = 1.5259021896696421759365224689097e-5f; // 1.0 / 65535.0
+			for(; i + 8 <= Count; i += 8)
+			{
+				uint16x8_t const Words = vld1q_u16(Source + i);
+				vst1q_f32(Dest + i, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(Words))), Scale));
+				vst1q_f32(Dest + i + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(Words))), Scale));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = unpackUnorm1x16(Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packSnorm16N(float const* Source, uint16* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_f32vec4 const Scale = _mm_set1_ps(32767.0f);
+			for(; i + 8 <= Count; i += 8)
+			{
+				glm_i32vec4 const A = glm_vec4_pack_snorm(_mm_loadu_ps(Source + i), Scale);
+				glm_i32vec4 const B = glm_vec4_pack_snorm(_mm_loadu_ps(Source + i + 4), Scale);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Dest + i), _mm_packs_epi32(A, B));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			for(; i + 8 <= Count; i += 8)
+			{
+				int16x4_t const Low = vmovn_s32(neon::pack_snorm(vld1q_f32(Source + i), 32767.0f));
+				int16x4_t const High = vmovn_s32(neon::pack_snorm(vld1q_f32(Source + i + 4), 32767.0f));
+				vst1q_u16(Dest + i, vreinterpretq_u16_s16(vcombine_s16(Low, High)));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = packSnorm1x16(isnan(Source[i]) ? 0.0f : Source[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackSnorm16N(uint16 const* Source, float* Dest, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_f32vec4 const Scale = _mm_set1_ps(3.0518509475997192297128208258309e-5f); // 1.0f / 32767.0f
+			for(; i + 8 <= Count; i += 8)
+			{
+				glm_i32vec4 const Words = _mm_loadu_si128(reinterpret_cast<__m128i const*>(Source + i));
+				_mm_storeu_ps(Dest + i, glm_vec4_unpack_snorm(_mm_srai_epi32(_mm_unpacklo_epi16(Words, Words), 16), Scale));
+				_mm_storeu_ps(Dest + i + 4, glm_vec4_unpack_snorm(_mm_srai_epi32(_mm_unpackhi_epi16(Words, Words), 16), Scale));
+			}
+#		elif GLM_ARCH & GLM_ARCH_NEON_BIT
+			float const Scale = 3.0518509475997192297128208258309e-5f; // 1.0f / 32767.0f
+			for(; i + 8 <= Count; i += 8)
+			{
+				int16x8_t const Words = vreinterpretq_s16_u16(vld1q_u16(Source + i));
+				vst1q_f32(Dest + i, neon::unpack_snorm(vmovl_s16(vget_low_s16(Words)), Scale));
+				vst1q_f32(Dest + i + 4, neon::unpack_snorm(vmovl_s16(vget_high_s16(Words)), Scale));
+			}
+#		endif
+		for(; i < Count; ++i)
+			Dest[i] = unpackSnorm1x16(Source[i]);
+	}
 }//namespace glm
 
@@ -150,6 +150,127 @@ namespace glm {
 			return vaddq_f32(acc, vmulq_f32(v, dupq_lane(vlane, lane)));
 #endif
 		}
+
+		// Round to nearest, ARMv7 only converts towards zero and rounds ties away from zero instead
+		static int32x4_t cvtn(float32x4_t v) {
+#if GLM_ARCH & GLM_ARCH_ARMV8_BIT
+			return vcvtnq_s32_f32(v);
+#else
+			uint32x4_t const Negative = vcltq_f32(v, vdupq_n_f32(0.0f));
+			return vcvtq_s32_f32(vaddq_f32(v, vbslq_f32(Negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f))));
+#endif
+		}
+
+		// Same reduction and polynomials as glm_vec4_sincos of simd/trigonometric.h
+		static void sincos(float32x4_t x, float32x4_t& s, float32x4_t& c) {
+			int32x4_t const Quadrant = cvtn(vmulq_f32(x, vdupq_n_f32(0.636619772367581343f)));
+			float32x4_t const q = vcvtq_f32_s32(Quadrant);
+			float32x4_t r = vsubq_f32(x, vmulq_f32(q, vdupq_n_f32(1.5703125f)));
+			r = vsubq_f32(r, vmulq_f32(q, vdupq_n_f32(4.837512969970703125e-4f)));
+			r = vsubq_f32(r, vmulq_f32(q, vdupq_n_f32(7.54953362047672271728515625e-8f)));
+			r = vsubq_f32(r, vmulq_f32(q, vdupq_n_f32(2.563344151594518881e-12f)));
+			float32x4_t const r2 = vmulq_f32(r, r);
+
+			float32x4_t SinR = vaddq_f32(vdupq_n_f32(8.3321608736e-3f), vmulq_f32(r2, vdupq_n_f32(-1.9515295891e-4f)));
+			SinR = vaddq_f32(vdupq_n_f32(-1.6666654611e-1f), vmulq_f32(r2, SinR));
+			SinR = vaddq_f32(r, vmulq_f32(vmulq_f32(r, r2), SinR));
+
+			float32x4_t CosR = vaddq_f32(vdupq_n_f32(-1.388731625493765e-3f), vmulq_f32(r2, vdupq_n_f32(2.443315711809948e-5f)));
+			CosR = vaddq_f32(vdupq_n_f32(4.166664568298827e-2f), vmulq_f32(r2, CosR));
+			CosR = vaddq_f32(vsubq_f32(vdupq_n_f32(1.0f), vmulq_f32(vdupq_n_f32(0.5f), r2)), vmulq_f32(vmulq_f32(r2, r2), CosR));
+
+			uint32x4_t const Bits = vreinterpretq_u32_s32(Quadrant);
+			uint32x4_t const One = vdupq_n_u32(1);
+			uint32x4_t const Two = vdupq_n_u32(2);
+			uint32x4_t const Swap = vceqq_u32(vandq_u32(Bits, One), One);
+			uint32x4_t const SinSign = vshlq_n_u32(vandq_u32(Bits, Two), 30);
+			uint32x4_t const CosSign = vshlq_n_u32(vandq_u32(vaddq_u32(Bits, One), Two), 30);
+			float32x4_t const Sin = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(Swap, CosR, SinR)), SinSign));
+			s = vbslq_f32(vceqq_f32(x, vdupq_n_f32(0.0f)), x, Sin);
+			c = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(Swap, SinR, CosR)), CosSign));
+		}
+
+		static float32x4_t sin(float32x4_t x) {
+			float32x4_t s, c;
+			sincos(x, s, c);
+			return s;
+		}
+
+		static float32x4_t cos(float32x4_t x) {
+			float32x4_t s, c;
+			sincos(x, s, c);
+			return c;
+		}
+
+		// Whether no component is larger in magnitude than Max, a NaN never is
+		static bool all_within(float32x4_t x, float Max) {
+			uint32x4_t const Outside = vcagtq_f32(x, vdupq_n_f32(Max));
+			uint32x2_t Any = vorr_u32(vget_low_u32(Outside), vget_high_u32(Outside));
+			Any = vpmax_u32(Any, Any);
+			return vget_lane_u32(Any, 0) == 0;
+		}
+
+		// Same reduction and polynomial as glm_vec4_exp of simd/exponential.h, vminq_f32 and
+		// vmaxq_f32 return NaN if either operand is NaN
+		static float32x4_t exp(float32x4_t x) {
+			float32x4_t const Clamped = vmaxq_f32(vdupq_n_f32(-104.0f), vminq_f32(vdupq_n_f32(89.0f), x));
+			int32x4_t const Exponent = cvtn(vmulq_f32(Clamped, vdupq_n_f32(1.44269504088896341f)));
+			float32x4_t const n = vcvtq_f32_s32(Exponent);
+			float32x4_t r = vsubq_f32(Clamped, vmulq_f32(n, vdupq_n_f32(0.693359375f)));
+			r = vsubq_f32(r, vmulq_f32(n, vdupq_n_f32(-2.12194440e-4f)));
+
+			float32x4_t p = vaddq_f32(vmulq_f32(vdupq_n_f32(1.9875691500e-4f), r), vdupq_n_f32(1.3981999507e-3f));
+			p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(8.3334519073e-3f));
+			p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(4.1665795894e-2f));
+			p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(1.6666665459e-1f));
+			p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(5.0000001201e-1f));
+			p = vaddq_f32(vaddq_f32(vmulq_f32(p, vmulq_f32(r, r)), r), vdupq_n_f32(1.0f));
+
+			int32x4_t const Half = vshrq_n_s32(Exponent, 1);
+			int32x4_t const Bias = vdupq_n_s32(127);
+			float32x4_t const Scale0 = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(Half, Bias), 23));
+			float32x4_t const Scale1 = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vsubq_s32(Exponent, Half), Bias), 23));
+			return vmulq_f32(vmulq_f32(p, Scale0), Scale1);
+		}
+
+		// round(clamp(v, 0, 1) * Scale) with halfway cases away from zero like std::round, NaNs give 0
+		static int32x4_t pack_unorm(float32x4_t v, float Scale) {
+			float32x4_t const Number = vbslq_f32(vceqq_f32(v, v), v, vdupq_n_f32(0.0f));
+			float32x4_t const Clamped = vminq_f32(vmaxq_f32(Number, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+			float32x4_t const Scaled = vmulq_f32(Clamped, vdupq_n_f32(Scale));
+			int32x4_t const Truncated = vcvtq_s32_f32(Scaled);
+			float32x4_t const Fraction = vsubq_f32(Scaled, vcvtq_f32_s32(Truncated));
+			return vsubq_s32(Truncated, vreinterpretq_s32_u32(vcgeq_f32(Fraction, vdupq_n_f32(0.5f))));
+		}
+
+		// round(clamp(v, -1, 1) * Scale) with halfway cases away from zero like std::round, NaNs give 0
+		static int32x4_t pack_snorm(float32x4_t v, float Scale) {
+			float32x4_t const Number = vbslq_f32(vceqq_f32(v, v), v, vdupq_n_f32(0.0f));
+			float32x4_t const Clamped = vminq_f32(vmaxq_f32(Number, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+			float32x4_t const Scaled = vmulq_f32(Clamped, vdupq_n_f32(Scale));
+			float32x4_t const Abs = vabsq_f32(Scaled);
+			int32x4_t const Truncated = vcvtq_s32_f32(Abs);
+			float32x4_t const Fraction = vsubq_f32(Abs, vcvtq_f32_s32(Truncated));
+			int32x4_t const Rounded = vsubq_s32(Truncated, vreinterpretq_s32_u32(vcgeq_f32(Fraction, vdupq_n_f32(0.5f))));
+			return vbslq_s32(vcltq_f32(Scaled, vdupq_n_f32(0.0f)), vnegq_s32(Rounded), Rounded);
+		}
+
+		// Integers of pack_snorm back to floats, clamp(v * Scale, -1, 1)
+		static float32x4_t unpack_snorm(int32x4_t v, float Scale) {
+			float32x4_t const Scaled = vmulq_f32(vcvtq_f32_s32(v), vdupq_n_f32(Scale));
+			return vminq_f32(vmaxq_f32(Scaled, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+		}
+
+#if (GLM_ARCH & GLM_ARCH_ARMV8_BIT) && defined(__aarch64__)
+		// AArch64 converts halves with IEEE rounding and denormals, AArch32 NEON flushes them to zero
+		static uint16x4_t pack_half(float32x4_t v) {
+			return vreinterpret_u16_f16(vcvt_f16_f32(v));
+		}
+
+		static float32x4_t unpack_half(uint16x4_t v) {
+			return vcvt_f32_f16(vreinterpret_f16_u16(v));
+		}
+#endif
 	} //namespace neon
 } // namespace glm
 #endif // GLM_ARCH & GLM_ARCH_NEON_BIT
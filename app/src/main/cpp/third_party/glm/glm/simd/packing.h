@@ -5,4 +5,106 @@
 
 #if GLM_ARCH & GLM_ARCH_SSE2_BIT
 
+#if defined(__F16C__)
+#	include <immintrin.h>
+#endif
+
+// Four floats to halves in the low 64 bits. Halfway cases round to even and NaNs turn quiet, like
+// F16C, whose instruction is used when the compiler targets it.
+GLM_FUNC_QUALIFIER glm_i32vec4 glm_vec4_pack_half(glm_f32vec4 v)
+{
+#	if defined(__F16C__)
+		return _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+#	else
+		glm_i32vec4 const Bits = _mm_castps_si128(v);
+		glm_i32vec4 const Abs = _mm_and_si128(Bits, _mm_set1_epi32(0x7FFFFFFF));
+		glm_i32vec4 const Sign = _mm_and_si128(_mm_srli_epi32(Bits, 16), _mm_set1_epi32(0x8000));
+
+		// Subnormal halves, adding 0.5 lets the float addition round at the half subnormal ULP
+		glm_i32vec4 const Subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(Abs), _mm_set1_ps(0.5f))), _mm_set1_epi32(0x3F000000));
+
+		// Normal halves, rebias the exponent and round to nearest even on bit 13
+		glm_i32vec4 const Odd = _mm_and_si128(_mm_srli_epi32(Abs, 13), _mm_set1_epi32(1));
+		glm_i32vec4 const Normal = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(Abs, _mm_set1_epi32(0x37FFF001)), Odd), 13);
+
+		glm_i32vec4 const NaN = _mm_or_si128(_mm_set1_epi32(0x7E00), _mm_and_si128(_mm_srli_epi32(Abs, 13), _mm_set1_epi32(0x3FF)));
+
+		glm_i32vec4 const IsSubnormal = _mm_cmplt_epi32(Abs, _mm_set1_epi32(0x38800000));
+		glm_i32vec4 const IsInfinite = _mm_cmpgt_epi32(Abs, _mm_set1_epi32(0x477FEFFF));
+		glm_i32vec4 const IsNaN = _mm_cmpgt_epi32(Abs, _mm_set1_epi32(0x7F800000));
+
+		glm_i32vec4 Half = _mm_or_si128(_mm_and_si128(IsSubnormal, Subnormal), _mm_andnot_si128(IsSubnormal, Normal));
+		Half = _mm_or_si128(_mm_and_si128(IsInfinite, _mm_set1_epi32(0x7C00)), _mm_andnot_si128(IsInfinite, Half));
+		Half = _mm_or_si128(_mm_and_si128(IsNaN, NaN), _mm_andnot_si128(IsNaN, Half));
+		Half = _mm_or_si128(Half, Sign);
+
+		// Sign extended so that the saturating pack keeps the bits
+		Half = _mm_srai_epi32(_mm_slli_epi32(Half, 16), 16);
+		return _mm_packs_epi32(Half, Half);
+#	endif
+}
+
+// Four halves in the low 64 bits to floats, exact, NaNs turn quiet like with F16C
+GLM_FUNC_QUALIFIER glm_f32vec4 glm_vec4_unpack_half(glm_i32vec4 v)
+{
+#	if defined(__F16C__)
+		return _mm_cvtph_ps(v);
+#	else
+		glm_i32vec4 const Halves = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+		glm_i32vec4 const Abs = _mm_and_si128(Halves, _mm_set1_epi32(0x7FFF));
+		glm_i32vec4 const Sign = _mm_slli_epi32(_mm_and_si128(Halves, _mm_set1_epi32(0x8000)), 16);
+
+		glm_i32vec4 const Subnormal = _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(Abs), _mm_set1_ps(5.9604644775390625e-8f))); // 2^-24
+		glm_i32vec4 const Normal = _mm_add_epi32(_mm_slli_epi32(Abs, 13), _mm_set1_epi32(0x38000000));
+		glm_i32vec4 const NotFinite = _mm_or_si128(_mm_slli_epi32(Abs, 13), _mm_set1_epi32(0x7F800000));
+		glm_i32vec4 const Quiet = _mm_and_si128(_mm_cmpgt_epi32(Abs, _mm_set1_epi32(0x7C00)), _mm_set1_epi32(0x00400000));
+
+		glm_i32vec4 const IsSubnormal = _mm_cmplt_epi32(Abs, _mm_set1_epi32(0x0400));
+		glm_i32vec4 const IsNotFinite = _mm_cmpgt_epi32(Abs, _mm_set1_epi32(0x7BFF));
+
+		glm_i32vec4 Float = _mm_or_si128(_mm_and_si128(IsSubnormal, Subnormal), _mm_andnot_si128(IsSubnormal, Normal));
+		Float = _mm_or_si128(_mm_and_si128(IsNotFinite, _mm_or_si128(NotFinite, Quiet)), _mm_andnot_si128(IsNotFinite, Float));
+		return _mm_castsi128_ps(_mm_or_si128(Float, Sign));
+#	endif
+}
+
+// round(clamp(v, 0, 1) * Scale) with halfway cases away from zero like std::round, NaNs give 0
+GLM_FUNC_QUALIFIER glm_i32vec4 glm_vec4_pack_unorm(glm_f32vec4 v, glm_f32vec4 Scale)
+{
+	glm_f32vec4 const Number = _mm_and_ps(v, _mm_cmpeq_ps(v, v));
+	glm_f32vec4 const Scaled = _mm_mul_ps(_mm_min_ps(_mm_max_ps(Number, _mm_setzero_ps()), _mm_set1_ps(1.0f)), Scale);
+	glm_i32vec4 const Truncated = _mm_cvttps_epi32(Scaled);
+	glm_f32vec4 const Fraction = _mm_sub_ps(Scaled, _mm_cvtepi32_ps(Truncated));
+
+	// The comparison gives -1 where the fraction rounds up
+	return _mm_sub_epi32(Truncated, _mm_castps_si128(_mm_cmpge_ps(Fraction, _mm_set1_ps(0.5f))));
+}
+
+// round(clamp(v, -1, 1) * Scale) with halfway cases away from zero like std::round, NaNs give 0
+GLM_FUNC_QUALIFIER glm_i32vec4 glm_vec4_pack_snorm(glm_f32vec4 v, glm_f32vec4 Scale)
+{
+	glm_f32vec4 const Number = _mm_and_ps(v, _mm_cmpeq_ps(v, v));
+	glm_f32vec4 const Scaled = _mm_mul_ps(_mm_min_ps(_mm_max_ps(Number, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f)), Scale);
+	glm_f32vec4 const Abs = _mm_and_ps(Scaled, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+	glm_i32vec4 const Truncated = _mm_cvttps_epi32(Abs);
+	glm_f32vec4 const Fraction = _mm_sub_ps(Abs, _mm_cvtepi32_ps(Truncated));
+	glm_i32vec4 const Rounded = _mm_sub_epi32(Truncated, _mm_castps_si128(_mm_cmpge_ps(Fraction, _mm_set1_ps(0.5f))));
+
+	// (x ^ -1) - -1 negates, (x ^ 0) - 0 does not
+	glm_i32vec4 const Negative = _mm_castps_si128(_mm_cmplt_ps(Scaled, _mm_setzero_ps()));
+	return _mm_sub_epi32(_mm_xor_si128(Rounded, Negative), Negative);
+}
+
+// Integers of packUnorm back to floats, v * Scale
+GLM_FUNC_QUALIFIER glm_f32vec4 glm_vec4_unpack_unorm(glm_i32vec4 v, glm_f32vec4 Scale)
+{
+	return _mm_mul_ps(_mm_cvtepi32_ps(v), Scale);
+}
+
+// Integers of packSnorm back to floats, clamp(v * Scale, -1, 1)
+GLM_FUNC_QUALIFIER glm_f32vec4 glm_vec4_unpack_snorm(glm_i32vec4 v, glm_f32vec4 Scale)
+{
+	return _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), Scale), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
 #endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
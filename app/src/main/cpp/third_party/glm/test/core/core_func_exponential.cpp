@@ -7,6 +7,13 @@
 #include <glm/ext/vector_float4.hpp>
 #include <glm/common.hpp>
 #include <glm/exponential.hpp>
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+#	include <glm/gtc/type_aligned.hpp>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 static int test_pow()
 {
@@ -74,6 +81,61 @@ static int test_exp()
 	return Error;
 }
 
+// Distance of a float result to the exact value, in ULP of the exact value
+static double ulp_error(float Result, double Exact)
+{
+	int Exponent = 0;
+	std::frexp(std::max(std::abs(Exact), static_cast<double>(std::numeric_limits<float>::min())), &Exponent);
+	return std::abs(static_cast<double>(Result) - Exact) / std::ldexp(1.0, Exponent - 24);
+}
+
+// Every 97th float of [0, 89] and its negation, down to the subnormal results, 4 at a time
+template<typename vecType>
+static int test_exp_accuracy()
+{
+	int Error = 0;
+
+	float const Max = 89.0f;
+	glm::uint Last;
+	std::memcpy(&Last, &Max, sizeof(Last));
+
+	double MaxError = 0.0;
+	for(glm::uint Bits = 0; Bits <= Last; Bits += 4 * 97)
+	{
+		float Values[4];
+		for(glm::uint i = 0; i < 4; ++i)
+		{
+			glm::uint const ValueBits = Bits + i * 97;
+			std::memcpy(&Values[i], &ValueBits, sizeof(float));
+			Values[i] = i % 2 ? -Values[i] : Values[i];
+		}
+
+		vecType const x(Values[0], Values[1], Values[2], Values[3]);
+		vecType const Result = glm::exp(x);
+		for(glm::length_t i = 0; i < 4; ++i)
+		{
+			double const Exact = std::exp(static_cast<double>(x[i]));
+			if(Exact > static_cast<double>(std::numeric_limits<float>::max()))
+				Error += Result[i] >= std::numeric_limits<float>::max() ? 0 : 1;
+			else
+				MaxError = std::max(MaxError, ulp_error(Result[i], Exact));
+		}
+	}
+
+	// Bound of simd/exponential.h
+	Error += MaxError <= 1.0 ? 0 : 1;
+
+	float const Infinity = std::numeric_limits<float>::infinity();
+	vecType const Limits = glm::exp(vecType(Infinity, -Infinity, 200.0f, -200.0f));
+	Error += std::isinf(Limits.x) && !(Limits.y > 0.0f) && !(Limits.y < 0.0f) ? 0 : 1;
+	Error += std::isinf(Limits.z) && !(Limits.w > 0.0f) && !(Limits.w < 0.0f) ? 0 : 1;
+
+	vecType const NaN = glm::exp(vecType(std::numeric_limits<float>::quiet_NaN()));
+	Error += std::isnan(NaN.x) && std::isnan(NaN.w) ? 0 : 1;
+
+	return Error;
+}
+
 static int test_log()
 {
 	int Error = 0;
@@ -175,6 +237,10 @@ int main()
 	Error += test_pow();
 	Error += test_sqrt();
 	Error += test_exp();
+	Error += test_exp_accuracy<glm::vec4>();
+#	if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+		Error += test_exp_accuracy<glm::aligned_vec4>();
+#	endif
 	Error += test_log();
 	Error += test_exp2();
 	Error += test_log2();
@@ -1,10 +1,140 @@
+#include <glm/gtc/constants.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <glm/trigonometric.hpp>
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+#	include <glm/gtc/type_aligned.hpp>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
-int main()
+// Distance of a float result to the exact value, in ULP of the exact value
+static double ulp_error(float Result, double Exact)
+{
+	int Exponent = 0;
+	std::frexp(std::max(std::abs(Exact), static_cast<double>(std::numeric_limits<float>::min())), &Exponent);
+	return std::abs(static_cast<double>(Result) - Exact) / std::ldexp(1.0, Exponent - 24);
+}
+
+static bool same_bits(float a, float b)
+{
+	return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static float from_bits(glm::uint Bits)
+{
+	float Value;
+	std::memcpy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+// Every 97th float of [0, Max] and its negation, 4 at a time
+template<typename vecType>
+static double max_ulp_error(float Max, vecType (*Function)(vecType const&), double (*Exact)(double))
+{
+	glm::uint Last;
+	std::memcpy(&Last, &Max, sizeof(Last));
+
+	double Error = 0.0;
+	for(glm::uint Bits = 0; Bits <= Last; Bits += 4 * 97)
+	{
+		vecType const x(from_bits(Bits), -from_bits(Bits + 97), from_bits(Bits + 2 * 97), -from_bits(Bits + 3 * 97));
+		vecType const Result = Function(x);
+		for(glm::length_t i = 0; i < 4; ++i)
+			Error = std::max(Error, ulp_error(Result[i], Exact(static_cast<double>(x[i]))));
+	}
+	return Error;
+}
+
+template<typename vecType>
+static vecType sin_of(vecType const& x)
+{
+	return glm::sin(x);
+}
+
+template<typename vecType>
+static vecType cos_of(vecType const& x)
+{
+	return glm::cos(x);
+}
+
+static double exact_sin(double x)
+{
+	return std::sin(x);
+}
+
+static double exact_cos(double x)
+{
+	return std::cos(x);
+}
+
+template<typename vecType>
+static int test_sin_cos_accuracy()
 {
 	int Error = 0;
 
+	// Bound of simd/trigonometric.h
+	Error += max_ulp_error<vecType>(8192.0f, sin_of<vecType>, exact_sin) <= 2.4 ? 0 : 1;
+	Error += max_ulp_error<vecType>(8192.0f, cos_of<vecType>, exact_cos) <= 2.4 ? 0 : 1;
+
+	// Close to multiples of pi / 2, where the reduction loses the most
+	vecType const Hard(4505.16895f, 2228.89746f, 505.796417f, -355.0f);
+	vecType const Sin = glm::sin(Hard);
+	vecType const Cos = glm::cos(Hard);
+	for(glm::length_t i = 0; i < 4; ++i)
+	{
+		Error += ulp_error(Sin[i], std::sin(static_cast<double>(Hard[i]))) <= 2.4 ? 0 : 1;
+		Error += ulp_error(Cos[i], std::cos(static_cast<double>(Hard[i]))) <= 2.4 ? 0 : 1;
+	}
 
 	return Error;
 }
 
+template<typename vecType>
+static int test_sin_cos_special()
+{
+	int Error = 0;
+
+	vecType const Zero = glm::sin(vecType(0.0f, -0.0f, 0.0f, -0.0f));
+	Error += same_bits(Zero.x, 0.0f) && same_bits(Zero.y, -0.0f) ? 0 : 1;
+
+	vecType const One = glm::cos(vecType(0.0f, -0.0f, 0.0f, -0.0f));
+	Error += same_bits(One.x, 1.0f) && same_bits(One.y, 1.0f) ? 0 : 1;
+
+	vecType const Quadrants = vecType(1.0f, 2.0f, -2.0f, -4.0f) * glm::half_pi<float>();
+	vecType const QuadrantsSin = glm::sin(Quadrants);
+	for(glm::length_t i = 0; i < 4; ++i)
+		Error += ulp_error(QuadrantsSin[i], std::sin(static_cast<double>(Quadrants[i]))) <= 2.4 ? 0 : 1;
+
+	// Beyond the SIMD range every component comes from the scalar functions
+	float const Large[] = {1.0e5f, -3.0e7f, 8193.0f, 1.0f};
+	vecType const LargeSin = glm::sin(vecType(Large[0], Large[1], Large[2], Large[3]));
+	vecType const LargeCos = glm::cos(vecType(Large[0], Large[1], Large[2], Large[3]));
+	for(glm::length_t i = 0; i < 4; ++i)
+	{
+		Error += same_bits(LargeSin[i], std::sin(Large[i])) ? 0 : 1;
+		Error += same_bits(LargeCos[i], std::cos(Large[i])) ? 0 : 1;
+	}
+
+	float const Infinity = std::numeric_limits<float>::infinity();
+	vecType const NotFinite = glm::sin(vecType(std::numeric_limits<float>::quiet_NaN(), Infinity, -Infinity, 0.0f));
+	Error += std::isnan(NotFinite.x) && std::isnan(NotFinite.y) && std::isnan(NotFinite.z) ? 0 : 1;
+
+	return Error;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_sin_cos_accuracy<glm::vec4>();
+	Error += test_sin_cos_special<glm::vec4>();
+
+#	if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+		Error += test_sin_cos_accuracy<glm::aligned_vec4>();
+		Error += test_sin_cos_special<glm::aligned_vec4>();
+#	endif
+
+	return Error;
+}
@@ -3,6 +3,8 @@
 #include <glm/gtc/epsilon.hpp>
 #include <glm/ext/vector_relational.hpp>
 #include <cstdio>
+#include <cstring>
+#include <limits>
 #include <vector>
 
 void print_bits(float const& s)
@@ -822,6 +824,189 @@ int test_packInt2x32()
 	return Error;
 }
 
+// The SIMD paths of the array functions convert all but the last few values, converting one value
+// at a time only runs the scalar path
+template<typename sourceType, typename destType>
+static bool sameAsScalar(void (*Convert)(sourceType const*, destType*, std::size_t), std::vector<sourceType> const& Source)
+{
+	std::vector<destType> Bulk(Source.size());
+	std::vector<destType> Scalar(Source.size());
+	Convert(&Source[0], &Bulk[0], Source.size());
+	for(std::size_t i = 0; i < Source.size(); ++i)
+		Convert(&Source[i], &Scalar[i], 1);
+	return std::memcmp(&Bulk[0], &Scalar[0], Bulk.size() * sizeof(destType)) == 0;
+}
+
+static float floatFromBits(glm::uint32 Bits)
+{
+	float Value = 0.0f;
+	std::memcpy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+static glm::uint32 bitsFromFloat(float Value)
+{
+	glm::uint32 Bits = 0;
+	std::memcpy(&Bits, &Value, sizeof(Bits));
+	return Bits;
+}
+
+// Every finite half but the largest, the midpoints between neighbours and the floats right next to the midpoints, then a
+// sample of all floats including infinities and NaNs
+static std::vector<float> halfTestValues()
+{
+	std::vector<float> Values;
+	for(glm::uint32 Half = 0; Half < 0x7bff; ++Half)
+	{
+		float const Value = glm::unpackHalf1x16(static_cast<glm::uint16>(Half));
+		float const Next = glm::unpackHalf1x16(static_cast<glm::uint16>(Half + 1));
+		float const Middle = Value + (Next - Value) * 0.5f;
+		float const Around[] = {Value, Middle, floatFromBits(bitsFromFloat(Middle) - 1), floatFromBits(bitsFromFloat(Middle) + 1)};
+		for(std::size_t i = 0; i < sizeof(Around) / sizeof(Around[0]); ++i)
+		{
+			Values.push_back(Around[i]);
+			Values.push_back(-Around[i]);
+		}
+	}
+	for(glm::uint64 Bits = 0; Bits <= 0xffffffff; Bits += 4099)
+		Values.push_back(floatFromBits(static_cast<glm::uint32>(Bits)));
+	Values.push_back(floatFromBits(0x7f800000));
+	Values.push_back(floatFromBits(0xff800000));
+	Values.push_back(floatFromBits(0x7f800001));
+	Values.push_back(floatFromBits(0xffc00000));
+	return Values;
+}
+
+int test_packHalfN()
+{
+	int Error = 0;
+
+	std::vector<float> const Values = halfTestValues();
+	Error += sameAsScalar(glm::packHalfN, Values) ? 0 : 1;
+
+	// Halves go through unchanged and midpoints round to the even neighbour, 65504 is next to
+	// infinity and among the special values
+	for(glm::uint16 Half = 0; Half < 0x7bff; ++Half)
+	{
+		float const Value = glm::unpackHalf1x16(Half);
+		float const Middle = Value + (glm::unpackHalf1x16(static_cast<glm::uint16>(Half + 1)) - Value) * 0.5f;
+		float const Source[] = {Value, -Value, Middle, floatFromBits(bitsFromFloat(Middle) + 1)};
+		glm::uint16 Packed[4];
+		glm::packHalfN(Source, Packed, 4);
+
+		Error += Packed[0] == Half ? 0 : 1;
+		Error += Packed[1] == (Half | 0x8000) ? 0 : 1;
+		Error += Packed[2] == Half + (Half & 1) ? 0 : 1;
+		Error += Packed[3] == Half + 1 ? 0 : 1;
+	}
+
+	float const Special[] = {65519.0f, 65520.0f, floatFromBits(0x33000000), floatFromBits(0x33000001), floatFromBits(0x7f800001), floatFromBits(0xffc00001), 1.0e10f, -1.0e-10f};
+	glm::uint16 Packed[8];
+	glm::packHalfN(Special, Packed, 8);
+	Error += Packed[0] == 0x7bff ? 0 : 1; // Below the midpoint to infinity
+	Error += Packed[1] == 0x7c00 ? 0 : 1; // The midpoint rounds to the even infinity
+	Error += Packed[2] == 0x0000 ? 0 : 1; // 2^-25, halfway to the smallest subnormal
+	Error += Packed[3] == 0x0001 ? 0 : 1;
+	Error += Packed[4] == 0x7e00 ? 0 : 1; // Signaling NaNs turn quiet
+	Error += Packed[5] == 0xfe00 ? 0 : 1;
+	Error += Packed[6] == 0x7c00 ? 0 : 1;
+	Error += Packed[7] == 0x8000 ? 0 : 1;
+
+	return Error;
+}
+
+int test_unpackHalfN()
+{
+	int Error = 0;
+
+	std::vector<glm::uint16> Halves;
+	for(glm::uint32 Half = 0; Half <= 0xffff; ++Half)
+		Halves.push_back(static_cast<glm::uint16>(Half));
+	Error += sameAsScalar(glm::unpackHalfN, Halves) ? 0 : 1;
+
+	std::vector<float> Floats(Halves.size());
+	glm::unpackHalfN(&Halves[0], &Floats[0], Halves.size());
+	for(std::size_t i = 0; i < Halves.size(); ++i)
+	{
+		bool const Signaling = (Halves[i] & 0x7e00) == 0x7c00 && (Halves[i] & 0x03ff) != 0;
+		glm::uint32 const Expected = bitsFromFloat(glm::unpackHalf1x16(Halves[i])) | (Signaling ? 0x00400000 : 0);
+		Error += bitsFromFloat(Floats[i]) == Expected ? 0 : 1;
+	}
+
+	return Error;
+}
+
+// Values of [-1.5, 1.5], the midpoints between two steps of Scale and the floats right next to them
+static std::vector<float> normTestValues(float Scale)
+{
+	std::vector<float> Values;
+	for(int i = -1000; i <= 1000; ++i)
+		Values.push_back(static_cast<float>(i) * 0.0015f);
+	for(int Step = -static_cast<int>(Scale) - 1; Step <= static_cast<int>(Scale); Step += Scale > 255.0f ? 7 : 1)
+	{
+		float const Middle = (static_cast<float>(Step) + 0.5f) / Scale;
+		Values.push_back(Middle);
+		Values.push_back(floatFromBits(bitsFromFloat(Middle) - 1));
+		Values.push_back(floatFromBits(bitsFromFloat(Middle) + 1));
+	}
+	Values.push_back(-0.0f);
+	Values.push_back(floatFromBits(0x7f800000));
+	Values.push_back(floatFromBits(0xff800000));
+	Values.push_back(floatFromBits(0x7fc00000));
+	return Values;
+}
+
+template<typename packedType>
+static int test_packNormN(void (*Pack)(float const*, packedType*, std::size_t), packedType (*Reference)(float), float Scale)
+{
+	int Error = 0;
+
+	std::vector<float> const Values = normTestValues(Scale);
+	Error += sameAsScalar(Pack, Values) ? 0 : 1;
+
+	std::vector<packedType> Packed(Values.size());
+	Pack(&Values[0], &Packed[0], Values.size());
+	for(std::size_t i = 0; i < Values.size(); ++i)
+		Error += Packed[i] == (glm::isnan(Values[i]) ? 0 : Reference(Values[i])) ? 0 : 1;
+
+	return Error;
+}
+
+template<typename packedType>
+static int test_unpackNormN(void (*Unpack)(packedType const*, float*, std::size_t), float (*Reference)(packedType))
+{
+	int Error = 0;
+
+	std::vector<packedType> Values;
+	for(glm::uint32 Value = 0; Value <= std::numeric_limits<packedType>::max(); ++Value)
+		Values.push_back(static_cast<packedType>(Value));
+	Error += sameAsScalar(Unpack, Values) ? 0 : 1;
+
+	std::vector<float> Floats(Values.size());
+	Unpack(&Values[0], &Floats[0], Values.size());
+	for(std::size_t i = 0; i < Values.size(); ++i)
+		Error += bitsFromFloat(Floats[i]) == bitsFromFloat(Reference(Values[i])) ? 0 : 1;
+
+	return Error;
+}
+
+int test_packNormN()
+{
+	int Error = 0;
+
+	Error += test_packNormN(glm::packUnorm8N, glm::packUnorm1x8, 255.0f);
+	Error += test_packNormN(glm::packSnorm8N, glm::packSnorm1x8, 127.0f);
+	Error += test_packNormN(glm::packUnorm16N, glm::packUnorm1x16, 65535.0f);
+	Error += test_packNormN(glm::packSnorm16N, glm::packSnorm1x16, 32767.0f);
+
+	Error += test_unpackNormN(glm::unpackUnorm8N, glm::unpackUnorm1x8);
+	Error += test_unpackNormN(glm::unpackSnorm8N, glm::unpackSnorm1x8);
+	Error += test_unpackNormN(glm::unpackUnorm16N, glm::unpackUnorm1x16);
+	Error += test_unpackNormN(glm::unpackSnorm16N, glm::unpackSnorm1x16);
+
+	return Error;
+}
+
 int main()
 {
 	int Error = 0;
@@ -874,5 +1059,9 @@ int main()
 	Error += test_Half1x16();
 	Error += test_Half4x16();
 
+	Error += test_packHalfN();
+	Error += test_unpackHalfN();
+	Error += test_packNormN();
+
 	return Error;
 }
@@ -0,0 +1,75 @@
+#define GLM_FORCE_INLINE
+#include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_relational.hpp>
+#include <glm/trigonometric.hpp>
+#if GLM_CONFIG_SIMD == GLM_ENABLE
+#include <glm/gtc/type_aligned.hpp>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+template <typename vecType>
+static void test_sin_cos(std::vector<vecType> const& I, std::vector<vecType>& O)
+{
+	for (std::size_t i = 0, n = I.size(); i < n; ++i)
+		O[i] = glm::sin(I[i]) + glm::cos(I[i]);
+}
+
+template <typename vecType>
+static int launch_sin_cos(std::vector<vecType>& O, std::size_t Samples)
+{
+	std::vector<vecType> I(Samples);
+	O.resize(Samples);
+
+	// Angles of a few turns, like the per-frame animation
+	for(std::size_t i = 0; i < Samples; ++i)
+		I[i] = vecType(0.001f, 0.002f, -0.003f, 0.005f) * static_cast<float>(i);
+
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	test_sin_cos<vecType>(I, O);
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+	return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+}
+
+template <typename packedVecType, typename alignedVecType>
+static int comp_sin_cos(std::size_t Samples)
+{
+	int Error = 0;
+
+	std::vector<packedVecType> SISD;
+	std::printf("- SISD: %d us\n", launch_sin_cos<packedVecType>(SISD, Samples));
+
+	std::vector<alignedVecType> SIMD;
+	std::printf("- SIMD: %d us\n", launch_sin_cos<alignedVecType>(SIMD, Samples));
+
+	for(std::size_t i = 0; i < Samples; ++i)
+	{
+		packedVecType const A = SISD[i];
+		packedVecType const B = SIMD[i];
+		Error += glm::all(glm::equal(A, B, 1e-5f)) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+int main()
+{
+	std::size_t const Samples = 1000000;
+
+	int Error = 0;
+
+	std::printf("sin(vec4) + cos(vec4):\n");
+	Error += comp_sin_cos<glm::vec4, glm::aligned_vec4>(Samples);
+
+	return Error;
+}
+
+#else
+
+int main()
+{
+	return 0;
+}
+
+#endif
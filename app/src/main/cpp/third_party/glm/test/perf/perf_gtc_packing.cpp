@@ -0,0 +1,144 @@
+#define GLM_FORCE_INLINE
+#include <glm/gtc/packing.hpp>
+#include <glm/common.hpp>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+template <typename functionType>
+static int measure(functionType Function)
+{
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	Function();
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+	return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+}
+
+static int comp_half(std::vector<float> const& I)
+{
+	int Error = 0;
+	std::size_t const Samples = I.size();
+
+	std::vector<glm::uint16> SISD(Samples);
+	std::printf("- SISD pack: %d us\n", measure([&]()
+	{
+		for(std::size_t i = 0; i < Samples; ++i)
+			SISD[i] = glm::packHalf1x16(I[i]);
+	}));
+
+	std::vector<glm::uint16> SIMD(Samples);
+	std::printf("- SIMD pack: %d us\n", measure([&]()
+	{
+		glm::packHalfN(&I[0], &SIMD[0], Samples);
+	}));
+
+	std::vector<float> O(Samples);
+	std::printf("- SISD unpack: %d us\n", measure([&]()
+	{
+		for(std::size_t i = 0; i < Samples; ++i)
+			O[i] = glm::unpackHalf1x16(SISD[i]);
+	}));
+	std::printf("- SIMD unpack: %d us\n", measure([&]()
+	{
+		glm::unpackHalfN(&SIMD[0], &O[0], Samples);
+	}));
+
+	// Rounding differs from packHalf1x16 at ties, both are within half a half ULP, 2^-25 for subnormals
+	for(std::size_t i = 0; i < Samples; ++i)
+		Error += glm::abs(O[i] - I[i]) <= glm::max(glm::abs(I[i]) * 0.00049f, 2.99e-8f) ? 0 : 1;
+
+	return Error;
+}
+
+static int comp_unorm8(std::vector<float> const& I)
+{
+	int Error = 0;
+	std::size_t const Samples = I.size();
+
+	std::vector<glm::uint8> SISD(Samples);
+	std::printf("- SISD pack: %d us\n", measure([&]()
+	{
+		for(std::size_t i = 0; i < Samples; ++i)
+			SISD[i] = glm::packUnorm1x8(I[i]);
+	}));
+
+	std::vector<glm::uint8> SIMD(Samples);
+	std::printf("- SIMD pack: %d us\n", measure([&]()
+	{
+		glm::packUnorm8N(&I[0], &SIMD[0], Samples);
+	}));
+
+	std::vector<float> O(Samples);
+	std::printf("- SISD unpack: %d us\n", measure([&]()
+	{
+		for(std::size_t i = 0; i < Samples; ++i)
+			O[i] = glm::unpackUnorm1x8(SISD[i]);
+	}));
+	std::printf("- SIMD unpack: %d us\n", measure([&]()
+	{
+		glm::unpackUnorm8N(&SIMD[0], &O[0], Samples);
+	}));
+
+	for(std::size_t i = 0; i < Samples; ++i)
+		Error += SISD[i] == SIMD[i] ? 0 : 1;
+
+	return Error;
+}
+
+static int comp_snorm16(std::vector<float> const& I)
+{
+	int Error = 0;
+	std::size_t const Samples = I.size();
+
+	std::vector<glm::uint16> SISD(Samples);
+	std::printf("- SISD pack: %d us\n", measure([&]()
+	{
+		for(std::size_t i = 0; i < Samples; ++i)
+			SISD[i] = glm::packSnorm1x16(I[i]);
+	}));
+
+	std::vector<glm::uint16> SIMD(Samples);
+	std::printf("- SIMD pack: %d us\n", measure([&]()
+	{
+		glm::packSnorm16N(&I[0], &SIMD[0], Samples);
+	}));
+
+	std::vector<float> O(Samples);
+	std::printf("- SISD unpack: %d us\n", measure([&]()
+	{
+		for(std::size_t i = 0; i < Samples; ++i)
+			O[i] = glm::unpackSnorm1x16(SISD[i]);
+	}));
+	std::printf("- SIMD unpack: %d us\n", measure([&]()
+	{
+		glm::unpackSnorm16N(&SIMD[0], &O[0], Samples);
+	}));
+
+	for(std::size_t i = 0; i < Samples; ++i)
+		Error += SISD[i] == SIMD[i] ? 0 : 1;
+
+	return Error;
+}
+
+int main()
+{
+	std::size_t const Samples = 4000000;
+
+	std::vector<float> I(Samples);
+	for(std::size_t i = 0; i < Samples; ++i)
+		I[i] = glm::sin(static_cast<float>(i) * 0.001f) * 1.01f;
+
+	int Error = 0;
+
+	std::printf("half:\n");
+	Error += comp_half(I);
+
+	std::printf("unorm8:\n");
+	Error += comp_unorm8(I);
+
+	std::printf("snorm16:\n");
+	Error += comp_snorm16(I);
+
+	return Error;
+}
@@ -0,0 +1,137 @@
+//
+// Created by eternal on 2024/7/6.
+//
+#include <algorithm>
+#include <cstring>
+#include "Debug.hh"
+#include "HeadlessDevice.hh"
+
+bool createHeadlessDevice(HeadlessDevice &device, const char *applicationName,
+                          const std::vector<const char *> &extensions,
+                          const VkPhysicalDeviceFeatures *features, const void *featureChain) {
+    const VkApplicationInfo applicationInfo{
+            .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+            .pNext = nullptr,
+            .pApplicationName = applicationName,
+            .applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0),
+            .pEngineName = "main",
+            .engineVersion = VK_MAKE_API_VERSION(0, 1, 0, 0),
+            .apiVersion = VK_MAKE_API_VERSION(0, 1, 1, 0)
+    };
+
+    const VkInstanceCreateInfo instanceCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .pApplicationInfo = &applicationInfo,
+            .enabledLayerCount = 0,
+            .ppEnabledLayerNames = nullptr,
+            .enabledExtensionCount = 0,
+            .ppEnabledExtensionNames = nullptr
+    };
+    if (vkCreateInstance(&instanceCreateInfo, nullptr, &device.instance) != VK_SUCCESS) {
+        return false;
+    }
+    InitVulkanInstance(device.instance, &instanceCreateInfo);
+
+    uint32_t gpuCount = 1;
+    if (vkEnumeratePhysicalDevices(device.instance, &gpuCount, &device.gpu) < 0 ||
+        gpuCount == 0) {
+        return false;
+    }
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device.gpu, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device.gpu, &queueFamilyCount,
+                                             queueFamilies.data());
+    uint32_t queueFamilyIndex = 0;
+    while (queueFamilyIndex < queueFamilyCount &&
+           (queueFamilies[queueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+        ++queueFamilyIndex;
+    }
+    if (queueFamilyIndex == queueFamilyCount) {
+        return false;
+    }
+    device.queueFamilyIndex = queueFamilyIndex;
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(device.gpu, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device.gpu, nullptr, &extensionCount,
+                                         availableExtensions.data());
+    const auto isAvailable = [&availableExtensions](const char *name) {
+        return std::any_of(availableExtensions.begin(), availableExtensions.end(),
+                           [name](const VkExtensionProperties &extension) {
+                               return strcmp(extension.extensionName, name) == 0;
+                           });
+    };
+    const auto isRequested = [&extensions](const char *name) {
+        return std::any_of(extensions.begin(), extensions.end(), [name](const char *extension) {
+            return strcmp(extension, name) == 0;
+        });
+    };
+
+    std::vector<const char *> enabledExtensions;
+    for (const char *extension: extensions) {
+        if (!isAvailable(extension)) {
+            LOGE("Device extension %s is not supported.", extension);
+            return false;
+        }
+        enabledExtensions.emplace_back(extension);
+    }
+    const char *feedbackExtension = VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME;
+    device.creationFeedback = isAvailable(feedbackExtension);
+    if (device.creationFeedback && !isRequested(feedbackExtension)) {
+        enabledExtensions.emplace_back(feedbackExtension);
+    }
+    // The descriptor update templates of DrawConstants, core from 1.1 on
+    const char *updateTemplateExtension = VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME;
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device.gpu, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_1 && isAvailable(updateTemplateExtension) &&
+        !isRequested(updateTemplateExtension)) {
+        enabledExtensions.emplace_back(updateTemplateExtension);
+    }
+
+    const float queuePriority = 1.0f;
+    const VkDeviceQueueCreateInfo queueCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .queueFamilyIndex = queueFamilyIndex,
+            .queueCount = 1,
+            .pQueuePriorities = &queuePriority
+    };
+
+    const VkDeviceCreateInfo deviceCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+            .pNext = featureChain,
+            .flags = 0,
+            .queueCreateInfoCount = 1,
+            .pQueueCreateInfos = &queueCreateInfo,
+            .enabledLayerCount = 0,
+            .ppEnabledLayerNames = nullptr,
+            .enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size()),
+            .ppEnabledExtensionNames = enabledExtensions.data(),
+            .pEnabledFeatures = features
+    };
+    if (vkCreateDevice(device.gpu, &deviceCreateInfo, nullptr, &device.device) != VK_SUCCESS) {
+        return false;
+    }
+    InitVulkanDevice(device.gpu, device.device, &deviceCreateInfo);
+
+    vkGetDeviceQueue(device.device, queueFamilyIndex, 0, &device.queue);
+    return true;
+}
+
+void destroyHeadlessDevice(HeadlessDevice &device) {
+    if (device.device != VK_NULL_HANDLE) {
+        vkDestroyDevice(device.device, nullptr);
+        device.device = VK_NULL_HANDLE;
+    }
+    if (device.instance != VK_NULL_HANDLE) {
+        vkDestroyInstance(device.instance, nullptr);
+        device.instance = VK_NULL_HANDLE;
+    }
+}
@@ -0,0 +1,41 @@
+//
+// Created by eternal on 2024/7/6.
+//
+
+#ifndef LEARNINGVULKAN_HEADLESSDEVICE_HH
+#define LEARNINGVULKAN_HEADLESSDEVICE_HH
+
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief A Vulkan 1.1 device without a surface for the host tools
+ *
+ * Takes the first physical device with a graphics queue. VK_EXT_pipeline_creation_feedback is
+ * enabled when available, and VK_KHR_descriptor_update_template on devices below 1.1.
+ */
+struct HeadlessDevice {
+    VkInstance instance = VK_NULL_HANDLE;
+
+    VkPhysicalDevice gpu = VK_NULL_HANDLE;
+
+    VkDevice device = VK_NULL_HANDLE;
+
+    uint32_t queueFamilyIndex = 0;
+
+    VkQueue queue = VK_NULL_HANDLE;
+
+    bool creationFeedback = false;
+};
+
+/// InitVulkan has to be called first. Points the wrapper's function pointers at the new
+/// instance and device. Fails if one of the extensions is not supported, features and the
+/// feature structures chained to featureChain are enabled as given.
+bool createHeadlessDevice(HeadlessDevice &device, const char *applicationName,
+                          const std::vector<const char *> &extensions = {},
+                          const VkPhysicalDeviceFeatures *features = nullptr,
+                          const void *featureChain = nullptr);
+
+void destroyHeadlessDevice(HeadlessDevice &device);
+
+#endif //LEARNINGVULKAN_HEADLESSDEVICE_HH
@@ -0,0 +1,132 @@
+//
+// Created by eternal on 2024/7/19.
+//
+// Runs BindlessDescriptors against the null driver: the device reports descriptor indexing, the
+// set is created once, each registration writes exactly one descriptor, full arrays refuse
+// further ones and released slots are only reused after the frames in flight.
+//   ./bindless_test
+//
+#include <cstdio>
+#include <vector>
+#include "BindlessDescriptors.hh"
+#include "HeadlessDevice.hh"
+#include "NullDriver.hh"
+
+namespace {
+    constexpr uint32_t kImageCount = 4;
+
+    constexpr uint32_t kBufferCount = 2;
+
+    constexpr uint32_t kFramesInFlight = 2;
+
+    uint32_t failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            fprintf(stderr, "FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    uint64_t updates() {
+        return null_driver::getCallCount("vkUpdateDescriptorSets");
+    }
+
+    /// Fake handles, the null driver never dereferences them
+    template<typename Handle>
+    Handle fakeHandle(uintptr_t value) {
+        return reinterpret_cast<Handle>(value);
+    }
+}
+
+int main() {
+    if (!null_driver::install()) {
+        fprintf(stderr, "Failed to install the null driver.\n");
+        return 1;
+    }
+
+    // The device is created with what an app enables when BindlessDescriptors::isSupported
+    const VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures =
+            BindlessDescriptors::getRequiredFeatures();
+    HeadlessDevice device;
+    if (!createHeadlessDevice(device, "bindless_test",
+                              BindlessDescriptors::getRequiredExtensions(), nullptr,
+                              &indexingFeatures)) {
+        fprintf(stderr, "Failed to create a Vulkan device.\n");
+        return 1;
+    }
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(device.gpu, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device.gpu, nullptr, &extensionCount, extensions.data());
+    check(BindlessDescriptors::isSupported(device.gpu, extensions), "isSupported");
+
+    null_driver::resetCallCounts();
+    BindlessDescriptors bindless;
+    check(bindless.init(device.gpu, device.device, kImageCount, kBufferCount, kFramesInFlight),
+          "init");
+    check(bindless.getSetLayout() != VK_NULL_HANDLE, "init creates the set layout");
+    check(null_driver::getCallCount("vkCreateDescriptorSetLayout") == 1 &&
+          null_driver::getCallCount("vkCreateDescriptorPool") == 1 &&
+          null_driver::getCallCount("vkAllocateDescriptorSets") == 1,
+          "init creates one layout, one pool and one set");
+    check(updates() == 0, "init writes no descriptors");
+
+    // Slots are handed out in order and each costs one write
+    for (uint32_t i = 0; i < kImageCount; ++i) {
+        const uint32_t index = bindless.registerImage(fakeHandle<VkImageView>(0x100 + i),
+                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        check(index == i, "registerImage returns the next free slot");
+    }
+    check(updates() == kImageCount, "registerImage writes one descriptor each");
+    check(bindless.registerImage(fakeHandle<VkImageView>(0x200),
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) ==
+          BindlessDescriptors::kInvalidIndex, "registerImage fails on a full array");
+
+    for (uint32_t i = 0; i < kBufferCount; ++i) {
+        const uint32_t index = bindless.registerBuffer(fakeHandle<VkBuffer>(0x300 + i), 0,
+                                                       VK_WHOLE_SIZE);
+        check(index == i, "registerBuffer returns the next free slot");
+    }
+    check(bindless.registerBuffer(fakeHandle<VkBuffer>(0x400), 0, VK_WHOLE_SIZE) ==
+          BindlessDescriptors::kInvalidIndex, "registerBuffer fails on a full array");
+    check(updates() == kImageCount + kBufferCount, "a full array writes nothing");
+
+    // A released slot may still be read by the frames in flight
+    bindless.releaseImage(1);
+    bindless.releaseBuffer(0);
+    for (uint32_t frame = 1; frame < kFramesInFlight; ++frame) {
+        bindless.beginFrame();
+        check(bindless.registerImage(fakeHandle<VkImageView>(0x500),
+                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) ==
+              BindlessDescriptors::kInvalidIndex, "a released image slot waits for its frames");
+    }
+    bindless.beginFrame();
+    check(bindless.registerImage(fakeHandle<VkImageView>(0x500),
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) == 1,
+          "a released image slot is reused after the frames in flight");
+    check(bindless.registerBuffer(fakeHandle<VkBuffer>(0x600), 0, VK_WHOLE_SIZE) == 0,
+          "a released buffer slot is reused after the frames in flight");
+    check(updates() == kImageCount + kBufferCount + 2, "reusing a slot writes it again");
+
+    // Bound once, whatever the shaders index
+    null_driver::resetCallCounts();
+    bindless.bind(fakeHandle<VkCommandBuffer>(0x700), fakeHandle<VkPipelineLayout>(0x800), 1);
+    check(null_driver::getCallCount("vkCmdBindDescriptorSets") == 1, "bind binds one set");
+
+    bindless.teardown();
+    check(null_driver::getCallCount("vkDestroyDescriptorPool") == 1 &&
+          null_driver::getCallCount("vkDestroyDescriptorSetLayout") == 1,
+          "teardown destroys the pool and the layout");
+    check(bindless.getSetLayout() == VK_NULL_HANDLE, "teardown resets the set layout");
+
+    destroyHeadlessDevice(device);
+
+    if (failures != 0) {
+        fprintf(stderr, "%u checks failed.\n", failures);
+        return 1;
+    }
+    printf("All bindless descriptor checks passed.\n");
+    return 0;
+}
@@ -0,0 +1,127 @@
+//
+// Created by eternal on 2024/7/6.
+//
+// Measures the per-call cost of recording through the loader's exported entry points against the
+// device's own ones from vkGetDeviceProcAddr, e.g. against lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./dispatch_bench [batches]
+// Only state setting commands are recorded, they do next to no work in the driver, which leaves
+// mostly the dispatch.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Debug.hh"
+#include "HeadlessDevice.hh"
+
+namespace {
+    struct Entry {
+        PFN_vkCmdSetViewport setViewport;
+
+        PFN_vkCmdSetScissor setScissor;
+    };
+
+    constexpr uint32_t kCallsPerBatch = 4096;
+
+    constexpr uint32_t kRounds = 5;
+
+    /// Returns nanoseconds per recorded command
+    double measure(VkDevice device, VkCommandPool commandPool, VkCommandBuffer commandBuffer,
+                   const Entry &entry, uint32_t batchCount) {
+        const VkViewport viewport{
+                .x = 0.0f,
+                .y = 0.0f,
+                .width = 64.0f,
+                .height = 64.0f,
+                .minDepth = 0.0f,
+                .maxDepth = 1.0f
+        };
+        const VkRect2D scissor{
+                .offset = {0, 0},
+                .extent = {64, 64}
+        };
+        const VkCommandBufferBeginInfo beginInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .pNext = nullptr,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+                .pInheritanceInfo = nullptr
+        };
+
+        std::chrono::nanoseconds elapsed{0};
+        for (uint32_t batch = 0; batch < batchCount; ++batch) {
+            // Keeps the command buffer small, only the recording itself is timed
+            vkResetCommandPool(device, commandPool, 0);
+            vkBeginCommandBuffer(commandBuffer, &beginInfo);
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < kCallsPerBatch; ++i) {
+                entry.setViewport(commandBuffer, 0, 1, &viewport);
+                entry.setScissor(commandBuffer, 0, 1, &scissor);
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+            vkEndCommandBuffer(commandBuffer);
+        }
+        return static_cast<double>(elapsed.count()) / (2.0 * kCallsPerBatch * batchCount);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [batches]\n", argv[0]);
+        return 1;
+    }
+    const uint32_t batchCount =
+            argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 256;
+
+    HeadlessDevice device;
+    if (!InitVulkan() || !createHeadlessDevice(device, "dispatch_bench")) {
+        LOGE("Failed to create a Vulkan device.");
+        return 1;
+    }
+    // Queried from the instance, device commands resolve to the loader's trampolines
+    const Entry loaderEntry{
+            reinterpret_cast<PFN_vkCmdSetViewport>(
+                    vkGetInstanceProcAddr(device.instance, "vkCmdSetViewport")),
+            reinterpret_cast<PFN_vkCmdSetScissor>(
+                    vkGetInstanceProcAddr(device.instance, "vkCmdSetScissor"))
+    };
+    const Entry deviceEntry{vkCmdSetViewport, vkCmdSetScissor};
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device.gpu, &properties);
+
+    const VkCommandPoolCreateInfo poolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = device.queueFamilyIndex
+    };
+    VkCommandPool commandPool;
+    CALL_VK(vkCreateCommandPool(device.device, &poolCreateInfo, nullptr, &commandPool))
+
+    const VkCommandBufferAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+    };
+    VkCommandBuffer commandBuffer;
+    CALL_VK(vkAllocateCommandBuffers(device.device, &allocateInfo, &commandBuffer))
+
+    // Interleaved rounds, the best of each is kept to filter out scheduling noise
+    double loaderNs = 1e9;
+    double deviceNs = 1e9;
+    for (uint32_t round = 0; round < kRounds; ++round) {
+        loaderNs = std::min(loaderNs, measure(device.device, commandPool, commandBuffer,
+                                              loaderEntry, batchCount));
+        deviceNs = std::min(deviceNs, measure(device.device, commandPool, commandBuffer,
+                                              deviceEntry, batchCount));
+    }
+    printf("{\"device\": \"%s\", \"loader_ns_per_call\": %.2f, \"device_ns_per_call\": %.2f, "
+           "\"saved_ns_per_call\": %.2f}\n",
+           properties.deviceName, loaderNs, deviceNs, loaderNs - deviceNs);
+
+    vkDestroyCommandPool(device.device, commandPool, nullptr);
+    destroyHeadlessDevice(device);
+    return 0;
+}
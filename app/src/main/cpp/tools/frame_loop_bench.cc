@@ -0,0 +1,900 @@
+//
+// Created by eternal on 2024/7/19.
+//
+// Runs the frame loop of TriangleApp without a window for every combination of object count and
+// frames in flight, and reports CPU frame times, heap allocations and Vulkan calls per frame as
+// JSON. Runs against the null driver unless --driver is given, e.g. for lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./frame_loop_bench --driver
+// Options:
+//   --frames N             measured frames per configuration, after --warmup N more
+//   --objects 1,100,1000   quads drawn per frame, each with a transform of its own
+//   --in-flight 1,2,3      frames recorded ahead of the GPU
+//   --gpu-latency US       null driver only, time until a submission's fence signals
+//   --dynamic-rendering    renders with VK_KHR_dynamic_rendering instead of a render pass
+//   --baseline path        compares against the results in the file, fails if there is none.
+//                          --update-baseline writes them there instead.
+//   --tolerance PERCENT    slowdown of the mean and p50 CPU frame time accepted by the comparison
+//
+// CPU frame time covers building the overlay, recording and submitting, without the fence wait,
+// which is reported separately. Any increase of allocations or Vulkan calls per frame counts as a
+// regression. The exit code is 2 if there is one, so the check_frame_loop target fails on it.
+// Vulkan calls are counted by the null driver only, they are null with --driver. Baselines of the
+// null driver keep the counts only, its frame times depend on the machine rather than a device.
+// Metrics a baseline has no value for are not compared.
+//
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "Debug.hh"
+#include "FileBackend.hh"
+#include "FrameRenderer.hh"
+#include "FrameStats.hh"
+#include "GpuProfiler.hh"
+#include "HeadlessDevice.hh"
+#include "LayoutCache.hh"
+#include "Logger.hh"
+#include "NullDriver.hh"
+#include "Overlay.hh"
+#include "PipelineCache.hh"
+#include "PipelineManager.hh"
+#include "ShaderModuleCache.hh"
+#include "VulkanCommon.hh"
+
+namespace {
+    std::atomic<uint64_t> heapAllocations{0};
+}
+
+// Counts every heap allocation of the process, the other forms of new end up here
+void *operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = malloc(size != 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+namespace {
+    constexpr VkExtent2D kExtent{1280, 720};
+
+    constexpr VkFormat kColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+    /// Frames end up ready to be read back, where the app presents them
+    constexpr VkImageLayout kFinalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    struct Options {
+        uint32_t frames = 1000;
+
+        uint32_t warmupFrames = 30;
+
+        std::vector<uint32_t> objectCounts{1, 100, 1000};
+
+        std::vector<uint32_t> framesInFlight{1, 2, 3};
+
+        uint32_t gpuLatencyMicroseconds = 0;
+
+        bool nullDriver = true;
+
+        bool dynamicRendering = false;
+
+        const char *baselinePath = nullptr;
+
+        bool updateBaseline = false;
+
+        double tolerance = 0.10;
+    };
+
+    struct Result {
+        uint32_t objects = 0;
+
+        uint32_t framesInFlight = 0;
+
+        double cpuMeanMs = 0.0;
+
+        double cpuP50Ms = 0.0;
+
+        double cpuP99Ms = 0.0;
+
+        double cpuMaxMs = 0.0;
+
+        double waitMeanMs = 0.0;
+
+        double allocationsPerFrame = 0.0;
+
+        /// NaN without the null driver, which does the counting
+        double vulkanCallsPerFrame = NAN;
+    };
+
+    struct FrameTiming {
+        double cpuMs;
+
+        double waitMs;
+    };
+
+    /// What all configurations share, so pipelines and layouts are only created once
+    struct Shared {
+        const HeadlessDevice *device;
+
+        ShaderModuleCache *shaderModules;
+
+        LayoutCache *layoutCache;
+
+        PipelineManager *pipelineManager;
+
+        /// VK_NULL_HANDLE with --dynamic-rendering
+        VkRenderPass renderPass;
+    };
+
+    double millisecondsBetween(std::chrono::steady_clock::time_point begin,
+                               std::chrono::steady_clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+
+    /**
+     * @brief The per-frame work of TriangleApp for one configuration
+     *
+     * Frames are recorded by the FrameRenderer of the app into plain images instead of swapchain
+     * images, so there is no acquire and no present. The overlay is built like in the app.
+     */
+    class FrameLoop {
+    public:
+        bool init(const Shared &shared, uint32_t objects, uint32_t framesInFlight) {
+            const HeadlessDevice &headless = *shared.device;
+            device = headless.device;
+            queue = headless.queue;
+            renderPass = shared.renderPass;
+            objectCount = objects;
+
+            // The frames are numbered like the swapchain images of the app
+            frames.resize(framesInFlight);
+            for (Frame &frame: frames) {
+                if (!initFrame(headless, frame)) {
+                    return false;
+                }
+            }
+
+            if (!gpuProfiler.init(headless.gpu, device, queue, headless.queueFamilyIndex,
+                                  framesInFlight, 8, false)) {
+                LOGW("GPU profiler: disabled.");
+            }
+            if (!renderer.init({
+                    .gpu = headless.gpu,
+                    .device = device,
+                    .layoutCache = shared.layoutCache,
+                    .shaderModules = shared.shaderModules,
+                    .pipelineManager = shared.pipelineManager,
+                    .gpuProfiler = &gpuProfiler,
+                    .renderPass = renderPass,
+                    .colorFormat = kColorFormat,
+                    .finalLayout = kFinalLayout,
+                    .frameCount = framesInFlight,
+                    .maxObjectsPerFrame = objectCount
+            })) {
+                return false;
+            }
+
+            if (!overlay.init(headless.gpu, device, queue, headless.queueFamilyIndex,
+                              shared.layoutCache, shared.shaderModules, shared.pipelineManager,
+                              renderPass, kColorFormat, framesInFlight)) {
+                LOGW("Overlay: disabled.");
+            }
+            return true;
+        }
+
+        void teardown() {
+            overlay.teardown();
+            renderer.teardown();
+            gpuProfiler.teardown();
+            for (Frame &frame: frames) {
+                vkDestroyFence(device, frame.fence, nullptr);
+                vkDestroyCommandPool(device, frame.commandPool, nullptr);
+                vkDestroyFramebuffer(device, frame.framebuffer, nullptr);
+                vkDestroyImageView(device, frame.imageView, nullptr);
+                vkDestroyImage(device, frame.image, nullptr);
+                vkFreeMemory(device, frame.memory, nullptr);
+            }
+            frames.clear();
+        }
+
+        FrameTiming runFrame(uint32_t frameNumber) {
+            const auto slot = static_cast<uint32_t>(frameNumber % frames.size());
+            Frame &frame = frames[slot];
+
+            const auto waitStart = std::chrono::steady_clock::now();
+            vkWaitForFences(device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+            vkResetFences(device, 1, &frame.fence);
+
+            const auto cpuStart = std::chrono::steady_clock::now();
+            vkResetCommandPool(device, frame.commandPool, 0);
+
+            overlay.beginFrame(slot);
+            updateOverlay();
+
+            const FrameRenderer::Target target{
+                    .image = frame.image,
+                    .imageView = frame.imageView,
+                    .framebuffer = frame.framebuffer,
+                    .extent = kExtent
+            };
+            const float timestamp = static_cast<float>(frameNumber) / 60.0f;
+            draws = renderer.record(frame.commandBuffer, slot, target, timestamp, objectCount,
+                                    &overlay).draws;
+
+            const VkSubmitInfo submitInfo{
+                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                    .pNext = nullptr,
+                    .waitSemaphoreCount = 0,
+                    .pWaitSemaphores = nullptr,
+                    .pWaitDstStageMask = nullptr,
+                    .commandBufferCount = 1,
+                    .pCommandBuffers = &frame.commandBuffer,
+                    .signalSemaphoreCount = 0,
+                    .pSignalSemaphores = nullptr
+            };
+            CALL_VK(vkQueueSubmit(queue, 1, &submitInfo, frame.fence))
+            const auto cpuEnd = std::chrono::steady_clock::now();
+
+            const FrameTiming timing{
+                    .cpuMs = millisecondsBetween(cpuStart, cpuEnd),
+                    .waitMs = millisecondsBetween(waitStart, cpuStart)
+            };
+            if (lastFrameStart != std::chrono::steady_clock::time_point{}) {
+                frameStats.add({
+                        .intervalMs = static_cast<float>(millisecondsBetween(lastFrameStart,
+                                                                             waitStart)),
+                        .cpuMs = static_cast<float>(timing.cpuMs),
+                        .gpuMs = static_cast<float>(gpuProfiler.getFrameMilliseconds())
+                });
+            }
+            lastFrameStart = waitStart;
+            return timing;
+        }
+
+    private:
+        struct Frame {
+            VkImage image = VK_NULL_HANDLE;
+
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+
+            VkImageView imageView = VK_NULL_HANDLE;
+
+            /// Only with a render pass
+            VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+            VkCommandPool commandPool = VK_NULL_HANDLE;
+
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+            VkFence fence = VK_NULL_HANDLE;
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+
+        VkQueue queue = VK_NULL_HANDLE;
+
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+
+        uint32_t objectCount = 0;
+
+        std::vector<Frame> frames{};
+
+        GpuProfiler gpuProfiler{};
+
+        FrameRenderer renderer{};
+
+        Overlay overlay{};
+
+        FrameStats frameStats{};
+
+        FrameStats::Percentiles framePercentiles{};
+
+        uint32_t framesUntilStatsRefresh = 0;
+
+        /// Of the previous frame, like the overlay of the app shows them
+        uint32_t draws = 0;
+
+        std::chrono::steady_clock::time_point lastFrameStart{};
+
+        bool initFrame(const HeadlessDevice &headless, Frame &frame) {
+            const VkImageCreateInfo imageCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .imageType = VK_IMAGE_TYPE_2D,
+                    .format = kColorFormat,
+                    .extent {.width = kExtent.width, .height = kExtent.height, .depth = 1},
+                    .mipLevels = 1,
+                    .arrayLayers = 1,
+                    .samples = VK_SAMPLE_COUNT_1_BIT,
+                    .tiling = VK_IMAGE_TILING_OPTIMAL,
+                    .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                             VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                    .queueFamilyIndexCount = 0,
+                    .pQueueFamilyIndices = nullptr,
+                    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+            };
+            if (vkCreateImage(device, &imageCreateInfo, nullptr, &frame.image) != VK_SUCCESS) {
+                return false;
+            }
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(device, frame.image, &requirements);
+            VkMemoryAllocateInfo allocateInfo{
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                    .pNext = nullptr,
+                    .allocationSize = requirements.size,
+                    .memoryTypeIndex = 0
+            };
+            if (!vulkan_common::mapMemoryTypeToIndex(headless.gpu, requirements.memoryTypeBits,
+                                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                     &allocateInfo.memoryTypeIndex) ||
+                vkAllocateMemory(device, &allocateInfo, nullptr, &frame.memory) != VK_SUCCESS ||
+                vkBindImageMemory(device, frame.image, frame.memory, 0) != VK_SUCCESS) {
+                return false;
+            }
+
+            const VkImageViewCreateInfo viewCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .image = frame.image,
+                    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+                    .format = kColorFormat,
+                    .components {
+                            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                            .a = VK_COMPONENT_SWIZZLE_IDENTITY
+                    },
+                    .subresourceRange {
+                            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                            .baseMipLevel = 0,
+                            .levelCount = 1,
+                            .baseArrayLayer = 0,
+                            .layerCount = 1
+                    }
+            };
+            if (vkCreateImageView(device, &viewCreateInfo, nullptr, &frame.imageView) !=
+                VK_SUCCESS) {
+                return false;
+            }
+
+            // Dynamic rendering starts from the image view
+            if (renderPass != VK_NULL_HANDLE) {
+                const VkFramebufferCreateInfo framebufferCreateInfo{
+                        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+                        .pNext = nullptr,
+                        .flags = 0,
+                        .renderPass = renderPass,
+                        .attachmentCount = 1,
+                        .pAttachments = &frame.imageView,
+                        .width = kExtent.width,
+                        .height = kExtent.height,
+                        .layers = 1
+                };
+                if (vkCreateFramebuffer(device, &framebufferCreateInfo, nullptr,
+                                        &frame.framebuffer) != VK_SUCCESS) {
+                    return false;
+                }
+            }
+
+            const VkCommandPoolCreateInfo poolCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                    .queueFamilyIndex = headless.queueFamilyIndex
+            };
+            if (vkCreateCommandPool(device, &poolCreateInfo, nullptr, &frame.commandPool) !=
+                VK_SUCCESS) {
+                return false;
+            }
+            const VkCommandBufferAllocateInfo commandBufferInfo{
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                    .pNext = nullptr,
+                    .commandPool = frame.commandPool,
+                    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                    .commandBufferCount = 1
+            };
+            if (vkAllocateCommandBuffers(device, &commandBufferInfo, &frame.commandBuffer) !=
+                VK_SUCCESS) {
+                return false;
+            }
+
+            // Signaled, so the first wait on each frame returns right away
+            const VkFenceCreateInfo fenceCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = VK_FENCE_CREATE_SIGNALED_BIT
+            };
+            return vkCreateFence(device, &fenceCreateInfo, nullptr, &frame.fence) == VK_SUCCESS;
+        }
+
+        /// The content of TriangleApp::updateOverlay, without the memory and GPU readouts
+        void updateOverlay() {
+            if (framesUntilStatsRefresh == 0) {
+                framePercentiles = frameStats.computeIntervalPercentiles();
+                framesUntilStatsRefresh = 30;
+            }
+            --framesUntilStatsRefresh;
+
+            constexpr uint32_t white = Overlay::rgba(255, 255, 255);
+            constexpr uint32_t cpuColor = Overlay::rgba(96, 200, 255);
+            overlay.setScale(2.0f);
+            const float lineHeight = overlay.getLineHeight();
+            const float x = lineHeight;
+            float y = lineHeight;
+            const FrameStats::Sample latest = frameStats.getLatest();
+
+            overlay.text(x, y, white, "FPS %.1f  FRAME %.2f MS", frameStats.getFps(),
+                         latest.intervalMs);
+            y += lineHeight;
+            overlay.text(x, y, white, "P50 %.2f  P95 %.2f  P99 %.2f MS", framePercentiles.p50,
+                         framePercentiles.p95, framePercentiles.p99);
+            y += lineHeight;
+            overlay.text(x, y, cpuColor, "CPU %.2f MS", latest.cpuMs);
+            y += lineHeight;
+            overlay.graph(x, y, 360.0f, lineHeight * 3.0f, frameStats.getCpuTimes().data(),
+                          FrameStats::kHistorySize, frameStats.getCount(), frameStats.getFirst(),
+                          33.3f, cpuColor);
+            y += lineHeight * 3.5f;
+            overlay.text(x, y, white, "DRAWS %u  SUBMITS 1", draws);
+        }
+    };
+
+    VkRenderPass createRenderPass(VkDevice device) {
+        const VkAttachmentDescription attachment{
+                .flags = 0,
+                .format = kColorFormat,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                .finalLayout = kFinalLayout
+        };
+        const VkAttachmentReference colorReference{
+                .attachment = 0,
+                .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+        };
+        const VkSubpassDescription subpass{
+                .flags = 0,
+                .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                .inputAttachmentCount = 0,
+                .pInputAttachments = nullptr,
+                .colorAttachmentCount = 1,
+                .pColorAttachments = &colorReference,
+                .pResolveAttachments = nullptr,
+                .pDepthStencilAttachment = nullptr,
+                .preserveAttachmentCount = 0,
+                .pPreserveAttachments = nullptr
+        };
+        const VkRenderPassCreateInfo createInfo{
+                .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .attachmentCount = 1,
+                .pAttachments = &attachment,
+                .subpassCount = 1,
+                .pSubpasses = &subpass,
+                .dependencyCount = 0,
+                .pDependencies = nullptr
+        };
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        CALL_VK(vkCreateRenderPass(device, &createInfo, nullptr, &renderPass))
+        return renderPass;
+    }
+
+    /// Nearest rank, sorted has to be sorted and not empty
+    double percentile(const std::vector<double> &sorted, double fraction) {
+        const auto rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+        return sorted[rank];
+    }
+
+    bool measure(const Shared &shared, const Options &options, uint32_t objects,
+                 uint32_t framesInFlight, Result &result) {
+        FrameLoop loop;
+        if (!loop.init(shared, objects, framesInFlight)) {
+            LOGE("Failed to set up %u objects with %u frames in flight.", objects,
+                 framesInFlight);
+            loop.teardown();
+            return false;
+        }
+
+        // Lets the overlay pipeline finish compiling and every container reach its final size
+        uint32_t frameNumber = 0;
+        for (; frameNumber < options.warmupFrames; ++frameNumber) {
+            loop.runFrame(frameNumber);
+        }
+
+        // The logger thread allocates while it writes out what init logged
+        logger::flush();
+
+        std::vector<double> cpuMs;
+        cpuMs.reserve(options.frames);
+        double waitMs = 0.0;
+        if (options.nullDriver) {
+            null_driver::resetCallCounts();
+        }
+        const uint64_t allocationsBefore = heapAllocations.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < options.frames; ++i, ++frameNumber) {
+            const FrameTiming timing = loop.runFrame(frameNumber);
+            cpuMs.push_back(timing.cpuMs);
+            waitMs += timing.waitMs;
+        }
+        const uint64_t allocations =
+                heapAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+        const double frameCount = static_cast<double>(options.frames);
+        if (options.nullDriver) {
+            result.vulkanCallsPerFrame =
+                    static_cast<double>(null_driver::getTotalCallCount()) / frameCount;
+        }
+
+        vkDeviceWaitIdle(shared.device->device);
+        loop.teardown();
+
+        std::sort(cpuMs.begin(), cpuMs.end());
+        result.objects = objects;
+        result.framesInFlight = framesInFlight;
+        result.cpuMeanMs = std::accumulate(cpuMs.begin(), cpuMs.end(), 0.0) / frameCount;
+        result.cpuP50Ms = percentile(cpuMs, 0.50);
+        result.cpuP99Ms = percentile(cpuMs, 0.99);
+        result.cpuMaxMs = cpuMs.back();
+        result.waitMeanMs = waitMs / frameCount;
+        result.allocationsPerFrame = static_cast<double>(allocations) / frameCount;
+        return true;
+    }
+
+    /// "key": value with the given decimals, null for NaN
+    void writeNumber(FILE *file, const char *key, double value, int decimals) {
+        if (std::isnan(value)) {
+            fprintf(file, "\"%s\": null", key);
+        } else {
+            fprintf(file, "\"%s\": %.*f", key, decimals, value);
+        }
+    }
+
+    const char *renderingName(const Options &options) {
+        return options.dynamicRendering ? "dynamic rendering" : "render pass";
+    }
+
+    /// One configuration per line, readBaseline relies on it
+    void writeResults(FILE *file, const char *deviceName, const Options &options,
+                      const std::vector<Result> &results) {
+        fprintf(file, "{\"device\": \"%s\", \"rendering\": \"%s\", \"frames\": %u, "
+                      "\"results\": [\n", deviceName, renderingName(options), options.frames);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result &result = results[i];
+            fprintf(file, "{\"objects\": %u, \"frames_in_flight\": %u, ", result.objects,
+                    result.framesInFlight);
+            writeNumber(file, "cpu_mean_ms", result.cpuMeanMs, 4);
+            fprintf(file, ", ");
+            writeNumber(file, "cpu_p50_ms", result.cpuP50Ms, 4);
+            fprintf(file, ", ");
+            writeNumber(file, "cpu_p99_ms", result.cpuP99Ms, 4);
+            fprintf(file, ", ");
+            writeNumber(file, "cpu_max_ms", result.cpuMaxMs, 4);
+            fprintf(file, ", ");
+            writeNumber(file, "wait_mean_ms", result.waitMeanMs, 4);
+            fprintf(file, ", ");
+            writeNumber(file, "allocations_per_frame", result.allocationsPerFrame, 2);
+            fprintf(file, ", ");
+            writeNumber(file, "vulkan_calls_per_frame", result.vulkanCallsPerFrame, 2);
+            fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+        }
+        fprintf(file, "]}\n");
+    }
+
+    /// The number after "key": in a line of writeResults, NaN if it is missing or null
+    double readNumber(const char *line, const char *key) {
+        const std::string pattern = std::string("\"") + key + "\": ";
+        const char *found = strstr(line, pattern.c_str());
+        if (found == nullptr) {
+            return NAN;
+        }
+        const char *begin = found + pattern.size();
+        char *end;
+        const double value = strtod(begin, &end);
+        return end != begin ? value : NAN;
+    }
+
+    /// The string after "key": in a line of writeResults, empty if it is missing
+    std::string readString(const char *line, const char *key) {
+        const std::string pattern = std::string("\"") + key + "\": \"";
+        const char *found = strstr(line, pattern.c_str());
+        if (found == nullptr) {
+            return {};
+        }
+        const char *begin = found + pattern.size();
+        return {begin, strcspn(begin, "\"")};
+    }
+
+    bool readBaseline(const char *path, std::string &deviceName, std::string &rendering,
+                      std::vector<Result> &results) {
+        FILE *file = fopen(path, "r");
+        if (file == nullptr) {
+            return false;
+        }
+        char line[1024];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (strstr(line, "\"device\"") != nullptr) {
+                deviceName = readString(line, "device");
+                rendering = readString(line, "rendering");
+            }
+            if (strstr(line, "\"objects\"") == nullptr) {
+                continue;
+            }
+            results.push_back({
+                    .objects = static_cast<uint32_t>(readNumber(line, "objects")),
+                    .framesInFlight = static_cast<uint32_t>(readNumber(line, "frames_in_flight")),
+                    .cpuMeanMs = readNumber(line, "cpu_mean_ms"),
+                    .cpuP50Ms = readNumber(line, "cpu_p50_ms"),
+                    .cpuP99Ms = readNumber(line, "cpu_p99_ms"),
+                    .cpuMaxMs = readNumber(line, "cpu_max_ms"),
+                    .waitMeanMs = readNumber(line, "wait_mean_ms"),
+                    .allocationsPerFrame = readNumber(line, "allocations_per_frame"),
+                    .vulkanCallsPerFrame = readNumber(line, "vulkan_calls_per_frame")
+            });
+        }
+        fclose(file);
+        return true;
+    }
+
+    /// Logs every configuration that got worse than its baseline, returns how many did
+    uint32_t compare(const std::vector<Result> &results, const std::vector<Result> &baseline,
+                     double tolerance) {
+        uint32_t regressions = 0;
+        for (const Result &result: results) {
+            const auto found = std::find_if(baseline.begin(), baseline.end(),
+                                            [&](const Result &base) {
+                                                return base.objects == result.objects &&
+                                                       base.framesInFlight ==
+                                                       result.framesInFlight;
+                                            });
+            if (found == baseline.end()) {
+                LOGW("No baseline for %u objects with %u frames in flight.", result.objects,
+                     result.framesInFlight);
+                continue;
+            }
+            const Result &base = *found;
+            const auto report = [&](const char *metric, double value, double baselineValue) {
+                LOGE("%u objects, %u in flight: %s %.4f, baseline %.4f", result.objects,
+                     result.framesInFlight, metric, value, baselineValue);
+                ++regressions;
+            };
+            // Counts are deterministic, any increase is a regression. Times get some slack.
+            // Comparisons with a value the baseline does not have, NaN, are false.
+            if (result.cpuMeanMs > base.cpuMeanMs * (1.0 + tolerance)) {
+                report("cpu_mean_ms", result.cpuMeanMs, base.cpuMeanMs);
+            }
+            if (result.cpuP50Ms > base.cpuP50Ms * (1.0 + tolerance)) {
+                report("cpu_p50_ms", result.cpuP50Ms, base.cpuP50Ms);
+            }
+            if (result.allocationsPerFrame > base.allocationsPerFrame + 0.005) {
+                report("allocations_per_frame", result.allocationsPerFrame,
+                       base.allocationsPerFrame);
+            }
+            if (result.vulkanCallsPerFrame > base.vulkanCallsPerFrame + 0.005) {
+                report("vulkan_calls_per_frame", result.vulkanCallsPerFrame,
+                       base.vulkanCallsPerFrame);
+            }
+        }
+        return regressions;
+    }
+
+    std::vector<uint32_t> parseList(const char *list) {
+        std::vector<uint32_t> values;
+        for (char *end; *list != '\0'; list = *end == ',' ? end + 1 : end) {
+            const auto value = static_cast<uint32_t>(strtoul(list, &end, 10));
+            if (end == list || value == 0) {
+                return {};
+            }
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    bool parseOptions(int argc, char **argv, Options &options) {
+        for (int i = 1; i < argc; ++i) {
+            const bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+                options.frames = std::max(1u, static_cast<uint32_t>(strtoul(argv[++i], nullptr,
+                                                                            10)));
+            } else if (strcmp(argv[i], "--warmup") == 0 && hasValue) {
+                options.warmupFrames = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            } else if (strcmp(argv[i], "--objects") == 0 && hasValue) {
+                options.objectCounts = parseList(argv[++i]);
+            } else if (strcmp(argv[i], "--in-flight") == 0 && hasValue) {
+                options.framesInFlight = parseList(argv[++i]);
+            } else if (strcmp(argv[i], "--gpu-latency") == 0 && hasValue) {
+                options.gpuLatencyMicroseconds =
+                        static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            } else if (strcmp(argv[i], "--driver") == 0) {
+                options.nullDriver = false;
+            } else if (strcmp(argv[i], "--dynamic-rendering") == 0) {
+                options.dynamicRendering = true;
+            } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+                options.baselinePath = argv[++i];
+            } else if (strcmp(argv[i], "--update-baseline") == 0) {
+                options.updateBaseline = true;
+            } else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+                options.tolerance = strtod(argv[++i], nullptr) / 100.0;
+            } else {
+                return false;
+            }
+        }
+        return !options.objectCounts.empty() && !options.framesInFlight.empty() &&
+               (!options.updateBaseline || options.baselinePath != nullptr);
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--frames N] [--warmup N] [--objects 1,100,1000] "
+                        "[--in-flight 1,2,3] [--gpu-latency US] [--driver] [--dynamic-rendering] "
+                        "[--baseline path [--update-baseline]] [--tolerance PERCENT]\n",
+                argv[0]);
+        return 1;
+    }
+
+    // The extensions and features TriangleApp enables for dynamic rendering
+    std::vector<const char *> extensions;
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
+            .pNext = nullptr,
+            .synchronization2 = VK_TRUE
+    };
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+            .pNext = &synchronization2Features,
+            .dynamicRendering = VK_TRUE
+    };
+    if (options.dynamicRendering) {
+        extensions = {
+                VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+                VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+                VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+                VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME
+        };
+    }
+
+    HeadlessDevice device;
+    const int loaded = options.nullDriver ? null_driver::install() : InitVulkan();
+    if (!loaded || !createHeadlessDevice(device, "frame_loop_bench", extensions, nullptr,
+                                         options.dynamicRendering ? &dynamicRenderingFeatures
+                                                                  : nullptr)) {
+        LOGE("Failed to create a Vulkan device.");
+        return 1;
+    }
+    if (options.nullDriver) {
+        null_driver::setFenceLatency(std::chrono::microseconds(options.gpuLatencyMicroseconds));
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device.gpu, &properties);
+
+    // Shaders are loaded by their asset paths, like the app does
+    const PosixFileBackend fileBackend{SHADER_ASSET_DIR};
+    ShaderModuleCache shaderModules;
+    shaderModules.init(device.device, &fileBackend);
+    LayoutCache layoutCache;
+    layoutCache.init(device.device);
+    PipelineCache pipelineCache;
+    if (!pipelineCache.init(device.gpu, device.device, "frame_loop_bench_cache.bin",
+                            device.creationFeedback)) {
+        return 1;
+    }
+    PipelineManager pipelineManager;
+    pipelineManager.init(device.device, &pipelineCache, 1);
+
+    const Shared shared{
+            .device = &device,
+            .shaderModules = &shaderModules,
+            .layoutCache = &layoutCache,
+            .pipelineManager = &pipelineManager,
+            .renderPass = options.dynamicRendering ? VK_NULL_HANDLE
+                                                   : createRenderPass(device.device)
+    };
+
+    std::vector<Result> results;
+    bool measured = true;
+    for (const uint32_t objects: options.objectCounts) {
+        for (const uint32_t framesInFlight: options.framesInFlight) {
+            Result result;
+            if (!measure(shared, options, objects, framesInFlight, result)) {
+                measured = false;
+                break;
+            }
+            results.push_back(result);
+        }
+    }
+
+    pipelineManager.teardown();
+    if (shared.renderPass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(device.device, shared.renderPass, nullptr);
+    }
+    shaderModules.teardown();
+    layoutCache.teardown();
+    pipelineCache.teardown();
+    destroyHeadlessDevice(device);
+    if (!measured) {
+        return 1;
+    }
+
+    writeResults(stdout, properties.deviceName, options, results);
+    if (options.baselinePath == nullptr) {
+        return 0;
+    }
+
+    if (options.updateBaseline) {
+        // Frame times of the null driver would only hold on this machine
+        std::vector<Result> baselineResults = results;
+        if (options.nullDriver) {
+            for (Result &result: baselineResults) {
+                result.cpuMeanMs = result.cpuP50Ms = result.cpuP99Ms = result.cpuMaxMs = NAN;
+                result.waitMeanMs = NAN;
+            }
+        }
+        FILE *file = fopen(options.baselinePath, "w");
+        if (file == nullptr) {
+            LOGE("Failed to write %s", options.baselinePath);
+            return 1;
+        }
+        writeResults(file, properties.deviceName, options, baselineResults);
+        fclose(file);
+        LOGI("Baseline written to %s", options.baselinePath);
+        return 0;
+    }
+
+    std::string baselineDevice;
+    std::string baselineRendering;
+    std::vector<Result> baseline;
+    if (!readBaseline(options.baselinePath, baselineDevice, baselineRendering, baseline)) {
+        LOGE("No baseline at %s, --update-baseline writes one.", options.baselinePath);
+        return 1;
+    }
+    if (baselineDevice != properties.deviceName) {
+        LOGW("Baseline is from %s, not comparing.", baselineDevice.c_str());
+        return 0;
+    }
+    if (baselineRendering != renderingName(options)) {
+        LOGW("Baseline is with %s, not comparing.", baselineRendering.c_str());
+        return 0;
+    }
+
+    const uint32_t regressions = compare(results, baseline, options.tolerance);
+    if (regressions > 0) {
+        LOGE("%u regressions against %s", regressions, options.baselinePath);
+        return 2;
+    }
+    LOGI("No regressions against %s", options.baselinePath);
+    return 0;
+}
@@ -0,0 +1,145 @@
+//
+// Created by eternal on 2024/6/8.
+//
+// Measures cold vs warm pipeline creation through PipelineManager and PipelineCache, the path the
+// app takes, without a window or a GPU, e.g. against lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json \
+//   ./pipeline_cache_bench [cache file]
+// The triangle shaders are taken from the build's SPIR-V output directory.
+//
+#include <cstdio>
+#include <string>
+#include "Debug.hh"
+#include "FileBackend.hh"
+#include "HeadlessDevice.hh"
+#include "PipelineCache.hh"
+#include "PipelineManager.hh"
+#include "ShaderModuleCache.hh"
+#include "shader_layouts/triangle.layout.hh"
+
+namespace {
+    /**
+     * @brief Requests the pipeline through a fresh PipelineCache and PipelineManager
+     *
+     * This is what the app does on every launch: the cache is loaded from disk, the pipeline is
+     * compiled on a worker with its own cache and the worker caches are merged before saving.
+     */
+    PipelineCache::Statistics createPipeline(const HeadlessDevice &device,
+                                             const std::string &cachePath,
+                                             const GraphicsPipelineState &state) {
+        PipelineCache cache;
+        if (!cache.init(device.gpu, device.device, cachePath, device.creationFeedback)) {
+            return {};
+        }
+
+        PipelineManager pipelineManager;
+        pipelineManager.init(device.device, &cache, 1);
+        if (pipelineManager.request(state).get() == VK_NULL_HANDLE) {
+            LOGE("Failed to create the triangle pipeline.");
+        }
+        pipelineManager.teardown();
+
+        const PipelineCache::Statistics statistics = cache.getStatistics();
+        cache.teardown();
+        return statistics;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [cache file]\n", argv[0]);
+        return 1;
+    }
+    const std::string cachePath = argc > 1 ? argv[1] : "pipeline_cache.bin";
+
+    HeadlessDevice device;
+    if (!InitVulkan() || !createHeadlessDevice(device, "pipeline_cache_bench")) {
+        LOGE("Failed to create a Vulkan device.");
+        return 1;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device.gpu, &properties);
+    LOGI("Device: %s", properties.deviceName);
+
+    const PosixFileBackend fileBackend{SHADER_OUTPUT_DIR};
+    ShaderModuleCache shaderModules;
+    shaderModules.init(device.device, &fileBackend);
+    const VkShaderModule vertexShader = shaderModules.load("triangle.vert.spv");
+    const VkShaderModule fragmentShader = shaderModules.load("triangle.frag.spv");
+    if (vertexShader == VK_NULL_HANDLE || fragmentShader == VK_NULL_HANDLE) {
+        return 1;
+    }
+
+    const VkAttachmentDescription attachment{
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+    };
+    const VkAttachmentReference colorReference{
+            .attachment = 0,
+            .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+    };
+    const VkSubpassDescription subpass{
+            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &colorReference
+    };
+    const VkRenderPassCreateInfo renderPassCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+            .attachmentCount = 1,
+            .pAttachments = &attachment,
+            .subpassCount = 1,
+            .pSubpasses = &subpass
+    };
+    VkRenderPass renderPass;
+    CALL_VK(vkCreateRenderPass(device.device, &renderPassCreateInfo, nullptr, &renderPass))
+
+    const auto &pushConstantRanges = shader_layouts::triangle::pushConstantRanges;
+    const VkPipelineLayoutCreateInfo layoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+            .pPushConstantRanges = pushConstantRanges.data()
+    };
+    VkPipelineLayout pipelineLayout;
+    CALL_VK(vkCreatePipelineLayout(device.device, &layoutCreateInfo, nullptr, &pipelineLayout))
+
+    const auto &vertexAttributes = shader_layouts::triangle::vertexAttributes;
+    const GraphicsPipelineState state{
+            .vertexShader = vertexShader,
+            .fragmentShader = fragmentShader,
+            .vertexBindings {
+                    {
+                            .binding = 0,
+                            .stride = shader_layouts::triangle::vertexStride,
+                            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+                    }
+            },
+            .vertexAttributes {vertexAttributes.begin(), vertexAttributes.end()},
+            .layout = pipelineLayout,
+            .renderPass = renderPass
+    };
+
+    remove(cachePath.c_str());
+    const PipelineCache::Statistics cold = createPipeline(device, cachePath, state);
+    const PipelineCache::Statistics warm = createPipeline(device, cachePath, state);
+    if (cold.pipelineCount == 0 || warm.pipelineCount == 0) {
+        return 1;
+    }
+    // Hits are only known with VK_EXT_pipeline_creation_feedback, -1 without
+    printf("{\"device\": \"%s\", \"cold_ms\": %.3f, \"warm_ms\": %.3f, "
+           "\"warm_cache_hits\": %d}\n",
+           properties.deviceName, cold.totalCreationMs, warm.totalCreationMs,
+           warm.feedbackCount > 0 ? static_cast<int>(warm.cacheHits) : -1);
+
+    vkDestroyPipelineLayout(device.device, pipelineLayout, nullptr);
+    vkDestroyRenderPass(device.device, renderPass, nullptr);
+    shaderModules.teardown();
+    destroyHeadlessDevice(device);
+    return 0;
+}
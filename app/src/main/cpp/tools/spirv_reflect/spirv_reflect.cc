@@ -0,0 +1,703 @@
+//
+// Created by eternal on 2024/6/22.
+//
+// Reflects the SPIR-V stages of one shader program and writes a header with its pipeline
+// interface as constexpr Vulkan structs:
+//   spirv_reflect <program name> <output header> <stage.spv>...
+// The vertex stage inputs become vertex attributes, interleaved in location order in binding 0.
+// Push constant blocks and descriptor bindings are merged across stages. A fragment input without
+// a matching vertex output fails the build. Specialization constants are listed by name with their
+// default values.
+//
+// Only the standard library is used, so the tool can be built for the host while the renderer is
+// cross compiled.
+//
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // The subset of the SPIR-V specification used below
+    constexpr uint32_t spirvMagic = 0x07230203;
+
+    enum Op : uint32_t {
+        OpName = 5,
+        OpEntryPoint = 15,
+        OpTypeVoid = 19,
+        OpTypeBool = 20,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpTypeForwardPointer = 39,
+        OpConstant = 43,
+        OpSpecConstantTrue = 48,
+        OpSpecConstantFalse = 49,
+        OpSpecConstant = 50,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+    };
+
+    enum Decoration : uint32_t {
+        DecorationSpecId = 1,
+        DecorationBlock = 2,
+        DecorationBufferBlock = 3,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBuiltIn = 11,
+        DecorationLocation = 30,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35,
+    };
+
+    enum StorageClass : uint32_t {
+        StorageClassUniformConstant = 0,
+        StorageClassInput = 1,
+        StorageClassUniform = 2,
+        StorageClassOutput = 3,
+        StorageClassPushConstant = 9,
+        StorageClassStorageBuffer = 12,
+    };
+
+    enum ExecutionModel : uint32_t {
+        ExecutionModelVertex = 0,
+        ExecutionModelFragment = 4,
+        ExecutionModelGLCompute = 5,
+    };
+
+    constexpr uint32_t imageDimBuffer = 5;
+
+    // VkShaderStageFlagBits
+    constexpr uint32_t vertexStageBit = 0x1;
+    constexpr uint32_t fragmentStageBit = 0x10;
+    constexpr uint32_t computeStageBit = 0x20;
+
+    struct Type {
+        uint32_t opcode;
+
+        /// Operands following the result id
+        std::vector<uint32_t> operands;
+    };
+
+    struct Variable {
+        uint32_t id;
+
+        uint32_t pointerType;
+
+        uint32_t storageClass;
+    };
+
+    using Decorations = std::unordered_map<uint32_t, uint32_t>;
+
+    struct Module {
+        std::string path;
+
+        std::optional<uint32_t> executionModel;
+
+        std::unordered_map<uint32_t, Type> types;
+
+        std::unordered_map<uint32_t, uint32_t> constants;
+
+        /// Result id -> default value of the specialization constants
+        std::map<uint32_t, uint32_t> specConstants;
+
+        std::unordered_map<uint32_t, std::string> names;
+
+        std::unordered_map<uint32_t, Decorations> decorations;
+
+        std::map<std::pair<uint32_t, uint32_t>, Decorations> memberDecorations;
+
+        std::vector<Variable> variables;
+
+        std::optional<uint32_t> decoration(uint32_t id, uint32_t decoration) const {
+            const auto it = decorations.find(id);
+            if (it == decorations.end() || !it->second.contains(decoration)) {
+                return std::nullopt;
+            }
+            return it->second.at(decoration);
+        }
+
+        std::optional<uint32_t>
+        memberDecoration(uint32_t structId, uint32_t member, uint32_t decoration) const {
+            const auto it = memberDecorations.find({structId, member});
+            if (it == memberDecorations.end() || !it->second.contains(decoration)) {
+                return std::nullopt;
+            }
+            return it->second.at(decoration);
+        }
+
+        const Type &type(uint32_t id) const {
+            return types.at(id);
+        }
+
+        /// Type a variable points to
+        uint32_t pointee(const Variable &variable) const {
+            return type(variable.pointerType).operands[1];
+        }
+    };
+
+    struct Attribute {
+        uint32_t location;
+
+        std::string format;
+
+        uint32_t size;
+    };
+
+    struct DescriptorBinding {
+        uint32_t set;
+
+        uint32_t binding;
+
+        std::string descriptorType;
+
+        uint32_t descriptorCount;
+
+        uint32_t stages;
+
+        uint32_t blockSize;
+    };
+
+    struct PushConstantRange {
+        uint32_t offset;
+
+        uint32_t size;
+
+        uint32_t stages;
+    };
+
+    /// A vertex output or fragment input
+    struct InterfaceVariable {
+        /// e.g. "f32x4"
+        std::string signature;
+
+        /// Signature of one component of a scalar or vector, the whole type otherwise
+        std::string componentSignature;
+
+        uint32_t componentCount;
+    };
+
+    struct SpecializationConstant {
+        std::string name;
+
+        uint32_t defaultValue;
+    };
+
+    struct Program {
+        /// By constant_id
+        std::map<uint32_t, SpecializationConstant> specializationConstants;
+
+        std::vector<Attribute> attributes;
+
+        std::map<std::pair<uint32_t, uint32_t>, DescriptorBinding> descriptorBindings;
+
+        std::optional<PushConstantRange> pushConstants;
+
+        /// Location -> type of the vertex outputs and fragment inputs
+        std::map<uint32_t, InterfaceVariable> vertexOutputs;
+
+        std::map<uint32_t, InterfaceVariable> fragmentInputs;
+    };
+
+    [[noreturn]] void fail(const std::string &message) {
+        fprintf(stderr, "spirv_reflect: error: %s\n", message.c_str());
+        exit(1);
+    }
+
+    Module parse(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            fail("cannot open " + path);
+        }
+        const std::string bytes((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+        if (bytes.size() < 5 * sizeof(uint32_t) || bytes.size() % sizeof(uint32_t) != 0) {
+            fail(path + " is not a SPIR-V module");
+        }
+        std::vector<uint32_t> words(bytes.size() / sizeof(uint32_t));
+        std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char *>(words.data()));
+        if (words[0] != spirvMagic) {
+            fail(path + " is not a SPIR-V module");
+        }
+
+        Module module;
+        module.path = path;
+        for (size_t i = 5; i < words.size();) {
+            const uint32_t wordCount = words[i] >> 16;
+            const uint32_t opcode = words[i] & 0xffff;
+            if (wordCount == 0 || i + wordCount > words.size()) {
+                fail(path + " is truncated");
+            }
+            const uint32_t *operands = &words[i + 1];
+
+            if (opcode == OpEntryPoint && !module.executionModel) {
+                module.executionModel = operands[0];
+            } else if (opcode >= OpTypeVoid && opcode <= OpTypeForwardPointer) {
+                module.types[operands[0]] = {
+                        .opcode = opcode,
+                        .operands {operands + 1, operands + wordCount - 1}
+                };
+            } else if (opcode == OpConstant) {
+                module.constants[operands[1]] = operands[2];
+            } else if (opcode == OpSpecConstantTrue || opcode == OpSpecConstantFalse) {
+                module.specConstants[operands[1]] = opcode == OpSpecConstantTrue ? 1 : 0;
+            } else if (opcode == OpSpecConstant) {
+                module.specConstants[operands[1]] = operands[2];
+            } else if (opcode == OpName) {
+                module.names[operands[0]] = reinterpret_cast<const char *>(operands + 1);
+            } else if (opcode == OpVariable) {
+                module.variables.push_back({
+                        .id = operands[1],
+                        .pointerType = operands[0],
+                        .storageClass = operands[2]
+                });
+            } else if (opcode == OpDecorate) {
+                module.decorations[operands[0]][operands[1]] = wordCount > 3 ? operands[2] : 0;
+            } else if (opcode == OpMemberDecorate) {
+                module.memberDecorations[{operands[0], operands[1]}][operands[2]] =
+                        wordCount > 4 ? operands[3] : 0;
+            }
+            i += wordCount;
+        }
+
+        if (!module.executionModel) {
+            fail(path + " has no entry point");
+        }
+        return module;
+    }
+
+    uint32_t sizeOf(const Module &module, uint32_t typeId,
+                    std::optional<uint32_t> matrixStride = std::nullopt) {
+        const Type &type = module.type(typeId);
+        switch (type.opcode) {
+            case OpTypeBool:
+                return 4;
+            case OpTypeInt:
+            case OpTypeFloat:
+                return type.operands[0] / 8;
+            case OpTypeVector:
+                return type.operands[1] * sizeOf(module, type.operands[0]);
+            case OpTypeMatrix:
+                return type.operands[1] *
+                       matrixStride.value_or(sizeOf(module, type.operands[0]));
+            case OpTypeArray: {
+                const uint32_t length = module.constants.at(type.operands[1]);
+                const auto stride = module.decoration(typeId, DecorationArrayStride);
+                return length * stride.value_or(sizeOf(module, type.operands[0]));
+            }
+            case OpTypeStruct: {
+                uint32_t size = 0;
+                for (uint32_t member = 0; member < type.operands.size(); ++member) {
+                    const uint32_t memberSize = sizeOf(
+                            module, type.operands[member],
+                            module.memberDecoration(typeId, member, DecorationMatrixStride));
+                    const auto offset = module.memberDecoration(typeId, member, DecorationOffset);
+                    size = offset ? std::max(size, *offset + memberSize) : size + memberSize;
+                }
+                return size;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    /// Describes a type for interface matching, e.g. "f32x4"
+    std::string signature(const Module &module, uint32_t typeId) {
+        const Type &type = module.type(typeId);
+        switch (type.opcode) {
+            case OpTypeBool:
+                return "b";
+            case OpTypeInt:
+                return (type.operands[1] ? "i" : "u") + std::to_string(type.operands[0]);
+            case OpTypeFloat:
+                return "f" + std::to_string(type.operands[0]);
+            case OpTypeVector:
+            case OpTypeMatrix:
+                return signature(module, type.operands[0]) + "x" + std::to_string(type.operands[1]);
+            case OpTypeArray:
+                return signature(module, type.operands[0]) + "[" +
+                       std::to_string(module.constants.at(type.operands[1])) + "]";
+            case OpTypeStruct: {
+                std::string result = "{";
+                for (const uint32_t member: type.operands) {
+                    result += signature(module, member) + ",";
+                }
+                return result + "}";
+            }
+            default:
+                return "?";
+        }
+    }
+
+    InterfaceVariable interfaceVariable(const Module &module, uint32_t typeId) {
+        const Type &type = module.type(typeId);
+        if (type.opcode == OpTypeVector) {
+            return {
+                    .signature = signature(module, typeId),
+                    .componentSignature = signature(module, type.operands[0]),
+                    .componentCount = type.operands[1]
+            };
+        }
+        return {
+                .signature = signature(module, typeId),
+                .componentSignature = signature(module, typeId),
+                .componentCount = 1
+        };
+    }
+
+    /// Matching VkFormat of a vertex input, empty if there is none
+    std::string vertexFormat(const Module &module, uint32_t typeId) {
+        const Type &type = module.type(typeId);
+        uint32_t componentCount = 1;
+        const Type *component = &type;
+        if (type.opcode == OpTypeVector) {
+            componentCount = type.operands[1];
+            component = &module.type(type.operands[0]);
+        }
+
+        const uint32_t width = component->operands[0];
+        std::string numericFormat;
+        if (component->opcode == OpTypeFloat && (width == 16 || width == 32)) {
+            numericFormat = "SFLOAT";
+        } else if (component->opcode == OpTypeInt && (width == 16 || width == 32)) {
+            numericFormat = component->operands[1] ? "SINT" : "UINT";
+        } else {
+            return {};
+        }
+
+        std::string format = "VK_FORMAT_";
+        const char *channels = "RGBA";
+        for (uint32_t i = 0; i < componentCount; ++i) {
+            format += channels[i] + std::to_string(width);
+        }
+        return format + "_" + numericFormat;
+    }
+
+    std::string descriptorType(const Module &module, const Variable &variable, uint32_t typeId) {
+        const Type &type = module.type(typeId);
+        if (variable.storageClass == StorageClassStorageBuffer ||
+            (variable.storageClass == StorageClassUniform &&
+             module.decoration(typeId, DecorationBufferBlock))) {
+            return "VK_DESCRIPTOR_TYPE_STORAGE_BUFFER";
+        }
+        if (variable.storageClass == StorageClassUniform) {
+            return "VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER";
+        }
+        switch (type.opcode) {
+            case OpTypeSampler:
+                return "VK_DESCRIPTOR_TYPE_SAMPLER";
+            case OpTypeSampledImage:
+                return "VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER";
+            case OpTypeImage: {
+                // Operands: sampled type, dim, depth, arrayed, ms, sampled, format
+                const bool storage = type.operands[5] == 2;
+                if (type.operands[1] == imageDimBuffer) {
+                    return storage ? "VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER"
+                                   : "VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER";
+                }
+                return storage ? "VK_DESCRIPTOR_TYPE_STORAGE_IMAGE"
+                               : "VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE";
+            }
+            default:
+                fail(module.path + ": unsupported descriptor type of variable " +
+                     std::to_string(variable.id));
+        }
+    }
+
+    bool isBuiltIn(const Module &module, const Variable &variable) {
+        if (module.decoration(variable.id, DecorationBuiltIn)) {
+            return true;
+        }
+        // Built-in blocks such as gl_PerVertex decorate their members instead
+        const uint32_t typeId = module.pointee(variable);
+        return module.type(typeId).opcode == OpTypeStruct &&
+               module.memberDecoration(typeId, 0, DecorationBuiltIn).has_value();
+    }
+
+    uint32_t stageBit(uint32_t executionModel) {
+        switch (executionModel) {
+            case ExecutionModelVertex:
+                return vertexStageBit;
+            case ExecutionModelFragment:
+                return fragmentStageBit;
+            case ExecutionModelGLCompute:
+                return computeStageBit;
+            default:
+                fail("unsupported execution model " + std::to_string(executionModel));
+        }
+    }
+
+    std::string stageFlags(uint32_t stages) {
+        const std::pair<uint32_t, const char *> names[] = {
+                {vertexStageBit,   "VK_SHADER_STAGE_VERTEX_BIT"},
+                {fragmentStageBit, "VK_SHADER_STAGE_FRAGMENT_BIT"},
+                {computeStageBit,  "VK_SHADER_STAGE_COMPUTE_BIT"},
+        };
+        std::string result;
+        for (const auto &[bit, name]: names) {
+            if (stages & bit) {
+                result += (result.empty() ? "" : " | ") + std::string(name);
+            }
+        }
+        return result;
+    }
+
+    void reflect(const Module &module, Program &program) {
+        const uint32_t stage = stageBit(*module.executionModel);
+        for (const auto &[id, defaultValue]: module.specConstants) {
+            const auto constantId = module.decoration(id, DecorationSpecId);
+            if (!constantId) {
+                continue;
+            }
+            const SpecializationConstant constant{
+                    .name = module.names.contains(id) ? module.names.at(id)
+                                                      : "constant" + std::to_string(*constantId),
+                    .defaultValue = defaultValue
+            };
+            const auto [it, inserted] = program.specializationConstants.emplace(*constantId,
+                                                                                constant);
+            if (!inserted && (it->second.name != constant.name ||
+                              it->second.defaultValue != constant.defaultValue)) {
+                fail(module.path + ": constant_id " + std::to_string(*constantId) +
+                     " is declared differently by another stage");
+            }
+        }
+
+        for (const Variable &variable: module.variables) {
+            const uint32_t typeId = module.pointee(variable);
+            switch (variable.storageClass) {
+                case StorageClassInput:
+                case StorageClassOutput: {
+                    const auto location = module.decoration(variable.id, DecorationLocation);
+                    if (isBuiltIn(module, variable) || !location) {
+                        break;
+                    }
+                    const bool input = variable.storageClass == StorageClassInput;
+                    if (stage == vertexStageBit && input) {
+                        const std::string format = vertexFormat(module, typeId);
+                        if (format.empty()) {
+                            fail(module.path + ": unsupported vertex input type at location " +
+                                 std::to_string(*location));
+                        }
+                        program.attributes.push_back({
+                                .location = *location,
+                                .format = format,
+                                .size = sizeOf(module, typeId)
+                        });
+                    } else if (stage == vertexStageBit) {
+                        program.vertexOutputs[*location] = interfaceVariable(module, typeId);
+                    } else if (stage == fragmentStageBit && input) {
+                        program.fragmentInputs[*location] = interfaceVariable(module, typeId);
+                    }
+                    break;
+                }
+                case StorageClassPushConstant: {
+                    const Type &block = module.type(typeId);
+                    uint32_t offset = sizeOf(module, typeId);
+                    for (uint32_t member = 0; member < block.operands.size(); ++member) {
+                        offset = std::min(offset, module.memberDecoration(
+                                typeId, member, DecorationOffset).value_or(0));
+                    }
+                    const uint32_t end = sizeOf(module, typeId);
+                    auto &range = program.pushConstants;
+                    if (range) {
+                        const uint32_t rangeEnd = std::max(range->offset + range->size, end);
+                        range->offset = std::min(range->offset, offset);
+                        range->size = rangeEnd - range->offset;
+                        range->stages |= stage;
+                    } else {
+                        range = PushConstantRange{
+                                .offset = offset,
+                                .size = end - offset,
+                                .stages = stage
+                        };
+                    }
+                    break;
+                }
+                case StorageClassUniformConstant:
+                case StorageClassUniform:
+                case StorageClassStorageBuffer: {
+                    uint32_t descriptorCount = 1;
+                    uint32_t resourceType = typeId;
+                    if (module.type(typeId).opcode == OpTypeArray) {
+                        descriptorCount = module.constants.at(module.type(typeId).operands[1]);
+                        resourceType = module.type(typeId).operands[0];
+                    } else if (module.type(typeId).opcode == OpTypeRuntimeArray) {
+                        // Sized by the set layout, e.g. the arrays of BindlessDescriptors
+                        descriptorCount = 0;
+                        resourceType = module.type(typeId).operands[0];
+                    }
+
+                    DescriptorBinding binding{
+                            .set = module.decoration(variable.id, DecorationDescriptorSet)
+                                    .value_or(0),
+                            .binding = module.decoration(variable.id, DecorationBinding)
+                                    .value_or(0),
+                            .descriptorType = descriptorType(module, variable, resourceType),
+                            .descriptorCount = descriptorCount,
+                            .stages = stage,
+                            .blockSize = variable.storageClass == StorageClassUniformConstant
+                                         ? 0 : sizeOf(module, resourceType)
+                    };
+
+                    const auto key = std::make_pair(binding.set, binding.binding);
+                    const auto it = program.descriptorBindings.find(key);
+                    if (it == program.descriptorBindings.end()) {
+                        program.descriptorBindings.emplace(key, binding);
+                    } else if (it->second.descriptorType != binding.descriptorType ||
+                               it->second.descriptorCount != binding.descriptorCount) {
+                        fail(module.path + ": set " + std::to_string(binding.set) +
+                             " binding " + std::to_string(binding.binding) +
+                             " is declared differently by another stage");
+                    } else {
+                        it->second.stages |= stage;
+                        it->second.blockSize = std::max(it->second.blockSize, binding.blockSize);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+
+    /// Vulkan lets an output have more components than the input reads, the types match otherwise
+    bool isCompatible(const InterfaceVariable &output, const InterfaceVariable &input) {
+        const bool scalarOrVector = output.componentSignature.find_first_of("x[{") ==
+                                    std::string::npos;
+        return output.signature == input.signature ||
+               (scalarOrVector && output.componentSignature == input.componentSignature &&
+                output.componentCount >= input.componentCount);
+    }
+
+    void checkStageInterface(const Program &program) {
+        for (const auto &[location, input]: program.fragmentInputs) {
+            const auto it = program.vertexOutputs.find(location);
+            if (it == program.vertexOutputs.end()) {
+                fail("fragment input at location " + std::to_string(location) +
+                     " is not written by the vertex stage");
+            }
+            if (!isCompatible(it->second, input)) {
+                fail("fragment input at location " + std::to_string(location) + " is " +
+                     input.signature + " but the vertex stage writes " + it->second.signature);
+            }
+        }
+    }
+
+    std::string generate(const std::string &name, const Program &program,
+                         const std::vector<std::string> &inputs) {
+        std::string guard = "LEARNINGVULKAN_" + name + "_LAYOUT_HH";
+        std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) {
+            return std::isalnum(c) ? std::toupper(c) : '_';
+        });
+
+        std::ostringstream out;
+        out << "//\n// Generated by spirv_reflect from";
+        for (const auto &input: inputs) {
+            out << " " << input.substr(input.find_last_of("/\\") + 1);
+        }
+        out << ", do not edit.\n//\n\n"
+            << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+            << "#include <array>\n#include \"ShaderLayout.hh\"\n\n"
+            << "namespace shader_layouts::" << name << " {\n";
+
+        uint32_t vertexStride = 0;
+        out << "    /// Vertex inputs, interleaved in location order in binding 0\n"
+            << "    constexpr std::array<VkVertexInputAttributeDescription, "
+            << program.attributes.size() << "> vertexAttributes{{\n";
+        for (const auto &attribute: program.attributes) {
+            out << "            {.location = " << attribute.location
+                << ", .binding = 0, .format = " << attribute.format
+                << ", .offset = " << vertexStride << "},\n";
+            vertexStride += attribute.size;
+        }
+        out << "    }};\n\n"
+            << "    constexpr uint32_t vertexStride = " << vertexStride << ";\n\n";
+
+        out << "    constexpr std::array<VkPushConstantRange, "
+            << (program.pushConstants ? 1 : 0) << "> pushConstantRanges{{\n";
+        if (program.pushConstants) {
+            out << "            {.stageFlags = " << stageFlags(program.pushConstants->stages)
+                << ", .offset = " << program.pushConstants->offset
+                << ", .size = " << program.pushConstants->size << "},\n";
+        }
+        out << "    }};\n\n";
+
+        out << "    constexpr std::array<ShaderDescriptorBinding, "
+            << program.descriptorBindings.size() << "> descriptorBindings{{\n";
+        for (const auto &[key, binding]: program.descriptorBindings) {
+            out << "            {.set = " << binding.set
+                << ", .binding = " << binding.binding
+                << ", .descriptorType = " << binding.descriptorType
+                << ", .descriptorCount = " << binding.descriptorCount
+                << ", .stageFlags = " << stageFlags(binding.stages)
+                << ", .blockSize = " << binding.blockSize << "},\n";
+        }
+        out << "    }};\n\n";
+
+        // Ids without a declaration keep 0, they do not affect the pipeline
+        const uint32_t specializationCount = program.specializationConstants.empty()
+                                             ? 0 : program.specializationConstants.rbegin()->first + 1;
+        std::vector<uint32_t> defaults(specializationCount, 0);
+        out << "    /// Specialization constant ids, see ShaderVariants\n"
+            << "    namespace specialization {\n";
+        for (const auto &[constantId, constant]: program.specializationConstants) {
+            out << "        constexpr uint32_t " << constant.name << " = " << constantId << ";\n";
+            defaults[constantId] = constant.defaultValue;
+        }
+        out << "    }\n\n"
+            << "    constexpr std::array<uint32_t, " << specializationCount
+            << "> specializationDefaults{{";
+        for (uint32_t i = 0; i < specializationCount; ++i) {
+            out << (i ? ", " : "") << defaults[i];
+        }
+        out << "}};\n"
+            << "}\n\n#endif //" << guard << "\n";
+        return out.str();
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <program name> <output header> <stage.spv>...\n", argv[0]);
+        return 1;
+    }
+
+    const std::string name = argv[1];
+    const std::string outputPath = argv[2];
+    const std::vector<std::string> inputs(argv + 3, argv + argc);
+
+    Program program;
+    for (const auto &input: inputs) {
+        reflect(parse(input), program);
+    }
+    std::sort(program.attributes.begin(), program.attributes.end(),
+              [](const Attribute &a, const Attribute &b) { return a.location < b.location; });
+    checkStageInterface(program);
+
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    output << generate(name, program, inputs);
+    if (!output) {
+        fail("cannot write " + outputPath);
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+#version 320 es
+// Reads integers where wide_output.vert writes floats, which has to fail
+
+precision mediump float;
+
+layout (location = 0) flat in ivec2 in_color;
+layout (location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = vec4(vec2(in_color), 0.0, 1.0);
+}
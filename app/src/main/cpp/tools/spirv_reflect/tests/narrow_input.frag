@@ -0,0 +1,12 @@
+#version 320 es
+// Reads two of the four components wide_output.vert writes
+
+precision mediump float;
+
+layout (location = 0) in vec2 in_color;
+layout (location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = vec4(in_color, 0.0, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 320 es
+// Writes more components than narrow_input.frag reads, which Vulkan allows
+
+layout (location = 0) in vec2 in_position;
+layout (location = 0) out vec4 out_color;
+
+void main()
+{
+    gl_Position = vec4(in_position, 0.0, 1.0);
+
+    out_color = vec4(in_position, 0.0, 1.0);
+}
@@ -0,0 +1,788 @@
+//
+// Created by eternal on 2024/7/10.
+//
+// Replays a trace written by vulkan_capture and reports the CPU time of every frame, e.g. against
+// lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json \
+//   ./trace_replay capture.lvtrace [--loops N] [--null] [--trace replay.json]
+// --loops replays the captured frames N times after a single setup, --null replays against the
+// null driver, which leaves only the CPU cost of recording and submission. --trace writes the
+// profiler zones of the replay as a Chrome trace.
+//
+// Frame time is the time spent in the replayed calls between two presents, without decoding the
+// trace and without fence and idle waits, which are reported separately. There is no surface,
+// swapchain images are plain images, acquiring signals the semaphore and fence with an empty
+// submission and presenting waits for the semaphores the same way.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+#include "CpuProfiler.hh"
+#include "Debug.hh"
+#include "FileBackend.hh"
+#include "HeadlessDevice.hh"
+#include "NullDriver.hh"
+#include "VulkanTrace.hh"
+
+using namespace vulkan_trace;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        const char *path = nullptr;
+
+        uint32_t loops = 1;
+
+        bool nullDriver = false;
+
+        const char *tracePath = nullptr;
+    };
+
+    struct FrameTiming {
+        double cpuMs;
+
+        double waitMs;
+
+        VkDeviceSize uploadBytes;
+    };
+
+    class Replayer {
+    public:
+        explicit Replayer(const HeadlessDevice &headless) : device(headless.device),
+                                                            queue(headless.queue) {
+            vkGetPhysicalDeviceMemoryProperties(headless.gpu, &memoryProperties);
+        }
+
+        /// Decodes and replays the current record, false if it can't be read
+        bool replay(TraceReader &reader, Record type) {
+            switch (type) {
+#define REPLAY_CALL(function, call) \
+                case Record::call: \
+                    return replayCall<call>(reader);
+                VK_TRACE_CALLS(REPLAY_CALL)
+#undef REPLAY_CALL
+                case Record::MemoryWrite:
+                    return replayCall<MemoryWrite>(reader);
+                case Record::DeviceInfo:
+                case Record::FramesBegin:
+                    return true;
+                default:
+                    LOGE("Trace has records of unknown type %u.", static_cast<uint32_t>(type));
+                    return false;
+            }
+        }
+
+        /// Timing since the last frame ended
+        FrameTiming endFrame() {
+            const FrameTiming timing{
+                    .cpuMs = toMilliseconds(callTime - waitTime),
+                    .waitMs = toMilliseconds(waitTime),
+                    .uploadBytes = uploadBytes
+            };
+            callTime = {};
+            waitTime = {};
+            uploadBytes = 0;
+            return timing;
+        }
+
+        /// Waits on fences that were never submitted in the replay
+        uint32_t getSkippedWaitCount() const {
+            return skippedWaitCount;
+        }
+
+    private:
+        struct Allocation {
+            uint32_t memoryTypeIndex;
+
+            VkDeviceSize size;
+
+            /// Host visible memory stays mapped for the memory writes of the trace
+            uint8_t *mapped;
+        };
+
+        struct FenceState {
+            bool signaled;
+
+            /// Submitted since the last reset
+            bool pending;
+        };
+
+        struct Swapchain {
+            VkFormat format;
+
+            VkExtent2D extent;
+
+            uint32_t arrayLayers;
+
+            VkImageUsageFlags usage;
+
+            std::vector<VkImage> images;
+
+            std::vector<VkDeviceMemory> memory;
+        };
+
+        VkDevice device;
+
+        VkQueue queue;
+
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+
+        std::unordered_map<VkDeviceMemory, Allocation> allocations;
+
+        std::unordered_map<VkFence, FenceState> fences;
+
+        std::unordered_map<VkSwapchainKHR, Swapchain> swapchains;
+
+        uint64_t nextSwapchain = 1;
+
+        std::unordered_map<VkDescriptorUpdateTemplate,
+                std::vector<VkDescriptorUpdateTemplateEntry>> templates;
+
+        Clock::duration callTime{};
+
+        Clock::duration waitTime{};
+
+        VkDeviceSize uploadBytes = 0;
+
+        uint32_t skippedWaitCount = 0;
+
+        static double toMilliseconds(Clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        template<typename Call>
+        bool replayCall(TraceReader &reader) {
+            Call call{};
+            serialize(reader, call);
+            if (!reader.ok()) {
+                LOGE("Trace has a malformed record of type %u.",
+                     static_cast<uint32_t>(recordOf<Call>));
+                return false;
+            }
+            const Clock::time_point start = Clock::now();
+            execute(call);
+            callTime += Clock::now() - start;
+            reader.bindOutputs();
+            return true;
+        }
+
+        /// Prefers a type with all the flags, then a host visible one if that was asked for
+        uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags flags) const {
+            const VkMemoryPropertyFlags fallbacks[]{
+                    flags,
+                    flags & (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+                    flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                    0
+            };
+            for (const VkMemoryPropertyFlags required: fallbacks) {
+                for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+                    const VkMemoryPropertyFlags available =
+                            memoryProperties.memoryTypes[i].propertyFlags;
+                    if ((typeBits & (1u << i)) != 0 && (available & required) == required) {
+                        return i;
+                    }
+                }
+            }
+            return 0;
+        }
+
+        void checkBinding(const VkMemoryRequirements &requirements, VkDeviceMemory memory,
+                          VkDeviceSize offset) const {
+            const auto allocation = allocations.find(memory);
+            if (allocation == allocations.end()) {
+                return;
+            }
+            const bool typeFits =
+                    (requirements.memoryTypeBits & (1u << allocation->second.memoryTypeIndex)) != 0;
+            if (!typeFits || offset + requirements.size > allocation->second.size) {
+                LOGW("Memory bound at offset %llu does not fit the requirements of this device.",
+                     static_cast<unsigned long long>(offset));
+            }
+        }
+
+        /// Signals or waits through an empty submission, in place of the presentation engine
+        void submitEmpty(uint32_t waitSemaphoreCount, const VkSemaphore *waitSemaphores,
+                         VkSemaphore signalSemaphore, VkFence fence) {
+            const std::vector<VkPipelineStageFlags> waitStages(
+                    waitSemaphoreCount, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+            const VkSubmitInfo submitInfo{
+                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                    .pNext = nullptr,
+                    .waitSemaphoreCount = waitSemaphoreCount,
+                    .pWaitSemaphores = waitSemaphores,
+                    .pWaitDstStageMask = waitStages.data(),
+                    .commandBufferCount = 0,
+                    .pCommandBuffers = nullptr,
+                    .signalSemaphoreCount = signalSemaphore != VK_NULL_HANDLE ? 1u : 0u,
+                    .pSignalSemaphores = &signalSemaphore
+            };
+            vkQueueSubmit(queue, 1, &submitInfo, fence);
+            markSubmitted(fence);
+        }
+
+        void markSubmitted(VkFence fence) {
+            if (fence != VK_NULL_HANDLE) {
+                fences[fence].pending = true;
+            }
+        }
+
+        void markIdle() {
+            for (auto &[fence, state]: fences) {
+                if (state.pending) {
+                    state = {.signaled = true, .pending = false};
+                }
+            }
+        }
+
+        /* Memory */
+
+        void execute(MemoryWrite &call) {
+            const auto allocation = allocations.find(call.memory);
+            if (allocation == allocations.end() || allocation->second.mapped == nullptr ||
+                call.offset + call.size > allocation->second.size) {
+                LOGW("Memory write of %llu bytes does not fit the replay's memory.",
+                     static_cast<unsigned long long>(call.size));
+                return;
+            }
+            memcpy(allocation->second.mapped + call.offset, call.pData, call.size);
+            uploadBytes += call.size;
+        }
+
+        void execute(AllocateMemory &call) {
+            const VkMemoryPropertyFlags flags = call.propertyFlags &
+                                                (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+                                                 VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+            VkMemoryAllocateInfo allocateInfo = *call.pAllocateInfo;
+            allocateInfo.memoryTypeIndex = findMemoryType(~0u, flags);
+            if (vkAllocateMemory(device, &allocateInfo, nullptr, &call.memory) != VK_SUCCESS) {
+                LOGE("Failed to allocate %llu bytes of memory.",
+                     static_cast<unsigned long long>(allocateInfo.allocationSize));
+                return;
+            }
+
+            void *mapped = nullptr;
+            const VkMemoryPropertyFlags available =
+                    memoryProperties.memoryTypes[allocateInfo.memoryTypeIndex].propertyFlags;
+            if ((available & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+                vkMapMemory(device, call.memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+            }
+            allocations[call.memory] = {
+                    .memoryTypeIndex = allocateInfo.memoryTypeIndex,
+                    .size = allocateInfo.allocationSize,
+                    .mapped = static_cast<uint8_t *>(mapped)
+            };
+        }
+
+        void execute(FreeMemory &call) {
+            allocations.erase(call.memory);
+            vkFreeMemory(device, call.memory, nullptr);
+        }
+
+        void execute(CreateBuffer &call) {
+            vkCreateBuffer(device, call.pCreateInfo, nullptr, &call.buffer);
+        }
+
+        void execute(DestroyBuffer &call) {
+            vkDestroyBuffer(device, call.buffer, nullptr);
+        }
+
+        void execute(BindBufferMemory &call) {
+            VkMemoryRequirements requirements;
+            vkGetBufferMemoryRequirements(device, call.buffer, &requirements);
+            checkBinding(requirements, call.memory, call.memoryOffset);
+            vkBindBufferMemory(device, call.buffer, call.memory, call.memoryOffset);
+        }
+
+        void execute(CreateImage &call) {
+            vkCreateImage(device, call.pCreateInfo, nullptr, &call.image);
+        }
+
+        void execute(DestroyImage &call) {
+            vkDestroyImage(device, call.image, nullptr);
+        }
+
+        void execute(BindImageMemory &call) {
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(device, call.image, &requirements);
+            checkBinding(requirements, call.memory, call.memoryOffset);
+            vkBindImageMemory(device, call.image, call.memory, call.memoryOffset);
+        }
+
+        /* Objects */
+
+        /// Objects made from a create info alone
+#define REPLAY_CREATE_DESTROY(object, created, destroyed) \
+        void execute(Create##object &call) { \
+            vkCreate##object(device, call.pCreateInfo, nullptr, &call.created); \
+        } \
+        void execute(Destroy##object &call) { \
+            vkDestroy##object(device, call.destroyed, nullptr); \
+        }
+        REPLAY_CREATE_DESTROY(ImageView, view, imageView)
+        REPLAY_CREATE_DESTROY(ShaderModule, shaderModule, shaderModule)
+        REPLAY_CREATE_DESTROY(PipelineCache, pipelineCache, pipelineCache)
+        REPLAY_CREATE_DESTROY(DescriptorSetLayout, setLayout, descriptorSetLayout)
+        REPLAY_CREATE_DESTROY(PipelineLayout, pipelineLayout, pipelineLayout)
+        REPLAY_CREATE_DESTROY(Sampler, sampler, sampler)
+        REPLAY_CREATE_DESTROY(RenderPass, renderPass, renderPass)
+        REPLAY_CREATE_DESTROY(Framebuffer, framebuffer, framebuffer)
+        REPLAY_CREATE_DESTROY(DescriptorPool, descriptorPool, descriptorPool)
+        REPLAY_CREATE_DESTROY(CommandPool, commandPool, commandPool)
+        REPLAY_CREATE_DESTROY(Semaphore, semaphore, semaphore)
+#undef REPLAY_CREATE_DESTROY
+
+        void execute(CreateGraphicsPipelines &call) {
+            vkCreateGraphicsPipelines(device, call.pipelineCache, call.createInfoCount,
+                                      call.pCreateInfos, nullptr, call.pPipelines);
+        }
+
+        void execute(DestroyPipeline &call) {
+            vkDestroyPipeline(device, call.pipeline, nullptr);
+        }
+
+        /* Descriptors */
+
+        void execute(ResetDescriptorPool &call) {
+            vkResetDescriptorPool(device, call.descriptorPool, call.flags);
+        }
+
+        void execute(AllocateDescriptorSets &call) {
+            vkAllocateDescriptorSets(device, call.pAllocateInfo, call.pDescriptorSets);
+        }
+
+        void execute(UpdateDescriptorSets &call) {
+            vkUpdateDescriptorSets(device, call.descriptorWriteCount, call.pDescriptorWrites,
+                                   call.descriptorCopyCount, call.pDescriptorCopies);
+        }
+
+        void execute(CreateDescriptorUpdateTemplate &call) {
+            const VkDescriptorUpdateTemplateCreateInfo &createInfo = *call.pCreateInfo;
+            if (vkCreateDescriptorUpdateTemplate(device, &createInfo, nullptr,
+                                                 &call.descriptorUpdateTemplate) == VK_SUCCESS) {
+                const VkDescriptorUpdateTemplateEntry *entries =
+                        createInfo.pDescriptorUpdateEntries;
+                templates[call.descriptorUpdateTemplate].assign(
+                        entries, entries + createInfo.descriptorUpdateEntryCount);
+            }
+        }
+
+        void execute(DestroyDescriptorUpdateTemplate &call) {
+            templates.erase(call.descriptorUpdateTemplate);
+            vkDestroyDescriptorUpdateTemplate(device, call.descriptorUpdateTemplate, nullptr);
+        }
+
+        void execute(UpdateDescriptorSetWithTemplate &call) {
+            const auto entries = templates.find(call.descriptorUpdateTemplate);
+            if (entries == templates.end()) {
+                return;
+            }
+            const std::vector<uint8_t> data = packTemplateData(entries->second, call.pDescriptors,
+                                                               call.descriptorCount);
+            vkUpdateDescriptorSetWithTemplate(device, call.descriptorSet,
+                                              call.descriptorUpdateTemplate, data.data());
+        }
+
+        /* Command buffers */
+
+        void execute(ResetCommandPool &call) {
+            vkResetCommandPool(device, call.commandPool, call.flags);
+        }
+
+        void execute(AllocateCommandBuffers &call) {
+            vkAllocateCommandBuffers(device, call.pAllocateInfo, call.pCommandBuffers);
+        }
+
+        void execute(FreeCommandBuffers &call) {
+            vkFreeCommandBuffers(device, call.commandPool, call.commandBufferCount,
+                                 call.pCommandBuffers);
+        }
+
+        void execute(BeginCommandBuffer &call) {
+            vkBeginCommandBuffer(call.commandBuffer, call.pBeginInfo);
+        }
+
+        void execute(EndCommandBuffer &call) {
+            vkEndCommandBuffer(call.commandBuffer);
+        }
+
+        void execute(CmdBindPipeline &call) {
+            vkCmdBindPipeline(call.commandBuffer, call.pipelineBindPoint, call.pipeline);
+        }
+
+        void execute(CmdSetViewport &call) {
+            vkCmdSetViewport(call.commandBuffer, call.firstViewport, call.viewportCount,
+                             call.pViewports);
+        }
+
+        void execute(CmdSetScissor &call) {
+            vkCmdSetScissor(call.commandBuffer, call.firstScissor, call.scissorCount,
+                            call.pScissors);
+        }
+
+        void execute(CmdBindDescriptorSets &call) {
+            vkCmdBindDescriptorSets(call.commandBuffer, call.pipelineBindPoint, call.layout,
+                                    call.firstSet, call.descriptorSetCount, call.pDescriptorSets,
+                                    call.dynamicOffsetCount, call.pDynamicOffsets);
+        }
+
+        void execute(CmdBindVertexBuffers &call) {
+            vkCmdBindVertexBuffers(call.commandBuffer, call.firstBinding, call.bindingCount,
+                                   call.pBuffers, call.pOffsets);
+        }
+
+        void execute(CmdBindIndexBuffer &call) {
+            vkCmdBindIndexBuffer(call.commandBuffer, call.buffer, call.offset, call.indexType);
+        }
+
+        void execute(CmdDraw &call) {
+            vkCmdDraw(call.commandBuffer, call.vertexCount, call.instanceCount, call.firstVertex,
+                      call.firstInstance);
+        }
+
+        void execute(CmdDrawIndexed &call) {
+            vkCmdDrawIndexed(call.commandBuffer, call.indexCount, call.instanceCount,
+                             call.firstIndex, call.vertexOffset, call.firstInstance);
+        }
+
+        void execute(CmdPushConstants &call) {
+            vkCmdPushConstants(call.commandBuffer, call.layout, call.stageFlags, call.offset,
+                               call.size, call.pValues);
+        }
+
+        void execute(CmdUpdateBuffer &call) {
+            vkCmdUpdateBuffer(call.commandBuffer, call.dstBuffer, call.dstOffset, call.dataSize,
+                              call.pData);
+        }
+
+        void execute(CmdCopyBuffer &call) {
+            vkCmdCopyBuffer(call.commandBuffer, call.srcBuffer, call.dstBuffer, call.regionCount,
+                            call.pRegions);
+        }
+
+        void execute(CmdPipelineBarrier2KHR &call) {
+            vkCmdPipelineBarrier2KHR(call.commandBuffer, call.pDependencyInfo);
+        }
+
+        void execute(CmdBeginRenderingKHR &call) {
+            vkCmdBeginRenderingKHR(call.commandBuffer, call.pRenderingInfo);
+        }
+
+        void execute(CmdEndRenderingKHR &call) {
+            vkCmdEndRenderingKHR(call.commandBuffer);
+        }
+
+        void execute(CmdBeginRenderPass &call) {
+            vkCmdBeginRenderPass(call.commandBuffer, call.pRenderPassBegin, call.contents);
+        }
+
+        void execute(CmdEndRenderPass &call) {
+            vkCmdEndRenderPass(call.commandBuffer);
+        }
+
+        /* Synchronization */
+
+        void execute(CreateFence &call) {
+            if (vkCreateFence(device, call.pCreateInfo, nullptr, &call.fence) == VK_SUCCESS) {
+                const bool signaled = (call.pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0;
+                fences[call.fence] = {.signaled = signaled, .pending = false};
+            }
+        }
+
+        void execute(DestroyFence &call) {
+            fences.erase(call.fence);
+            vkDestroyFence(device, call.fence, nullptr);
+        }
+
+        void execute(ResetFences &call) {
+            for (uint32_t i = 0; i < call.fenceCount; ++i) {
+                fences[call.pFences[i]] = {.signaled = false, .pending = false};
+            }
+            vkResetFences(device, call.fenceCount, call.pFences);
+        }
+
+        void execute(WaitForFences &call) {
+            // The fence may have been submitted in a frame that was skipped during capture
+            std::vector<VkFence> waitable;
+            for (uint32_t i = 0; i < call.fenceCount; ++i) {
+                const FenceState &state = fences[call.pFences[i]];
+                if (state.signaled || state.pending) {
+                    waitable.push_back(call.pFences[i]);
+                }
+            }
+            if (waitable.size() < call.fenceCount) {
+                ++skippedWaitCount;
+            }
+            if (waitable.empty()) {
+                return;
+            }
+
+            PROFILE_SCOPE("vkWaitForFences");
+            const Clock::time_point start = Clock::now();
+            const VkResult result = vkWaitForFences(device, static_cast<uint32_t>(waitable.size()),
+                                                    waitable.data(), call.waitAll, call.timeout);
+            waitTime += Clock::now() - start;
+            if (result == VK_SUCCESS && (call.waitAll || waitable.size() == 1)) {
+                for (VkFence fence: waitable) {
+                    fences[fence] = {.signaled = true, .pending = false};
+                }
+            }
+        }
+
+        void execute(QueueSubmit &call) {
+            vkQueueSubmit(queue, call.submitCount, call.pSubmits, call.fence);
+            markSubmitted(call.fence);
+        }
+
+        void execute(QueueWaitIdle &) {
+            PROFILE_SCOPE("vkQueueWaitIdle");
+            const Clock::time_point start = Clock::now();
+            vkQueueWaitIdle(queue);
+            waitTime += Clock::now() - start;
+            markIdle();
+        }
+
+        void execute(DeviceWaitIdle &) {
+            PROFILE_SCOPE("vkDeviceWaitIdle");
+            const Clock::time_point start = Clock::now();
+            vkDeviceWaitIdle(device);
+            waitTime += Clock::now() - start;
+            markIdle();
+        }
+
+        /* Presentation */
+
+        void execute(CreateSwapchainKHR &call) {
+            const VkSwapchainCreateInfoKHR &createInfo = *call.pCreateInfo;
+            call.swapchain = fromHandleValue<VkSwapchainKHR>(nextSwapchain++);
+            swapchains[call.swapchain] = {
+                    .format = createInfo.imageFormat,
+                    .extent = createInfo.imageExtent,
+                    .arrayLayers = createInfo.imageArrayLayers,
+                    .usage = createInfo.imageUsage
+            };
+        }
+
+        void execute(DestroySwapchainKHR &call) {
+            const auto swapchain = swapchains.find(call.swapchain);
+            if (swapchain == swapchains.end()) {
+                return;
+            }
+            for (VkImage image: swapchain->second.images) {
+                vkDestroyImage(device, image, nullptr);
+            }
+            for (VkDeviceMemory memory: swapchain->second.memory) {
+                vkFreeMemory(device, memory, nullptr);
+            }
+            swapchains.erase(swapchain);
+        }
+
+        void execute(GetSwapchainImagesKHR &call) {
+            const auto found = swapchains.find(call.swapchain);
+            if (found == swapchains.end()) {
+                return;
+            }
+            Swapchain &swapchain = found->second;
+            while (swapchain.images.size() < call.swapchainImageCount) {
+                const VkImageCreateInfo imageCreateInfo{
+                        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                        .imageType = VK_IMAGE_TYPE_2D,
+                        .format = swapchain.format,
+                        .extent = {swapchain.extent.width, swapchain.extent.height, 1},
+                        .mipLevels = 1,
+                        .arrayLayers = swapchain.arrayLayers,
+                        .samples = VK_SAMPLE_COUNT_1_BIT,
+                        .tiling = VK_IMAGE_TILING_OPTIMAL,
+                        .usage = swapchain.usage,
+                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+                };
+                VkImage image;
+                CALL_VK(vkCreateImage(device, &imageCreateInfo, nullptr, &image))
+
+                VkMemoryRequirements requirements;
+                vkGetImageMemoryRequirements(device, image, &requirements);
+                const VkMemoryAllocateInfo allocateInfo{
+                        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                        .allocationSize = requirements.size,
+                        .memoryTypeIndex = findMemoryType(requirements.memoryTypeBits,
+                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                };
+                VkDeviceMemory memory;
+                CALL_VK(vkAllocateMemory(device, &allocateInfo, nullptr, &memory))
+                CALL_VK(vkBindImageMemory(device, image, memory, 0))
+
+                swapchain.images.push_back(image);
+                swapchain.memory.push_back(memory);
+            }
+            std::copy_n(swapchain.images.begin(), call.swapchainImageCount,
+                        call.pSwapchainImages);
+        }
+
+        void execute(AcquireNextImageKHR &call) {
+            if (call.semaphore != VK_NULL_HANDLE || call.fence != VK_NULL_HANDLE) {
+                submitEmpty(0, nullptr, call.semaphore, call.fence);
+            }
+        }
+
+        void execute(QueuePresentKHR &call) {
+            const VkPresentInfoKHR &presentInfo = *call.pPresentInfo;
+            if (presentInfo.waitSemaphoreCount > 0) {
+                submitEmpty(presentInfo.waitSemaphoreCount, presentInfo.pWaitSemaphores,
+                            VK_NULL_HANDLE, VK_NULL_HANDLE);
+            }
+        }
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options) {
+        for (int i = 1; i < argc; ++i) {
+            if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+                const auto loops = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+                options.loops = std::max(1u, loops);
+            } else if (strcmp(argv[i], "--null") == 0) {
+                options.nullDriver = true;
+            } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                options.tracePath = argv[++i];
+            } else if (options.path == nullptr && argv[i][0] != '-') {
+                options.path = argv[i];
+            } else {
+                return false;
+            }
+        }
+        return options.path != nullptr;
+    }
+
+    /// Nearest rank, sorted has to be sorted and not empty
+    double percentile(const std::vector<double> &sorted, double fraction) {
+        const auto rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+        return sorted[rank];
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s <trace> [--loops N] [--null] [--trace path]\n", argv[0]);
+        return 1;
+    }
+
+    const PosixFileBackend fileBackend{""};
+    const std::unique_ptr<MappedFile> file = fileBackend.open(options.path);
+    if (file == nullptr) {
+        LOGE("Failed to read %s", options.path);
+        return 1;
+    }
+
+    // The device info is read first, the device it describes is needed to read the rest
+    TraceReader infoReader;
+    Record type{};
+    DeviceInfo deviceInfo{};
+    if (!infoReader.open(file->data(), file->size(), 0) || !infoReader.nextRecord(type) ||
+        type != Record::DeviceInfo) {
+        LOGE("%s does not start with the device info.", options.path);
+        return 1;
+    }
+    serialize(infoReader, deviceInfo);
+
+    // Swapchain images are emulated
+    std::vector<const char *> extensions;
+    for (uint32_t i = 0; i < deviceInfo.enabledExtensionCount; ++i) {
+        const char *extension = deviceInfo.ppEnabledExtensionNames[i];
+        if (strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) != 0) {
+            extensions.push_back(extension);
+        }
+    }
+
+    HeadlessDevice device;
+    const int loaded = options.nullDriver ? null_driver::install() : InitVulkan();
+    if (!infoReader.ok() || !loaded ||
+        !createHeadlessDevice(device, "trace_replay", extensions, deviceInfo.pEnabledFeatures,
+                              deviceInfo.pNext)) {
+        LOGE("Failed to create a Vulkan device like the one of the trace.");
+        return 1;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device.gpu, &properties);
+    LOGI("Captured on %s, replaying on %s", deviceInfo.deviceName, properties.deviceName);
+
+    TraceReader reader;
+    reader.open(file->data(), file->size(), device.queueFamilyIndex);
+    Replayer replayer{device};
+
+    PROFILE_THREAD_NAME("Replay");
+    int64_t zoneBegin = cpu_profiler::now();
+    size_t framesOffset = 0;
+    while (framesOffset == 0 && reader.nextRecord(type)) {
+        if (type == Record::FramesBegin) {
+            framesOffset = reader.getRecordOffset();
+        } else if (!replayer.replay(reader, type)) {
+            return 1;
+        }
+    }
+    if (framesOffset == 0) {
+        LOGE("%s has no frames.", options.path);
+        return 1;
+    }
+    replayer.endFrame();
+    const int64_t setupEnd = cpu_profiler::now();
+    cpu_profiler::recordZone("Setup", zoneBegin, setupEnd);
+    zoneBegin = setupEnd;
+
+    std::vector<FrameTiming> frames;
+    for (uint32_t loop = 0; loop < options.loops; ++loop) {
+        reader.seek(framesOffset);
+        while (reader.nextRecord(type)) {
+            if (!replayer.replay(reader, type)) {
+                return 1;
+            }
+            if (type == Record::QueuePresentKHR) {
+                frames.push_back(replayer.endFrame());
+                const int64_t frameEnd = cpu_profiler::now();
+                cpu_profiler::recordZone("Frame", zoneBegin, frameEnd);
+                zoneBegin = frameEnd;
+            }
+        }
+    }
+    vkDeviceWaitIdle(device.device);
+    if (options.tracePath != nullptr && cpu_profiler::writeTrace(options.tracePath)) {
+        LOGI("Trace written to %s", options.tracePath);
+    }
+    if (frames.empty()) {
+        LOGE("%s has no complete frames.", options.path);
+        return 1;
+    }
+    if (reader.getUnknownHandleCount() > 0 || replayer.getSkippedWaitCount() > 0) {
+        LOGW("%u unknown handles, %u waits on unsubmitted fences skipped",
+             reader.getUnknownHandleCount(), replayer.getSkippedWaitCount());
+    }
+
+    std::vector<double> cpuMs;
+    double waitMs = 0.0;
+    VkDeviceSize uploadBytes = 0;
+    for (const FrameTiming &frame: frames) {
+        cpuMs.push_back(frame.cpuMs);
+        waitMs += frame.waitMs;
+        uploadBytes += frame.uploadBytes;
+    }
+    std::sort(cpuMs.begin(), cpuMs.end());
+    const double frameCount = static_cast<double>(frames.size());
+    printf("{\"device\": \"%s\", \"frames\": %zu, \"cpu_mean_ms\": %.4f, \"cpu_p50_ms\": %.4f, "
+           "\"cpu_p95_ms\": %.4f, \"cpu_max_ms\": %.4f, \"wait_mean_ms\": %.4f, "
+           "\"upload_bytes_per_frame\": %.0f}\n",
+           properties.deviceName, frames.size(),
+           std::accumulate(cpuMs.begin(), cpuMs.end(), 0.0) / frameCount,
+           percentile(cpuMs, 0.5), percentile(cpuMs, 0.95), cpuMs.back(), waitMs / frameCount,
+           static_cast<double>(uploadBytes) / frameCount);
+
+    // The trace need not destroy what it created, the driver cleans up when the process exits
+    return 0;
+}
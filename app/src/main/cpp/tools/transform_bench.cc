@@ -0,0 +1,138 @@
+//
+// Created by eternal on 2024/7/19.
+//
+// Measures the 2D model transforms of math_utils on one core, e.g.
+//   ./transform_bench [transforms]
+// and prints one JSON line per variant. The three matrix product of TriangleApp::updateTransform
+// is the reference, the largest difference to it is printed next to the throughput.
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "MathUtils.hh"
+
+namespace {
+    constexpr uint32_t kRounds = 10;
+
+    /// Transforms as the batched variant takes them, one array per component
+    struct Inputs {
+        std::vector<float> translationX;
+
+        std::vector<float> translationY;
+
+        std::vector<float> angles;
+
+        std::vector<float> scaleX;
+
+        std::vector<float> scaleY;
+    };
+
+    Inputs generate(size_t count) {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> translation(-400.0f, 400.0f);
+        std::uniform_real_distribution<float> angle(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+        Inputs inputs;
+        for (size_t i = 0; i < count; ++i) {
+            inputs.translationX.push_back(translation(random));
+            inputs.translationY.push_back(translation(random));
+            inputs.angles.push_back(angle(random));
+            inputs.scaleX.push_back(scale(random));
+            inputs.scaleY.push_back(scale(random));
+        }
+        return inputs;
+    }
+
+    /// Returns the fastest of kRounds runs in nanoseconds per transform
+    template<typename Run>
+    double measure(size_t count, Run run) {
+        double best = 0.0;
+        for (uint32_t round = 0; round < kRounds; ++round) {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            const auto elapsed = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start).count();
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+        }
+        return best / static_cast<double>(count);
+    }
+
+    float getMaxError(const std::vector<glm::mat4x4> &reference,
+                      const std::vector<glm::mat4x4> &result) {
+        float error = 0.0f;
+        for (size_t i = 0; i < reference.size(); ++i) {
+            for (int column = 0; column < 4; ++column) {
+                for (int row = 0; row < 4; ++row) {
+                    error = std::max(error,
+                                     std::abs(reference[i][column][row] - result[i][column][row]));
+                }
+            }
+        }
+        return error;
+    }
+
+    void print(const char *variant, double nanoseconds, float maxError) {
+        printf("{\"variant\": \"%s\", \"ns_per_transform\": %.3f, "
+               "\"million_transforms_per_second\": %.1f, \"max_error\": %g}\n",
+               variant, nanoseconds, 1e3 / nanoseconds, maxError);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [transforms]\n", argv[0]);
+        return 1;
+    }
+    const size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1'000'000;
+    if (count == 0) {
+        fprintf(stderr, "Nothing to transform.\n");
+        return 1;
+    }
+
+    const Inputs inputs = generate(count);
+    std::vector<glm::mat4x4> reference(count);
+    std::vector<glm::mat4x4> matrices(count);
+    std::vector<glm::mat3x2> affines(count);
+
+    const double separate = measure(count, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            reference[i] =
+                    math_utils::translate2D({inputs.translationX[i], inputs.translationY[i]}) *
+                    math_utils::rotateZ(inputs.angles[i]) *
+                    math_utils::scale2D({inputs.scaleX[i], inputs.scaleY[i]});
+        }
+    });
+    print("separate", separate, 0.0f);
+
+    const double fused = measure(count, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            matrices[i] = math_utils::transform2D({inputs.translationX[i], inputs.translationY[i]},
+                                                  inputs.angles[i],
+                                                  {inputs.scaleX[i], inputs.scaleY[i]});
+        }
+    });
+    print("fused", fused, getMaxError(reference, matrices));
+
+    const double affine = measure(count, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            affines[i] = math_utils::affine2D({inputs.translationX[i], inputs.translationY[i]},
+                                              inputs.angles[i],
+                                              {inputs.scaleX[i], inputs.scaleY[i]});
+        }
+    });
+    std::transform(affines.begin(), affines.end(), matrices.begin(), math_utils::toMatrix);
+    print("affine", affine, getMaxError(reference, matrices));
+
+    const double batch = measure(count, [&] {
+        math_utils::affine2DBatch(inputs.translationX.data(), inputs.translationY.data(),
+                                  inputs.angles.data(), inputs.scaleX.data(),
+                                  inputs.scaleY.data(), count, affines.data());
+    });
+    std::transform(affines.begin(), affines.end(), matrices.begin(), math_utils::toMatrix);
+    print("batch", batch, getMaxError(reference, matrices));
+    return 0;
+}
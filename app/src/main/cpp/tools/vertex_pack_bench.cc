@@ -0,0 +1,149 @@
+//
+// Created by eternal on 2024/7/19.
+//
+// Packs a generated mesh with the vertex inputs of triangle.vert on one core, e.g.
+//   ./vertex_pack_bench [vertices]
+// and prints one JSON line per layout: the vertex size, the encoding throughput and, after
+// decoding, the largest error of each attribute next to the bound the encoder reported. Fails if
+// an error exceeds its bound.
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "VertexPacking.hh"
+#include "shader_layouts/triangle.layout.hh"
+
+namespace {
+    constexpr uint32_t kRounds = 10;
+
+    /// The float vertex of TriangleApp
+    struct Vertex {
+        glm::vec2 position;
+
+        glm::vec4 color;
+    };
+
+    struct Variant {
+        const char *name;
+
+        std::vector<vertex_packing::Encoding> encodings;
+    };
+
+    std::vector<Vertex> generate(size_t count) {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> position(-2000.0f, 2000.0f);
+        std::uniform_real_distribution<float> color(0.0f, 1.0f);
+        std::vector<Vertex> vertices(count);
+        for (auto &vertex: vertices) {
+            vertex.position = {position(random), position(random)};
+            vertex.color = {color(random), color(random), color(random), color(random)};
+        }
+        return vertices;
+    }
+
+    /// Returns the fastest of kRounds runs in nanoseconds per vertex
+    template<typename Run>
+    double measure(size_t count, Run run) {
+        double best = 0.0;
+        for (uint32_t round = 0; round < kRounds; ++round) {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            const auto elapsed = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start).count();
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+        }
+        return best / static_cast<double>(count);
+    }
+
+    /// Largest error of the decoded components and the largest bound of them
+    struct Error {
+        float error = 0.0f;
+
+        float bound = 0.0f;
+
+        bool withinBound = true;
+    };
+
+    Error getError(const float *source, size_t sourceStride, const std::vector<float> &decoded,
+                   uint32_t componentCount, const vertex_packing::Quantization &quantization) {
+        Error result;
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            const size_t vertex = i / componentCount;
+            const uint32_t component = i % componentCount;
+            const float value = *reinterpret_cast<const float *>(
+                    reinterpret_cast<const uint8_t *>(source) + vertex * sourceStride +
+                    component * sizeof(float));
+            const float error = std::abs(decoded[i] - value);
+            result.error = std::max(result.error, error);
+            result.bound = std::max(result.bound, quantization.maxError[component]);
+            result.withinBound = result.withinBound && error <= quantization.maxError[component];
+        }
+        return result;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [vertices]\n", argv[0]);
+        return 1;
+    }
+    const size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1'000'000;
+    if (count == 0) {
+        fprintf(stderr, "Nothing to pack.\n");
+        return 1;
+    }
+
+    using vertex_packing::Encoding;
+    const Variant variants[] = {
+            {"float32", {Encoding::Float32, Encoding::Float32}},
+            {"float16_unorm8", {Encoding::Float16, Encoding::Unorm8}},
+            {"snorm16_unorm8", {Encoding::Snorm16, Encoding::Unorm8}},
+    };
+
+    using shader_layouts::triangle::vertexAttributes;
+    const std::vector<Vertex> vertices = generate(count);
+    const std::vector<vertex_packing::Source> sources{
+            {.data = &vertices[0].position.x, .stride = sizeof(Vertex)},
+            {.data = &vertices[0].color.x, .stride = sizeof(Vertex)}
+    };
+
+    bool withinBounds = true;
+    for (const auto &variant: variants) {
+        const vertex_packing::Layout layout = vertex_packing::makeLayout(
+                {vertexAttributes.begin(), vertexAttributes.end()}, variant.encodings);
+        if (layout.stride == 0) {
+            return 1;
+        }
+
+        std::vector<uint8_t> packed(count * layout.stride);
+        std::vector<vertex_packing::Quantization> quantizations;
+        const double nanoseconds = measure(count, [&] {
+            quantizations = vertex_packing::encode(layout, sources, count, packed.data());
+        });
+
+        std::vector<float> positions(count * 2);
+        std::vector<float> colors(count * 4);
+        vertex_packing::decode(layout, quantizations, packed.data(), count,
+                               {positions.data(), colors.data()});
+        const Error position = getError(&vertices[0].position.x, sizeof(Vertex), positions, 2,
+                                        quantizations[0]);
+        const Error color = getError(&vertices[0].color.x, sizeof(Vertex), colors, 4,
+                                     quantizations[1]);
+        withinBounds = withinBounds && position.withinBound && color.withinBound;
+
+        printf("{\"layout\": \"%s\", \"bytes_per_vertex\": %u, \"size_ratio\": %.3f, "
+               "\"ns_per_vertex\": %.3f, \"source_gb_per_second\": %.2f, "
+               "\"position_error\": %g, \"position_bound\": %g, "
+               "\"color_error\": %g, \"color_bound\": %g, \"within_bounds\": %s}\n",
+               variant.name, layout.stride,
+               static_cast<double>(layout.stride) / static_cast<double>(sizeof(Vertex)),
+               nanoseconds, static_cast<double>(sizeof(Vertex)) / nanoseconds,
+               position.error, position.bound, color.error, color.bound,
+               position.withinBound && color.withinBound ? "true" : "false");
+    }
+    return withinBounds ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+//
+// Created by eternal on 2024/6/16.
+//
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "AssetFileBackend.hh"
+
+namespace {
+    /// Part of the APK mapped through the asset's file descriptor
+    class DescriptorMappedFile final : public MappedFile {
+    public:
+        DescriptorMappedFile(void *mapping, size_t mappingSize, size_t dataOffset, size_t dataSize)
+                : mapping(mapping), mappingSize(mappingSize), dataOffset(dataOffset),
+                  dataSize(dataSize) {}
+
+        ~DescriptorMappedFile() override {
+            munmap(mapping, mappingSize);
+        }
+
+        const void *data() const override {
+            return static_cast<const uint8_t *>(mapping) + dataOffset;
+        }
+
+        size_t size() const override {
+            return dataSize;
+        }
+
+    private:
+        void *mapping;
+
+        size_t mappingSize;
+
+        size_t dataOffset;
+
+        size_t dataSize;
+    };
+
+    /// Asset kept open for as long as its buffer is in use
+    class AssetBufferFile final : public MappedFile {
+    public:
+        explicit AssetBufferFile(AAsset *asset) : asset(asset) {}
+
+        ~AssetBufferFile() override {
+            AAsset_close(asset);
+        }
+
+        const void *data() const override {
+            return AAsset_getBuffer(asset);
+        }
+
+        size_t size() const override {
+            return static_cast<size_t>(AAsset_getLength64(asset));
+        }
+
+    private:
+        AAsset *asset;
+    };
+
+    std::unique_ptr<MappedFile> mapDescriptor(AAsset *asset) {
+        off64_t start = 0;
+        off64_t length = 0;
+        const int fd = AAsset_openFileDescriptor64(asset, &start, &length);
+        if (fd < 0) {
+            // Compressed assets have no descriptor
+            return nullptr;
+        }
+
+        // mmap offsets have to be page aligned, the asset usually starts somewhere inside a page
+        const off64_t pageSize = sysconf(_SC_PAGESIZE);
+        const off64_t alignedStart = start - start % pageSize;
+        const auto dataOffset = static_cast<size_t>(start - alignedStart);
+        const size_t mappingSize = dataOffset + static_cast<size_t>(length);
+
+        void *mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, alignedStart);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            return nullptr;
+        }
+        madvise(mapping, mappingSize, MADV_WILLNEED);
+        return std::make_unique<DescriptorMappedFile>(mapping, mappingSize, dataOffset,
+                                                      static_cast<size_t>(length));
+    }
+}
+
+AssetFileBackend::AssetFileBackend(AAssetManager *assetManager) : assetManager(assetManager) {}
+
+std::unique_ptr<MappedFile> AssetFileBackend::open(const std::string &path) const {
+    AAsset *asset = AAssetManager_open(assetManager, path.c_str(), AASSET_MODE_BUFFER);
+    if (asset == nullptr) {
+        return nullptr;
+    }
+
+    if (AAsset_getLength64(asset) > 0) {
+        auto mapped = mapDescriptor(asset);
+        if (mapped != nullptr) {
+            AAsset_close(asset);
+            return mapped;
+        }
+    }
+
+    if (AAsset_getLength64(asset) > 0 && AAsset_getBuffer(asset) == nullptr) {
+        AAsset_close(asset);
+        return nullptr;
+    }
+    return std::make_unique<AssetBufferFile>(asset);
+}
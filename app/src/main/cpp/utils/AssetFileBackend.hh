@@ -0,0 +1,28 @@
+//
+// Created by eternal on 2024/6/16.
+//
+
+#ifndef LEARNINGVULKAN_ASSETFILEBACKEND_HH
+#define LEARNINGVULKAN_ASSETFILEBACKEND_HH
+
+#include <android/asset_manager.h>
+#include "FileBackend.hh"
+
+/**
+ * @brief Reads files from the APK assets
+ *
+ * Uncompressed assets are mapped straight out of the APK through their file descriptor.
+ * Compressed ones fall back to AAsset_getBuffer, which inflates them once into memory owned
+ * by the asset.
+ */
+class AssetFileBackend final : public FileBackend {
+public:
+    explicit AssetFileBackend(AAssetManager *assetManager);
+
+    std::unique_ptr<MappedFile> open(const std::string &path) const override;
+
+private:
+    AAssetManager *assetManager;
+};
+
+#endif //LEARNINGVULKAN_ASSETFILEBACKEND_HH
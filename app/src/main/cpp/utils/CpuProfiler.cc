@@ -0,0 +1,173 @@
+//
+// Created by eternal on 2024/7/16.
+//
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "CpuProfiler.hh"
+#include "Debug.hh"
+
+namespace cpu_profiler {
+    /// Zones per thread, about a few seconds of a frame loop. Has to be a power of two.
+    constexpr uint64_t kCapacity = 4096;
+
+    /**
+     * @brief Zone slot guarded by a sequence number
+     *
+     * The sequence is odd while the owning thread writes the slot and 2 * (index + 1) once the
+     * zone with that index is complete, so a reader can tell a torn or overwritten zone apart.
+     */
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+
+        std::atomic<const char *> name{nullptr};
+
+        std::atomic<int64_t> begin{0};
+
+        std::atomic<int64_t> end{0};
+    };
+
+    struct Buffer {
+        uint32_t id = 0;
+
+        /// Guarded by the registry mutex
+        std::string name{};
+
+        /// Index of the next zone, only written by the recording thread
+        std::atomic<uint64_t> head{0};
+
+        std::array<Slot, kCapacity> slots{};
+
+        void push(const char *zoneName, int64_t begin, int64_t end) {
+            const uint64_t index = head.load(std::memory_order_relaxed);
+            Slot &slot = slots[index & (kCapacity - 1)];
+            slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.name.store(zoneName, std::memory_order_relaxed);
+            slot.begin.store(begin, std::memory_order_relaxed);
+            slot.end.store(end, std::memory_order_relaxed);
+            slot.sequence.store(index * 2 + 2, std::memory_order_release);
+            head.store(index + 1, std::memory_order_release);
+        }
+    };
+}
+
+namespace {
+    using cpu_profiler::Buffer;
+
+    struct Registry {
+        std::mutex mutex{};
+
+        std::vector<std::unique_ptr<Buffer>> buffers{};
+    };
+
+    /// Never destroyed, threads may still record while static destructors run
+    Registry &registry() {
+        static auto *instance = new Registry();
+        return *instance;
+    }
+
+    Buffer *createBuffer(const char *name) {
+        Registry &instance = registry();
+        std::lock_guard lock(instance.mutex);
+        auto buffer = std::make_unique<Buffer>();
+        buffer->id = static_cast<uint32_t>(instance.buffers.size());
+        buffer->name = name != nullptr ? name : "Thread " + std::to_string(buffer->id);
+        instance.buffers.push_back(std::move(buffer));
+        return instance.buffers.back().get();
+    }
+
+    thread_local Buffer *threadBuffer = nullptr;
+
+    Buffer &getThreadBuffer() {
+        if (threadBuffer == nullptr) {
+            threadBuffer = createBuffer(nullptr);
+        }
+        return *threadBuffer;
+    }
+
+    void writeZones(FILE *file, const Buffer &buffer) {
+        const uint64_t head = buffer.head.load(std::memory_order_acquire);
+        const uint64_t first = head > cpu_profiler::kCapacity ? head - cpu_profiler::kCapacity : 0;
+        for (uint64_t index = first; index < head; ++index) {
+            const cpu_profiler::Slot &slot = buffer.slots[index & (cpu_profiler::kCapacity - 1)];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const char *name = slot.name.load(std::memory_order_relaxed);
+            const int64_t begin = slot.begin.load(std::memory_order_relaxed);
+            const int64_t end = slot.end.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // Overwritten by a newer zone while it was read
+            if (sequence != index * 2 + 2 ||
+                slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                          "\"ts\":%.3f,\"dur\":%.3f}",
+                    name, buffer.id, static_cast<double>(begin) / 1000.0,
+                    static_cast<double>(end - begin) / 1000.0);
+        }
+    }
+}
+
+namespace cpu_profiler {
+    int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void setThreadName(const char *name) {
+        Buffer &buffer = getThreadBuffer();
+        std::lock_guard lock(registry().mutex);
+        buffer.name = name;
+    }
+
+    void recordZone(const char *name, int64_t beginNanoseconds, int64_t endNanoseconds) {
+        getThreadBuffer().push(name, beginNanoseconds, endNanoseconds);
+    }
+
+    Track createTrack(const char *name) {
+        return createBuffer(name);
+    }
+
+    void recordZone(Track track, const char *name, int64_t beginNanoseconds,
+                    int64_t endNanoseconds) {
+        track->push(name, beginNanoseconds, endNanoseconds);
+    }
+
+    bool writeTrace(const char *path) {
+        FILE *file = fopen(path, "w");
+        if (file == nullptr) {
+            LOGE("CPU profiler: failed to open %s", path);
+            return false;
+        }
+
+        // Buffers are never removed, only their names need the lock
+        std::vector<const Buffer *> buffers;
+        fprintf(file, "{\"traceEvents\":[\n");
+        fprintf(file, R"({"name":"process_name","ph":"M","pid":1,)"
+                      R"("args":{"name":"LearningVulkan"}})");
+        {
+            Registry &instance = registry();
+            std::lock_guard lock(instance.mutex);
+            for (const auto &buffer: instance.buffers) {
+                fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                              "\"args\":{\"name\":\"%s\"}}",
+                        buffer->id, buffer->name.c_str());
+                buffers.push_back(buffer.get());
+            }
+        }
+        for (const Buffer *buffer: buffers) {
+            writeZones(file, *buffer);
+        }
+        fprintf(file, "\n]}\n");
+
+        const bool written = ferror(file) == 0;
+        fclose(file);
+        return written;
+    }
+}
@@ -0,0 +1,83 @@
+//
+// Created by eternal on 2024/7/16.
+//
+
+#ifndef LEARNINGVULKAN_CPUPROFILER_HH
+#define LEARNINGVULKAN_CPUPROFILER_HH
+
+#include <cstdint>
+
+// Zones are compiled out of release builds, unless CPU_PROFILER_ENABLED is defined to 1, see the
+// CPU_PROFILER CMake option
+#ifndef CPU_PROFILER_ENABLED
+#ifdef NDEBUG
+#define CPU_PROFILER_ENABLED 0
+#else
+#define CPU_PROFILER_ENABLED 1
+#endif
+#endif
+
+/**
+ * @brief Timed zones per thread, exported as a Chrome trace (chrome://tracing, Perfetto)
+ *
+ * Every thread records into a ring buffer of its own, without locks, and overwrites its oldest
+ * zones once the ring is full. writeTrace may run on any thread while the others keep recording.
+ * Times are nanoseconds of std::chrono::steady_clock, the timeline of GpuProfiler.
+ *
+ * Zone names are not copied, they have to outlive the process, e.g. string literals. They are
+ * written to the trace as they are, so they must not contain quotes or backslashes.
+ */
+namespace cpu_profiler {
+    struct Buffer;
+
+    /// A timeline that is not a thread, e.g. GPU scopes. Only one thread may record into it.
+    using Track = Buffer *;
+
+    int64_t now();
+
+    /// Names the calling thread in the trace, "Thread N" otherwise
+    void setThreadName(const char *name);
+
+    /// Records a zone of the calling thread
+    void recordZone(const char *name, int64_t beginNanoseconds, int64_t endNanoseconds);
+
+    /// Tracks live as long as the process
+    Track createTrack(const char *name);
+
+    void recordZone(Track track, const char *name, int64_t beginNanoseconds,
+                    int64_t endNanoseconds);
+
+    bool writeTrace(const char *path);
+
+    class Zone {
+    public:
+        explicit Zone(const char *name) : name(name), begin(now()) {}
+
+        ~Zone() {
+            recordZone(name, begin, now());
+        }
+
+        Zone(const Zone &) = delete;
+
+        Zone &operator=(const Zone &) = delete;
+
+    private:
+        const char *name;
+
+        int64_t begin;
+    };
+}
+
+#if CPU_PROFILER_ENABLED
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) const cpu_profiler::Zone PROFILE_CONCAT(profileZone, __COUNTER__){name}
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD_NAME(name) cpu_profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif //LEARNINGVULKAN_CPUPROFILER_HH
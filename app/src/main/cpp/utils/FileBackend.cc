@@ -0,0 +1,68 @@
+//
+// Created by eternal on 2024/6/16.
+//
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FileBackend.hh"
+
+namespace {
+    class PosixMappedFile final : public MappedFile {
+    public:
+        PosixMappedFile(void *mapping, size_t mappingSize) : mapping(mapping), mappingSize(mappingSize) {}
+
+        ~PosixMappedFile() override {
+            if (mapping != nullptr) {
+                munmap(mapping, mappingSize);
+            }
+        }
+
+        const void *data() const override {
+            return mapping;
+        }
+
+        size_t size() const override {
+            return mappingSize;
+        }
+
+    private:
+        void *mapping;
+
+        size_t mappingSize;
+    };
+}
+
+PosixFileBackend::PosixFileBackend(std::string rootDirectory)
+        : rootDirectory(std::move(rootDirectory)) {}
+
+std::unique_ptr<MappedFile> PosixFileBackend::open(const std::string &path) const {
+    const std::string fullPath = rootDirectory.empty() ? path : rootDirectory + "/" + path;
+    const int fd = ::open(fullPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    // mmap rejects empty ranges, an empty file is still a valid file
+    const auto fileSize = static_cast<size_t>(fileStat.st_size);
+    void *mapping = nullptr;
+    if (fileSize > 0) {
+        mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+        // Assets are read in full right after opening, start paging them in now
+        madvise(mapping, fileSize, MADV_WILLNEED);
+    }
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+    return std::make_unique<PosixMappedFile>(mapping, fileSize);
+}
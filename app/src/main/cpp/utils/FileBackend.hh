@@ -0,0 +1,48 @@
+//
+// Created by eternal on 2024/6/16.
+//
+
+#ifndef LEARNINGVULKAN_FILEBACKEND_HH
+#define LEARNINGVULKAN_FILEBACKEND_HH
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Read-only bytes of an opened file
+ *
+ * Backends map the file where they can, so data() points straight at the page cache and
+ * consumers such as vkCreateShaderModule read it without an intermediate copy.
+ */
+class MappedFile {
+public:
+    virtual ~MappedFile() = default;
+
+    virtual const void *data() const = 0;
+
+    virtual size_t size() const = 0;
+};
+
+class FileBackend {
+public:
+    virtual ~FileBackend() = default;
+
+    /// Returns nullptr if the file does not exist or cannot be read
+    virtual std::unique_ptr<MappedFile> open(const std::string &path) const = 0;
+};
+
+/**
+ * @brief Maps files below a root directory with mmap, used on Linux hosts
+ */
+class PosixFileBackend final : public FileBackend {
+public:
+    explicit PosixFileBackend(std::string rootDirectory);
+
+    std::unique_ptr<MappedFile> open(const std::string &path) const override;
+
+private:
+    std::string rootDirectory;
+};
+
+#endif //LEARNINGVULKAN_FILEBACKEND_HH
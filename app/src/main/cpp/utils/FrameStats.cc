@@ -0,0 +1,76 @@
+//
+// Created by eternal on 2024/7/18.
+//
+#include <algorithm>
+#include "FrameStats.hh"
+
+void FrameStats::add(const Sample &sample) {
+    // The sum is kept incrementally, the oldest interval leaves it once the ring is full
+    if (count == kHistorySize) {
+        intervalSum -= intervals[next];
+    } else {
+        ++count;
+    }
+    intervalSum += sample.intervalMs;
+
+    intervals[next] = sample.intervalMs;
+    cpuTimes[next] = sample.cpuMs;
+    gpuTimes[next] = sample.gpuMs;
+    next = (next + 1) % kHistorySize;
+}
+
+float FrameStats::getFps() const {
+    return intervalSum > 0.0f ? 1000.0f * static_cast<float>(count) / intervalSum : 0.0f;
+}
+
+FrameStats::Percentiles FrameStats::computeIntervalPercentiles() const {
+    if (count == 0) {
+        return {};
+    }
+
+    // Nearest rank, nth_element leaves the elements after the rank unsorted but not smaller
+    Series sorted = intervals;
+    const auto end = sorted.begin() + static_cast<ptrdiff_t>(count);
+    const auto rank = [&](float fraction) {
+        const auto index = static_cast<ptrdiff_t>(fraction * static_cast<float>(count - 1));
+        std::nth_element(sorted.begin(), sorted.begin() + index, end);
+        return sorted[index];
+    };
+    return {
+            .p50 = rank(0.50f),
+            .p95 = rank(0.95f),
+            .p99 = rank(0.99f)
+    };
+}
+
+const FrameStats::Series &FrameStats::getIntervals() const {
+    return intervals;
+}
+
+const FrameStats::Series &FrameStats::getCpuTimes() const {
+    return cpuTimes;
+}
+
+const FrameStats::Series &FrameStats::getGpuTimes() const {
+    return gpuTimes;
+}
+
+size_t FrameStats::getFirst() const {
+    return count == kHistorySize ? next : 0;
+}
+
+size_t FrameStats::getCount() const {
+    return count;
+}
+
+FrameStats::Sample FrameStats::getLatest() const {
+    if (count == 0) {
+        return {};
+    }
+    const size_t latest = (next + kHistorySize - 1) % kHistorySize;
+    return {
+            .intervalMs = intervals[latest],
+            .cpuMs = cpuTimes[latest],
+            .gpuMs = gpuTimes[latest]
+    };
+}
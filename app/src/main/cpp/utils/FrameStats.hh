@@ -0,0 +1,78 @@
+//
+// Created by eternal on 2024/7/18.
+//
+
+#ifndef LEARNINGVULKAN_FRAMESTATS_HH
+#define LEARNINGVULKAN_FRAMESTATS_HH
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Frame times of the last frames, for graphs and percentiles
+ *
+ * The series are rings, index getFirst() holds the oldest frame. Percentiles are computed on
+ * request, callers decide how often that is worth it.
+ */
+class FrameStats {
+public:
+    /// About four seconds at 60 fps
+    static constexpr size_t kHistorySize = 240;
+
+    using Series = std::array<float, kHistorySize>;
+
+    struct Sample {
+        /// Since the previous frame
+        float intervalMs = 0.0f;
+
+        float cpuMs = 0.0f;
+
+        float gpuMs = 0.0f;
+    };
+
+    struct Percentiles {
+        float p50 = 0.0f;
+
+        float p95 = 0.0f;
+
+        float p99 = 0.0f;
+    };
+
+    void add(const Sample &sample);
+
+    /// Frames per second over the history
+    float getFps() const;
+
+    /// Percentiles of the frame intervals in the history
+    Percentiles computeIntervalPercentiles() const;
+
+    const Series &getIntervals() const;
+
+    const Series &getCpuTimes() const;
+
+    const Series &getGpuTimes() const;
+
+    /// Ring index of the oldest sample
+    size_t getFirst() const;
+
+    /// Samples in the history, at most kHistorySize
+    size_t getCount() const;
+
+    Sample getLatest() const;
+
+private:
+    Series intervals{};
+
+    Series cpuTimes{};
+
+    Series gpuTimes{};
+
+    size_t next = 0;
+
+    size_t count = 0;
+
+    float intervalSum = 0.0f;
+};
+
+#endif //LEARNINGVULKAN_FRAMESTATS_HH
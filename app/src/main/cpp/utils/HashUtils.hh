@@ -0,0 +1,34 @@
+//
+// Created by eternal on 2024/6/12.
+//
+
+#ifndef LEARNINGVULKAN_HASHUTILS_HH
+#define LEARNINGVULKAN_HASHUTILS_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace hash_utils {
+    constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+
+    constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+    /// 64-bit FNV-1a over a byte range
+    inline uint64_t fnv1a(const void *data, size_t size, uint64_t hash = kFnvOffsetBasis) {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * kFnvPrime;
+        }
+        return hash;
+    }
+
+    /// Hashes a single value without padding bytes, pass struct members one by one
+    template<typename T>
+    inline uint64_t combine(uint64_t hash, const T &value) {
+        static_assert(std::is_scalar_v<T>, "Hash struct members individually");
+        return fnv1a(&value, sizeof(value), hash);
+    }
+}
+
+#endif //LEARNINGVULKAN_HASHUTILS_HH
@@ -0,0 +1,72 @@
+//
+// Created by eternal on 2024/7/2.
+//
+
+#ifndef LEARNINGVULKAN_INDEXALLOCATOR_HH
+#define LEARNINGVULKAN_INDEXALLOCATOR_HH
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Hands out indices below a capacity and recycles released ones
+ *
+ * A released index may still be read by frames in flight, so it only returns to the free list
+ * after retireDelay calls to advanceFrame.
+ */
+class IndexAllocator {
+public:
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    explicit IndexAllocator(uint32_t capacity = 0, uint32_t retireDelay = 0)
+            : capacity(capacity), retireDelay(retireDelay) {}
+
+    /// Returns kInvalidIndex once all indices are in use
+    uint32_t allocate() {
+        if (!freeIndices.empty()) {
+            const uint32_t index = freeIndices.back();
+            freeIndices.pop_back();
+            return index;
+        }
+        return nextIndex < capacity ? nextIndex++ : kInvalidIndex;
+    }
+
+    void release(uint32_t index) {
+        retiring.emplace_back(frame + retireDelay, index);
+    }
+
+    void advanceFrame() {
+        ++frame;
+        while (!retiring.empty() && retiring.front().first <= frame) {
+            freeIndices.push_back(retiring.front().second);
+            retiring.pop_front();
+        }
+    }
+
+    uint32_t getUsedCount() const {
+        return nextIndex - static_cast<uint32_t>(freeIndices.size());
+    }
+
+    uint32_t getCapacity() const {
+        return capacity;
+    }
+
+private:
+    uint32_t capacity;
+
+    uint32_t retireDelay;
+
+    /// Indices below it have been handed out at least once
+    uint32_t nextIndex = 0;
+
+    uint64_t frame = 0;
+
+    std::vector<uint32_t> freeIndices{};
+
+    /// Released indices with the frame they become free again
+    std::deque<std::pair<uint64_t, uint32_t>> retiring{};
+};
+
+#endif //LEARNINGVULKAN_INDEXALLOCATOR_HH
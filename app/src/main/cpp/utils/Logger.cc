@@ -0,0 +1,389 @@
+//
+// Created by eternal on 2024/7/19.
+//
+#include <array>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "HashUtils.hh"
+#include "Logger.hh"
+
+#if defined(__ANDROID__)
+#include <android/log.h>
+#endif
+
+namespace {
+    using logger::CallSite;
+    using logger::Level;
+    using logger::Record;
+    using logger::Sink;
+
+    /// Messages queued at once, has to be a power of two
+    constexpr uint64_t kCapacity = 1024;
+
+    /// Longer messages are truncated
+    constexpr size_t kMessageSize = 256;
+
+    /// Per call site and second
+    constexpr uint32_t kMaxMessagesPerSecond = 20;
+
+    constexpr int64_t kNanosecondsPerSecond = 1'000'000'000;
+
+    constexpr auto kFlushInterval = std::chrono::milliseconds(10);
+
+    int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char *getLevelName(Level level) {
+        switch (level) {
+            case Level::Info:
+                return "INFO";
+            case Level::Warn:
+                return "WARN";
+            case Level::Error:
+                return "ERROR";
+        }
+        return "?";
+    }
+
+    /**
+     * @brief Message slot of the ring, guarded by a sequence number
+     *
+     * The sequence is the ring position the slot can be claimed at next, position + 1 once the
+     * message at that position is complete and position + kCapacity once it has been written out.
+     */
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+
+        Level level = Level::Info;
+
+        const char *tag = nullptr;
+
+        CallSite *site = nullptr;
+
+        char message[kMessageSize]{};
+    };
+
+    /// The last message of a call site and how often it came again since it was written out
+    struct SiteState {
+        uint64_t hash = 0;
+
+        Level level = Level::Info;
+
+        const char *tag = nullptr;
+
+        uint32_t repeats = 0;
+
+        char message[kMessageSize]{};
+    };
+
+    class Logger {
+    public:
+        Logger() {
+            for (uint64_t i = 0; i < kCapacity; ++i) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            sinks.push_back(logger::createPlatformSink());
+            std::thread(&Logger::run, this).detach();
+            std::atexit(logger::flush);
+        }
+
+        /// Returns the ring position of a free slot, or false if the ring is full
+        bool claim(uint64_t &position) {
+            position = tail.load(std::memory_order_relaxed);
+            while (true) {
+                const uint64_t sequence =
+                        slots[position & (kCapacity - 1)].sequence.load(std::memory_order_acquire);
+                const auto difference =
+                        static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+                if (difference == 0) {
+                    // compare_exchange_weak reloads position when another producer was faster
+                    if (tail.compare_exchange_weak(position, position + 1,
+                                                   std::memory_order_relaxed)) {
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        Slot &getSlot(uint64_t position) {
+            return slots[position & (kCapacity - 1)];
+        }
+
+        void publish(uint64_t position) {
+            getSlot(position).sequence.store(position + 1, std::memory_order_release);
+        }
+
+        /// Writes out the complete messages in ring order, the consumer mutex has to be held
+        void drain(bool final) {
+            const int64_t time = now();
+            while (true) {
+                Slot &slot = getSlot(head);
+                if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+                    break;
+                }
+                process(slot);
+                slot.sequence.store(head + kCapacity, std::memory_order_release);
+                ++head;
+            }
+
+            const uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+            if (droppedNow != reportedDropped) {
+                char message[kMessageSize];
+                snprintf(message, sizeof(message), "Log ring full, %llu messages dropped",
+                         static_cast<unsigned long long>(droppedNow - reportedDropped));
+                emit({.level = Level::Warn, .tag = "Logger", .message = message});
+                reportedDropped = droppedNow;
+            }
+
+            // Repeats and rate limited messages are summed up about once a second
+            if (final || time - lastSummary >= kNanosecondsPerSecond) {
+                for (auto &[site, state]: sites) {
+                    summarize(*site, state);
+                }
+                lastSummary = time;
+            }
+
+            if (final) {
+                for (const auto &sink: sinks) {
+                    sink->flush();
+                }
+            }
+        }
+
+        /// Bypasses the ring, the consumer mutex has to be held
+        void emitNow(const Record &record) {
+            drain(false);
+            emit(record);
+            for (const auto &sink: sinks) {
+                sink->flush();
+            }
+        }
+
+        /// Guards everything below, producers never take it
+        std::mutex consumerMutex{};
+
+        std::vector<std::unique_ptr<Sink>> sinks{};
+
+        std::atomic<uint64_t> dropped{0};
+
+    private:
+        std::array<Slot, kCapacity> slots{};
+
+        /// Next position producers claim, on a cache line of its own
+        alignas(64) std::atomic<uint64_t> tail{0};
+
+        alignas(64) uint64_t head = 0;
+
+        uint64_t reportedDropped = 0;
+
+        /// Allocates once per call site, on the consumer side only
+        std::unordered_map<CallSite *, SiteState> sites{};
+
+        int64_t lastSummary = 0;
+
+        [[noreturn]] void run() {
+            while (true) {
+                std::this_thread::sleep_for(kFlushInterval);
+                std::lock_guard lock(consumerMutex);
+                drain(false);
+            }
+        }
+
+        void process(const Slot &slot) {
+            const uint64_t hash = hash_utils::fnv1a(
+                    slot.message, strlen(slot.message),
+                    hash_utils::combine(hash_utils::kFnvOffsetBasis,
+                                        static_cast<uint8_t>(slot.level)));
+            auto [entry, inserted] = sites.try_emplace(slot.site);
+            SiteState &state = entry->second;
+            if (!inserted && state.hash == hash) {
+                ++state.repeats;
+                return;
+            }
+            if (!inserted) {
+                summarize(*slot.site, state);
+            }
+
+            state.hash = hash;
+            state.level = slot.level;
+            state.tag = slot.tag;
+            memcpy(state.message, slot.message, kMessageSize);
+            emit({.level = slot.level, .tag = slot.tag, .message = slot.message});
+        }
+
+        void summarize(CallSite &site, SiteState &state) {
+            char message[kMessageSize + 64];
+            if (state.repeats > 0) {
+                snprintf(message, sizeof(message), "Repeated %u times: %s", state.repeats,
+                         state.message);
+                emit({.level = state.level, .tag = state.tag, .message = message});
+                state.repeats = 0;
+            }
+            const uint32_t suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed > 0) {
+                snprintf(message, sizeof(message), "Rate limited, %u more like: %s", suppressed,
+                         state.message);
+                emit({.level = state.level, .tag = state.tag, .message = message});
+            }
+        }
+
+        void emit(const Record &record) {
+            for (const auto &sink: sinks) {
+                sink->write(record);
+            }
+        }
+    };
+
+    /// Never destroyed, threads may still log while static destructors run
+    Logger &instance() {
+        static auto *logger = new Logger();
+        return *logger;
+    }
+
+    /// Writes lines in the format of the host logging before it was asynchronous
+    class StreamSink : public Sink {
+    public:
+        StreamSink(FILE *file, bool owned) : file(file), owned(owned) {}
+
+        ~StreamSink() override {
+            if (owned) {
+                fclose(file);
+            }
+        }
+
+        void write(const Record &record) override {
+            fprintf(file, "%s/%s: %s\n", getLevelName(record.level), record.tag, record.message);
+        }
+
+        void flush() override {
+            fflush(file);
+        }
+
+    private:
+        FILE *file;
+
+        bool owned;
+    };
+
+#if defined(__ANDROID__)
+    class LogcatSink : public Sink {
+    public:
+        void write(const Record &record) override {
+            __android_log_write(getPriority(record.level), record.tag, record.message);
+        }
+
+    private:
+        static int getPriority(Level level) {
+            switch (level) {
+                case Level::Info:
+                    return ANDROID_LOG_INFO;
+                case Level::Warn:
+                    return ANDROID_LOG_WARN;
+                case Level::Error:
+                    return ANDROID_LOG_ERROR;
+            }
+            return ANDROID_LOG_DEFAULT;
+        }
+    };
+#endif
+}
+
+namespace logger {
+    std::unique_ptr<Sink> createPlatformSink() {
+#if defined(__ANDROID__)
+        return std::make_unique<LogcatSink>();
+#else
+        return std::make_unique<StreamSink>(stderr, false);
+#endif
+    }
+
+    std::unique_ptr<Sink> createFileSink(const char *path) {
+        FILE *file = fopen(path, "a");
+        if (file == nullptr) {
+            return nullptr;
+        }
+        return std::make_unique<StreamSink>(file, true);
+    }
+
+    void addSink(std::unique_ptr<Sink> sink) {
+        if (sink == nullptr) {
+            return;
+        }
+        Logger &logger = instance();
+        std::lock_guard lock(logger.consumerMutex);
+        logger.sinks.push_back(std::move(sink));
+    }
+
+    void clearSinks() {
+        Logger &logger = instance();
+        std::lock_guard lock(logger.consumerMutex);
+        logger.drain(true);
+        logger.sinks.clear();
+    }
+
+    void write(CallSite &site, Level level, const char *tag, const char *format, ...) {
+        // Producers racing at the start of a second may let a few more messages through, the
+        // limit is about noise and not exact
+        const int64_t window = now() / kNanosecondsPerSecond;
+        int64_t current = site.window.load(std::memory_order_relaxed);
+        if (current != window &&
+            site.window.compare_exchange_strong(current, window, std::memory_order_relaxed)) {
+            site.count.store(0, std::memory_order_relaxed);
+        }
+        if (site.count.fetch_add(1, std::memory_order_relaxed) >= kMaxMessagesPerSecond) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Logger &logger = instance();
+        uint64_t position;
+        if (!logger.claim(position)) {
+            return;
+        }
+        Slot &slot = logger.getSlot(position);
+        slot.level = level;
+        slot.tag = tag;
+        slot.site = &site;
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(slot.message, kMessageSize, format, arguments);
+        va_end(arguments);
+        logger.publish(position);
+    }
+
+    void flush() {
+        Logger &logger = instance();
+        std::lock_guard lock(logger.consumerMutex);
+        logger.drain(true);
+    }
+
+    void writeNow(Level level, const char *tag, const char *format, ...) {
+        char message[kMessageSize];
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(message, sizeof(message), format, arguments);
+        va_end(arguments);
+
+        Logger &logger = instance();
+        std::lock_guard lock(logger.consumerMutex);
+        logger.emitNow({.level = level, .tag = tag, .message = message});
+    }
+
+    uint64_t getDroppedCount() {
+        return instance().dropped.load(std::memory_order_relaxed);
+    }
+}
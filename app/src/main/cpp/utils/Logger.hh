@@ -0,0 +1,93 @@
+//
+// Created by eternal on 2024/7/19.
+//
+
+#ifndef LEARNINGVULKAN_LOGGER_HH
+#define LEARNINGVULKAN_LOGGER_HH
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Logging without syscalls on the calling thread, behind the macros of Debug.hh
+ *
+ * Messages are formatted into a lock-free ring shared by all threads and written to the sinks by
+ * a background thread, which wakes up every few milliseconds. A full ring drops messages and the
+ * flusher reports how many. flush() writes everything queued so far on the calling thread, e.g.
+ * before an assert, and runs at exit.
+ *
+ * Every call site may log a limited number of messages per second, the rest are dropped before
+ * they are formatted. A message identical to the previous one of its call site is not written
+ * again. The flusher sums up both per call site about once a second and at flush().
+ *
+ * writeNow() skips the ring and the rate limit, for the last message before an abort, which would
+ * not run the flush at exit.
+ */
+namespace logger {
+    enum class Level : uint8_t {
+        Info,
+        Warn,
+        Error
+    };
+
+    /// Only compares, so that LOG_MIN_LEVEL 0 does not warn about a comparison that is always true
+    constexpr bool isEnabled(Level level, int minLevel) {
+        return static_cast<int>(level) >= minLevel;
+    }
+
+    /// Rate limiting state of one call site, a static of the logging macros
+    struct CallSite {
+        std::atomic<int64_t> window{-1};
+
+        std::atomic<uint32_t> count{0};
+
+        /// Messages over the limit, taken by the flusher
+        std::atomic<uint32_t> suppressed{0};
+    };
+
+    struct Record {
+        Level level;
+
+        const char *tag;
+
+        const char *message;
+    };
+
+    /// Called on the flusher thread, or on the thread calling flush(), never concurrently
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+
+        virtual void write(const Record &record) = 0;
+
+        virtual void flush() {}
+    };
+
+    /// Logcat on Android, stderr elsewhere. Installed until clearSinks().
+    std::unique_ptr<Sink> createPlatformSink();
+
+    /// Appends to a file, e.g. next to a capture on a device
+    std::unique_ptr<Sink> createFileSink(const char *path);
+
+    void addSink(std::unique_ptr<Sink> sink);
+
+    void clearSinks();
+
+    /// Tags are not copied, they have to outlive the process, e.g. string literals
+    void write(CallSite &site, Level level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+    /// Writes out every message queued before the call
+    void flush();
+
+    /// Writes the message on the calling thread after everything queued before it, and flushes
+    /// the sinks
+    void writeNow(Level level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+    /// Messages lost to a full ring since the start
+    uint64_t getDroppedCount();
+}
+
+#endif //LEARNINGVULKAN_LOGGER_HH
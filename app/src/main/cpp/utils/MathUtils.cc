@@ -4,6 +4,120 @@
 #include <cmath>
 #include "MathUtils.hh"
 
+namespace {
+    static_assert(sizeof(glm::mat3x2) == 6 * sizeof(float), "affine2DBatch writes packed floats");
+
+    // Sine and cosine come from the vec4 kernels glm uses with GLM_FORCE_INTRINSICS, which the
+    // glm target defines
+#if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_SSE2_BIT)
+#define MATH_UTILS_SIMD 1
+    using Float4 = glm_f32vec4;
+
+    struct SinCos4 {
+        Float4 sin;
+
+        Float4 cos;
+    };
+
+    Float4 load(const float *values) {
+        return _mm_loadu_ps(values);
+    }
+
+    /// Whether sinCos is accurate for every lane, see GLM_SIMD_SINCOS_MAX_INPUT
+    bool inSinCosRange(const Float4 x) {
+        return glm_vec4_sincos_in_range(x);
+    }
+
+    SinCos4 sinCos(const Float4 x) {
+        SinCos4 result;
+        glm_vec4_sincos(x, &result.sin, &result.cos);
+        return result;
+    }
+
+    Float4 multiply(const Float4 a, const Float4 b) {
+        return _mm_mul_ps(a, b);
+    }
+
+    Float4 negate(const Float4 a) {
+        return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+    }
+
+    /// Interleaves the columns of four transforms into 24 consecutive floats
+    void store(float *out, const Float4 c0x, const Float4 c0y, const Float4 c1x, const Float4 c1y,
+               const Float4 tx, const Float4 ty) {
+        const Float4 c0Low = _mm_unpacklo_ps(c0x, c0y);
+        const Float4 c0High = _mm_unpackhi_ps(c0x, c0y);
+        const Float4 c1Low = _mm_unpacklo_ps(c1x, c1y);
+        const Float4 c1High = _mm_unpackhi_ps(c1x, c1y);
+        const Float4 tLow = _mm_unpacklo_ps(tx, ty);
+        const Float4 tHigh = _mm_unpackhi_ps(tx, ty);
+        _mm_storeu_ps(out, _mm_movelh_ps(c0Low, c1Low));
+        _mm_storeu_ps(out + 4, _mm_shuffle_ps(tLow, c0Low, _MM_SHUFFLE(3, 2, 1, 0)));
+        _mm_storeu_ps(out + 8, _mm_movehl_ps(tLow, c1Low));
+        _mm_storeu_ps(out + 12, _mm_movelh_ps(c0High, c1High));
+        _mm_storeu_ps(out + 16, _mm_shuffle_ps(tHigh, c0High, _MM_SHUFFLE(3, 2, 1, 0)));
+        _mm_storeu_ps(out + 20, _mm_movehl_ps(tHigh, c1High));
+    }
+#elif GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_NEON_BIT)
+#define MATH_UTILS_SIMD 1
+    using Float4 = float32x4_t;
+
+    struct SinCos4 {
+        Float4 sin;
+
+        Float4 cos;
+    };
+
+    Float4 load(const float *values) {
+        return vld1q_f32(values);
+    }
+
+    bool inSinCosRange(const Float4 x) {
+        return glm::neon::all_within(x, GLM_SIMD_SINCOS_MAX_INPUT);
+    }
+
+    SinCos4 sinCos(const Float4 x) {
+        SinCos4 result;
+        glm::neon::sincos(x, result.sin, result.cos);
+        return result;
+    }
+
+    Float4 multiply(const Float4 a, const Float4 b) {
+        return vmulq_f32(a, b);
+    }
+
+    Float4 negate(const Float4 a) {
+        return vnegq_f32(a);
+    }
+
+    /// Interleaves the columns of four transforms into 24 consecutive floats
+    void store(float *out, const Float4 c0x, const Float4 c0y, const Float4 c1x, const Float4 c1y,
+               const Float4 tx, const Float4 ty) {
+        const float32x4x2_t c0 = vzipq_f32(c0x, c0y);
+        const float32x4x2_t c1 = vzipq_f32(c1x, c1y);
+        const float32x4x2_t t = vzipq_f32(tx, ty);
+        for (int half = 0; half < 2; ++half) {
+            float *halfOut = out + 12 * half;
+            vst1q_f32(halfOut,
+                      vcombine_f32(vget_low_f32(c0.val[half]), vget_low_f32(c1.val[half])));
+            vst1q_f32(halfOut + 4,
+                      vcombine_f32(vget_low_f32(t.val[half]), vget_high_f32(c0.val[half])));
+            vst1q_f32(halfOut + 8,
+                      vcombine_f32(vget_high_f32(c1.val[half]), vget_high_f32(t.val[half])));
+        }
+    }
+#endif
+
+    void affine2DScalar(const float translationX, const float translationY, const float zRadians,
+                        const float scaleX, const float scaleY, glm::mat3x2 &out) {
+        const float s = std::sin(zRadians);
+        const float c = std::cos(zRadians);
+        out = {{c * scaleX,   s * scaleX},
+               {-s * scaleY,  c * scaleY},
+               {translationX, translationY}};
+    }
+}
+
 namespace math_utils {
     glm::mat4x4 scale2D(const glm::vec2 &s) {
         return {{s.x, 0,   0, 0},
@@ -28,6 +142,58 @@ namespace math_utils {
                 {t.x, t.y, 0, 1}};
     }
 
+    glm::mat4x4 transform2D(const glm::vec2 &translation, const float zRadians,
+                            const glm::vec2 &scale) {
+        const float s = std::sin(zRadians);
+        const float c = std::cos(zRadians);
+        return {{c * scale.x,   s * scale.x,   0, 0},
+                {-s * scale.y,  c * scale.y,   0, 0},
+                {0,             0,             1, 0},
+                {translation.x, translation.y, 0, 1}};
+    }
+
+    glm::mat3x2 affine2D(const glm::vec2 &translation, const float zRadians,
+                         const glm::vec2 &scale) {
+        glm::mat3x2 affine;
+        affine2DScalar(translation.x, translation.y, zRadians, scale.x, scale.y, affine);
+        return affine;
+    }
+
+    glm::mat4x4 toMatrix(const glm::mat3x2 &affine) {
+        return {{affine[0], 0, 0},
+                {affine[1], 0, 0},
+                {0, 0,      1, 0},
+                {affine[2], 0, 1}};
+    }
+
+    void affine2DBatch(const float *translationX, const float *translationY, const float *zRadians,
+                       const float *scaleX, const float *scaleY, const size_t count,
+                       glm::mat3x2 *out) {
+        size_t i = 0;
+#if defined(MATH_UTILS_SIMD)
+        for (; i + 4 <= count; i += 4) {
+            const Float4 angles = load(zRadians + i);
+            if (!inSinCosRange(angles)) {
+                for (size_t j = i; j < i + 4; ++j) {
+                    affine2DScalar(translationX[j], translationY[j], zRadians[j], scaleX[j],
+                                   scaleY[j], out[j]);
+                }
+                continue;
+            }
+            const SinCos4 sc = sinCos(angles);
+            const Float4 sx = load(scaleX + i);
+            const Float4 sy = load(scaleY + i);
+            store(&out[i][0][0], multiply(sc.cos, sx), multiply(sc.sin, sx),
+                  negate(multiply(sc.sin, sy)), multiply(sc.cos, sy), load(translationX + i),
+                  load(translationY + i));
+        }
+#endif
+        for (; i < count; ++i) {
+            affine2DScalar(translationX[i], translationY[i], zRadians[i], scaleX[i], scaleY[i],
+                           out[i]);
+        }
+    }
+
     glm::mat4x4
     orthographicProjection(const float left, const float top, const float right, const float bottom,
                            const float near, const float far) {
@@ -4,6 +4,7 @@
 
 #ifndef LEARNINGVULKAN_MATHUTILS_HH
 #define LEARNINGVULKAN_MATHUTILS_HH
+#include <cstddef>
 #include <glm/glm.hpp>
 
 namespace math_utils {
@@ -13,6 +14,25 @@ namespace math_utils {
 
     glm::mat4x4 translate2D(const glm::vec2& t);
 
+    /// translate2D(translation) * rotateZ(zRadians) * scale2D(scale), without the products
+    glm::mat4x4 transform2D(const glm::vec2 &translation, float zRadians, const glm::vec2 &scale);
+
+    /// The 2D part of transform2D, 6 floats packed as columns for instance data
+    glm::mat3x2 affine2D(const glm::vec2 &translation, float zRadians, const glm::vec2 &scale);
+
+    /// The same transform as transform2D, for a shader that takes a mat4
+    glm::mat4x4 toMatrix(const glm::mat3x2 &affine);
+
+    /**
+     * @brief affine2D of count transforms given as arrays, four at a time on SSE2 and NEON
+     *
+     * Sine and cosine come from glm's vec4 kernel, within 2.4 ULP of the exact values for angles
+     * up to 8192 radians. Groups with a larger angle and the last count % 4 transforms use
+     * std::sin and std::cos. The input arrays need no alignment and out may not overlap them.
+     */
+    void affine2DBatch(const float *translationX, const float *translationY, const float *zRadians,
+                       const float *scaleX, const float *scaleY, size_t count, glm::mat3x2 *out);
+
     glm::mat4x4 orthographicProjection(float left, float top, float right, float bottom, float near,
                                        float far);
 }
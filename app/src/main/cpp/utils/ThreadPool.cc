@@ -0,0 +1,78 @@
+//
+// Created by eternal on 2024/6/12.
+//
+#include <string>
+#include "CpuProfiler.hh"
+#include "ThreadPool.hh"
+
+ThreadPool::ThreadPool(uint32_t threadCount) {
+    workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    // Queued tasks are still drained before the workers exit
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(Task &&task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.emplace_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::enqueueFront(Task &&task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.emplace_front(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return tasks.empty() && runningTasks == 0; });
+}
+
+uint32_t ThreadPool::getThreadCount() const {
+    return static_cast<uint32_t>(workers.size());
+}
+
+void ThreadPool::run(uint32_t workerIndex) {
+    const std::string threadName = "Worker " + std::to_string(workerIndex);
+    PROFILE_THREAD_NAME(threadName.c_str());
+
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            ++runningTasks;
+        }
+
+        task(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --runningTasks;
+        }
+        idle.notify_all();
+    }
+}
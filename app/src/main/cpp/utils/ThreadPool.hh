@@ -0,0 +1,62 @@
+//
+// Created by eternal on 2024/6/12.
+//
+
+#ifndef LEARNINGVULKAN_THREADPOOL_HH
+#define LEARNINGVULKAN_THREADPOOL_HH
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed size pool of worker threads
+ *
+ * Tasks receive the index of the worker running them, so they can use per-worker resources
+ * (e.g. one VkPipelineCache per worker) without locking.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void(uint32_t workerIndex)>;
+
+    explicit ThreadPool(uint32_t threadCount);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void enqueue(Task &&task);
+
+    /// Runs the task ahead of everything already queued, e.g. work a frame is waiting for
+    void enqueueFront(Task &&task);
+
+    /// Blocks until the queue is empty and no task is running
+    void waitIdle();
+
+    uint32_t getThreadCount() const;
+
+private:
+    std::vector<std::thread> workers{};
+
+    std::deque<Task> tasks{};
+
+    std::mutex mutex{};
+
+    std::condition_variable taskAvailable{};
+
+    std::condition_variable idle{};
+
+    uint32_t runningTasks = 0;
+
+    bool stopping = false;
+
+    void run(uint32_t workerIndex);
+};
+
+#endif //LEARNINGVULKAN_THREADPOOL_HH
@@ -0,0 +1,838 @@
+//
+// Created by eternal on 2024/7/8.
+//
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Debug.hh"
+#include "NullDriver.hh"
+
+// Fake handles are made from integers, which only works where every handle is a pointer
+static_assert(sizeof(void *) == 8, "The null driver needs a 64-bit target");
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    enum EntryIndex : uint32_t {
+#define NULL_ENTRY_INDEX(name) Index_##name,
+#define NULL_EXTENSION_ENTRY_INDEX(extension, name) NULL_ENTRY_INDEX(name)
+        VK_ALL_FUNCTIONS(NULL_ENTRY_INDEX, NULL_EXTENSION_ENTRY_INDEX)
+#undef NULL_EXTENSION_ENTRY_INDEX
+#undef NULL_ENTRY_INDEX
+        Index_vkGetInstanceProcAddr,
+        kEntryCount
+    };
+
+    constexpr std::array<const char *, kEntryCount> kEntryNames{
+#define NULL_ENTRY_NAME(name) #name,
+#define NULL_EXTENSION_ENTRY_NAME(extension, name) NULL_ENTRY_NAME(name)
+            VK_ALL_FUNCTIONS(NULL_ENTRY_NAME, NULL_EXTENSION_ENTRY_NAME)
+#undef NULL_EXTENSION_ENTRY_NAME
+#undef NULL_ENTRY_NAME
+            "vkGetInstanceProcAddr"
+    };
+
+    std::array<std::atomic<uint64_t>, kEntryCount> callCounts{};
+
+    std::atomic<uint64_t> nextHandle{0x1000};
+
+    template<typename Handle>
+    Handle newHandle() {
+        return reinterpret_cast<Handle>(static_cast<uintptr_t>(nextHandle.fetch_add(0x10)));
+    }
+
+    struct Fence {
+        bool signaled = false;
+
+        bool submitted = false;
+
+        Clock::time_point readyTime{};
+    };
+
+    struct Swapchain {
+        std::vector<VkImage> images{};
+
+        uint32_t nextImage = 0;
+    };
+
+    struct Allocation {
+        std::unique_ptr<std::byte[]> data{};
+
+        VkDeviceSize size = 0;
+    };
+
+    struct State {
+        std::mutex mutex{};
+
+        std::chrono::microseconds fenceLatency{0};
+
+        /// When everything submitted so far has completed
+        Clock::time_point idleTime{};
+
+        uint64_t allocatedSize = 0;
+
+        std::unordered_map<VkDeviceMemory, Allocation> allocations{};
+
+        std::unordered_map<VkBuffer, VkDeviceSize> bufferSizes{};
+
+        std::unordered_map<VkImage, VkDeviceSize> imageSizes{};
+
+        std::unordered_map<VkFence, Fence> fences{};
+
+        std::unordered_map<VkSwapchainKHR, Swapchain> swapchains{};
+    };
+
+    State &state() {
+        static State instance;
+        return instance;
+    }
+
+    const VkPhysicalDevice kPhysicalDevice = reinterpret_cast<VkPhysicalDevice>(uintptr_t{0x100});
+
+    const VkQueue kQueue = reinterpret_cast<VkQueue>(uintptr_t{0x200});
+
+    constexpr VkDeviceSize kBufferAlignment = 256;
+
+    constexpr VkDeviceSize kImageAlignment = 4096;
+
+    template<typename T>
+    VkResult enumerate(const T *items, uint32_t itemCount, uint32_t *count, T *out) {
+        if (out == nullptr) {
+            *count = itemCount;
+            return VK_SUCCESS;
+        }
+        const uint32_t copied = std::min(*count, itemCount);
+        std::copy(items, items + copied, out);
+        *count = copied;
+        return copied < itemCount ? VK_INCOMPLETE : VK_SUCCESS;
+    }
+
+    VkExtensionProperties extension(const char *name, uint32_t specVersion) {
+        VkExtensionProperties properties{};
+        strncpy(properties.extensionName, name, VK_MAX_EXTENSION_NAME_SIZE - 1);
+        properties.specVersion = specVersion;
+        return properties;
+    }
+
+    /// The structure of type sType chained to pNext, nullptr if there is none
+    template<typename T>
+    T *findChained(void *pNext, VkStructureType sType) {
+        for (auto *next = static_cast<VkBaseOutStructure *>(pNext); next != nullptr;
+             next = next->pNext) {
+            if (next->sType == sType) {
+                return reinterpret_cast<T *>(next);
+            }
+        }
+        return nullptr;
+    }
+
+    VkPhysicalDeviceProperties makeProperties() {
+        VkPhysicalDeviceProperties properties{};
+        properties.apiVersion = VK_API_VERSION_1_1;
+        properties.driverVersion = 1;
+        properties.deviceType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+        strncpy(properties.deviceName, "Null Device", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+
+        // Generous limits, nothing is rendered anyway
+        VkPhysicalDeviceLimits &limits = properties.limits;
+        limits.maxImageDimension1D = 16384;
+        limits.maxImageDimension2D = 16384;
+        limits.maxImageDimension3D = 2048;
+        limits.maxImageDimensionCube = 16384;
+        limits.maxImageArrayLayers = 2048;
+        limits.maxTexelBufferElements = 1u << 27;
+        limits.maxUniformBufferRange = 65536;
+        limits.maxStorageBufferRange = 1u << 30;
+        limits.maxPushConstantsSize = 128;
+        limits.maxMemoryAllocationCount = 4096;
+        limits.maxSamplerAllocationCount = 4000;
+        limits.bufferImageGranularity = 1;
+        limits.maxBoundDescriptorSets = 8;
+        limits.maxPerStageDescriptorSamplers = 1u << 20;
+        limits.maxPerStageDescriptorUniformBuffers = 1u << 20;
+        limits.maxPerStageDescriptorStorageBuffers = 1u << 20;
+        limits.maxPerStageDescriptorSampledImages = 1u << 20;
+        limits.maxPerStageDescriptorStorageImages = 1u << 20;
+        limits.maxPerStageDescriptorInputAttachments = 8;
+        limits.maxPerStageResources = 1u << 20;
+        limits.maxDescriptorSetSamplers = 1u << 20;
+        limits.maxDescriptorSetUniformBuffers = 1u << 20;
+        limits.maxDescriptorSetUniformBuffersDynamic = 16;
+        limits.maxDescriptorSetStorageBuffers = 1u << 20;
+        limits.maxDescriptorSetStorageBuffersDynamic = 16;
+        limits.maxDescriptorSetSampledImages = 1u << 20;
+        limits.maxDescriptorSetStorageImages = 1u << 20;
+        limits.maxDescriptorSetInputAttachments = 8;
+        limits.maxVertexInputAttributes = 16;
+        limits.maxVertexInputBindings = 16;
+        limits.maxVertexInputAttributeOffset = 2047;
+        limits.maxVertexInputBindingStride = 2048;
+        limits.maxVertexOutputComponents = 128;
+        limits.maxFragmentInputComponents = 128;
+        limits.maxFragmentOutputAttachments = 8;
+        limits.maxComputeSharedMemorySize = 32768;
+        limits.maxComputeWorkGroupCount[0] = 65535;
+        limits.maxComputeWorkGroupCount[1] = 65535;
+        limits.maxComputeWorkGroupCount[2] = 65535;
+        limits.maxComputeWorkGroupInvocations = 1024;
+        limits.maxComputeWorkGroupSize[0] = 1024;
+        limits.maxComputeWorkGroupSize[1] = 1024;
+        limits.maxComputeWorkGroupSize[2] = 64;
+        limits.maxDrawIndexedIndexValue = UINT32_MAX;
+        limits.maxDrawIndirectCount = UINT32_MAX;
+        limits.maxSamplerLodBias = 16.0f;
+        limits.maxSamplerAnisotropy = 16.0f;
+        limits.maxViewports = 1;
+        limits.maxViewportDimensions[0] = 16384;
+        limits.maxViewportDimensions[1] = 16384;
+        limits.viewportBoundsRange[0] = -32768.0f;
+        limits.viewportBoundsRange[1] = 32767.0f;
+        limits.minMemoryMapAlignment = 64;
+        limits.minTexelBufferOffsetAlignment = kBufferAlignment;
+        limits.minUniformBufferOffsetAlignment = kBufferAlignment;
+        limits.minStorageBufferOffsetAlignment = kBufferAlignment;
+        limits.maxFramebufferWidth = 16384;
+        limits.maxFramebufferHeight = 16384;
+        limits.maxFramebufferLayers = 1024;
+        limits.framebufferColorSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.framebufferDepthSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.framebufferStencilSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.framebufferNoAttachmentsSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.maxColorAttachments = 8;
+        limits.sampledImageColorSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.sampledImageIntegerSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.sampledImageDepthSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.sampledImageStencilSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.storageImageSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+        limits.maxSampleMaskWords = 1;
+        limits.timestampComputeAndGraphics = VK_TRUE;
+        limits.timestampPeriod = 1.0f;
+        limits.discreteQueuePriorities = 2;
+        limits.lineWidthRange[0] = 1.0f;
+        limits.lineWidthRange[1] = 1.0f;
+        limits.pointSizeRange[0] = 1.0f;
+        limits.pointSizeRange[1] = 1.0f;
+        limits.optimalBufferCopyOffsetAlignment = 1;
+        limits.optimalBufferCopyRowPitchAlignment = 1;
+        limits.nonCoherentAtomSize = 64;
+        return properties;
+    }
+
+    /// Whether a parameter receives the handle of a single created object
+    template<typename T>
+    constexpr bool isHandleOutput = false;
+
+    template<typename Object>
+    constexpr bool isHandleOutput<Object **> = std::is_class_v<Object>;
+
+    /// Counts the call and returns success. Entry points creating a single object, such as most
+    /// vkCreate* ones, get a fresh handle in their last parameter.
+    template<typename Function, uint32_t Index>
+    struct Noop;
+
+    template<typename Result, typename... Args, uint32_t Index>
+    struct Noop<Result (VKAPI_PTR *)(Args...), Index> {
+        static Result VKAPI_CALL call(Args... args) {
+            callCounts[Index].fetch_add(1, std::memory_order_relaxed);
+            if constexpr (std::is_same_v<Result, VkResult>) {
+                if constexpr (sizeof...(Args) > 0) {
+                    using Last = std::tuple_element_t<sizeof...(Args) - 1, std::tuple<Args...>>;
+                    if constexpr (isHandleOutput<Last>) {
+                        Last output = std::get<sizeof...(Args) - 1>(std::forward_as_tuple(args...));
+                        *output = newHandle<std::remove_pointer_t<Last>>();
+                    }
+                }
+                return VK_SUCCESS;
+            } else if constexpr (!std::is_void_v<Result>) {
+                return Result{};
+            }
+        }
+    };
+
+    /// Counts the call and forwards it to an implementation
+    template<auto Function, uint32_t Index>
+    struct Counted;
+
+    template<typename Result, typename... Args, Result (*Function)(Args...), uint32_t Index>
+    struct Counted<Function, Index> {
+        static Result VKAPI_CALL call(Args... args) {
+            callCounts[Index].fetch_add(1, std::memory_order_relaxed);
+            return Function(args...);
+        }
+    };
+
+    /* Global */
+
+    VkResult CreateInstance(const VkInstanceCreateInfo *, const VkAllocationCallbacks *,
+                            VkInstance *pInstance) {
+        *pInstance = newHandle<VkInstance>();
+        return VK_SUCCESS;
+    }
+
+    VkResult EnumerateInstanceExtensionProperties(const char *, uint32_t *pPropertyCount,
+                                                  VkExtensionProperties *pProperties) {
+        const std::array extensions{
+                extension(VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_SURFACE_SPEC_VERSION)
+        };
+        return enumerate(extensions.data(), extensions.size(), pPropertyCount, pProperties);
+    }
+
+    VkResult EnumerateInstanceLayerProperties(uint32_t *pPropertyCount, VkLayerProperties *) {
+        *pPropertyCount = 0;
+        return VK_SUCCESS;
+    }
+
+    /* Instance */
+
+    VkResult EnumeratePhysicalDevices(VkInstance, uint32_t *pPhysicalDeviceCount,
+                                      VkPhysicalDevice *pPhysicalDevices) {
+        return enumerate(&kPhysicalDevice, 1, pPhysicalDeviceCount, pPhysicalDevices);
+    }
+
+    void GetPhysicalDeviceFeatures(VkPhysicalDevice, VkPhysicalDeviceFeatures *pFeatures) {
+        *pFeatures = {};
+    }
+
+    void GetPhysicalDeviceFeatures2(VkPhysicalDevice, VkPhysicalDeviceFeatures2 *pFeatures) {
+        pFeatures->features = {};
+        // Descriptor indexing is reported for BindlessDescriptors, other chained extension
+        // features stay as the caller left them
+        auto *indexing = findChained<VkPhysicalDeviceDescriptorIndexingFeaturesEXT>(
+                pFeatures->pNext,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT);
+        if (indexing != nullptr) {
+            indexing->shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            indexing->shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+            indexing->descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            indexing->descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            indexing->descriptorBindingPartiallyBound = VK_TRUE;
+            indexing->runtimeDescriptorArray = VK_TRUE;
+        }
+    }
+
+    void GetPhysicalDeviceFormatProperties(VkPhysicalDevice, VkFormat,
+                                           VkFormatProperties *pFormatProperties) {
+        const VkFormatFeatureFlags imageFeatures =
+                VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT |
+                VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT |
+                VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT |
+                VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+                VK_FORMAT_FEATURE_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+        *pFormatProperties = {
+                .linearTilingFeatures = imageFeatures,
+                .optimalTilingFeatures = imageFeatures,
+                .bufferFeatures = VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT |
+                                  VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT |
+                                  VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_BIT
+        };
+    }
+
+    void GetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties *pProperties) {
+        *pProperties = makeProperties();
+    }
+
+    void GetPhysicalDeviceProperties2(VkPhysicalDevice, VkPhysicalDeviceProperties2 *pProperties) {
+        pProperties->properties = makeProperties();
+        auto *indexing = findChained<VkPhysicalDeviceDescriptorIndexingPropertiesEXT>(
+                pProperties->pNext,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT);
+        if (indexing != nullptr) {
+            indexing->maxUpdateAfterBindDescriptorsInAllPools = 1u << 20;
+            indexing->maxPerStageDescriptorUpdateAfterBindStorageBuffers = 1u << 20;
+            indexing->maxPerStageDescriptorUpdateAfterBindSampledImages = 1u << 20;
+            indexing->maxPerStageUpdateAfterBindResources = 1u << 20;
+            indexing->maxDescriptorSetUpdateAfterBindStorageBuffers = 1u << 20;
+            indexing->maxDescriptorSetUpdateAfterBindSampledImages = 1u << 20;
+        }
+    }
+
+    void GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice,
+                                                uint32_t *pQueueFamilyPropertyCount,
+                                                VkQueueFamilyProperties *pQueueFamilyProperties) {
+        const VkQueueFamilyProperties family{
+                .queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT,
+                .queueCount = 1,
+                .timestampValidBits = 64,
+                .minImageTransferGranularity = {1, 1, 1}
+        };
+        enumerate(&family, 1, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+    }
+
+    void GetPhysicalDeviceMemoryProperties(VkPhysicalDevice,
+                                           VkPhysicalDeviceMemoryProperties *pMemoryProperties) {
+        *pMemoryProperties = {};
+        pMemoryProperties->memoryTypeCount = 1;
+        pMemoryProperties->memoryTypes[0] = {
+                .propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+                                 VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                .heapIndex = 0
+        };
+        pMemoryProperties->memoryHeapCount = 1;
+        pMemoryProperties->memoryHeaps[0] = {
+                .size = VkDeviceSize{4} << 30,
+                .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT
+        };
+    }
+
+    PFN_vkVoidFunction GetInstanceProcAddr(VkInstance, const char *pName);
+
+    PFN_vkVoidFunction GetDeviceProcAddr(VkDevice, const char *pName) {
+        return GetInstanceProcAddr(VK_NULL_HANDLE, pName);
+    }
+
+    VkResult CreateDevice(VkPhysicalDevice, const VkDeviceCreateInfo *,
+                          const VkAllocationCallbacks *, VkDevice *pDevice) {
+        *pDevice = newHandle<VkDevice>();
+        return VK_SUCCESS;
+    }
+
+    VkResult EnumerateDeviceExtensionProperties(VkPhysicalDevice, const char *,
+                                                uint32_t *pPropertyCount,
+                                                VkExtensionProperties *pProperties) {
+        // The renderer's extensions, their commands are recorded like any other
+        const std::array extensions{
+                extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_SWAPCHAIN_SPEC_VERSION),
+                extension(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+                          VK_KHR_CREATE_RENDERPASS_2_SPEC_VERSION),
+                extension(VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_KHR_MAINTENANCE3_SPEC_VERSION),
+                extension(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+                          VK_KHR_DEPTH_STENCIL_RESOLVE_SPEC_VERSION),
+                extension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+                          VK_KHR_DYNAMIC_RENDERING_SPEC_VERSION),
+                extension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
+                          VK_KHR_SYNCHRONIZATION_2_SPEC_VERSION),
+                extension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+                          VK_KHR_PIPELINE_LIBRARY_SPEC_VERSION),
+                extension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
+                          VK_EXT_GRAPHICS_PIPELINE_LIBRARY_SPEC_VERSION),
+                extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+                          VK_EXT_DESCRIPTOR_INDEXING_SPEC_VERSION)
+        };
+        return enumerate(extensions.data(), extensions.size(), pPropertyCount, pProperties);
+    }
+
+    VkResult EnumerateDeviceLayerProperties(VkPhysicalDevice, uint32_t *pPropertyCount,
+                                            VkLayerProperties *) {
+        *pPropertyCount = 0;
+        return VK_SUCCESS;
+    }
+
+    /* Device */
+
+    void GetDeviceQueue(VkDevice, uint32_t, uint32_t, VkQueue *pQueue) {
+        *pQueue = kQueue;
+    }
+
+    VkResult QueueSubmit(VkQueue, uint32_t, const VkSubmitInfo *, VkFence fence) {
+        State &driver = state();
+        std::lock_guard lock(driver.mutex);
+        const Clock::time_point readyTime = Clock::now() + driver.fenceLatency;
+        driver.idleTime = std::max(driver.idleTime, readyTime);
+        if (fence != VK_NULL_HANDLE) {
+            Fence &status = driver.fences[fence];
+            status.submitted = true;
+            status.readyTime = readyTime;
+        }
+        return VK_SUCCESS;
+    }
+
+    VkResult QueueWaitIdle(VkQueue) {
+        Clock::time_point idleTime;
+        {
+            std::lock_guard lock(state().mutex);
+            idleTime = state().idleTime;
+        }
+        std::this_thread::sleep_until(idleTime);
+        return VK_SUCCESS;
+    }
+
+    VkResult DeviceWaitIdle(VkDevice) {
+        return QueueWaitIdle(kQueue);
+    }
+
+    VkResult AllocateMemory(VkDevice, const VkMemoryAllocateInfo *pAllocateInfo,
+                            const VkAllocationCallbacks *, VkDeviceMemory *pMemory) {
+        State &driver = state();
+        std::lock_guard lock(driver.mutex);
+        *pMemory = newHandle<VkDeviceMemory>();
+        driver.allocations[*pMemory] = {
+                .data = std::make_unique<std::byte[]>(pAllocateInfo->allocationSize),
+                .size = pAllocateInfo->allocationSize
+        };
+        driver.allocatedSize += pAllocateInfo->allocationSize;
+        return VK_SUCCESS;
+    }
+
+    void FreeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks *) {
+        State &driver = state();
+        std::lock_guard lock(driver.mutex);
+        const auto allocation = driver.allocations.find(memory);
+        if (allocation != driver.allocations.end()) {
+            driver.allocatedSize -= allocation->second.size;
+            driver.allocations.erase(allocation);
+        }
+    }
+
+    VkResult MapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize,
+                       VkMemoryMapFlags, void **ppData) {
+        State &driver = state();
+        std::lock_guard lock(driver.mutex);
+        const auto allocation = driver.allocations.find(memory);
+        if (allocation == driver.allocations.end()) {
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+        *ppData = allocation->second.data.get() + offset;
+        return VK_SUCCESS;
+    }
+
+    VkResult CreateFence(VkDevice, const VkFenceCreateInfo *pCreateInfo,
+                         const VkAllocationCallbacks *, VkFence *pFence) {
+        State &driver = state();
+        std::lock_guard lock(driver.mutex);
+        *pFence = newHandle<VkFence>();
+        driver.fences[*pFence].signaled = (pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0;
+        return VK_SUCCESS;
+    }
+
+    void DestroyFence(VkDevice, VkFence fence, const VkAllocationCallbacks *) {
+        std::lock_guard lock(state().mutex);
+        state().fences.erase(fence);
+    }
+
+    VkResult ResetFences(VkDevice, uint32_t fenceCount, const VkFence *pFences) {
+        std::lock_guard lock(state().mutex);
+        for (uint32_t i = 0; i < fenceCount; ++i) {
+            state().fences[pFences[i]] = {};
+        }
+        return VK_SUCCESS;
+    }
+
+    VkResult GetFenceStatus(VkDevice, VkFence fence) {
+        std::lock_guard lock(state().mutex);
+        const Fence &status = state().fences[fence];
+        const bool signaled = status.signaled ||
+                              (status.submitted && Clock::now() >= status.readyTime);
+        return signaled ? VK_SUCCESS : VK_NOT_READY;
+    }
+
+    VkResult WaitForFences(VkDevice, uint32_t fenceCount, const VkFence *pFences,
+                           VkBool32 waitAll, uint64_t timeout) {
+        State &driver = state();
+        Clock::time_point readyTime = waitAll ? Clock::time_point::min() : Clock::time_point::max();
+        {
+            std::lock_guard lock(driver.mutex);
+            for (uint32_t i = 0; i < fenceCount; ++i) {
+                const Fence &fence = driver.fences[pFences[i]];
+                // A fence that was never submitted never signals
+                const Clock::time_point fenceReady =
+                        fence.signaled ? Clock::time_point::min()
+                                       : fence.submitted ? fence.readyTime
+                                                         : Clock::time_point::max();
+                readyTime = waitAll ? std::max(readyTime, fenceReady)
+                                    : std::min(readyTime, fenceReady);
+            }
+        }
+
+        if (readyTime == Clock::time_point::max()) {
+            LOGW("Null driver: waiting for fences that were never submitted");
+            return VK_TIMEOUT;
+        }
+        const Clock::time_point now = Clock::now();
+        if (readyTime > now) {
+            const auto remaining =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(readyTime - now);
+            if (static_cast<uint64_t>(remaining.count()) > timeout) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(timeout));
+                return VK_TIMEOUT;
+            }
+            std::this_thread::sleep_until(readyTime);
+        }
+        return VK_SUCCESS;
+    }
+
+    VkResult CreateBuffer(VkDevice, const VkBufferCreateInfo *pCreateInfo,
+                          const VkAllocationCallbacks *, VkBuffer *pBuffer) {
+        std::lock_guard lock(state().mutex);
+        *pBuffer = newHandle<VkBuffer>();
+        state().bufferSizes[*pBuffer] = pCreateInfo->size;
+        return VK_SUCCESS;
+    }
+
+    void DestroyBuffer(VkDevice, VkBuffer buffer, const VkAllocationCallbacks *) {
+        std::lock_guard lock(state().mutex);
+        state().bufferSizes.erase(buffer);
+    }
+
+    void GetBufferMemoryRequirements(VkDevice, VkBuffer buffer,
+                                     VkMemoryRequirements *pMemoryRequirements) {
+        std::lock_guard lock(state().mutex);
+        const VkDeviceSize size = state().bufferSizes[buffer];
+        *pMemoryRequirements = {
+                .size = (size + kBufferAlignment - 1) & ~(kBufferAlignment - 1),
+                .alignment = kBufferAlignment,
+                .memoryTypeBits = 1
+        };
+    }
+
+    VkResult CreateImage(VkDevice, const VkImageCreateInfo *pCreateInfo,
+                         const VkAllocationCallbacks *, VkImage *pImage) {
+        // 16 bytes per texel covers every format, a full mip chain adds at most a third
+        const VkExtent3D &extent = pCreateInfo->extent;
+        VkDeviceSize size = VkDeviceSize{16} * extent.width * extent.height * extent.depth *
+                            pCreateInfo->arrayLayers;
+        if (pCreateInfo->mipLevels > 1) {
+            size += size / 3;
+        }
+
+        std::lock_guard lock(state().mutex);
+        *pImage = newHandle<VkImage>();
+        state().imageSizes[*pImage] = size;
+        return VK_SUCCESS;
+    }
+
+    void DestroyImage(VkDevice, VkImage image, const VkAllocationCallbacks *) {
+        std::lock_guard lock(state().mutex);
+        state().imageSizes.erase(image);
+    }
+
+    void GetImageMemoryRequirements(VkDevice, VkImage image,
+                                    VkMemoryRequirements *pMemoryRequirements) {
+        std::lock_guard lock(state().mutex);
+        const VkDeviceSize size = state().imageSizes[image];
+        *pMemoryRequirements = {
+                .size = (size + kImageAlignment - 1) & ~(kImageAlignment - 1),
+                .alignment = kImageAlignment,
+                .memoryTypeBits = 1
+        };
+    }
+
+    VkResult GetQueryPoolResults(VkDevice, VkQueryPool, uint32_t, uint32_t queryCount,
+                                 size_t, void *pData, VkDeviceSize stride,
+                                 VkQueryResultFlags flags) {
+        // Timestamps read as the host clock in nanoseconds, timestampPeriod is 1
+        const auto now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now().time_since_epoch()).count());
+        const bool wide = (flags & VK_QUERY_RESULT_64_BIT) != 0;
+        const bool availability = (flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT) != 0;
+        auto *data = static_cast<uint8_t *>(pData);
+        for (uint32_t i = 0; i < queryCount; ++i) {
+            uint8_t *result = data + i * stride;
+            if (wide) {
+                const uint64_t values[]{now, 1};
+                memcpy(result, values, availability ? 16 : 8);
+            } else {
+                const uint32_t values[]{static_cast<uint32_t>(now), 1};
+                memcpy(result, values, availability ? 8 : 4);
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+    VkResult GetPipelineCacheData(VkDevice, VkPipelineCache, size_t *pDataSize, void *) {
+        *pDataSize = 0;
+        return VK_SUCCESS;
+    }
+
+    VkResult CreateGraphicsPipelines(VkDevice, VkPipelineCache, uint32_t createInfoCount,
+                                     const VkGraphicsPipelineCreateInfo *,
+                                     const VkAllocationCallbacks *, VkPipeline *pPipelines) {
+        std::generate_n(pPipelines, createInfoCount, newHandle<VkPipeline>);
+        return VK_SUCCESS;
+    }
+
+    VkResult CreateComputePipelines(VkDevice, VkPipelineCache, uint32_t createInfoCount,
+                                    const VkComputePipelineCreateInfo *,
+                                    const VkAllocationCallbacks *, VkPipeline *pPipelines) {
+        std::generate_n(pPipelines, createInfoCount, newHandle<VkPipeline>);
+        return VK_SUCCESS;
+    }
+
+    VkResult AllocateDescriptorSets(VkDevice, const VkDescriptorSetAllocateInfo *pAllocateInfo,
+                                    VkDescriptorSet *pDescriptorSets) {
+        std::generate_n(pDescriptorSets, pAllocateInfo->descriptorSetCount,
+                        newHandle<VkDescriptorSet>);
+        return VK_SUCCESS;
+    }
+
+    VkResult AllocateCommandBuffers(VkDevice, const VkCommandBufferAllocateInfo *pAllocateInfo,
+                                    VkCommandBuffer *pCommandBuffers) {
+        std::generate_n(pCommandBuffers, pAllocateInfo->commandBufferCount,
+                        newHandle<VkCommandBuffer>);
+        return VK_SUCCESS;
+    }
+
+    VkResult CreateSwapchainKHR(VkDevice, const VkSwapchainCreateInfoKHR *pCreateInfo,
+                                const VkAllocationCallbacks *, VkSwapchainKHR *pSwapchain) {
+        std::lock_guard lock(state().mutex);
+        *pSwapchain = newHandle<VkSwapchainKHR>();
+        Swapchain &swapchain = state().swapchains[*pSwapchain];
+        swapchain.images.resize(std::max(pCreateInfo->minImageCount, 2u));
+        std::generate(swapchain.images.begin(), swapchain.images.end(), newHandle<VkImage>);
+        return VK_SUCCESS;
+    }
+
+    void DestroySwapchainKHR(VkDevice, VkSwapchainKHR swapchain, const VkAllocationCallbacks *) {
+        std::lock_guard lock(state().mutex);
+        state().swapchains.erase(swapchain);
+    }
+
+    VkResult GetSwapchainImagesKHR(VkDevice, VkSwapchainKHR swapchain,
+                                   uint32_t *pSwapchainImageCount, VkImage *pSwapchainImages) {
+        std::lock_guard lock(state().mutex);
+        const std::vector<VkImage> &images = state().swapchains[swapchain].images;
+        return enumerate(images.data(), static_cast<uint32_t>(images.size()),
+                         pSwapchainImageCount, pSwapchainImages);
+    }
+
+    VkResult AcquireNextImageKHR(VkDevice, VkSwapchainKHR swapchain, uint64_t, VkSemaphore,
+                                 VkFence fence, uint32_t *pImageIndex) {
+        State &driver = state();
+        std::lock_guard lock(driver.mutex);
+        Swapchain &chain = driver.swapchains[swapchain];
+        if (chain.images.empty()) {
+            return VK_ERROR_OUT_OF_DATE_KHR;
+        }
+        *pImageIndex = chain.nextImage;
+        chain.nextImage = (chain.nextImage + 1) % static_cast<uint32_t>(chain.images.size());
+        if (fence != VK_NULL_HANDLE) {
+            driver.fences[fence].signaled = true;
+        }
+        return VK_SUCCESS;
+    }
+
+    VkResult QueuePresentKHR(VkQueue, const VkPresentInfoKHR *pPresentInfo) {
+        if (pPresentInfo->pResults != nullptr) {
+            std::fill_n(pPresentInfo->pResults, pPresentInfo->swapchainCount, VK_SUCCESS);
+        }
+        return VK_SUCCESS;
+    }
+
+#define NULL_IMPLEMENTED_FUNCTIONS(X) \
+    X(CreateInstance) \
+    X(EnumerateInstanceExtensionProperties) \
+    X(EnumerateInstanceLayerProperties) \
+    X(EnumeratePhysicalDevices) \
+    X(GetPhysicalDeviceFeatures) \
+    X(GetPhysicalDeviceFeatures2) \
+    X(GetPhysicalDeviceFormatProperties) \
+    X(GetPhysicalDeviceProperties) \
+    X(GetPhysicalDeviceProperties2) \
+    X(GetPhysicalDeviceQueueFamilyProperties) \
+    X(GetPhysicalDeviceMemoryProperties) \
+    X(GetDeviceProcAddr) \
+    X(CreateDevice) \
+    X(EnumerateDeviceExtensionProperties) \
+    X(EnumerateDeviceLayerProperties) \
+    X(GetDeviceQueue) \
+    X(QueueSubmit) \
+    X(QueueWaitIdle) \
+    X(DeviceWaitIdle) \
+    X(AllocateMemory) \
+    X(FreeMemory) \
+    X(MapMemory) \
+    X(CreateFence) \
+    X(DestroyFence) \
+    X(ResetFences) \
+    X(GetFenceStatus) \
+    X(WaitForFences) \
+    X(CreateBuffer) \
+    X(DestroyBuffer) \
+    X(GetBufferMemoryRequirements) \
+    X(CreateImage) \
+    X(DestroyImage) \
+    X(GetImageMemoryRequirements) \
+    X(GetQueryPoolResults) \
+    X(GetPipelineCacheData) \
+    X(CreateGraphicsPipelines) \
+    X(CreateComputePipelines) \
+    X(AllocateDescriptorSets) \
+    X(AllocateCommandBuffers) \
+    X(CreateSwapchainKHR) \
+    X(DestroySwapchainKHR) \
+    X(GetSwapchainImagesKHR) \
+    X(AcquireNextImageKHR) \
+    X(QueuePresentKHR)
+
+    const std::unordered_map<std::string_view, PFN_vkVoidFunction> &getEntryPoints() {
+        static const auto entryPoints = [] {
+            std::unordered_map<std::string_view, PFN_vkVoidFunction> entries;
+#define NULL_DEFAULT_ENTRY(name) \
+            entries[#name] = reinterpret_cast<PFN_vkVoidFunction>( \
+                    &Noop<PFN_##name, Index_##name>::call);
+#define NULL_DEFAULT_EXTENSION_ENTRY(extension, name) NULL_DEFAULT_ENTRY(name)
+            VK_ALL_FUNCTIONS(NULL_DEFAULT_ENTRY, NULL_DEFAULT_EXTENSION_ENTRY)
+#undef NULL_DEFAULT_EXTENSION_ENTRY
+#undef NULL_DEFAULT_ENTRY
+
+#define NULL_IMPLEMENTED_ENTRY(name) \
+            static_assert(std::is_same_v<decltype(&Counted<&name, Index_vk##name>::call), \
+                                         PFN_vk##name>, "vk" #name " has the wrong signature"); \
+            entries["vk" #name] = reinterpret_cast<PFN_vkVoidFunction>( \
+                    &Counted<&name, Index_vk##name>::call);
+            NULL_IMPLEMENTED_FUNCTIONS(NULL_IMPLEMENTED_ENTRY)
+#undef NULL_IMPLEMENTED_ENTRY
+
+            entries["vkGetInstanceProcAddr"] = reinterpret_cast<PFN_vkVoidFunction>(
+                    &Counted<&GetInstanceProcAddr, Index_vkGetInstanceProcAddr>::call);
+            return entries;
+        }();
+        return entryPoints;
+    }
+
+    PFN_vkVoidFunction GetInstanceProcAddr(VkInstance, const char *pName) {
+        const auto &entryPoints = getEntryPoints();
+        const auto entry = entryPoints.find(pName);
+        return entry != entryPoints.end() ? entry->second : nullptr;
+    }
+}
+
+int null_driver::install() {
+    LOGI("Using the null Vulkan driver");
+    return InitVulkanFromProcAddr(
+            &Counted<&GetInstanceProcAddr, Index_vkGetInstanceProcAddr>::call);
+}
+
+void null_driver::setFenceLatency(std::chrono::microseconds latency) {
+    std::lock_guard lock(state().mutex);
+    state().fenceLatency = latency;
+}
+
+uint64_t null_driver::getCallCount(const char *entryPoint) {
+    for (uint32_t i = 0; i < kEntryCount; ++i) {
+        if (strcmp(kEntryNames[i], entryPoint) == 0) {
+            return callCounts[i].load(std::memory_order_relaxed);
+        }
+    }
+    return 0;
+}
+
+uint64_t null_driver::getTotalCallCount() {
+    uint64_t total = 0;
+    for (const auto &count: callCounts) {
+        total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void null_driver::resetCallCounts() {
+    for (auto &count: callCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t null_driver::getAllocatedMemorySize() {
+    std::lock_guard lock(state().mutex);
+    return state().allocatedSize;
+}
@@ -0,0 +1,43 @@
+//
+// Created by eternal on 2024/7/8.
+//
+
+#ifndef LEARNINGVULKAN_NULLDRIVER_HH
+#define LEARNINGVULKAN_NULLDRIVER_HH
+
+#include <chrono>
+#include <cstdint>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief A Vulkan driver that does no GPU work, for CPU-only runs and CPU overhead measurements
+ *
+ * install() takes the place of InitVulkan. The wrapper then loads the null driver's entry points
+ * through the usual InitVulkanInstance and InitVulkanDevice. It reports a single physical device
+ * with one universal queue family and one host visible, coherent memory type.
+ *
+ * Handles are fake and never dereferenced. Device memory is host memory, so mapped writes land
+ * somewhere real. Fences signal when they are submitted, or after the configured latency, which
+ * stands in for GPU time. Every call is counted per entry point, e.g. to check that a frame
+ * does no allocations or descriptor writes. Entry points without an implementation only count
+ * the call and return VK_SUCCESS.
+ */
+namespace null_driver {
+    /// Points the wrapper at the null driver, returns 0 like InitVulkan on failure
+    int install();
+
+    /// Time between a submission and its fence signaling, zero by default
+    void setFenceLatency(std::chrono::microseconds latency);
+
+    /// Number of calls to the entry point since the last reset, e.g. "vkAllocateMemory"
+    uint64_t getCallCount(const char *entryPoint);
+
+    uint64_t getTotalCallCount();
+
+    void resetCallCounts();
+
+    /// Bytes of device memory currently allocated
+    uint64_t getAllocatedMemorySize();
+}
+
+#endif //LEARNINGVULKAN_NULLDRIVER_HH
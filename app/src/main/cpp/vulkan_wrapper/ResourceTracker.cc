@@ -0,0 +1,613 @@
+//
+// Created by eternal on 2024/7/19.
+//
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include "Debug.hh"
+#include "HashUtils.hh"
+#include "ResourceTracker.hh"
+#include "VulkanTrace.hh"
+
+using resource_tracker::Site;
+using resource_tracker::Totals;
+using resource_tracker::Type;
+using resource_tracker::kTypeCount;
+using vulkan_trace::toHandleValue;
+
+namespace {
+    /// Per report, the log rate limits every call site
+    constexpr size_t kMaxLoggedSites = 16;
+
+    struct SiteKey {
+        Type type;
+
+        const char *scope;
+
+        const void *caller;
+
+        bool operator==(const SiteKey &other) const = default;
+    };
+
+    struct SiteKeyHash {
+        size_t operator()(const SiteKey &key) const {
+            uint64_t hash = hash_utils::combine(hash_utils::kFnvOffsetBasis,
+                                                static_cast<uint8_t>(key.type));
+            hash = hash_utils::combine(hash, key.scope);
+            return hash_utils::combine(hash, key.caller);
+        }
+    };
+
+    struct Object {
+        uint32_t site;
+
+        int64_t bytes;
+
+        /// Command or descriptor pool the object came from, zero otherwise
+        uint64_t pool;
+    };
+
+    /// Order of Snapshot::sites, scopes by name so that it does not depend on addresses
+    bool isSiteBefore(const Site &a, const Site &b) {
+        if (a.type != b.type) {
+            return a.type < b.type;
+        }
+        if (a.scope != b.scope) {
+            const int order = strcmp(a.scope != nullptr ? a.scope : "",
+                                     b.scope != nullptr ? b.scope : "");
+            if (order != 0) {
+                return order < 0;
+            }
+        }
+        return std::less<const void *>()(a.caller, b.caller);
+    }
+
+    struct Tracker {
+        /// Guards everything below, objects are created on any thread
+        std::mutex mutex;
+
+        VkDevice device = VK_NULL_HANDLE;
+
+        /// The entry points the hooks forward to
+        VulkanDeviceTable next{};
+
+        std::array<std::unordered_map<uint64_t, Object>, kTypeCount> objects{};
+
+        /// Sites are never removed, their totals drop to zero
+        std::vector<Site> sites{};
+
+        std::unordered_map<SiteKey, uint32_t, SiteKeyHash> siteIndices{};
+
+        std::array<Totals, kTypeCount> types{};
+
+        void add(Type type, uint64_t handle, const void *caller, int64_t bytes,
+                 uint64_t pool = 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            const SiteKey key{.type = type, .scope = currentScope, .caller = caller};
+            const auto [entry, inserted] =
+                    siteIndices.try_emplace(key, static_cast<uint32_t>(sites.size()));
+            if (inserted) {
+                sites.push_back({.type = type, .scope = key.scope, .caller = caller});
+            }
+            objects[static_cast<size_t>(type)][handle] = {
+                    .site = entry->second,
+                    .bytes = bytes,
+                    .pool = pool
+            };
+            book(type, sites[entry->second], 1, bytes);
+        }
+
+        void remove(Type type, uint64_t handle) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &objectsOfType = objects[static_cast<size_t>(type)];
+            const auto object = objectsOfType.find(handle);
+            if (object == objectsOfType.end()) {
+                return;
+            }
+            book(type, sites[object->second.site], -1, -object->second.bytes);
+            objectsOfType.erase(object);
+        }
+
+        /// Objects that go away with their pool
+        void removeFromPool(Type type, uint64_t pool) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::erase_if(objects[static_cast<size_t>(type)], [&](const auto &entry) {
+                const Object &object = entry.second;
+                if (object.pool != pool) {
+                    return false;
+                }
+                book(type, sites[object.site], -1, -object.bytes);
+                return true;
+            });
+        }
+
+        void clear() {
+            for (auto &objectsOfType: objects) {
+                objectsOfType.clear();
+            }
+            sites.clear();
+            siteIndices.clear();
+            types = {};
+        }
+
+        static inline thread_local const char *currentScope = nullptr;
+
+    private:
+        void book(Type type, Site &site, int64_t count, int64_t bytes) {
+            Totals &totals = types[static_cast<size_t>(type)];
+            totals.count += count;
+            totals.bytes += bytes;
+            site.totals.count += count;
+            site.totals.bytes += bytes;
+        }
+    };
+
+    /// Never destroyed, objects may still be released while static destructors run
+    Tracker &tracker() {
+        static auto *instance = new Tracker();
+        return *instance;
+    }
+
+    /* Objects made from a create info alone */
+
+#define TRACK_CREATE_DESTROY(object, info) \
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkCreate##object( \
+            VkDevice device, const info *pCreateInfo, const VkAllocationCallbacks *pAllocator, \
+            Vk##object *pObject) { \
+        const VkResult result = tracker().next.vkCreate##object(device, pCreateInfo, pAllocator, \
+                                                                pObject); \
+        if (result == VK_SUCCESS) { \
+            tracker().add(Type::object, toHandleValue(*pObject), __builtin_return_address(0), 0); \
+        } \
+        return result; \
+    } \
+    VKAPI_ATTR void VKAPI_CALL Track_vkDestroy##object( \
+            VkDevice device, Vk##object handle, const VkAllocationCallbacks *pAllocator) { \
+        tracker().remove(Type::object, toHandleValue(handle)); \
+        tracker().next.vkDestroy##object(device, handle, pAllocator); \
+    }
+    TRACK_CREATE_DESTROY(BufferView, VkBufferViewCreateInfo)
+    TRACK_CREATE_DESTROY(ImageView, VkImageViewCreateInfo)
+    TRACK_CREATE_DESTROY(Sampler, VkSamplerCreateInfo)
+    TRACK_CREATE_DESTROY(ShaderModule, VkShaderModuleCreateInfo)
+    TRACK_CREATE_DESTROY(PipelineCache, VkPipelineCacheCreateInfo)
+    TRACK_CREATE_DESTROY(PipelineLayout, VkPipelineLayoutCreateInfo)
+    TRACK_CREATE_DESTROY(DescriptorSetLayout, VkDescriptorSetLayoutCreateInfo)
+    TRACK_CREATE_DESTROY(DescriptorUpdateTemplate, VkDescriptorUpdateTemplateCreateInfo)
+    TRACK_CREATE_DESTROY(RenderPass, VkRenderPassCreateInfo)
+    TRACK_CREATE_DESTROY(Framebuffer, VkFramebufferCreateInfo)
+    TRACK_CREATE_DESTROY(Fence, VkFenceCreateInfo)
+    TRACK_CREATE_DESTROY(Semaphore, VkSemaphoreCreateInfo)
+    TRACK_CREATE_DESTROY(Event, VkEventCreateInfo)
+    TRACK_CREATE_DESTROY(QueryPool, VkQueryPoolCreateInfo)
+    TRACK_CREATE_DESTROY(SwapchainKHR, VkSwapchainCreateInfoKHR)
+#undef TRACK_CREATE_DESTROY
+
+    /* Memory and the resources bound to it */
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkAllocateMemory(
+            VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo,
+            const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory) {
+        const VkResult result = tracker().next.vkAllocateMemory(device, pAllocateInfo, pAllocator,
+                                                                pMemory);
+        if (result == VK_SUCCESS) {
+            tracker().add(Type::DeviceMemory, toHandleValue(*pMemory), __builtin_return_address(0),
+                          static_cast<int64_t>(pAllocateInfo->allocationSize));
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkFreeMemory(VkDevice device, VkDeviceMemory memory,
+                                                  const VkAllocationCallbacks *pAllocator) {
+        tracker().remove(Type::DeviceMemory, toHandleValue(memory));
+        tracker().next.vkFreeMemory(device, memory, pAllocator);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkCreateBuffer(
+            VkDevice device, const VkBufferCreateInfo *pCreateInfo,
+            const VkAllocationCallbacks *pAllocator, VkBuffer *pBuffer) {
+        const VkResult result = tracker().next.vkCreateBuffer(device, pCreateInfo, pAllocator,
+                                                              pBuffer);
+        if (result == VK_SUCCESS) {
+            tracker().add(Type::Buffer, toHandleValue(*pBuffer), __builtin_return_address(0),
+                          static_cast<int64_t>(pCreateInfo->size));
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkDestroyBuffer(VkDevice device, VkBuffer buffer,
+                                                     const VkAllocationCallbacks *pAllocator) {
+        tracker().remove(Type::Buffer, toHandleValue(buffer));
+        tracker().next.vkDestroyBuffer(device, buffer, pAllocator);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkCreateImage(
+            VkDevice device, const VkImageCreateInfo *pCreateInfo,
+            const VkAllocationCallbacks *pAllocator, VkImage *pImage) {
+        Tracker &state = tracker();
+        const VkResult result = state.next.vkCreateImage(device, pCreateInfo, pAllocator, pImage);
+        if (result == VK_SUCCESS) {
+            // Unlike buffers, the create info does not tell the size
+            VkMemoryRequirements requirements;
+            state.next.vkGetImageMemoryRequirements(device, *pImage, &requirements);
+            state.add(Type::Image, toHandleValue(*pImage), __builtin_return_address(0),
+                      static_cast<int64_t>(requirements.size));
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkDestroyImage(VkDevice device, VkImage image,
+                                                    const VkAllocationCallbacks *pAllocator) {
+        tracker().remove(Type::Image, toHandleValue(image));
+        tracker().next.vkDestroyImage(device, image, pAllocator);
+    }
+
+    /* Pipelines */
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkCreateGraphicsPipelines(
+            VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount,
+            const VkGraphicsPipelineCreateInfo *pCreateInfos,
+            const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines) {
+        const VkResult result = tracker().next.vkCreateGraphicsPipelines(
+                device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+        // Pipelines that were not created, e.g. with VK_PIPELINE_COMPILE_REQUIRED, are null
+        for (uint32_t i = 0; result >= VK_SUCCESS && i < createInfoCount; ++i) {
+            if (pPipelines[i] != VK_NULL_HANDLE) {
+                tracker().add(Type::Pipeline, toHandleValue(pPipelines[i]),
+                              __builtin_return_address(0), 0);
+            }
+        }
+        return result;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkCreateComputePipelines(
+            VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount,
+            const VkComputePipelineCreateInfo *pCreateInfos,
+            const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines) {
+        const VkResult result = tracker().next.vkCreateComputePipelines(
+                device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+        for (uint32_t i = 0; result >= VK_SUCCESS && i < createInfoCount; ++i) {
+            if (pPipelines[i] != VK_NULL_HANDLE) {
+                tracker().add(Type::Pipeline, toHandleValue(pPipelines[i]),
+                              __builtin_return_address(0), 0);
+            }
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkDestroyPipeline(
+            VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *pAllocator) {
+        tracker().remove(Type::Pipeline, toHandleValue(pipeline));
+        tracker().next.vkDestroyPipeline(device, pipeline, pAllocator);
+    }
+
+    /* Pools and what is allocated from them */
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkCreateDescriptorPool(
+            VkDevice device, const VkDescriptorPoolCreateInfo *pCreateInfo,
+            const VkAllocationCallbacks *pAllocator, VkDescriptorPool *pDescriptorPool) {
+        const VkResult result = tracker().next.vkCreateDescriptorPool(device, pCreateInfo,
+                                                                      pAllocator,
+                                                                      pDescriptorPool);
+        if (result == VK_SUCCESS) {
+            tracker().add(Type::DescriptorPool, toHandleValue(*pDescriptorPool),
+                          __builtin_return_address(0), 0);
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkDestroyDescriptorPool(
+            VkDevice device, VkDescriptorPool descriptorPool,
+            const VkAllocationCallbacks *pAllocator) {
+        tracker().removeFromPool(Type::DescriptorSet, toHandleValue(descriptorPool));
+        tracker().remove(Type::DescriptorPool, toHandleValue(descriptorPool));
+        tracker().next.vkDestroyDescriptorPool(device, descriptorPool, pAllocator);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkResetDescriptorPool(
+            VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags) {
+        tracker().removeFromPool(Type::DescriptorSet, toHandleValue(descriptorPool));
+        return tracker().next.vkResetDescriptorPool(device, descriptorPool, flags);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkAllocateDescriptorSets(
+            VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo,
+            VkDescriptorSet *pDescriptorSets) {
+        const VkResult result = tracker().next.vkAllocateDescriptorSets(device, pAllocateInfo,
+                                                                        pDescriptorSets);
+        for (uint32_t i = 0; result == VK_SUCCESS && i < pAllocateInfo->descriptorSetCount; ++i) {
+            tracker().add(Type::DescriptorSet, toHandleValue(pDescriptorSets[i]),
+                          __builtin_return_address(0), 0,
+                          toHandleValue(pAllocateInfo->descriptorPool));
+        }
+        return result;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkFreeDescriptorSets(
+            VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount,
+            const VkDescriptorSet *pDescriptorSets) {
+        for (uint32_t i = 0; i < descriptorSetCount; ++i) {
+            tracker().remove(Type::DescriptorSet, toHandleValue(pDescriptorSets[i]));
+        }
+        return tracker().next.vkFreeDescriptorSets(device, descriptorPool, descriptorSetCount,
+                                                   pDescriptorSets);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkCreateCommandPool(
+            VkDevice device, const VkCommandPoolCreateInfo *pCreateInfo,
+            const VkAllocationCallbacks *pAllocator, VkCommandPool *pCommandPool) {
+        const VkResult result = tracker().next.vkCreateCommandPool(device, pCreateInfo,
+                                                                   pAllocator, pCommandPool);
+        if (result == VK_SUCCESS) {
+            tracker().add(Type::CommandPool, toHandleValue(*pCommandPool),
+                          __builtin_return_address(0), 0);
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkDestroyCommandPool(
+            VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks *pAllocator) {
+        tracker().removeFromPool(Type::CommandBuffer, toHandleValue(commandPool));
+        tracker().remove(Type::CommandPool, toHandleValue(commandPool));
+        tracker().next.vkDestroyCommandPool(device, commandPool, pAllocator);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Track_vkAllocateCommandBuffers(
+            VkDevice device, const VkCommandBufferAllocateInfo *pAllocateInfo,
+            VkCommandBuffer *pCommandBuffers) {
+        const VkResult result = tracker().next.vkAllocateCommandBuffers(device, pAllocateInfo,
+                                                                        pCommandBuffers);
+        for (uint32_t i = 0; result == VK_SUCCESS && i < pAllocateInfo->commandBufferCount; ++i) {
+            tracker().add(Type::CommandBuffer, toHandleValue(pCommandBuffers[i]),
+                          __builtin_return_address(0), 0,
+                          toHandleValue(pAllocateInfo->commandPool));
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkFreeCommandBuffers(
+            VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount,
+            const VkCommandBuffer *pCommandBuffers) {
+        for (uint32_t i = 0; i < commandBufferCount; ++i) {
+            tracker().remove(Type::CommandBuffer, toHandleValue(pCommandBuffers[i]));
+        }
+        tracker().next.vkFreeCommandBuffers(device, commandPool, commandBufferCount,
+                                            pCommandBuffers);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Track_vkDestroyDevice(VkDevice device,
+                                                     const VkAllocationCallbacks *pAllocator) {
+        Tracker &state = tracker();
+        if (device == state.device) {
+            resource_tracker::reportLeaks();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.clear();
+            state.device = VK_NULL_HANDLE;
+        }
+        state.next.vkDestroyDevice(device, pAllocator);
+    }
+
+    /// Cuts the parameter list off demangled names, the offset tells overloads apart
+    std::string describeCaller(const void *caller) {
+        Dl_info info{};
+        if (caller == nullptr || dladdr(caller, &info) == 0) {
+            return {};
+        }
+        char offset[32];
+        if (info.dli_sname == nullptr) {
+            // Not exported, e.g. a static function, symbolize the offset with addr2line
+            const char *file = info.dli_fname != nullptr ? info.dli_fname : "?";
+            const char *slash = strrchr(file, '/');
+            snprintf(offset, sizeof(offset), "+0x%zx",
+                     static_cast<size_t>(static_cast<const char *>(caller) -
+                                         static_cast<const char *>(info.dli_fbase)));
+            return std::string(slash != nullptr ? slash + 1 : file) + offset;
+        }
+
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : info.dli_sname;
+        free(demangled);
+        const size_t parameters = name.find('(');
+        if (parameters != std::string::npos) {
+            name.resize(parameters);
+        }
+        snprintf(offset, sizeof(offset), "+0x%zx",
+                 static_cast<size_t>(static_cast<const char *>(caller) -
+                                     static_cast<const char *>(info.dli_saddr)));
+        return name + offset;
+    }
+}
+
+namespace resource_tracker {
+    const char *getTypeName(Type type) {
+        switch (type) {
+#define RESOURCE_TRACKER_TYPE_NAME(name) case Type::name: return #name;
+            RESOURCE_TRACKER_TYPES(RESOURCE_TRACKER_TYPE_NAME)
+#undef RESOURCE_TRACKER_TYPE_NAME
+            case Type::Count:
+                break;
+        }
+        return "?";
+    }
+
+    void install(VkDevice device) {
+        Tracker &state = tracker();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.clear();
+        state.device = device;
+
+        // InitVulkanDevice resets the function pointers, the hooks are installed again then.
+        // Hooks installed before these, e.g. by vulkan_capture, are called after them.
+        if (vkDestroyDevice == Track_vkDestroyDevice) {
+            return;
+        }
+#define TRACK_SAVE(name) state.next.name = name;
+#define TRACK_SAVE_EXTENSION(extension, name) TRACK_SAVE(name)
+        VK_DEVICE_FUNCTIONS_1_0(TRACK_SAVE)
+        VK_DEVICE_FUNCTIONS_1_1(TRACK_SAVE)
+        VK_DEVICE_EXTENSION_FUNCTIONS(TRACK_SAVE_EXTENSION)
+#undef TRACK_SAVE_EXTENSION
+#undef TRACK_SAVE
+
+#define TRACK_HOOK(function) \
+        if (VK_IS_AVAILABLE(function)) { \
+            function = Track_##function; \
+        }
+#define TRACK_HOOK_CREATE_DESTROY(object) \
+        TRACK_HOOK(vkCreate##object) \
+        TRACK_HOOK(vkDestroy##object)
+        TRACK_HOOK_CREATE_DESTROY(Buffer)
+        TRACK_HOOK_CREATE_DESTROY(BufferView)
+        TRACK_HOOK_CREATE_DESTROY(Image)
+        TRACK_HOOK_CREATE_DESTROY(ImageView)
+        TRACK_HOOK_CREATE_DESTROY(Sampler)
+        TRACK_HOOK_CREATE_DESTROY(ShaderModule)
+        TRACK_HOOK_CREATE_DESTROY(PipelineCache)
+        TRACK_HOOK_CREATE_DESTROY(PipelineLayout)
+        TRACK_HOOK_CREATE_DESTROY(DescriptorSetLayout)
+        TRACK_HOOK_CREATE_DESTROY(DescriptorPool)
+        TRACK_HOOK_CREATE_DESTROY(DescriptorUpdateTemplate)
+        TRACK_HOOK_CREATE_DESTROY(RenderPass)
+        TRACK_HOOK_CREATE_DESTROY(Framebuffer)
+        TRACK_HOOK_CREATE_DESTROY(CommandPool)
+        TRACK_HOOK_CREATE_DESTROY(Fence)
+        TRACK_HOOK_CREATE_DESTROY(Semaphore)
+        TRACK_HOOK_CREATE_DESTROY(Event)
+        TRACK_HOOK_CREATE_DESTROY(QueryPool)
+        TRACK_HOOK_CREATE_DESTROY(SwapchainKHR)
+        TRACK_HOOK(vkAllocateMemory)
+        TRACK_HOOK(vkFreeMemory)
+        TRACK_HOOK(vkCreateGraphicsPipelines)
+        TRACK_HOOK(vkCreateComputePipelines)
+        TRACK_HOOK(vkDestroyPipeline)
+        TRACK_HOOK(vkResetDescriptorPool)
+        TRACK_HOOK(vkAllocateDescriptorSets)
+        TRACK_HOOK(vkFreeDescriptorSets)
+        TRACK_HOOK(vkAllocateCommandBuffers)
+        TRACK_HOOK(vkFreeCommandBuffers)
+        TRACK_HOOK(vkDestroyDevice)
+#undef TRACK_HOOK_CREATE_DESTROY
+#undef TRACK_HOOK
+    }
+
+    bool isInstalled() {
+        Tracker &state = tracker();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.device != VK_NULL_HANDLE;
+    }
+
+    Snapshot takeSnapshot() {
+        Tracker &state = tracker();
+        Snapshot snapshot;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            snapshot.types = state.types;
+            snapshot.sites = state.sites;
+        }
+        std::sort(snapshot.sites.begin(), snapshot.sites.end(), isSiteBefore);
+        return snapshot;
+    }
+
+    std::vector<Site> compare(const Snapshot &before, const Snapshot &after) {
+        std::unordered_map<SiteKey, Totals, SiteKeyHash> previous;
+        for (const Site &site: before.sites) {
+            previous[{.type = site.type, .scope = site.scope, .caller = site.caller}] =
+                    site.totals;
+        }
+
+        std::vector<Site> changes;
+        for (const Site &site: after.sites) {
+            Site change = site;
+            const auto found =
+                    previous.find({.type = site.type, .scope = site.scope, .caller = site.caller});
+            if (found != previous.end()) {
+                change.totals.count -= found->second.count;
+                change.totals.bytes -= found->second.bytes;
+                previous.erase(found);
+            }
+            if (change.totals.count != 0 || change.totals.bytes != 0) {
+                changes.push_back(change);
+            }
+        }
+        // Sites only the earlier snapshot knows, after a device was destroyed
+        for (const auto &[key, totals]: previous) {
+            if (totals.count != 0 || totals.bytes != 0) {
+                changes.push_back({
+                        .type = key.type,
+                        .scope = key.scope,
+                        .caller = key.caller,
+                        .totals {.count = -totals.count, .bytes = -totals.bytes}
+                });
+            }
+        }
+        std::sort(changes.begin(), changes.end(), isSiteBefore);
+        return changes;
+    }
+
+    bool logChanges(const Snapshot &before, const Snapshot &after) {
+        bool changed = false;
+        for (size_t type = 0; type < kTypeCount; ++type) {
+            const int64_t count = after.types[type].count - before.types[type].count;
+            const int64_t bytes = after.types[type].bytes - before.types[type].bytes;
+            if (count != 0 || bytes != 0) {
+                LOGI("%s: %+lld objects, %+lld bytes", getTypeName(static_cast<Type>(type)),
+                     static_cast<long long>(count), static_cast<long long>(bytes));
+                changed = true;
+            }
+        }
+        const std::vector<Site> changes = compare(before, after);
+        for (size_t i = 0; i < std::min(changes.size(), kMaxLoggedSites); ++i) {
+            const Site &site = changes[i];
+            LOGI("  %+lld %s, %+lld bytes, at %s", static_cast<long long>(site.totals.count),
+                 getTypeName(site.type), static_cast<long long>(site.totals.bytes),
+                 describe(site).c_str());
+        }
+        if (changes.size() > kMaxLoggedSites) {
+            LOGI("  and %zu more sites", changes.size() - kMaxLoggedSites);
+        }
+        return changed;
+    }
+
+    std::string describe(const Site &site) {
+        const std::string caller = describeCaller(site.caller);
+        if (site.scope == nullptr) {
+            return caller.empty() ? "unknown" : caller;
+        }
+        return caller.empty() ? site.scope : std::string(site.scope) + ", " + caller;
+    }
+
+    uint64_t reportLeaks() {
+        uint64_t leaked = 0;
+        size_t sites = 0;
+        for (const Site &site: takeSnapshot().sites) {
+            if (site.totals.count == 0) {
+                continue;
+            }
+            if (sites++ < kMaxLoggedSites) {
+                LOGW("Leaked %lld %s, %lld bytes, created at %s",
+                     static_cast<long long>(site.totals.count), getTypeName(site.type),
+                     static_cast<long long>(site.totals.bytes), describe(site).c_str());
+            }
+            leaked += static_cast<uint64_t>(site.totals.count);
+        }
+        if (leaked > 0) {
+            LOGW("%llu Vulkan objects from %zu sites still alive",
+                 static_cast<unsigned long long>(leaked), sites);
+        }
+        return leaked;
+    }
+
+    Scope::Scope(const char *name) : previous(Tracker::currentScope) {
+        Tracker::currentScope = name;
+    }
+
+    Scope::~Scope() {
+        Tracker::currentScope = previous;
+    }
+}
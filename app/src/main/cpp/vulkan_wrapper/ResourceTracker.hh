@@ -0,0 +1,149 @@
+//
+// Created by eternal on 2024/7/19.
+//
+
+#ifndef LEARNINGVULKAN_RESOURCETRACKER_HH
+#define LEARNINGVULKAN_RESOURCETRACKER_HH
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+// Tracking is compiled out of release builds, unless RESOURCE_TRACKER_ENABLED is defined to 1, see
+// the RESOURCE_TRACKER CMake option
+#ifndef RESOURCE_TRACKER_ENABLED
+#ifdef NDEBUG
+#define RESOURCE_TRACKER_ENABLED 0
+#else
+#define RESOURCE_TRACKER_ENABLED 1
+#endif
+#endif
+
+#define RESOURCE_TRACKER_TYPES(X) \
+    X(DeviceMemory) \
+    X(Buffer) \
+    X(BufferView) \
+    X(Image) \
+    X(ImageView) \
+    X(Sampler) \
+    X(ShaderModule) \
+    X(PipelineCache) \
+    X(PipelineLayout) \
+    X(Pipeline) \
+    X(DescriptorSetLayout) \
+    X(DescriptorPool) \
+    X(DescriptorSet) \
+    X(DescriptorUpdateTemplate) \
+    X(RenderPass) \
+    X(Framebuffer) \
+    X(CommandPool) \
+    X(CommandBuffer) \
+    X(Fence) \
+    X(Semaphore) \
+    X(Event) \
+    X(QueryPool) \
+    X(SwapchainKHR)
+
+/**
+ * @brief Live Vulkan objects and their bytes, by type and by creation site
+ *
+ * install() swaps the wrapper's device-level create, allocate, destroy and free entry points for
+ * hooks that book every object before calling the driver. Bytes are the allocation size of device
+ * memory, the size of buffers and the memory requirements of images, so memory and the resources
+ * bound to it are counted separately. Command buffers and descriptor sets leave with their pool.
+ *
+ * The creation site is the innermost Scope of the creating thread, if there is one, and the code
+ * that called the entry point. Objects still alive at vkDestroyDevice are reported as leaks.
+ * Snapshots of the totals can be compared later on, e.g. between frames or before and after a
+ * scene load. Tracking is thread safe.
+ */
+namespace resource_tracker {
+    enum class Type : uint8_t {
+#define RESOURCE_TRACKER_TYPE(name) name,
+        RESOURCE_TRACKER_TYPES(RESOURCE_TRACKER_TYPE)
+#undef RESOURCE_TRACKER_TYPE
+        Count
+    };
+
+    constexpr size_t kTypeCount = static_cast<size_t>(Type::Count);
+
+    const char *getTypeName(Type type);
+
+    struct Totals {
+        int64_t count = 0;
+
+        int64_t bytes = 0;
+    };
+
+    /// Objects of one type from one creation site
+    struct Site {
+        Type type = Type::Count;
+
+        /// Name of the innermost Scope, or nullptr
+        const char *scope = nullptr;
+
+        /// Return address of the call into the hook
+        const void *caller = nullptr;
+
+        Totals totals{};
+    };
+
+    struct Snapshot {
+        std::array<Totals, kTypeCount> types{};
+
+        /// Sorted by type, scope and caller
+        std::vector<Site> sites{};
+    };
+
+    /// Starts tracking, right after InitVulkanDevice and before anything is created
+    void install(VkDevice device);
+
+    bool isInstalled();
+
+    Snapshot takeSnapshot();
+
+    /// What changed from before to after, per site, sites without change are left out
+    std::vector<Site> compare(const Snapshot &before, const Snapshot &after);
+
+    /// Logs the changes of compare, returns whether there were any
+    bool logChanges(const Snapshot &before, const Snapshot &after);
+
+    /// The scope and the function the call came from, as far as the symbols tell
+    std::string describe(const Site &site);
+
+    /// Logs every live object by site, returns how many there are. Runs at vkDestroyDevice.
+    uint64_t reportLeaks();
+
+    /**
+     * @brief Names the objects the calling thread creates while it is alive
+     *
+     * Helpers like vulkan_common::createBuffer create objects for many callers, the scope tells
+     * them apart. The name is not copied, it has to outlive the process, e.g. a string literal.
+     */
+    class Scope {
+    public:
+        explicit Scope(const char *name);
+
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *previous;
+    };
+}
+
+#if RESOURCE_TRACKER_ENABLED
+#define RESOURCE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define RESOURCE_SCOPE_CONCAT(a, b) RESOURCE_SCOPE_CONCAT_IMPL(a, b)
+#define RESOURCE_SCOPE(name) \
+    const resource_tracker::Scope RESOURCE_SCOPE_CONCAT(resourceScope, __COUNTER__){name}
+#else
+#define RESOURCE_SCOPE(name) ((void)0)
+#endif
+
+#endif //LEARNINGVULKAN_RESOURCETRACKER_HH
@@ -0,0 +1,743 @@
+//
+// Created by eternal on 2024/7/10.
+//
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Debug.hh"
+#include "VulkanCapture.hh"
+#include "VulkanTrace.hh"
+
+using namespace vulkan_trace;
+
+namespace {
+    constexpr size_t kFileBufferSize = 1 << 20;
+
+    /// Granularity of the comparison of mapped memory with its shadow copy
+    constexpr size_t kDiffBlockSize = 64;
+
+    struct Mapping {
+        const uint8_t *data;
+
+        VkDeviceSize offset;
+
+        /// Contents as of the last recorded write
+        std::vector<uint8_t> shadow;
+    };
+
+    struct Capture {
+        /// Guards everything below, calls are recorded from any thread
+        std::mutex mutex;
+
+        std::atomic<bool> active{false};
+
+        bool hooked = false;
+
+        FILE *file = nullptr;
+
+        std::string path;
+
+        TraceWriter writer;
+
+        /// The entry points the hooks forward to
+        VulkanDeviceTable next{};
+
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+
+        std::unordered_map<VkDeviceMemory, VkDeviceSize> allocationSizes;
+
+        std::unordered_map<VkDeviceMemory, Mapping> mappings;
+
+        std::unordered_map<VkDescriptorUpdateTemplate,
+                std::vector<VkDescriptorUpdateTemplateEntry>> templates;
+
+        uint32_t firstFrame = 0;
+
+        uint32_t frameCount = 0;
+
+        /// Frames presented so far
+        uint32_t frame = 0;
+
+        /// Per-frame calls are recorded, before the first acquire and within the captured frames
+        bool recordingFrames = true;
+
+        bool framesBegun = false;
+
+        template<typename Call>
+        void write(Call &call) {
+            writer.begin();
+            serialize(writer, call);
+            const std::vector<uint8_t> &payload = writer.getPayload();
+            const auto type = static_cast<uint16_t>(recordOf<Call>);
+            const auto size = static_cast<uint32_t>(payload.size());
+            fwrite(&type, sizeof(type), 1, file);
+            fwrite(&size, sizeof(size), 1, file);
+            fwrite(payload.data(), 1, payload.size(), file);
+        }
+
+        void writeMemory(VkDeviceMemory memory, Mapping &mapping) {
+            const size_t size = mapping.shadow.size();
+            size_t start = 0;
+            while (start < size) {
+                if (!isDirty(mapping, start)) {
+                    start += kDiffBlockSize;
+                    continue;
+                }
+                size_t end = start + kDiffBlockSize;
+                while (end < size && isDirty(mapping, end)) {
+                    end += kDiffBlockSize;
+                }
+                end = std::min(end, size);
+
+                memcpy(mapping.shadow.data() + start, mapping.data + start, end - start);
+                MemoryWrite memoryWrite{
+                        .memory = memory,
+                        .offset = mapping.offset + start,
+                        .size = end - start,
+                        .pData = mapping.shadow.data() + start
+                };
+                write(memoryWrite);
+                start = end;
+            }
+        }
+
+        void close() {
+            fclose(file);
+            file = nullptr;
+            active.store(false, std::memory_order_release);
+            mappings.clear();
+            allocationSizes.clear();
+            templates.clear();
+        }
+
+    private:
+        static bool isDirty(const Mapping &mapping, size_t offset) {
+            const size_t size = std::min(kDiffBlockSize, mapping.shadow.size() - offset);
+            return memcmp(mapping.data + offset, mapping.shadow.data() + offset, size) != 0;
+        }
+    };
+
+    Capture &capture() {
+        static Capture instance;
+        return instance;
+    }
+
+    template<typename Call>
+    constexpr bool isFrameCall = false;
+
+#define CAPTURE_FRAME_CALL(call) template<> constexpr bool isFrameCall<call> = true;
+    CAPTURE_FRAME_CALL(ResetCommandPool)
+    CAPTURE_FRAME_CALL(ResetFences)
+    CAPTURE_FRAME_CALL(WaitForFences)
+    CAPTURE_FRAME_CALL(QueueWaitIdle)
+    CAPTURE_FRAME_CALL(DeviceWaitIdle)
+    CAPTURE_FRAME_CALL(BeginCommandBuffer)
+    CAPTURE_FRAME_CALL(EndCommandBuffer)
+    CAPTURE_FRAME_CALL(CmdBindPipeline)
+    CAPTURE_FRAME_CALL(CmdSetViewport)
+    CAPTURE_FRAME_CALL(CmdSetScissor)
+    CAPTURE_FRAME_CALL(CmdBindDescriptorSets)
+    CAPTURE_FRAME_CALL(CmdBindVertexBuffers)
+    CAPTURE_FRAME_CALL(CmdBindIndexBuffer)
+    CAPTURE_FRAME_CALL(CmdDraw)
+    CAPTURE_FRAME_CALL(CmdDrawIndexed)
+    CAPTURE_FRAME_CALL(CmdPushConstants)
+    CAPTURE_FRAME_CALL(CmdUpdateBuffer)
+    CAPTURE_FRAME_CALL(CmdCopyBuffer)
+    CAPTURE_FRAME_CALL(CmdPipelineBarrier2KHR)
+    CAPTURE_FRAME_CALL(CmdBeginRenderingKHR)
+    CAPTURE_FRAME_CALL(CmdEndRenderingKHR)
+    CAPTURE_FRAME_CALL(CmdBeginRenderPass)
+    CAPTURE_FRAME_CALL(CmdEndRenderPass)
+#undef CAPTURE_FRAME_CALL
+
+    template<typename Call>
+    void record(Call call) {
+        Capture &state = capture();
+        if (!state.active.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.file == nullptr || (isFrameCall<Call> && !state.recordingFrames)) {
+            return;
+        }
+        state.write(call);
+    }
+
+    /* Objects */
+
+    /// Objects made from a create info alone
+#define CAPTURE_CREATE_DESTROY(object, info) \
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkCreate##object( \
+            VkDevice device, const info *pCreateInfo, const VkAllocationCallbacks *pAllocator, \
+            Vk##object *pObject) { \
+        const VkResult result = capture().next.vkCreate##object(device, pCreateInfo, pAllocator, \
+                                                                pObject); \
+        if (result == VK_SUCCESS) { \
+            record(Create##object{pCreateInfo, *pObject}); \
+        } \
+        return result; \
+    } \
+    VKAPI_ATTR void VKAPI_CALL Capture_vkDestroy##object( \
+            VkDevice device, Vk##object handle, const VkAllocationCallbacks *pAllocator) { \
+        record(Destroy##object{handle}); \
+        capture().next.vkDestroy##object(device, handle, pAllocator); \
+    }
+    CAPTURE_CREATE_DESTROY(Buffer, VkBufferCreateInfo)
+    CAPTURE_CREATE_DESTROY(Image, VkImageCreateInfo)
+    CAPTURE_CREATE_DESTROY(ImageView, VkImageViewCreateInfo)
+    CAPTURE_CREATE_DESTROY(ShaderModule, VkShaderModuleCreateInfo)
+    CAPTURE_CREATE_DESTROY(PipelineCache, VkPipelineCacheCreateInfo)
+    CAPTURE_CREATE_DESTROY(DescriptorSetLayout, VkDescriptorSetLayoutCreateInfo)
+    CAPTURE_CREATE_DESTROY(PipelineLayout, VkPipelineLayoutCreateInfo)
+    CAPTURE_CREATE_DESTROY(Sampler, VkSamplerCreateInfo)
+    CAPTURE_CREATE_DESTROY(RenderPass, VkRenderPassCreateInfo)
+    CAPTURE_CREATE_DESTROY(Framebuffer, VkFramebufferCreateInfo)
+    CAPTURE_CREATE_DESTROY(DescriptorPool, VkDescriptorPoolCreateInfo)
+    CAPTURE_CREATE_DESTROY(CommandPool, VkCommandPoolCreateInfo)
+    CAPTURE_CREATE_DESTROY(Fence, VkFenceCreateInfo)
+    CAPTURE_CREATE_DESTROY(Semaphore, VkSemaphoreCreateInfo)
+    CAPTURE_CREATE_DESTROY(SwapchainKHR, VkSwapchainCreateInfoKHR)
+#undef CAPTURE_CREATE_DESTROY
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkAllocateMemory(
+            VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo,
+            const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory) {
+        Capture &state = capture();
+        const VkResult result = state.next.vkAllocateMemory(device, pAllocateInfo, pAllocator,
+                                                            pMemory);
+        if (result != VK_SUCCESS || !state.active.load(std::memory_order_acquire)) {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.file != nullptr) {
+            state.allocationSizes[*pMemory] = pAllocateInfo->allocationSize;
+            const VkMemoryType &memoryType =
+                    state.memoryProperties.memoryTypes[pAllocateInfo->memoryTypeIndex];
+            AllocateMemory call{pAllocateInfo, memoryType.propertyFlags, *pMemory};
+            state.write(call);
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkFreeMemory(VkDevice device, VkDeviceMemory memory,
+                                                    const VkAllocationCallbacks *pAllocator) {
+        Capture &state = capture();
+        if (state.active.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.file != nullptr) {
+                state.mappings.erase(memory);
+                state.allocationSizes.erase(memory);
+                FreeMemory call{memory};
+                state.write(call);
+            }
+        }
+        state.next.vkFreeMemory(device, memory, pAllocator);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkMapMemory(
+            VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size,
+            VkMemoryMapFlags flags, void **ppData) {
+        Capture &state = capture();
+        const VkResult result = state.next.vkMapMemory(device, memory, offset, size, flags, ppData);
+        if (result != VK_SUCCESS || !state.active.load(std::memory_order_acquire)) {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        const auto allocation = state.allocationSizes.find(memory);
+        if (state.file == nullptr || allocation == state.allocationSizes.end()) {
+            return result;
+        }
+        if (size == VK_WHOLE_SIZE) {
+            size = allocation->second - offset;
+        }
+        // Anything in the memory already was put there by the driver, not the host
+        const auto *data = static_cast<const uint8_t *>(*ppData);
+        state.mappings[memory] = Mapping{
+                .data = data,
+                .offset = offset,
+                .shadow = std::vector<uint8_t>(data, data + size)
+        };
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkUnmapMemory(VkDevice device, VkDeviceMemory memory) {
+        Capture &state = capture();
+        if (state.active.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            const auto mapping = state.mappings.find(memory);
+            if (state.file != nullptr && mapping != state.mappings.end()) {
+                state.writeMemory(memory, mapping->second);
+                state.mappings.erase(mapping);
+            }
+        }
+        state.next.vkUnmapMemory(device, memory);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkBindBufferMemory(
+            VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset) {
+        record(BindBufferMemory{buffer, memory, memoryOffset});
+        return capture().next.vkBindBufferMemory(device, buffer, memory, memoryOffset);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkBindImageMemory(
+            VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset) {
+        record(BindImageMemory{image, memory, memoryOffset});
+        return capture().next.vkBindImageMemory(device, image, memory, memoryOffset);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkCreateGraphicsPipelines(
+            VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount,
+            const VkGraphicsPipelineCreateInfo *pCreateInfos,
+            const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines) {
+        const VkResult result = capture().next.vkCreateGraphicsPipelines(
+                device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+        // Pipelines that were not created, e.g. with VK_PIPELINE_COMPILE_REQUIRED, are null
+        if (result >= VK_SUCCESS) {
+            record(CreateGraphicsPipelines{pipelineCache, createInfoCount, pCreateInfos,
+                                           pPipelines});
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkDestroyPipeline(
+            VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *pAllocator) {
+        record(DestroyPipeline{pipeline});
+        capture().next.vkDestroyPipeline(device, pipeline, pAllocator);
+    }
+
+    /* Descriptors */
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkResetDescriptorPool(
+            VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags) {
+        record(ResetDescriptorPool{descriptorPool, flags});
+        return capture().next.vkResetDescriptorPool(device, descriptorPool, flags);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkAllocateDescriptorSets(
+            VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo,
+            VkDescriptorSet *pDescriptorSets) {
+        const VkResult result = capture().next.vkAllocateDescriptorSets(device, pAllocateInfo,
+                                                                        pDescriptorSets);
+        if (result == VK_SUCCESS) {
+            record(AllocateDescriptorSets{pAllocateInfo, pDescriptorSets});
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkUpdateDescriptorSets(
+            VkDevice device, uint32_t descriptorWriteCount,
+            const VkWriteDescriptorSet *pDescriptorWrites, uint32_t descriptorCopyCount,
+            const VkCopyDescriptorSet *pDescriptorCopies) {
+        record(UpdateDescriptorSets{descriptorWriteCount, pDescriptorWrites, descriptorCopyCount,
+                                    pDescriptorCopies});
+        capture().next.vkUpdateDescriptorSets(device, descriptorWriteCount, pDescriptorWrites,
+                                              descriptorCopyCount, pDescriptorCopies);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkCreateDescriptorUpdateTemplate(
+            VkDevice device, const VkDescriptorUpdateTemplateCreateInfo *pCreateInfo,
+            const VkAllocationCallbacks *pAllocator,
+            VkDescriptorUpdateTemplate *pDescriptorUpdateTemplate) {
+        Capture &state = capture();
+        const VkResult result = state.next.vkCreateDescriptorUpdateTemplate(
+                device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
+        if (result != VK_SUCCESS || !state.active.load(std::memory_order_acquire)) {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.file != nullptr) {
+            const VkDescriptorUpdateTemplateEntry *entries = pCreateInfo->pDescriptorUpdateEntries;
+            state.templates[*pDescriptorUpdateTemplate].assign(
+                    entries, entries + pCreateInfo->descriptorUpdateEntryCount);
+            CreateDescriptorUpdateTemplate call{pCreateInfo, *pDescriptorUpdateTemplate};
+            state.write(call);
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkDestroyDescriptorUpdateTemplate(
+            VkDevice device, VkDescriptorUpdateTemplate descriptorUpdateTemplate,
+            const VkAllocationCallbacks *pAllocator) {
+        Capture &state = capture();
+        if (state.active.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.file != nullptr) {
+                state.templates.erase(descriptorUpdateTemplate);
+                DestroyDescriptorUpdateTemplate call{descriptorUpdateTemplate};
+                state.write(call);
+            }
+        }
+        state.next.vkDestroyDescriptorUpdateTemplate(device, descriptorUpdateTemplate, pAllocator);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkUpdateDescriptorSetWithTemplate(
+            VkDevice device, VkDescriptorSet descriptorSet,
+            VkDescriptorUpdateTemplate descriptorUpdateTemplate, const void *pData) {
+        Capture &state = capture();
+        if (state.active.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            const auto entries = state.templates.find(descriptorUpdateTemplate);
+            if (state.file != nullptr && entries != state.templates.end()) {
+                const std::vector<TemplateDescriptor> descriptors =
+                        unpackTemplateData(entries->second, pData);
+                UpdateDescriptorSetWithTemplate call{
+                        descriptorSet, descriptorUpdateTemplate,
+                        static_cast<uint32_t>(descriptors.size()), descriptors.data()};
+                state.write(call);
+            }
+        }
+        state.next.vkUpdateDescriptorSetWithTemplate(device, descriptorSet,
+                                                     descriptorUpdateTemplate, pData);
+    }
+
+    /* Command buffers */
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkResetCommandPool(
+            VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags) {
+        record(ResetCommandPool{commandPool, flags});
+        return capture().next.vkResetCommandPool(device, commandPool, flags);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkAllocateCommandBuffers(
+            VkDevice device, const VkCommandBufferAllocateInfo *pAllocateInfo,
+            VkCommandBuffer *pCommandBuffers) {
+        const VkResult result = capture().next.vkAllocateCommandBuffers(device, pAllocateInfo,
+                                                                        pCommandBuffers);
+        if (result == VK_SUCCESS) {
+            record(AllocateCommandBuffers{pAllocateInfo, pCommandBuffers});
+        }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkFreeCommandBuffers(
+            VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount,
+            const VkCommandBuffer *pCommandBuffers) {
+        record(FreeCommandBuffers{commandPool, commandBufferCount, pCommandBuffers});
+        capture().next.vkFreeCommandBuffers(device, commandPool, commandBufferCount,
+                                            pCommandBuffers);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkBeginCommandBuffer(
+            VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo) {
+        record(BeginCommandBuffer{commandBuffer, pBeginInfo});
+        return capture().next.vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkEndCommandBuffer(VkCommandBuffer commandBuffer) {
+        record(EndCommandBuffer{commandBuffer});
+        return capture().next.vkEndCommandBuffer(commandBuffer);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdBindPipeline(
+            VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint,
+            VkPipeline pipeline) {
+        record(CmdBindPipeline{commandBuffer, pipelineBindPoint, pipeline});
+        capture().next.vkCmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdSetViewport(
+            VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount,
+            const VkViewport *pViewports) {
+        record(CmdSetViewport{commandBuffer, firstViewport, viewportCount, pViewports});
+        capture().next.vkCmdSetViewport(commandBuffer, firstViewport, viewportCount, pViewports);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdSetScissor(
+            VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount,
+            const VkRect2D *pScissors) {
+        record(CmdSetScissor{commandBuffer, firstScissor, scissorCount, pScissors});
+        capture().next.vkCmdSetScissor(commandBuffer, firstScissor, scissorCount, pScissors);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdBindDescriptorSets(
+            VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint,
+            VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount,
+            const VkDescriptorSet *pDescriptorSets, uint32_t dynamicOffsetCount,
+            const uint32_t *pDynamicOffsets) {
+        record(CmdBindDescriptorSets{commandBuffer, pipelineBindPoint, layout, firstSet,
+                                     descriptorSetCount, pDescriptorSets, dynamicOffsetCount,
+                                     pDynamicOffsets});
+        capture().next.vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout,
+                                               firstSet, descriptorSetCount, pDescriptorSets,
+                                               dynamicOffsetCount, pDynamicOffsets);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdBindVertexBuffers(
+            VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount,
+            const VkBuffer *pBuffers, const VkDeviceSize *pOffsets) {
+        record(CmdBindVertexBuffers{commandBuffer, firstBinding, bindingCount, pBuffers,
+                                    pOffsets});
+        capture().next.vkCmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount,
+                                              pBuffers, pOffsets);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdBindIndexBuffer(
+            VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset,
+            VkIndexType indexType) {
+        record(CmdBindIndexBuffer{commandBuffer, buffer, offset, indexType});
+        capture().next.vkCmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdDraw(
+            VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount,
+            uint32_t firstVertex, uint32_t firstInstance) {
+        record(CmdDraw{commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance});
+        capture().next.vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex,
+                                 firstInstance);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdDrawIndexed(
+            VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount,
+            uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+        record(CmdDrawIndexed{commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset,
+                              firstInstance});
+        capture().next.vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex,
+                                        vertexOffset, firstInstance);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdPushConstants(
+            VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags,
+            uint32_t offset, uint32_t size, const void *pValues) {
+        record(CmdPushConstants{commandBuffer, layout, stageFlags, offset, size, pValues});
+        capture().next.vkCmdPushConstants(commandBuffer, layout, stageFlags, offset, size,
+                                          pValues);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdUpdateBuffer(
+            VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+            VkDeviceSize dataSize, const void *pData) {
+        record(CmdUpdateBuffer{commandBuffer, dstBuffer, dstOffset, dataSize, pData});
+        capture().next.vkCmdUpdateBuffer(commandBuffer, dstBuffer, dstOffset, dataSize, pData);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdCopyBuffer(
+            VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer,
+            uint32_t regionCount, const VkBufferCopy *pRegions) {
+        record(CmdCopyBuffer{commandBuffer, srcBuffer, dstBuffer, regionCount, pRegions});
+        capture().next.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount,
+                                       pRegions);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdPipelineBarrier2KHR(
+            VkCommandBuffer commandBuffer, const VkDependencyInfoKHR *pDependencyInfo) {
+        record(CmdPipelineBarrier2KHR{commandBuffer, pDependencyInfo});
+        capture().next.vkCmdPipelineBarrier2KHR(commandBuffer, pDependencyInfo);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdBeginRenderingKHR(
+            VkCommandBuffer commandBuffer, const VkRenderingInfoKHR *pRenderingInfo) {
+        record(CmdBeginRenderingKHR{commandBuffer, pRenderingInfo});
+        capture().next.vkCmdBeginRenderingKHR(commandBuffer, pRenderingInfo);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdEndRenderingKHR(VkCommandBuffer commandBuffer) {
+        record(CmdEndRenderingKHR{commandBuffer});
+        capture().next.vkCmdEndRenderingKHR(commandBuffer);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdBeginRenderPass(
+            VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin,
+            VkSubpassContents contents) {
+        record(CmdBeginRenderPass{commandBuffer, pRenderPassBegin, contents});
+        capture().next.vkCmdBeginRenderPass(commandBuffer, pRenderPassBegin, contents);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL Capture_vkCmdEndRenderPass(VkCommandBuffer commandBuffer) {
+        record(CmdEndRenderPass{commandBuffer});
+        capture().next.vkCmdEndRenderPass(commandBuffer);
+    }
+
+    /* Synchronization and presentation */
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkResetFences(VkDevice device, uint32_t fenceCount,
+                                                         const VkFence *pFences) {
+        record(ResetFences{fenceCount, pFences});
+        return capture().next.vkResetFences(device, fenceCount, pFences);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkWaitForFences(
+            VkDevice device, uint32_t fenceCount, const VkFence *pFences, VkBool32 waitAll,
+            uint64_t timeout) {
+        record(WaitForFences{fenceCount, pFences, waitAll, timeout});
+        return capture().next.vkWaitForFences(device, fenceCount, pFences, waitAll, timeout);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkQueueWaitIdle(VkQueue queue) {
+        record(QueueWaitIdle{});
+        return capture().next.vkQueueWaitIdle(queue);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkDeviceWaitIdle(VkDevice device) {
+        record(DeviceWaitIdle{});
+        return capture().next.vkDeviceWaitIdle(device);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkQueueSubmit(
+            VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence) {
+        Capture &state = capture();
+        if (state.active.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.file != nullptr && state.recordingFrames) {
+                // The GPU may read anything the host wrote since the last submission
+                for (auto &[memory, mapping]: state.mappings) {
+                    state.writeMemory(memory, mapping);
+                }
+                QueueSubmit call{submitCount, pSubmits, fence};
+                state.write(call);
+            }
+        }
+        return state.next.vkQueueSubmit(queue, submitCount, pSubmits, fence);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkGetSwapchainImagesKHR(
+            VkDevice device, VkSwapchainKHR swapchain, uint32_t *pSwapchainImageCount,
+            VkImage *pSwapchainImages) {
+        const VkResult result = capture().next.vkGetSwapchainImagesKHR(
+                device, swapchain, pSwapchainImageCount, pSwapchainImages);
+        if (result >= VK_SUCCESS && pSwapchainImages != nullptr) {
+            record(GetSwapchainImagesKHR{swapchain, *pSwapchainImageCount, pSwapchainImages});
+        }
+        return result;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkAcquireNextImageKHR(
+            VkDevice device, VkSwapchainKHR swapchain, uint64_t timeout, VkSemaphore semaphore,
+            VkFence fence, uint32_t *pImageIndex) {
+        Capture &state = capture();
+        const VkResult result = state.next.vkAcquireNextImageKHR(device, swapchain, timeout,
+                                                                 semaphore, fence, pImageIndex);
+        const bool acquired = result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+        if (!acquired || !state.active.load(std::memory_order_acquire)) {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.file == nullptr) {
+            return result;
+        }
+        // Frames start here, everything before the first acquire was setup
+        state.recordingFrames = state.frame >= state.firstFrame;
+        if (state.recordingFrames && !state.framesBegun) {
+            state.framesBegun = true;
+            FramesBegin framesBegin{state.frameCount};
+            state.write(framesBegin);
+        }
+        if (state.recordingFrames) {
+            AcquireNextImageKHR call{swapchain, timeout, semaphore, fence, *pImageIndex};
+            state.write(call);
+        }
+        return result;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL Capture_vkQueuePresentKHR(
+            VkQueue queue, const VkPresentInfoKHR *pPresentInfo) {
+        Capture &state = capture();
+        const VkResult result = state.next.vkQueuePresentKHR(queue, pPresentInfo);
+        if (!state.active.load(std::memory_order_acquire)) {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.file == nullptr) {
+            return result;
+        }
+        if (state.recordingFrames) {
+            QueuePresentKHR call{pPresentInfo};
+            state.write(call);
+        }
+        if (++state.frame == state.firstFrame + state.frameCount) {
+            LOGI("Captured %u frames to %s", state.frameCount, state.path.c_str());
+            state.close();
+        }
+        return result;
+    }
+}
+
+namespace vulkan_capture {
+    bool begin(VkPhysicalDevice gpu, const VkDeviceCreateInfo *createInfo, const char *path,
+               uint32_t firstFrame, uint32_t frameCount) {
+        Capture &state = capture();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.file != nullptr) {
+            LOGW("Already capturing to %s", state.path.c_str());
+            return false;
+        }
+        state.file = fopen(path, "wb");
+        if (state.file == nullptr) {
+            LOGE("Failed to create the capture file %s", path);
+            return false;
+        }
+        setvbuf(state.file, nullptr, _IOFBF, kFileBufferSize);
+
+        state.path = path;
+        state.firstFrame = firstFrame;
+        state.frameCount = frameCount;
+        state.frame = 0;
+        state.recordingFrames = true;
+        state.framesBegun = false;
+        vkGetPhysicalDeviceMemoryProperties(gpu, &state.memoryProperties);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(gpu, &properties);
+        fwrite(kMagic, sizeof(kMagic), 1, state.file);
+        fwrite(&kVersion, sizeof(kVersion), 1, state.file);
+        DeviceInfo deviceInfo{
+                .apiVersion = properties.apiVersion,
+                .deviceName = {},
+                .enabledExtensionCount = createInfo->enabledExtensionCount,
+                .ppEnabledExtensionNames = createInfo->ppEnabledExtensionNames,
+                .pEnabledFeatures = createInfo->pEnabledFeatures,
+                .pNext = createInfo->pNext
+        };
+        memcpy(deviceInfo.deviceName, properties.deviceName, sizeof(deviceInfo.deviceName));
+        state.write(deviceInfo);
+
+        // Hooked once, a second capture must not forward to its own hooks
+        if (!state.hooked) {
+            state.hooked = true;
+#define CAPTURE_SAVE(name) state.next.name = name;
+#define CAPTURE_SAVE_EXTENSION(extension, name) CAPTURE_SAVE(name)
+            VK_DEVICE_FUNCTIONS_1_0(CAPTURE_SAVE)
+            VK_DEVICE_FUNCTIONS_1_1(CAPTURE_SAVE)
+            VK_DEVICE_EXTENSION_FUNCTIONS(CAPTURE_SAVE_EXTENSION)
+#undef CAPTURE_SAVE_EXTENSION
+#undef CAPTURE_SAVE
+
+#define CAPTURE_HOOK(function, call) \
+            if (VK_IS_AVAILABLE(function)) { \
+                function = Capture_##function; \
+            }
+            VK_TRACE_CALLS(CAPTURE_HOOK)
+            CAPTURE_HOOK(vkMapMemory, )
+            CAPTURE_HOOK(vkUnmapMemory, )
+#undef CAPTURE_HOOK
+        }
+
+        state.active.store(true, std::memory_order_release);
+        LOGI("Capturing %u frames after %u to %s", frameCount, firstFrame, path);
+        return true;
+    }
+
+    void end() {
+        Capture &state = capture();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.file != nullptr) {
+            LOGW("Capture ended after %u of %u frames",
+                 std::max(state.frame, state.firstFrame) - state.firstFrame, state.frameCount);
+            state.close();
+        }
+    }
+
+    bool isCapturing() {
+        return capture().active.load(std::memory_order_acquire);
+    }
+}
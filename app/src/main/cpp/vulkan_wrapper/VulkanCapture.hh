@@ -0,0 +1,40 @@
+//
+// Created by eternal on 2024/7/10.
+//
+
+#ifndef LEARNINGVULKAN_VULKANCAPTURE_HH
+#define LEARNINGVULKAN_VULKANCAPTURE_HH
+
+#include <cstdint>
+#include "vulkan_wrapper.hh"
+
+/**
+ * @brief Records the device calls of a few frames into a trace for tools/trace_replay
+ *
+ * begin() swaps the wrapper's device-level function pointers of the calls in VK_TRACE_CALLS for
+ * hooks that write them to the trace and call the driver. Calls creating, destroying or updating
+ * objects are recorded from the start, so the replay can set everything up. Per-frame calls are
+ * recorded before the first vkAcquireNextImageKHR, e.g. staging copies, and for frameCount frames
+ * after skipping firstFrame frames. Frames end at vkQueuePresentKHR.
+ *
+ * Host writes to mapped memory are found by comparing the mapping with a shadow copy at every
+ * vkQueueSubmit and vkUnmapMemory, and recorded as the bytes that changed.
+ *
+ * The trace is closed after the last frame or by end(), the hooks then only call the driver.
+ * Recording is thread safe, pipelines may be created on worker threads.
+ */
+namespace vulkan_capture {
+    /**
+     * @brief Starts capturing, right after InitVulkanDevice with the same create info
+     *
+     * @return false if the trace file can't be created, nothing is hooked then
+     */
+    bool begin(VkPhysicalDevice gpu, const VkDeviceCreateInfo *createInfo, const char *path,
+               uint32_t firstFrame, uint32_t frameCount);
+
+    void end();
+
+    bool isCapturing();
+}
+
+#endif //LEARNINGVULKAN_VULKANCAPTURE_HH
@@ -0,0 +1,419 @@
+//
+// Created by eternal on 2024/7/10.
+//
+#include <cstring>
+#include "Debug.hh"
+#include "VulkanTrace.hh"
+
+namespace vulkan_trace {
+    namespace {
+        constexpr size_t kHeaderSize = sizeof(kMagic) + sizeof(kVersion);
+
+        constexpr size_t kRecordHeaderSize = sizeof(uint16_t) + sizeof(uint32_t);
+
+        /// Address of the descriptor of an entry in the raw template data
+        size_t getTemplateOffset(const VkDescriptorUpdateTemplateEntry &entry, uint32_t index) {
+            return entry.offset + index * entry.stride;
+        }
+
+        size_t getDescriptorSize(VkDescriptorType type) {
+            switch (getDescriptorKind(type)) {
+                case DescriptorKind::Image:
+                    return sizeof(VkDescriptorImageInfo);
+                case DescriptorKind::Buffer:
+                    return sizeof(VkDescriptorBufferInfo);
+                case DescriptorKind::TexelBuffer:
+                    return sizeof(VkBufferView);
+                case DescriptorKind::Other:
+                    break;
+            }
+            return 0;
+        }
+    }
+
+    DescriptorKind getDescriptorKind(VkDescriptorType type) {
+        switch (type) {
+            case VK_DESCRIPTOR_TYPE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                return DescriptorKind::Image;
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                return DescriptorKind::Buffer;
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                return DescriptorKind::TexelBuffer;
+            default:
+                return DescriptorKind::Other;
+        }
+    }
+
+    std::vector<TemplateDescriptor>
+    unpackTemplateData(const std::vector<VkDescriptorUpdateTemplateEntry> &entries,
+                       const void *data) {
+        std::vector<TemplateDescriptor> descriptors;
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        for (const VkDescriptorUpdateTemplateEntry &entry: entries) {
+            for (uint32_t i = 0; i < entry.descriptorCount; ++i) {
+                TemplateDescriptor descriptor{.type = entry.descriptorType};
+                const uint8_t *source = bytes + getTemplateOffset(entry, i);
+                switch (getDescriptorKind(entry.descriptorType)) {
+                    case DescriptorKind::Image:
+                        memcpy(&descriptor.image, source, sizeof(descriptor.image));
+                        break;
+                    case DescriptorKind::Buffer:
+                        memcpy(&descriptor.buffer, source, sizeof(descriptor.buffer));
+                        break;
+                    case DescriptorKind::TexelBuffer:
+                        memcpy(&descriptor.texelBufferView, source,
+                               sizeof(descriptor.texelBufferView));
+                        break;
+                    case DescriptorKind::Other:
+                        break;
+                }
+                descriptors.push_back(descriptor);
+            }
+        }
+        return descriptors;
+    }
+
+    std::vector<uint8_t>
+    packTemplateData(const std::vector<VkDescriptorUpdateTemplateEntry> &entries,
+                     const TemplateDescriptor *descriptors, uint32_t descriptorCount) {
+        size_t size = 0;
+        for (const VkDescriptorUpdateTemplateEntry &entry: entries) {
+            if (entry.descriptorCount > 0) {
+                size = std::max(size, getTemplateOffset(entry, entry.descriptorCount - 1) +
+                                      getDescriptorSize(entry.descriptorType));
+            }
+        }
+
+        std::vector<uint8_t> data(size);
+        uint32_t next = 0;
+        for (const VkDescriptorUpdateTemplateEntry &entry: entries) {
+            for (uint32_t i = 0; i < entry.descriptorCount && next < descriptorCount; ++i) {
+                const TemplateDescriptor &descriptor = descriptors[next++];
+                uint8_t *target = data.data() + getTemplateOffset(entry, i);
+                switch (getDescriptorKind(entry.descriptorType)) {
+                    case DescriptorKind::Image:
+                        memcpy(target, &descriptor.image, sizeof(descriptor.image));
+                        break;
+                    case DescriptorKind::Buffer:
+                        memcpy(target, &descriptor.buffer, sizeof(descriptor.buffer));
+                        break;
+                    case DescriptorKind::TexelBuffer:
+                        memcpy(target, &descriptor.texelBufferView,
+                               sizeof(descriptor.texelBufferView));
+                        break;
+                    case DescriptorKind::Other:
+                        break;
+                }
+            }
+        }
+        if (next != descriptorCount) {
+            LOGW("Template update has %u descriptors, the template expects %u.",
+                 descriptorCount, next);
+        }
+        return data;
+    }
+
+    /* TraceWriter */
+
+    void TraceWriter::begin() {
+        payload.clear();
+    }
+
+    const std::vector<uint8_t> &TraceWriter::getPayload() const {
+        return payload;
+    }
+
+    void TraceWriter::size(size_t &item) {
+        const uint64_t value = item;
+        append(&value, sizeof(value));
+    }
+
+    void TraceWriter::bytes(uint64_t size, const void *&data) {
+        if (flag(data != nullptr)) {
+            append(data, size);
+        }
+    }
+
+    void TraceWriter::string(const char *&item) {
+        if (flag(item != nullptr)) {
+            const auto length = static_cast<uint32_t>(strlen(item));
+            append(&length, sizeof(length));
+            append(item, length);
+        }
+    }
+
+    void TraceWriter::strings(uint32_t count, const char *const *&array) {
+        if (flag(array != nullptr)) {
+            for (uint32_t i = 0; i < count; ++i) {
+                const char *item = array[i];
+                string(item);
+            }
+        }
+    }
+
+    void TraceWriter::next(const void *&chain) {
+        std::vector<const VkBaseInStructure *> kept;
+        for (auto *structure = static_cast<const VkBaseInStructure *>(chain);
+             structure != nullptr; structure = structure->pNext) {
+            if (visitNext(structure->sType, [](auto *) {})) {
+                kept.push_back(structure);
+            } else if (droppedTypes.insert(structure->sType).second) {
+                LOGW("Trace drops pNext structures of type %d.", structure->sType);
+            }
+        }
+
+        const auto count = static_cast<uint32_t>(kept.size());
+        append(&count, sizeof(count));
+        for (const VkBaseInStructure *structure: kept) {
+            append(&structure->sType, sizeof(structure->sType));
+            visitNext(structure->sType, [this, structure](auto *tag) {
+                using Structure = std::remove_pointer_t<decltype(tag)>;
+                serialize(*this, *reinterpret_cast<Structure *>(
+                        const_cast<VkBaseInStructure *>(structure)));
+            });
+        }
+    }
+
+    void TraceWriter::layout(VkImageLayout &item) {
+        value(item);
+    }
+
+    void TraceWriter::queueFamily(uint32_t &item) {
+        value(item);
+    }
+
+    void TraceWriter::append(const void *data, size_t size) {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        payload.insert(payload.end(), bytes, bytes + size);
+    }
+
+    bool TraceWriter::flag(bool set) {
+        const uint8_t value = set ? 1 : 0;
+        append(&value, sizeof(value));
+        return set;
+    }
+
+    /* TraceReader */
+
+    bool TraceReader::open(const void *data, size_t size, uint32_t queueFamily) {
+        begin = static_cast<const uint8_t *>(data);
+        end = begin + size;
+        replayQueueFamily = queueFamily;
+
+        uint32_t version = 0;
+        if (size < kHeaderSize || memcmp(begin, kMagic, sizeof(kMagic)) != 0) {
+            LOGE("Not a Vulkan trace.");
+            return false;
+        }
+        memcpy(&version, begin + sizeof(kMagic), sizeof(version));
+        if (version != kVersion) {
+            LOGE("Trace version %u is not supported, expected %u.", version, kVersion);
+            return false;
+        }
+        seek(kHeaderSize);
+        return true;
+    }
+
+    bool TraceReader::nextRecord(Record &type) {
+        allocations.clear();
+        pendingOutputs.clear();
+        failed = false;
+
+        cursor = recordEnd;
+        if (static_cast<size_t>(end - cursor) < kRecordHeaderSize) {
+            return false;
+        }
+        uint16_t rawType = 0;
+        uint32_t size = 0;
+        memcpy(&rawType, cursor, sizeof(rawType));
+        memcpy(&size, cursor + sizeof(rawType), sizeof(size));
+        cursor += kRecordHeaderSize;
+        if (size > static_cast<size_t>(end - cursor)) {
+            LOGW("Trace ends in a truncated record.");
+            return false;
+        }
+        recordEnd = cursor + size;
+        type = static_cast<Record>(rawType);
+        return true;
+    }
+
+    bool TraceReader::ok() const {
+        return !failed;
+    }
+
+    void TraceReader::seek(size_t offset) {
+        cursor = begin + offset;
+        recordEnd = cursor;
+    }
+
+    size_t TraceReader::getRecordOffset() const {
+        return recordEnd - begin;
+    }
+
+    void TraceReader::bindOutputs() {
+        for (const PendingOutput &output: pendingOutputs) {
+            uint64_t replayHandle = 0;
+            memcpy(&replayHandle, output.replayHandle, output.handleSize);
+            bind(output.traceHandle, replayHandle);
+        }
+        pendingOutputs.clear();
+    }
+
+    void TraceReader::bind(uint64_t traceHandle, uint64_t replayHandle) {
+        if (traceHandle != 0) {
+            handleMap[traceHandle] = replayHandle;
+        }
+    }
+
+    uint32_t TraceReader::getUnknownHandleCount() const {
+        return unknownHandleCount;
+    }
+
+    void TraceReader::size(size_t &item) {
+        uint64_t value = 0;
+        read(&value, sizeof(value));
+        item = static_cast<size_t>(value);
+    }
+
+    void TraceReader::bytes(uint64_t size, const void *&data) {
+        data = nullptr;
+        if (!flag()) {
+            return;
+        }
+        if (size > static_cast<uint64_t>(recordEnd - cursor)) {
+            failed = true;
+            return;
+        }
+        // Keeps the alignment of the pushed constants and shader code the bytes stand for
+        auto *copy = allocate<uint64_t>((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        read(copy, size);
+        data = copy;
+    }
+
+    void TraceReader::string(const char *&item) {
+        item = nullptr;
+        if (!flag()) {
+            return;
+        }
+        uint32_t length = 0;
+        read(&length, sizeof(length));
+        if (length > static_cast<size_t>(recordEnd - cursor)) {
+            failed = true;
+            return;
+        }
+        char *copy = allocate<char>(length + 1);
+        read(copy, length);
+        item = copy;
+    }
+
+    void TraceReader::strings(uint32_t count, const char *const *&array) {
+        array = nullptr;
+        if (flag() && fits(count)) {
+            const char **decoded = allocate<const char *>(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                string(decoded[i]);
+            }
+            array = decoded;
+        }
+    }
+
+    void TraceReader::next(const void *&chain) {
+        chain = nullptr;
+        uint32_t count = 0;
+        read(&count, sizeof(count));
+        if (!fits(count)) {
+            return;
+        }
+
+        VkBaseOutStructure *last = nullptr;
+        for (uint32_t i = 0; i < count && !failed; ++i) {
+            VkStructureType sType{};
+            read(&sType, sizeof(sType));
+            const bool known = visitNext(sType, [this, sType, &chain, &last](auto *tag) {
+                using Structure = std::remove_pointer_t<decltype(tag)>;
+                Structure *structure = allocate<Structure>(1);
+                structure->sType = sType;
+                serialize(*this, *structure);
+
+                auto *linked = reinterpret_cast<VkBaseOutStructure *>(structure);
+                if (last == nullptr) {
+                    chain = linked;
+                } else {
+                    last->pNext = linked;
+                }
+                last = linked;
+            });
+            if (!known) {
+                // Unknown structures have no size in the trace, nothing after them can be read
+                LOGE("Trace has pNext structures of unknown type %d.", sType);
+                failed = true;
+            }
+        }
+    }
+
+    void TraceReader::layout(VkImageLayout &item) {
+        value(item);
+        if (item == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+            item = VK_IMAGE_LAYOUT_GENERAL;
+        }
+    }
+
+    void TraceReader::queueFamily(uint32_t &item) {
+        value(item);
+        if (item != VK_QUEUE_FAMILY_IGNORED && item != VK_QUEUE_FAMILY_EXTERNAL) {
+            item = replayQueueFamily;
+        }
+    }
+
+    void TraceReader::read(void *data, size_t size) {
+        if (failed || size > static_cast<size_t>(recordEnd - cursor)) {
+            failed = true;
+            memset(data, 0, size);
+            return;
+        }
+        memcpy(data, cursor, size);
+        cursor += size;
+    }
+
+    void TraceReader::skip(size_t size) {
+        if (failed || size > static_cast<size_t>(recordEnd - cursor)) {
+            failed = true;
+            return;
+        }
+        cursor += size;
+    }
+
+    bool TraceReader::flag() {
+        uint8_t value = 0;
+        read(&value, sizeof(value));
+        return value != 0 && !failed;
+    }
+
+    bool TraceReader::fits(uint32_t count) {
+        if (failed || count > static_cast<size_t>(recordEnd - cursor)) {
+            failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t TraceReader::lookup(uint64_t traceHandle) {
+        if (traceHandle == 0) {
+            return 0;
+        }
+        const auto found = handleMap.find(traceHandle);
+        if (found == handleMap.end()) {
+            ++unknownHandleCount;
+            return 0;
+        }
+        return found->second;
+    }
+}
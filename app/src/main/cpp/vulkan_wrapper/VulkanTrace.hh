@@ -0,0 +1,2067 @@
+//
+// Created by eternal on 2024/7/10.
+//
+
+#ifndef LEARNINGVULKAN_VULKANTRACE_HH
+#define LEARNINGVULKAN_VULKANTRACE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "vulkan_wrapper.hh"
+
+/* Binary trace of the device calls of a frame workload, written by vulkan_capture and read by
+ * tools/trace_replay.
+ *
+ * A trace starts with kMagic and kVersion, followed by records of a 16-bit Record type, a 32-bit
+ * payload size and the payload. The first record is DeviceInfo, then come the calls creating
+ * objects, FramesBegin and the captured frames, each ending with its QueuePresentKHR.
+ *
+ * A call is stored as its parameters without the device, see the structs below. Each struct has
+ * one serialize function used for both directions, TraceWriter encodes and TraceReader decodes
+ * into freshly allocated structs. Handles are stored as the capturing process's handle values and
+ * map to the replay's own objects once they are created. Structures without pointers and handles
+ * are stored as plain bytes, they are laid out the same on every 64-bit and 32-bit ABI we build
+ * for. pNext chains keep the structures listed in visitNext and drop the others.
+ */
+namespace vulkan_trace {
+    constexpr char kMagic[8] = {'L', 'V', 'T', 'R', 'A', 'C', 'E', '\0'};
+
+    constexpr uint32_t kVersion = 1;
+
+    /// Entry points recorded, with the struct holding their parameters
+#define VK_TRACE_CALLS(X) \
+    X(vkCreateBuffer, CreateBuffer) \
+    X(vkDestroyBuffer, DestroyBuffer) \
+    X(vkAllocateMemory, AllocateMemory) \
+    X(vkFreeMemory, FreeMemory) \
+    X(vkBindBufferMemory, BindBufferMemory) \
+    X(vkCreateImage, CreateImage) \
+    X(vkDestroyImage, DestroyImage) \
+    X(vkBindImageMemory, BindImageMemory) \
+    X(vkCreateImageView, CreateImageView) \
+    X(vkDestroyImageView, DestroyImageView) \
+    X(vkCreateShaderModule, CreateShaderModule) \
+    X(vkDestroyShaderModule, DestroyShaderModule) \
+    X(vkCreatePipelineCache, CreatePipelineCache) \
+    X(vkDestroyPipelineCache, DestroyPipelineCache) \
+    X(vkCreateDescriptorSetLayout, CreateDescriptorSetLayout) \
+    X(vkDestroyDescriptorSetLayout, DestroyDescriptorSetLayout) \
+    X(vkCreatePipelineLayout, CreatePipelineLayout) \
+    X(vkDestroyPipelineLayout, DestroyPipelineLayout) \
+    X(vkCreateSampler, CreateSampler) \
+    X(vkDestroySampler, DestroySampler) \
+    X(vkCreateRenderPass, CreateRenderPass) \
+    X(vkDestroyRenderPass, DestroyRenderPass) \
+    X(vkCreateFramebuffer, CreateFramebuffer) \
+    X(vkDestroyFramebuffer, DestroyFramebuffer) \
+    X(vkCreateGraphicsPipelines, CreateGraphicsPipelines) \
+    X(vkDestroyPipeline, DestroyPipeline) \
+    X(vkCreateDescriptorPool, CreateDescriptorPool) \
+    X(vkDestroyDescriptorPool, DestroyDescriptorPool) \
+    X(vkResetDescriptorPool, ResetDescriptorPool) \
+    X(vkAllocateDescriptorSets, AllocateDescriptorSets) \
+    X(vkUpdateDescriptorSets, UpdateDescriptorSets) \
+    X(vkCreateDescriptorUpdateTemplate, CreateDescriptorUpdateTemplate) \
+    X(vkDestroyDescriptorUpdateTemplate, DestroyDescriptorUpdateTemplate) \
+    X(vkUpdateDescriptorSetWithTemplate, UpdateDescriptorSetWithTemplate) \
+    X(vkCreateCommandPool, CreateCommandPool) \
+    X(vkDestroyCommandPool, DestroyCommandPool) \
+    X(vkResetCommandPool, ResetCommandPool) \
+    X(vkAllocateCommandBuffers, AllocateCommandBuffers) \
+    X(vkFreeCommandBuffers, FreeCommandBuffers) \
+    X(vkCreateFence, CreateFence) \
+    X(vkDestroyFence, DestroyFence) \
+    X(vkResetFences, ResetFences) \
+    X(vkWaitForFences, WaitForFences) \
+    X(vkCreateSemaphore, CreateSemaphore) \
+    X(vkDestroySemaphore, DestroySemaphore) \
+    X(vkCreateSwapchainKHR, CreateSwapchainKHR) \
+    X(vkDestroySwapchainKHR, DestroySwapchainKHR) \
+    X(vkGetSwapchainImagesKHR, GetSwapchainImagesKHR) \
+    X(vkAcquireNextImageKHR, AcquireNextImageKHR) \
+    X(vkQueueSubmit, QueueSubmit) \
+    X(vkQueuePresentKHR, QueuePresentKHR) \
+    X(vkQueueWaitIdle, QueueWaitIdle) \
+    X(vkDeviceWaitIdle, DeviceWaitIdle) \
+    X(vkBeginCommandBuffer, BeginCommandBuffer) \
+    X(vkEndCommandBuffer, EndCommandBuffer) \
+    X(vkCmdBindPipeline, CmdBindPipeline) \
+    X(vkCmdSetViewport, CmdSetViewport) \
+    X(vkCmdSetScissor, CmdSetScissor) \
+    X(vkCmdBindDescriptorSets, CmdBindDescriptorSets) \
+    X(vkCmdBindVertexBuffers, CmdBindVertexBuffers) \
+    X(vkCmdBindIndexBuffer, CmdBindIndexBuffer) \
+    X(vkCmdDraw, CmdDraw) \
+    X(vkCmdDrawIndexed, CmdDrawIndexed) \
+    X(vkCmdPushConstants, CmdPushConstants) \
+    X(vkCmdUpdateBuffer, CmdUpdateBuffer) \
+    X(vkCmdCopyBuffer, CmdCopyBuffer) \
+    X(vkCmdPipelineBarrier2KHR, CmdPipelineBarrier2KHR) \
+    X(vkCmdBeginRenderingKHR, CmdBeginRenderingKHR) \
+    X(vkCmdEndRenderingKHR, CmdEndRenderingKHR) \
+    X(vkCmdBeginRenderPass, CmdBeginRenderPass) \
+    X(vkCmdEndRenderPass, CmdEndRenderPass)
+
+    enum class Record : uint16_t {
+        /// The device the trace was captured on and what it had enabled
+        DeviceInfo,
+        /// Everything before was setup, the captured frames follow
+        FramesBegin,
+        /// Bytes the host wrote to mapped memory
+        MemoryWrite,
+#define VK_TRACE_RECORD(function, call) call,
+        VK_TRACE_CALLS(VK_TRACE_RECORD)
+#undef VK_TRACE_RECORD
+        Count
+    };
+
+    template<typename Handle>
+    uint64_t toHandleValue(Handle handle) {
+        if constexpr (std::is_pointer_v<Handle>) {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+        } else {
+            return handle;
+        }
+    }
+
+    template<typename Handle>
+    Handle fromHandleValue(uint64_t value) {
+        if constexpr (std::is_pointer_v<Handle>) {
+            return reinterpret_cast<Handle>(static_cast<uintptr_t>(value));
+        } else {
+            return value;
+        }
+    }
+
+    /// Types stored as plain bytes: numbers, enums and the structs listed below
+    template<typename T>
+    constexpr bool isPlain = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+    template<typename T, size_t N>
+    constexpr bool isPlain<T[N]> = isPlain<T>;
+
+#define VK_TRACE_PLAIN(type) template<> constexpr bool isPlain<type> = true;
+    VK_TRACE_PLAIN(VkExtent2D)
+    VK_TRACE_PLAIN(VkExtent3D)
+    VK_TRACE_PLAIN(VkOffset2D)
+    VK_TRACE_PLAIN(VkRect2D)
+    VK_TRACE_PLAIN(VkViewport)
+    VK_TRACE_PLAIN(VkClearValue)
+    VK_TRACE_PLAIN(VkComponentMapping)
+    VK_TRACE_PLAIN(VkImageSubresourceRange)
+    VK_TRACE_PLAIN(VkPushConstantRange)
+    VK_TRACE_PLAIN(VkVertexInputBindingDescription)
+    VK_TRACE_PLAIN(VkVertexInputAttributeDescription)
+    VK_TRACE_PLAIN(VkPipelineColorBlendAttachmentState)
+    VK_TRACE_PLAIN(VkStencilOpState)
+    VK_TRACE_PLAIN(VkSubpassDependency)
+    VK_TRACE_PLAIN(VkDescriptorPoolSize)
+    VK_TRACE_PLAIN(VkBufferCopy)
+    VK_TRACE_PLAIN(VkPhysicalDeviceFeatures)
+#undef VK_TRACE_PLAIN
+
+    /**
+     * @brief Calls visitor with a null pointer of the structure type behind sType, if it is one
+     * of the pNext structures kept in traces
+     *
+     * Creation feedback and other structures the driver writes to are left out on purpose.
+     */
+    template<typename Visitor>
+    bool visitNext(VkStructureType sType, Visitor &&visitor) {
+        switch (sType) {
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2:
+                visitor(static_cast<VkPhysicalDeviceFeatures2 *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR:
+                visitor(static_cast<VkPhysicalDeviceSynchronization2FeaturesKHR *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR:
+                visitor(static_cast<VkPhysicalDeviceDynamicRenderingFeaturesKHR *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT:
+                visitor(static_cast<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT:
+                visitor(static_cast<VkPhysicalDeviceDescriptorIndexingFeaturesEXT *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT:
+                visitor(static_cast<VkDescriptorSetLayoutBindingFlagsCreateInfoEXT *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT:
+                visitor(static_cast<VkDescriptorSetVariableDescriptorCountAllocateInfoEXT *>(
+                        nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR:
+                visitor(static_cast<VkPipelineRenderingCreateInfoKHR *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT:
+                visitor(static_cast<VkGraphicsPipelineLibraryCreateInfoEXT *>(nullptr));
+                return true;
+            case VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR:
+                visitor(static_cast<VkPipelineLibraryCreateInfoKHR *>(nullptr));
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    template<typename Archive, typename T>
+    void serializeItem(Archive &archive, T &item) {
+        if constexpr (isPlain<T>) {
+            archive.value(item);
+        } else {
+            serialize(archive, item);
+        }
+    }
+
+    /**
+     * @brief Encodes one record at a time
+     */
+    class TraceWriter {
+    public:
+        static constexpr bool kReading = false;
+
+        void begin();
+
+        const std::vector<uint8_t> &getPayload() const;
+
+        template<typename T>
+        void value(T &item) {
+            static_assert(isPlain<T>, "Only plain values are stored as bytes");
+            append(&item, sizeof(T));
+        }
+
+        /// Stored as 64 bits on every ABI
+        void size(size_t &item);
+
+        template<typename Handle>
+        void handle(Handle &item) {
+            uint64_t value = toHandleValue(item);
+            append(&value, sizeof(value));
+        }
+
+        /// A handle the call creates
+        template<typename Handle>
+        void output(Handle &item) {
+            handle(item);
+        }
+
+        /// A structure behind a pointer that may be null
+        template<typename T>
+        void object(const T *&item) {
+            if (flag(item != nullptr)) {
+                serializeItem(*this, const_cast<T &>(*item));
+            }
+        }
+
+        /// An array that may be null, its count is serialized before
+        template<typename T>
+        void items(uint32_t count, const T *&array) {
+            if (flag(array != nullptr)) {
+                for (uint32_t i = 0; i < count; ++i) {
+                    serializeItem(*this, const_cast<T &>(array[i]));
+                }
+            }
+        }
+
+        template<typename Handle>
+        void handles(uint32_t count, const Handle *&array) {
+            if (flag(array != nullptr)) {
+                for (uint32_t i = 0; i < count; ++i) {
+                    Handle item = array[i];
+                    handle(item);
+                }
+            }
+        }
+
+        template<typename Handle>
+        void outputs(uint32_t count, Handle *&array) {
+            const Handle *created = array;
+            handles(count, created);
+        }
+
+        void bytes(uint64_t size, const void *&data);
+
+        void string(const char *&item);
+
+        void strings(uint32_t count, const char *const *&array);
+
+        void next(const void *&chain);
+
+        /// The members after sType and pNext of a structure without pointers and handles
+        template<typename T>
+        void body(T &item) {
+            constexpr size_t offset = offsetof(T, pNext) + sizeof(void *);
+            const auto size = static_cast<uint32_t>(sizeof(T) - offset);
+            append(&size, sizeof(size));
+            append(reinterpret_cast<const uint8_t *>(&item) + offset, size);
+        }
+
+        void layout(VkImageLayout &item);
+
+        void queueFamily(uint32_t &item);
+
+    private:
+        std::vector<uint8_t> payload{};
+
+        /// pNext structures dropped so far, each is reported once
+        std::unordered_set<VkStructureType> droppedTypes{};
+
+        void append(const void *data, size_t size);
+
+        bool flag(bool set);
+    };
+
+    /**
+     * @brief Decodes the records of a trace in memory
+     *
+     * Decoded structures live until the next record is read. Handles are translated to the
+     * replay's objects registered with bindOutputs. Swapchain images become plain images in a
+     * replay, so VK_IMAGE_LAYOUT_PRESENT_SRC_KHR reads as VK_IMAGE_LAYOUT_GENERAL, and queue
+     * family indices read as the replay's queue family.
+     */
+    class TraceReader {
+    public:
+        static constexpr bool kReading = true;
+
+        /// Checks the header, data has to outlive the reader
+        bool open(const void *data, size_t size, uint32_t queueFamily);
+
+        /// Moves to the next record, false at the end of the trace or on a truncated record
+        bool nextRecord(Record &type);
+
+        /// Whether the current record decoded without running past its end
+        bool ok() const;
+
+        /// Continues reading at an offset returned by getRecordOffset, e.g. to loop over frames
+        void seek(size_t offset);
+
+        /// Offset of the record after the current one
+        size_t getRecordOffset() const;
+
+        /// Maps the handles created by the last decoded call to the replay's ones
+        void bindOutputs();
+
+        /// Maps a handle value of the trace to a replay object created outside of a call
+        void bind(uint64_t traceHandle, uint64_t replayHandle);
+
+        /// Handles that were referenced without being created in the trace
+        uint32_t getUnknownHandleCount() const;
+
+        template<typename T>
+        T *allocate(size_t count) {
+            if (count == 0) {
+                return nullptr;
+            }
+            auto storage = std::make_unique<uint8_t[]>(sizeof(T) * count + alignof(T));
+            void *aligned = storage.get();
+            size_t space = sizeof(T) * count + alignof(T);
+            aligned = std::align(alignof(T), sizeof(T) * count, aligned, space);
+            allocations.emplace_back(std::move(storage));
+            T *items = static_cast<T *>(aligned);
+            for (size_t i = 0; i < count; ++i) {
+                new(items + i) T{};
+            }
+            return items;
+        }
+
+        template<typename T>
+        void value(T &item) {
+            static_assert(isPlain<T>, "Only plain values are stored as bytes");
+            read(&item, sizeof(T));
+        }
+
+        void size(size_t &item);
+
+        template<typename Handle>
+        void handle(Handle &item) {
+            uint64_t value = 0;
+            read(&value, sizeof(value));
+            item = fromHandleValue<Handle>(lookup(value));
+        }
+
+        template<typename Handle>
+        void output(Handle &item) {
+            uint64_t value = 0;
+            read(&value, sizeof(value));
+            item = Handle{};
+            pendingOutputs.push_back({value, &item, sizeof(Handle)});
+        }
+
+        template<typename T>
+        void object(const T *&item) {
+            item = nullptr;
+            if (flag()) {
+                T *decoded = allocate<T>(1);
+                serializeItem(*this, *decoded);
+                item = decoded;
+            }
+        }
+
+        template<typename T>
+        void items(uint32_t count, const T *&array) {
+            array = nullptr;
+            if (flag() && fits(count)) {
+                T *decoded = allocate<T>(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    serializeItem(*this, decoded[i]);
+                }
+                array = decoded;
+            }
+        }
+
+        template<typename Handle>
+        void handles(uint32_t count, const Handle *&array) {
+            array = nullptr;
+            if (flag() && fits(count)) {
+                Handle *decoded = allocate<Handle>(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    handle(decoded[i]);
+                }
+                array = decoded;
+            }
+        }
+
+        template<typename Handle>
+        void outputs(uint32_t count, Handle *&array) {
+            array = nullptr;
+            if (flag() && fits(count)) {
+                array = allocate<Handle>(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    output(array[i]);
+                }
+            }
+        }
+
+        void bytes(uint64_t size, const void *&data);
+
+        void string(const char *&item);
+
+        void strings(uint32_t count, const char *const *&array);
+
+        void next(const void *&chain);
+
+        template<typename T>
+        void body(T &item) {
+            constexpr size_t offset = offsetof(T, pNext) + sizeof(void *);
+            uint32_t size = 0;
+            read(&size, sizeof(size));
+            const size_t copied = std::min<size_t>(size, sizeof(T) - offset);
+            read(reinterpret_cast<uint8_t *>(&item) + offset, copied);
+            skip(size - copied);
+        }
+
+        void layout(VkImageLayout &item);
+
+        void queueFamily(uint32_t &item);
+
+    private:
+        struct PendingOutput {
+            uint64_t traceHandle;
+
+            void *replayHandle;
+
+            size_t handleSize;
+        };
+
+        const uint8_t *begin = nullptr;
+
+        const uint8_t *end = nullptr;
+
+        /// Next record
+        const uint8_t *recordEnd = nullptr;
+
+        const uint8_t *cursor = nullptr;
+
+        bool failed = false;
+
+        uint32_t replayQueueFamily = 0;
+
+        /// Handle values of the trace to the replay's
+        std::unordered_map<uint64_t, uint64_t> handleMap{};
+
+        std::vector<PendingOutput> pendingOutputs{};
+
+        std::vector<std::unique_ptr<uint8_t[]>> allocations{};
+
+        uint32_t unknownHandleCount = 0;
+
+        void read(void *data, size_t size);
+
+        void skip(size_t size);
+
+        bool flag();
+
+        /// Rejects counts that cannot possibly be in the rest of the record
+        bool fits(uint32_t count);
+
+        uint64_t lookup(uint64_t traceHandle);
+    };
+
+    /* Parameters of the recorded calls, without the device and the allocation callbacks. Created
+     * handles are the last members. */
+
+    struct DeviceInfo {
+        uint32_t apiVersion;
+
+        char deviceName[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE];
+
+        uint32_t enabledExtensionCount;
+
+        const char *const *ppEnabledExtensionNames;
+
+        const VkPhysicalDeviceFeatures *pEnabledFeatures;
+
+        /// Feature structures of the device create info
+        const void *pNext;
+    };
+
+    struct FramesBegin {
+        uint32_t frameCount;
+    };
+
+    struct MemoryWrite {
+        VkDeviceMemory memory;
+
+        VkDeviceSize offset;
+
+        VkDeviceSize size;
+
+        const void *pData;
+    };
+
+    struct CreateBuffer {
+        const VkBufferCreateInfo *pCreateInfo;
+
+        VkBuffer buffer;
+    };
+
+    struct DestroyBuffer {
+        VkBuffer buffer;
+    };
+
+    struct AllocateMemory {
+        const VkMemoryAllocateInfo *pAllocateInfo;
+
+        /// Of the memory type, the index itself means nothing on another device
+        VkMemoryPropertyFlags propertyFlags;
+
+        VkDeviceMemory memory;
+    };
+
+    struct FreeMemory {
+        VkDeviceMemory memory;
+    };
+
+    struct BindBufferMemory {
+        VkBuffer buffer;
+
+        VkDeviceMemory memory;
+
+        VkDeviceSize memoryOffset;
+    };
+
+    struct CreateImage {
+        const VkImageCreateInfo *pCreateInfo;
+
+        VkImage image;
+    };
+
+    struct DestroyImage {
+        VkImage image;
+    };
+
+    struct BindImageMemory {
+        VkImage image;
+
+        VkDeviceMemory memory;
+
+        VkDeviceSize memoryOffset;
+    };
+
+    struct CreateImageView {
+        const VkImageViewCreateInfo *pCreateInfo;
+
+        VkImageView view;
+    };
+
+    struct DestroyImageView {
+        VkImageView imageView;
+    };
+
+    struct CreateShaderModule {
+        const VkShaderModuleCreateInfo *pCreateInfo;
+
+        VkShaderModule shaderModule;
+    };
+
+    struct DestroyShaderModule {
+        VkShaderModule shaderModule;
+    };
+
+    /// The initial data is not recorded, it only fits the capturing driver
+    struct CreatePipelineCache {
+        const VkPipelineCacheCreateInfo *pCreateInfo;
+
+        VkPipelineCache pipelineCache;
+    };
+
+    struct DestroyPipelineCache {
+        VkPipelineCache pipelineCache;
+    };
+
+    struct CreateDescriptorSetLayout {
+        const VkDescriptorSetLayoutCreateInfo *pCreateInfo;
+
+        VkDescriptorSetLayout setLayout;
+    };
+
+    struct DestroyDescriptorSetLayout {
+        VkDescriptorSetLayout descriptorSetLayout;
+    };
+
+    struct CreatePipelineLayout {
+        const VkPipelineLayoutCreateInfo *pCreateInfo;
+
+        VkPipelineLayout pipelineLayout;
+    };
+
+    struct DestroyPipelineLayout {
+        VkPipelineLayout pipelineLayout;
+    };
+
+    struct CreateSampler {
+        const VkSamplerCreateInfo *pCreateInfo;
+
+        VkSampler sampler;
+    };
+
+    struct DestroySampler {
+        VkSampler sampler;
+    };
+
+    struct CreateRenderPass {
+        const VkRenderPassCreateInfo *pCreateInfo;
+
+        VkRenderPass renderPass;
+    };
+
+    struct DestroyRenderPass {
+        VkRenderPass renderPass;
+    };
+
+    struct CreateFramebuffer {
+        const VkFramebufferCreateInfo *pCreateInfo;
+
+        VkFramebuffer framebuffer;
+    };
+
+    struct DestroyFramebuffer {
+        VkFramebuffer framebuffer;
+    };
+
+    struct CreateGraphicsPipelines {
+        VkPipelineCache pipelineCache;
+
+        uint32_t createInfoCount;
+
+        const VkGraphicsPipelineCreateInfo *pCreateInfos;
+
+        VkPipeline *pPipelines;
+    };
+
+    struct DestroyPipeline {
+        VkPipeline pipeline;
+    };
+
+    struct CreateDescriptorPool {
+        const VkDescriptorPoolCreateInfo *pCreateInfo;
+
+        VkDescriptorPool descriptorPool;
+    };
+
+    struct DestroyDescriptorPool {
+        VkDescriptorPool descriptorPool;
+    };
+
+    struct ResetDescriptorPool {
+        VkDescriptorPool descriptorPool;
+
+        VkDescriptorPoolResetFlags flags;
+    };
+
+    struct AllocateDescriptorSets {
+        const VkDescriptorSetAllocateInfo *pAllocateInfo;
+
+        VkDescriptorSet *pDescriptorSets;
+    };
+
+    struct UpdateDescriptorSets {
+        uint32_t descriptorWriteCount;
+
+        const VkWriteDescriptorSet *pDescriptorWrites;
+
+        uint32_t descriptorCopyCount;
+
+        const VkCopyDescriptorSet *pDescriptorCopies;
+    };
+
+    struct CreateDescriptorUpdateTemplate {
+        const VkDescriptorUpdateTemplateCreateInfo *pCreateInfo;
+
+        VkDescriptorUpdateTemplate descriptorUpdateTemplate;
+    };
+
+    struct DestroyDescriptorUpdateTemplate {
+        VkDescriptorUpdateTemplate descriptorUpdateTemplate;
+    };
+
+    /// One descriptor of a template update, only the member matching type is used
+    struct TemplateDescriptor {
+        VkDescriptorType type;
+
+        VkDescriptorImageInfo image;
+
+        VkDescriptorBufferInfo buffer;
+
+        VkBufferView texelBufferView;
+    };
+
+    /**
+     * @brief The raw template data holds handles at offsets of the capturing process, it is
+     * stored as the descriptors of the template entries in order and packed again on replay
+     */
+    struct UpdateDescriptorSetWithTemplate {
+        VkDescriptorSet descriptorSet;
+
+        VkDescriptorUpdateTemplate descriptorUpdateTemplate;
+
+        uint32_t descriptorCount;
+
+        const TemplateDescriptor *pDescriptors;
+    };
+
+    struct CreateCommandPool {
+        const VkCommandPoolCreateInfo *pCreateInfo;
+
+        VkCommandPool commandPool;
+    };
+
+    struct DestroyCommandPool {
+        VkCommandPool commandPool;
+    };
+
+    struct ResetCommandPool {
+        VkCommandPool commandPool;
+
+        VkCommandPoolResetFlags flags;
+    };
+
+    struct AllocateCommandBuffers {
+        const VkCommandBufferAllocateInfo *pAllocateInfo;
+
+        VkCommandBuffer *pCommandBuffers;
+    };
+
+    struct FreeCommandBuffers {
+        VkCommandPool commandPool;
+
+        uint32_t commandBufferCount;
+
+        const VkCommandBuffer *pCommandBuffers;
+    };
+
+    struct CreateFence {
+        const VkFenceCreateInfo *pCreateInfo;
+
+        VkFence fence;
+    };
+
+    struct DestroyFence {
+        VkFence fence;
+    };
+
+    struct ResetFences {
+        uint32_t fenceCount;
+
+        const VkFence *pFences;
+    };
+
+    struct WaitForFences {
+        uint32_t fenceCount;
+
+        const VkFence *pFences;
+
+        VkBool32 waitAll;
+
+        uint64_t timeout;
+    };
+
+    struct CreateSemaphore {
+        const VkSemaphoreCreateInfo *pCreateInfo;
+
+        VkSemaphore semaphore;
+    };
+
+    struct DestroySemaphore {
+        VkSemaphore semaphore;
+    };
+
+    /// The surface is not recorded, a replay renders to plain images
+    struct CreateSwapchainKHR {
+        const VkSwapchainCreateInfoKHR *pCreateInfo;
+
+        VkSwapchainKHR swapchain;
+    };
+
+    struct DestroySwapchainKHR {
+        VkSwapchainKHR swapchain;
+    };
+
+    struct GetSwapchainImagesKHR {
+        VkSwapchainKHR swapchain;
+
+        uint32_t swapchainImageCount;
+
+        VkImage *pSwapchainImages;
+    };
+
+    struct AcquireNextImageKHR {
+        VkSwapchainKHR swapchain;
+
+        uint64_t timeout;
+
+        VkSemaphore semaphore;
+
+        VkFence fence;
+
+        uint32_t imageIndex;
+    };
+
+    /// There is a single queue
+    struct QueueSubmit {
+        uint32_t submitCount;
+
+        const VkSubmitInfo *pSubmits;
+
+        VkFence fence;
+    };
+
+    struct QueuePresentKHR {
+        const VkPresentInfoKHR *pPresentInfo;
+    };
+
+    struct QueueWaitIdle {
+    };
+
+    struct DeviceWaitIdle {
+    };
+
+    struct BeginCommandBuffer {
+        VkCommandBuffer commandBuffer;
+
+        const VkCommandBufferBeginInfo *pBeginInfo;
+    };
+
+    struct EndCommandBuffer {
+        VkCommandBuffer commandBuffer;
+    };
+
+    struct CmdBindPipeline {
+        VkCommandBuffer commandBuffer;
+
+        VkPipelineBindPoint pipelineBindPoint;
+
+        VkPipeline pipeline;
+    };
+
+    struct CmdSetViewport {
+        VkCommandBuffer commandBuffer;
+
+        uint32_t firstViewport;
+
+        uint32_t viewportCount;
+
+        const VkViewport *pViewports;
+    };
+
+    struct CmdSetScissor {
+        VkCommandBuffer commandBuffer;
+
+        uint32_t firstScissor;
+
+        uint32_t scissorCount;
+
+        const VkRect2D *pScissors;
+    };
+
+    struct CmdBindDescriptorSets {
+        VkCommandBuffer commandBuffer;
+
+        VkPipelineBindPoint pipelineBindPoint;
+
+        VkPipelineLayout layout;
+
+        uint32_t firstSet;
+
+        uint32_t descriptorSetCount;
+
+        const VkDescriptorSet *pDescriptorSets;
+
+        uint32_t dynamicOffsetCount;
+
+        const uint32_t *pDynamicOffsets;
+    };
+
+    struct CmdBindVertexBuffers {
+        VkCommandBuffer commandBuffer;
+
+        uint32_t firstBinding;
+
+        uint32_t bindingCount;
+
+        const VkBuffer *pBuffers;
+
+        const VkDeviceSize *pOffsets;
+    };
+
+    struct CmdBindIndexBuffer {
+        VkCommandBuffer commandBuffer;
+
+        VkBuffer buffer;
+
+        VkDeviceSize offset;
+
+        VkIndexType indexType;
+    };
+
+    struct CmdDraw {
+        VkCommandBuffer commandBuffer;
+
+        uint32_t vertexCount;
+
+        uint32_t instanceCount;
+
+        uint32_t firstVertex;
+
+        uint32_t firstInstance;
+    };
+
+    struct CmdDrawIndexed {
+        VkCommandBuffer commandBuffer;
+
+        uint32_t indexCount;
+
+        uint32_t instanceCount;
+
+        uint32_t firstIndex;
+
+        int32_t vertexOffset;
+
+        uint32_t firstInstance;
+    };
+
+    struct CmdPushConstants {
+        VkCommandBuffer commandBuffer;
+
+        VkPipelineLayout layout;
+
+        VkShaderStageFlags stageFlags;
+
+        uint32_t offset;
+
+        uint32_t size;
+
+        const void *pValues;
+    };
+
+    struct CmdUpdateBuffer {
+        VkCommandBuffer commandBuffer;
+
+        VkBuffer dstBuffer;
+
+        VkDeviceSize dstOffset;
+
+        VkDeviceSize dataSize;
+
+        const void *pData;
+    };
+
+    struct CmdCopyBuffer {
+        VkCommandBuffer commandBuffer;
+
+        VkBuffer srcBuffer;
+
+        VkBuffer dstBuffer;
+
+        uint32_t regionCount;
+
+        const VkBufferCopy *pRegions;
+    };
+
+    struct CmdPipelineBarrier2KHR {
+        VkCommandBuffer commandBuffer;
+
+        const VkDependencyInfoKHR *pDependencyInfo;
+    };
+
+    struct CmdBeginRenderingKHR {
+        VkCommandBuffer commandBuffer;
+
+        const VkRenderingInfoKHR *pRenderingInfo;
+    };
+
+    struct CmdEndRenderingKHR {
+        VkCommandBuffer commandBuffer;
+    };
+
+    struct CmdBeginRenderPass {
+        VkCommandBuffer commandBuffer;
+
+        const VkRenderPassBeginInfo *pRenderPassBegin;
+
+        VkSubpassContents contents;
+    };
+
+    struct CmdEndRenderPass {
+        VkCommandBuffer commandBuffer;
+    };
+
+    template<typename Call>
+    constexpr Record recordOf = Record::Count;
+
+#define VK_TRACE_RECORD_OF(function, call) \
+    template<> constexpr Record recordOf<call> = Record::call;
+    VK_TRACE_RECORD_OF(, DeviceInfo)
+    VK_TRACE_RECORD_OF(, FramesBegin)
+    VK_TRACE_RECORD_OF(, MemoryWrite)
+    VK_TRACE_CALLS(VK_TRACE_RECORD_OF)
+#undef VK_TRACE_RECORD_OF
+
+    /// Flattens the raw data of a template update into its descriptors
+    std::vector<TemplateDescriptor>
+    unpackTemplateData(const std::vector<VkDescriptorUpdateTemplateEntry> &entries,
+                       const void *data);
+
+    /// Lays out descriptors in the raw data the template reads
+    std::vector<uint8_t>
+    packTemplateData(const std::vector<VkDescriptorUpdateTemplateEntry> &entries,
+                     const TemplateDescriptor *descriptors, uint32_t descriptorCount);
+
+    /* Structures */
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPhysicalDeviceFeatures2 &item) {
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPhysicalDeviceSynchronization2FeaturesKHR &item) {
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPhysicalDeviceDynamicRenderingFeaturesKHR &item) {
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT &item) {
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPhysicalDeviceDescriptorIndexingFeaturesEXT &item) {
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorSetLayoutBindingFlagsCreateInfoEXT &item) {
+        archive.value(item.bindingCount);
+        archive.items(item.bindingCount, item.pBindingFlags);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorSetVariableDescriptorCountAllocateInfoEXT &item) {
+        archive.value(item.descriptorSetCount);
+        archive.items(item.descriptorSetCount, item.pDescriptorCounts);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineRenderingCreateInfoKHR &item) {
+        archive.value(item.viewMask);
+        archive.value(item.colorAttachmentCount);
+        archive.items(item.colorAttachmentCount, item.pColorAttachmentFormats);
+        archive.value(item.depthAttachmentFormat);
+        archive.value(item.stencilAttachmentFormat);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkGraphicsPipelineLibraryCreateInfoEXT &item) {
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineLibraryCreateInfoKHR &item) {
+        archive.value(item.libraryCount);
+        archive.handles(item.libraryCount, item.pLibraries);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkBufferCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.size);
+        archive.value(item.usage);
+        archive.value(item.sharingMode);
+        archive.value(item.queueFamilyIndexCount);
+        archive.items(item.queueFamilyIndexCount, item.pQueueFamilyIndices);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkMemoryAllocateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.allocationSize);
+        archive.value(item.memoryTypeIndex);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkImageCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.imageType);
+        archive.value(item.format);
+        archive.value(item.extent);
+        archive.value(item.mipLevels);
+        archive.value(item.arrayLayers);
+        archive.value(item.samples);
+        archive.value(item.tiling);
+        archive.value(item.usage);
+        archive.value(item.sharingMode);
+        archive.value(item.queueFamilyIndexCount);
+        archive.items(item.queueFamilyIndexCount, item.pQueueFamilyIndices);
+        archive.layout(item.initialLayout);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkImageViewCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.handle(item.image);
+        archive.value(item.viewType);
+        archive.value(item.format);
+        archive.value(item.components);
+        archive.value(item.subresourceRange);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkShaderModuleCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.size(item.codeSize);
+        const void *code = item.pCode;
+        archive.bytes(item.codeSize, code);
+        item.pCode = static_cast<const uint32_t *>(code);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineCacheCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        if constexpr (Archive::kReading) {
+            item.initialDataSize = 0;
+            item.pInitialData = nullptr;
+        }
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorSetLayoutBinding &item) {
+        archive.value(item.binding);
+        archive.value(item.descriptorType);
+        archive.value(item.descriptorCount);
+        archive.value(item.stageFlags);
+        // Ignored and possibly dangling for the other descriptor types
+        const bool samplers = item.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                              item.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        if (samplers) {
+            archive.handles(item.descriptorCount, item.pImmutableSamplers);
+        } else if constexpr (Archive::kReading) {
+            item.pImmutableSamplers = nullptr;
+        }
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorSetLayoutCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.bindingCount);
+        archive.items(item.bindingCount, item.pBindings);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineLayoutCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.setLayoutCount);
+        archive.handles(item.setLayoutCount, item.pSetLayouts);
+        archive.value(item.pushConstantRangeCount);
+        archive.items(item.pushConstantRangeCount, item.pPushConstantRanges);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkSamplerCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkAttachmentDescription &item) {
+        archive.value(item.flags);
+        archive.value(item.format);
+        archive.value(item.samples);
+        archive.value(item.loadOp);
+        archive.value(item.storeOp);
+        archive.value(item.stencilLoadOp);
+        archive.value(item.stencilStoreOp);
+        archive.layout(item.initialLayout);
+        archive.layout(item.finalLayout);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkAttachmentReference &item) {
+        archive.value(item.attachment);
+        archive.layout(item.layout);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkSubpassDescription &item) {
+        archive.value(item.flags);
+        archive.value(item.pipelineBindPoint);
+        archive.value(item.inputAttachmentCount);
+        archive.items(item.inputAttachmentCount, item.pInputAttachments);
+        archive.value(item.colorAttachmentCount);
+        archive.items(item.colorAttachmentCount, item.pColorAttachments);
+        archive.items(item.colorAttachmentCount, item.pResolveAttachments);
+        archive.object(item.pDepthStencilAttachment);
+        archive.value(item.preserveAttachmentCount);
+        archive.items(item.preserveAttachmentCount, item.pPreserveAttachments);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkRenderPassCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.attachmentCount);
+        archive.items(item.attachmentCount, item.pAttachments);
+        archive.value(item.subpassCount);
+        archive.items(item.subpassCount, item.pSubpasses);
+        archive.value(item.dependencyCount);
+        archive.items(item.dependencyCount, item.pDependencies);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkFramebufferCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.handle(item.renderPass);
+        archive.value(item.attachmentCount);
+        archive.handles(item.attachmentCount, item.pAttachments);
+        archive.value(item.width);
+        archive.value(item.height);
+        archive.value(item.layers);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkSpecializationMapEntry &item) {
+        archive.value(item.constantID);
+        archive.value(item.offset);
+        archive.size(item.size);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkSpecializationInfo &item) {
+        archive.value(item.mapEntryCount);
+        archive.items(item.mapEntryCount, item.pMapEntries);
+        archive.size(item.dataSize);
+        archive.bytes(item.dataSize, item.pData);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineShaderStageCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.stage);
+        archive.handle(item.module);
+        archive.string(item.pName);
+        archive.object(item.pSpecializationInfo);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineVertexInputStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.vertexBindingDescriptionCount);
+        archive.items(item.vertexBindingDescriptionCount, item.pVertexBindingDescriptions);
+        archive.value(item.vertexAttributeDescriptionCount);
+        archive.items(item.vertexAttributeDescriptionCount, item.pVertexAttributeDescriptions);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineInputAssemblyStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineTessellationStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineViewportStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.viewportCount);
+        archive.items(item.viewportCount, item.pViewports);
+        archive.value(item.scissorCount);
+        archive.items(item.scissorCount, item.pScissors);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineRasterizationStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineMultisampleStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.rasterizationSamples);
+        archive.value(item.sampleShadingEnable);
+        archive.value(item.minSampleShading);
+        archive.items((item.rasterizationSamples + 31) / 32, item.pSampleMask);
+        archive.value(item.alphaToCoverageEnable);
+        archive.value(item.alphaToOneEnable);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineDepthStencilStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineColorBlendStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.logicOpEnable);
+        archive.value(item.logicOp);
+        archive.value(item.attachmentCount);
+        archive.items(item.attachmentCount, item.pAttachments);
+        archive.value(item.blendConstants);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPipelineDynamicStateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.dynamicStateCount);
+        archive.items(item.dynamicStateCount, item.pDynamicStates);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkGraphicsPipelineCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.stageCount);
+        archive.items(item.stageCount, item.pStages);
+        archive.object(item.pVertexInputState);
+        archive.object(item.pInputAssemblyState);
+        archive.object(item.pTessellationState);
+        archive.object(item.pViewportState);
+        archive.object(item.pRasterizationState);
+        archive.object(item.pMultisampleState);
+        archive.object(item.pDepthStencilState);
+        archive.object(item.pColorBlendState);
+        archive.object(item.pDynamicState);
+        archive.handle(item.layout);
+        archive.handle(item.renderPass);
+        archive.value(item.subpass);
+        archive.handle(item.basePipelineHandle);
+        archive.value(item.basePipelineIndex);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorPoolCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.maxSets);
+        archive.value(item.poolSizeCount);
+        archive.items(item.poolSizeCount, item.pPoolSizes);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorSetAllocateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.handle(item.descriptorPool);
+        archive.value(item.descriptorSetCount);
+        archive.handles(item.descriptorSetCount, item.pSetLayouts);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorImageInfo &item) {
+        archive.handle(item.sampler);
+        archive.handle(item.imageView);
+        archive.layout(item.imageLayout);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorBufferInfo &item) {
+        archive.handle(item.buffer);
+        archive.value(item.offset);
+        archive.value(item.range);
+    }
+
+    enum class DescriptorKind {
+        Image,
+        Buffer,
+        TexelBuffer,
+        /// Not supported by traces
+        Other
+    };
+
+    DescriptorKind getDescriptorKind(VkDescriptorType type);
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkWriteDescriptorSet &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.handle(item.dstSet);
+        archive.value(item.dstBinding);
+        archive.value(item.dstArrayElement);
+        archive.value(item.descriptorCount);
+        archive.value(item.descriptorType);
+        // Only the array matching the type is valid, the others may dangle
+        switch (getDescriptorKind(item.descriptorType)) {
+            case DescriptorKind::Image:
+                archive.items(item.descriptorCount, item.pImageInfo);
+                break;
+            case DescriptorKind::Buffer:
+                archive.items(item.descriptorCount, item.pBufferInfo);
+                break;
+            case DescriptorKind::TexelBuffer:
+                archive.handles(item.descriptorCount, item.pTexelBufferView);
+                break;
+            case DescriptorKind::Other:
+                break;
+        }
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkCopyDescriptorSet &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.handle(item.srcSet);
+        archive.value(item.srcBinding);
+        archive.value(item.srcArrayElement);
+        archive.handle(item.dstSet);
+        archive.value(item.dstBinding);
+        archive.value(item.dstArrayElement);
+        archive.value(item.descriptorCount);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorUpdateTemplateEntry &item) {
+        archive.value(item.dstBinding);
+        archive.value(item.dstArrayElement);
+        archive.value(item.descriptorCount);
+        archive.value(item.descriptorType);
+        archive.size(item.offset);
+        archive.size(item.stride);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDescriptorUpdateTemplateCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.descriptorUpdateEntryCount);
+        archive.items(item.descriptorUpdateEntryCount, item.pDescriptorUpdateEntries);
+        archive.value(item.templateType);
+        archive.handle(item.descriptorSetLayout);
+        archive.value(item.pipelineBindPoint);
+        archive.handle(item.pipelineLayout);
+        archive.value(item.set);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, TemplateDescriptor &item) {
+        archive.value(item.type);
+        switch (getDescriptorKind(item.type)) {
+            case DescriptorKind::Image:
+                serialize(archive, item.image);
+                break;
+            case DescriptorKind::Buffer:
+                serialize(archive, item.buffer);
+                break;
+            case DescriptorKind::TexelBuffer:
+                archive.handle(item.texelBufferView);
+                break;
+            case DescriptorKind::Other:
+                break;
+        }
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkCommandPoolCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.queueFamily(item.queueFamilyIndex);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkCommandBufferAllocateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.handle(item.commandPool);
+        archive.value(item.level);
+        archive.value(item.commandBufferCount);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkFenceCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkSemaphoreCreateInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkSwapchainCreateInfoKHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.minImageCount);
+        archive.value(item.imageFormat);
+        archive.value(item.imageColorSpace);
+        archive.value(item.imageExtent);
+        archive.value(item.imageArrayLayers);
+        archive.value(item.imageUsage);
+        archive.value(item.imageSharingMode);
+        archive.value(item.queueFamilyIndexCount);
+        archive.items(item.queueFamilyIndexCount, item.pQueueFamilyIndices);
+        archive.value(item.preTransform);
+        archive.value(item.compositeAlpha);
+        archive.value(item.presentMode);
+        archive.value(item.clipped);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkSubmitInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.waitSemaphoreCount);
+        archive.handles(item.waitSemaphoreCount, item.pWaitSemaphores);
+        archive.items(item.waitSemaphoreCount, item.pWaitDstStageMask);
+        archive.value(item.commandBufferCount);
+        archive.handles(item.commandBufferCount, item.pCommandBuffers);
+        archive.value(item.signalSemaphoreCount);
+        archive.handles(item.signalSemaphoreCount, item.pSignalSemaphores);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkPresentInfoKHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.waitSemaphoreCount);
+        archive.handles(item.waitSemaphoreCount, item.pWaitSemaphores);
+        archive.value(item.swapchainCount);
+        archive.handles(item.swapchainCount, item.pSwapchains);
+        archive.items(item.swapchainCount, item.pImageIndices);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkCommandBufferInheritanceInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.handle(item.renderPass);
+        archive.value(item.subpass);
+        archive.handle(item.framebuffer);
+        archive.value(item.occlusionQueryEnable);
+        archive.value(item.queryFlags);
+        archive.value(item.pipelineStatistics);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkCommandBufferBeginInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.object(item.pInheritanceInfo);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkMemoryBarrier2KHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.body(item);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkBufferMemoryBarrier2KHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.srcStageMask);
+        archive.value(item.srcAccessMask);
+        archive.value(item.dstStageMask);
+        archive.value(item.dstAccessMask);
+        archive.value(item.srcQueueFamilyIndex);
+        archive.value(item.dstQueueFamilyIndex);
+        archive.handle(item.buffer);
+        archive.value(item.offset);
+        archive.value(item.size);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkImageMemoryBarrier2KHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.srcStageMask);
+        archive.value(item.srcAccessMask);
+        archive.value(item.dstStageMask);
+        archive.value(item.dstAccessMask);
+        archive.layout(item.oldLayout);
+        archive.layout(item.newLayout);
+        archive.value(item.srcQueueFamilyIndex);
+        archive.value(item.dstQueueFamilyIndex);
+        archive.handle(item.image);
+        archive.value(item.subresourceRange);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkDependencyInfoKHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.dependencyFlags);
+        archive.value(item.memoryBarrierCount);
+        archive.items(item.memoryBarrierCount, item.pMemoryBarriers);
+        archive.value(item.bufferMemoryBarrierCount);
+        archive.items(item.bufferMemoryBarrierCount, item.pBufferMemoryBarriers);
+        archive.value(item.imageMemoryBarrierCount);
+        archive.items(item.imageMemoryBarrierCount, item.pImageMemoryBarriers);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkRenderingAttachmentInfoKHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.handle(item.imageView);
+        archive.layout(item.imageLayout);
+        archive.value(item.resolveMode);
+        archive.handle(item.resolveImageView);
+        archive.layout(item.resolveImageLayout);
+        archive.value(item.loadOp);
+        archive.value(item.storeOp);
+        archive.value(item.clearValue);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkRenderingInfoKHR &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.value(item.flags);
+        archive.value(item.renderArea);
+        archive.value(item.layerCount);
+        archive.value(item.viewMask);
+        archive.value(item.colorAttachmentCount);
+        archive.items(item.colorAttachmentCount, item.pColorAttachments);
+        archive.object(item.pDepthAttachment);
+        archive.object(item.pStencilAttachment);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, VkRenderPassBeginInfo &item) {
+        archive.value(item.sType);
+        archive.next(item.pNext);
+        archive.handle(item.renderPass);
+        archive.handle(item.framebuffer);
+        archive.value(item.renderArea);
+        archive.value(item.clearValueCount);
+        archive.items(item.clearValueCount, item.pClearValues);
+    }
+
+    /* Records */
+
+    template<typename Archive>
+    void serialize(Archive &archive, DeviceInfo &item) {
+        archive.value(item.apiVersion);
+        archive.value(item.deviceName);
+        archive.value(item.enabledExtensionCount);
+        archive.strings(item.enabledExtensionCount, item.ppEnabledExtensionNames);
+        archive.object(item.pEnabledFeatures);
+        archive.next(item.pNext);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, FramesBegin &item) {
+        archive.value(item.frameCount);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, MemoryWrite &item) {
+        archive.handle(item.memory);
+        archive.value(item.offset);
+        archive.value(item.size);
+        archive.bytes(item.size, item.pData);
+    }
+
+    /// Calls creating one object from a create info
+#define VK_TRACE_CREATE_CALL(call, info, created) \
+    template<typename Archive> \
+    void serialize(Archive &archive, call &item) { \
+        archive.object(item.info); \
+        archive.output(item.created); \
+    }
+    VK_TRACE_CREATE_CALL(CreateBuffer, pCreateInfo, buffer)
+    VK_TRACE_CREATE_CALL(CreateImage, pCreateInfo, image)
+    VK_TRACE_CREATE_CALL(CreateImageView, pCreateInfo, view)
+    VK_TRACE_CREATE_CALL(CreateShaderModule, pCreateInfo, shaderModule)
+    VK_TRACE_CREATE_CALL(CreatePipelineCache, pCreateInfo, pipelineCache)
+    VK_TRACE_CREATE_CALL(CreateDescriptorSetLayout, pCreateInfo, setLayout)
+    VK_TRACE_CREATE_CALL(CreatePipelineLayout, pCreateInfo, pipelineLayout)
+    VK_TRACE_CREATE_CALL(CreateSampler, pCreateInfo, sampler)
+    VK_TRACE_CREATE_CALL(CreateRenderPass, pCreateInfo, renderPass)
+    VK_TRACE_CREATE_CALL(CreateFramebuffer, pCreateInfo, framebuffer)
+    VK_TRACE_CREATE_CALL(CreateDescriptorPool, pCreateInfo, descriptorPool)
+    VK_TRACE_CREATE_CALL(CreateDescriptorUpdateTemplate, pCreateInfo, descriptorUpdateTemplate)
+    VK_TRACE_CREATE_CALL(CreateCommandPool, pCreateInfo, commandPool)
+    VK_TRACE_CREATE_CALL(CreateFence, pCreateInfo, fence)
+    VK_TRACE_CREATE_CALL(CreateSemaphore, pCreateInfo, semaphore)
+    VK_TRACE_CREATE_CALL(CreateSwapchainKHR, pCreateInfo, swapchain)
+#undef VK_TRACE_CREATE_CALL
+
+    /// Calls taking a single handle
+#define VK_TRACE_HANDLE_CALL(call, member) \
+    template<typename Archive> \
+    void serialize(Archive &archive, call &item) { \
+        archive.handle(item.member); \
+    }
+    VK_TRACE_HANDLE_CALL(DestroyBuffer, buffer)
+    VK_TRACE_HANDLE_CALL(FreeMemory, memory)
+    VK_TRACE_HANDLE_CALL(DestroyImage, image)
+    VK_TRACE_HANDLE_CALL(DestroyImageView, imageView)
+    VK_TRACE_HANDLE_CALL(DestroyShaderModule, shaderModule)
+    VK_TRACE_HANDLE_CALL(DestroyPipelineCache, pipelineCache)
+    VK_TRACE_HANDLE_CALL(DestroyDescriptorSetLayout, descriptorSetLayout)
+    VK_TRACE_HANDLE_CALL(DestroyPipelineLayout, pipelineLayout)
+    VK_TRACE_HANDLE_CALL(DestroySampler, sampler)
+    VK_TRACE_HANDLE_CALL(DestroyRenderPass, renderPass)
+    VK_TRACE_HANDLE_CALL(DestroyFramebuffer, framebuffer)
+    VK_TRACE_HANDLE_CALL(DestroyPipeline, pipeline)
+    VK_TRACE_HANDLE_CALL(DestroyDescriptorPool, descriptorPool)
+    VK_TRACE_HANDLE_CALL(DestroyDescriptorUpdateTemplate, descriptorUpdateTemplate)
+    VK_TRACE_HANDLE_CALL(DestroyCommandPool, commandPool)
+    VK_TRACE_HANDLE_CALL(DestroyFence, fence)
+    VK_TRACE_HANDLE_CALL(DestroySemaphore, semaphore)
+    VK_TRACE_HANDLE_CALL(DestroySwapchainKHR, swapchain)
+    VK_TRACE_HANDLE_CALL(EndCommandBuffer, commandBuffer)
+    VK_TRACE_HANDLE_CALL(CmdEndRenderingKHR, commandBuffer)
+    VK_TRACE_HANDLE_CALL(CmdEndRenderPass, commandBuffer)
+#undef VK_TRACE_HANDLE_CALL
+
+    template<typename Archive>
+    void serialize(Archive &archive, AllocateMemory &item) {
+        archive.object(item.pAllocateInfo);
+        archive.value(item.propertyFlags);
+        archive.output(item.memory);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, BindBufferMemory &item) {
+        archive.handle(item.buffer);
+        archive.handle(item.memory);
+        archive.value(item.memoryOffset);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, BindImageMemory &item) {
+        archive.handle(item.image);
+        archive.handle(item.memory);
+        archive.value(item.memoryOffset);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CreateGraphicsPipelines &item) {
+        archive.handle(item.pipelineCache);
+        archive.value(item.createInfoCount);
+        archive.items(item.createInfoCount, item.pCreateInfos);
+        archive.outputs(item.createInfoCount, item.pPipelines);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, ResetDescriptorPool &item) {
+        archive.handle(item.descriptorPool);
+        archive.value(item.flags);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, AllocateDescriptorSets &item) {
+        archive.object(item.pAllocateInfo);
+        const uint32_t count = item.pAllocateInfo != nullptr
+                               ? item.pAllocateInfo->descriptorSetCount : 0;
+        archive.outputs(count, item.pDescriptorSets);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, UpdateDescriptorSets &item) {
+        archive.value(item.descriptorWriteCount);
+        archive.items(item.descriptorWriteCount, item.pDescriptorWrites);
+        archive.value(item.descriptorCopyCount);
+        archive.items(item.descriptorCopyCount, item.pDescriptorCopies);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, UpdateDescriptorSetWithTemplate &item) {
+        archive.handle(item.descriptorSet);
+        archive.handle(item.descriptorUpdateTemplate);
+        archive.value(item.descriptorCount);
+        archive.items(item.descriptorCount, item.pDescriptors);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, ResetCommandPool &item) {
+        archive.handle(item.commandPool);
+        archive.value(item.flags);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, AllocateCommandBuffers &item) {
+        archive.object(item.pAllocateInfo);
+        const uint32_t count = item.pAllocateInfo != nullptr
+                               ? item.pAllocateInfo->commandBufferCount : 0;
+        archive.outputs(count, item.pCommandBuffers);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, FreeCommandBuffers &item) {
+        archive.handle(item.commandPool);
+        archive.value(item.commandBufferCount);
+        archive.handles(item.commandBufferCount, item.pCommandBuffers);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, ResetFences &item) {
+        archive.value(item.fenceCount);
+        archive.handles(item.fenceCount, item.pFences);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, WaitForFences &item) {
+        archive.value(item.fenceCount);
+        archive.handles(item.fenceCount, item.pFences);
+        archive.value(item.waitAll);
+        archive.value(item.timeout);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, GetSwapchainImagesKHR &item) {
+        archive.handle(item.swapchain);
+        archive.value(item.swapchainImageCount);
+        archive.outputs(item.swapchainImageCount, item.pSwapchainImages);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, AcquireNextImageKHR &item) {
+        archive.handle(item.swapchain);
+        archive.value(item.timeout);
+        archive.handle(item.semaphore);
+        archive.handle(item.fence);
+        archive.value(item.imageIndex);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, QueueSubmit &item) {
+        archive.value(item.submitCount);
+        archive.items(item.submitCount, item.pSubmits);
+        archive.handle(item.fence);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, QueuePresentKHR &item) {
+        archive.object(item.pPresentInfo);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &, QueueWaitIdle &) {
+    }
+
+    template<typename Archive>
+    void serialize(Archive &, DeviceWaitIdle &) {
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, BeginCommandBuffer &item) {
+        archive.handle(item.commandBuffer);
+        archive.object(item.pBeginInfo);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdBindPipeline &item) {
+        archive.handle(item.commandBuffer);
+        archive.value(item.pipelineBindPoint);
+        archive.handle(item.pipeline);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdSetViewport &item) {
+        archive.handle(item.commandBuffer);
+        archive.value(item.firstViewport);
+        archive.value(item.viewportCount);
+        archive.items(item.viewportCount, item.pViewports);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdSetScissor &item) {
+        archive.handle(item.commandBuffer);
+        archive.value(item.firstScissor);
+        archive.value(item.scissorCount);
+        archive.items(item.scissorCount, item.pScissors);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdBindDescriptorSets &item) {
+        archive.handle(item.commandBuffer);
+        archive.value(item.pipelineBindPoint);
+        archive.handle(item.layout);
+        archive.value(item.firstSet);
+        archive.value(item.descriptorSetCount);
+        archive.handles(item.descriptorSetCount, item.pDescriptorSets);
+        archive.value(item.dynamicOffsetCount);
+        archive.items(item.dynamicOffsetCount, item.pDynamicOffsets);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdBindVertexBuffers &item) {
+        archive.handle(item.commandBuffer);
+        archive.value(item.firstBinding);
+        archive.value(item.bindingCount);
+        archive.handles(item.bindingCount, item.pBuffers);
+        archive.items(item.bindingCount, item.pOffsets);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdBindIndexBuffer &item) {
+        archive.handle(item.commandBuffer);
+        archive.handle(item.buffer);
+        archive.value(item.offset);
+        archive.value(item.indexType);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdDraw &item) {
+        archive.handle(item.commandBuffer);
+        archive.value(item.vertexCount);
+        archive.value(item.instanceCount);
+        archive.value(item.firstVertex);
+        archive.value(item.firstInstance);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdDrawIndexed &item) {
+        archive.handle(item.commandBuffer);
+        archive.value(item.indexCount);
+        archive.value(item.instanceCount);
+        archive.value(item.firstIndex);
+        archive.value(item.vertexOffset);
+        archive.value(item.firstInstance);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdPushConstants &item) {
+        archive.handle(item.commandBuffer);
+        archive.handle(item.layout);
+        archive.value(item.stageFlags);
+        archive.value(item.offset);
+        archive.value(item.size);
+        archive.bytes(item.size, item.pValues);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdUpdateBuffer &item) {
+        archive.handle(item.commandBuffer);
+        archive.handle(item.dstBuffer);
+        archive.value(item.dstOffset);
+        archive.value(item.dataSize);
+        archive.bytes(item.dataSize, item.pData);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdCopyBuffer &item) {
+        archive.handle(item.commandBuffer);
+        archive.handle(item.srcBuffer);
+        archive.handle(item.dstBuffer);
+        archive.value(item.regionCount);
+        archive.items(item.regionCount, item.pRegions);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdPipelineBarrier2KHR &item) {
+        archive.handle(item.commandBuffer);
+        archive.object(item.pDependencyInfo);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdBeginRenderingKHR &item) {
+        archive.handle(item.commandBuffer);
+        archive.object(item.pRenderingInfo);
+    }
+
+    template<typename Archive>
+    void serialize(Archive &archive, CmdBeginRenderPass &item) {
+        archive.handle(item.commandBuffer);
+        archive.object(item.pRenderPassBegin);
+        archive.value(item.contents);
+    }
+}
+
+#endif //LEARNINGVULKAN_VULKANTRACE_HH
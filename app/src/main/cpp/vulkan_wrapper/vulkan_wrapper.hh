@@ -12,224 +12,357 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// This file is generated.
 #ifndef VULKAN_WRAPPER_H
 #define VULKAN_WRAPPER_H
 
 #define VK_NO_PROTOTYPES 1
 #include <vulkan/vulkan.h>
-/* Initialize the Vulkan function pointer variables declared in this header.
- * Returns 0 if vulkan is not available, non-zero if it is available.
+
+/* Entry points are listed per level and per core version or extension. InitVulkan only resolves
+ * the global level. Once the instance or device exists, the extension entry points it was created
+ * with are resolved, and those of its core version point at a trampoline that resolves them on
+ * their first call. Everything else points at a stub that names the entry point and aborts, see
+ * IsVulkanEntryPointAvailable.
  */
-int InitVulkan(void);
+#define VK_GLOBAL_FUNCTIONS(X) \
+    X(vkCreateInstance) \
+    X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties)
 
-// VK_core
-extern PFN_vkCreateInstance vkCreateInstance;
-extern PFN_vkDestroyInstance vkDestroyInstance;
-extern PFN_vkEnumeratePhysicalDevices vkEnumeratePhysicalDevices;
-extern PFN_vkGetPhysicalDeviceFeatures vkGetPhysicalDeviceFeatures;
-extern PFN_vkGetPhysicalDeviceFormatProperties vkGetPhysicalDeviceFormatProperties;
-extern PFN_vkGetPhysicalDeviceImageFormatProperties vkGetPhysicalDeviceImageFormatProperties;
-extern PFN_vkGetPhysicalDeviceProperties vkGetPhysicalDeviceProperties;
-extern PFN_vkGetPhysicalDeviceQueueFamilyProperties vkGetPhysicalDeviceQueueFamilyProperties;
-extern PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties;
-extern PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
-extern PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr;
-extern PFN_vkCreateDevice vkCreateDevice;
-extern PFN_vkDestroyDevice vkDestroyDevice;
-extern PFN_vkEnumerateInstanceExtensionProperties vkEnumerateInstanceExtensionProperties;
-extern PFN_vkEnumerateDeviceExtensionProperties vkEnumerateDeviceExtensionProperties;
-extern PFN_vkEnumerateInstanceLayerProperties vkEnumerateInstanceLayerProperties;
-extern PFN_vkEnumerateDeviceLayerProperties vkEnumerateDeviceLayerProperties;
-extern PFN_vkGetDeviceQueue vkGetDeviceQueue;
-extern PFN_vkQueueSubmit vkQueueSubmit;
-extern PFN_vkQueueWaitIdle vkQueueWaitIdle;
-extern PFN_vkDeviceWaitIdle vkDeviceWaitIdle;
-extern PFN_vkAllocateMemory vkAllocateMemory;
-extern PFN_vkFreeMemory vkFreeMemory;
-extern PFN_vkMapMemory vkMapMemory;
-extern PFN_vkUnmapMemory vkUnmapMemory;
-extern PFN_vkFlushMappedMemoryRanges vkFlushMappedMemoryRanges;
-extern PFN_vkInvalidateMappedMemoryRanges vkInvalidateMappedMemoryRanges;
-extern PFN_vkGetDeviceMemoryCommitment vkGetDeviceMemoryCommitment;
-extern PFN_vkBindBufferMemory vkBindBufferMemory;
-extern PFN_vkBindImageMemory vkBindImageMemory;
-extern PFN_vkGetBufferMemoryRequirements vkGetBufferMemoryRequirements;
-extern PFN_vkGetImageMemoryRequirements vkGetImageMemoryRequirements;
-extern PFN_vkGetImageSparseMemoryRequirements vkGetImageSparseMemoryRequirements;
-extern PFN_vkGetPhysicalDeviceSparseImageFormatProperties vkGetPhysicalDeviceSparseImageFormatProperties;
-extern PFN_vkQueueBindSparse vkQueueBindSparse;
-extern PFN_vkCreateFence vkCreateFence;
-extern PFN_vkDestroyFence vkDestroyFence;
-extern PFN_vkResetFences vkResetFences;
-extern PFN_vkGetFenceStatus vkGetFenceStatus;
-extern PFN_vkWaitForFences vkWaitForFences;
-extern PFN_vkCreateSemaphore vkCreateSemaphore;
-extern PFN_vkDestroySemaphore vkDestroySemaphore;
-extern PFN_vkCreateEvent vkCreateEvent;
-extern PFN_vkDestroyEvent vkDestroyEvent;
-extern PFN_vkGetEventStatus vkGetEventStatus;
-extern PFN_vkSetEvent vkSetEvent;
-extern PFN_vkResetEvent vkResetEvent;
-extern PFN_vkCreateQueryPool vkCreateQueryPool;
-extern PFN_vkDestroyQueryPool vkDestroyQueryPool;
-extern PFN_vkGetQueryPoolResults vkGetQueryPoolResults;
-extern PFN_vkCreateBuffer vkCreateBuffer;
-extern PFN_vkDestroyBuffer vkDestroyBuffer;
-extern PFN_vkCreateBufferView vkCreateBufferView;
-extern PFN_vkDestroyBufferView vkDestroyBufferView;
-extern PFN_vkCreateImage vkCreateImage;
-extern PFN_vkDestroyImage vkDestroyImage;
-extern PFN_vkGetImageSubresourceLayout vkGetImageSubresourceLayout;
-extern PFN_vkCreateImageView vkCreateImageView;
-extern PFN_vkDestroyImageView vkDestroyImageView;
-extern PFN_vkCreateShaderModule vkCreateShaderModule;
-extern PFN_vkDestroyShaderModule vkDestroyShaderModule;
-extern PFN_vkCreatePipelineCache vkCreatePipelineCache;
-extern PFN_vkDestroyPipelineCache vkDestroyPipelineCache;
-extern PFN_vkGetPipelineCacheData vkGetPipelineCacheData;
-extern PFN_vkMergePipelineCaches vkMergePipelineCaches;
-extern PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines;
-extern PFN_vkCreateComputePipelines vkCreateComputePipelines;
-extern PFN_vkDestroyPipeline vkDestroyPipeline;
-extern PFN_vkCreatePipelineLayout vkCreatePipelineLayout;
-extern PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout;
-extern PFN_vkCreateSampler vkCreateSampler;
-extern PFN_vkDestroySampler vkDestroySampler;
-extern PFN_vkCreateDescriptorSetLayout vkCreateDescriptorSetLayout;
-extern PFN_vkDestroyDescriptorSetLayout vkDestroyDescriptorSetLayout;
-extern PFN_vkCreateDescriptorPool vkCreateDescriptorPool;
-extern PFN_vkDestroyDescriptorPool vkDestroyDescriptorPool;
-extern PFN_vkResetDescriptorPool vkResetDescriptorPool;
-extern PFN_vkAllocateDescriptorSets vkAllocateDescriptorSets;
-extern PFN_vkFreeDescriptorSets vkFreeDescriptorSets;
-extern PFN_vkUpdateDescriptorSets vkUpdateDescriptorSets;
-extern PFN_vkCreateFramebuffer vkCreateFramebuffer;
-extern PFN_vkDestroyFramebuffer vkDestroyFramebuffer;
-extern PFN_vkCreateRenderPass vkCreateRenderPass;
-extern PFN_vkDestroyRenderPass vkDestroyRenderPass;
-extern PFN_vkGetRenderAreaGranularity vkGetRenderAreaGranularity;
-extern PFN_vkCreateCommandPool vkCreateCommandPool;
-extern PFN_vkDestroyCommandPool vkDestroyCommandPool;
-extern PFN_vkResetCommandPool vkResetCommandPool;
-extern PFN_vkAllocateCommandBuffers vkAllocateCommandBuffers;
-extern PFN_vkFreeCommandBuffers vkFreeCommandBuffers;
-extern PFN_vkBeginCommandBuffer vkBeginCommandBuffer;
-extern PFN_vkEndCommandBuffer vkEndCommandBuffer;
-extern PFN_vkResetCommandBuffer vkResetCommandBuffer;
-extern PFN_vkCmdBindPipeline vkCmdBindPipeline;
-extern PFN_vkCmdSetViewport vkCmdSetViewport;
-extern PFN_vkCmdSetScissor vkCmdSetScissor;
-extern PFN_vkCmdSetLineWidth vkCmdSetLineWidth;
-extern PFN_vkCmdSetDepthBias vkCmdSetDepthBias;
-extern PFN_vkCmdSetBlendConstants vkCmdSetBlendConstants;
-extern PFN_vkCmdSetDepthBounds vkCmdSetDepthBounds;
-extern PFN_vkCmdSetStencilCompareMask vkCmdSetStencilCompareMask;
-extern PFN_vkCmdSetStencilWriteMask vkCmdSetStencilWriteMask;
-extern PFN_vkCmdSetStencilReference vkCmdSetStencilReference;
-extern PFN_vkCmdBindDescriptorSets vkCmdBindDescriptorSets;
-extern PFN_vkCmdBindIndexBuffer vkCmdBindIndexBuffer;
-extern PFN_vkCmdBindVertexBuffers vkCmdBindVertexBuffers;
-extern PFN_vkCmdDraw vkCmdDraw;
-extern PFN_vkCmdDrawIndexed vkCmdDrawIndexed;
-extern PFN_vkCmdDrawIndirect vkCmdDrawIndirect;
-extern PFN_vkCmdDrawIndexedIndirect vkCmdDrawIndexedIndirect;
-extern PFN_vkCmdDispatch vkCmdDispatch;
-extern PFN_vkCmdDispatchIndirect vkCmdDispatchIndirect;
-extern PFN_vkCmdCopyBuffer vkCmdCopyBuffer;
-extern PFN_vkCmdCopyImage vkCmdCopyImage;
-extern PFN_vkCmdBlitImage vkCmdBlitImage;
-extern PFN_vkCmdCopyBufferToImage vkCmdCopyBufferToImage;
-extern PFN_vkCmdCopyImageToBuffer vkCmdCopyImageToBuffer;
-extern PFN_vkCmdUpdateBuffer vkCmdUpdateBuffer;
-extern PFN_vkCmdFillBuffer vkCmdFillBuffer;
-extern PFN_vkCmdClearColorImage vkCmdClearColorImage;
-extern PFN_vkCmdClearDepthStencilImage vkCmdClearDepthStencilImage;
-extern PFN_vkCmdClearAttachments vkCmdClearAttachments;
-extern PFN_vkCmdResolveImage vkCmdResolveImage;
-extern PFN_vkCmdSetEvent vkCmdSetEvent;
-extern PFN_vkCmdResetEvent vkCmdResetEvent;
-extern PFN_vkCmdWaitEvents vkCmdWaitEvents;
-extern PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier;
-extern PFN_vkCmdBeginQuery vkCmdBeginQuery;
-extern PFN_vkCmdEndQuery vkCmdEndQuery;
-extern PFN_vkCmdResetQueryPool vkCmdResetQueryPool;
-extern PFN_vkCmdWriteTimestamp vkCmdWriteTimestamp;
-extern PFN_vkCmdCopyQueryPoolResults vkCmdCopyQueryPoolResults;
-extern PFN_vkCmdPushConstants vkCmdPushConstants;
-extern PFN_vkCmdBeginRenderPass vkCmdBeginRenderPass;
-extern PFN_vkCmdNextSubpass vkCmdNextSubpass;
-extern PFN_vkCmdEndRenderPass vkCmdEndRenderPass;
-extern PFN_vkCmdExecuteCommands vkCmdExecuteCommands;
-
-// VK_KHR_surface
-extern PFN_vkDestroySurfaceKHR vkDestroySurfaceKHR;
-extern PFN_vkGetPhysicalDeviceSurfaceSupportKHR vkGetPhysicalDeviceSurfaceSupportKHR;
-extern PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR vkGetPhysicalDeviceSurfaceCapabilitiesKHR;
-extern PFN_vkGetPhysicalDeviceSurfaceFormatsKHR vkGetPhysicalDeviceSurfaceFormatsKHR;
-extern PFN_vkGetPhysicalDeviceSurfacePresentModesKHR vkGetPhysicalDeviceSurfacePresentModesKHR;
-
-// VK_KHR_swapchain
-extern PFN_vkCreateSwapchainKHR vkCreateSwapchainKHR;
-extern PFN_vkDestroySwapchainKHR vkDestroySwapchainKHR;
-extern PFN_vkGetSwapchainImagesKHR vkGetSwapchainImagesKHR;
-extern PFN_vkAcquireNextImageKHR vkAcquireNextImageKHR;
-extern PFN_vkQueuePresentKHR vkQueuePresentKHR;
-
-// VK_KHR_display
-extern PFN_vkGetPhysicalDeviceDisplayPropertiesKHR vkGetPhysicalDeviceDisplayPropertiesKHR;
-extern PFN_vkGetPhysicalDeviceDisplayPlanePropertiesKHR vkGetPhysicalDeviceDisplayPlanePropertiesKHR;
-extern PFN_vkGetDisplayPlaneSupportedDisplaysKHR vkGetDisplayPlaneSupportedDisplaysKHR;
-extern PFN_vkGetDisplayModePropertiesKHR vkGetDisplayModePropertiesKHR;
-extern PFN_vkCreateDisplayModeKHR vkCreateDisplayModeKHR;
-extern PFN_vkGetDisplayPlaneCapabilitiesKHR vkGetDisplayPlaneCapabilitiesKHR;
-extern PFN_vkCreateDisplayPlaneSurfaceKHR vkCreateDisplayPlaneSurfaceKHR;
-
-// VK_KHR_display_swapchain
-extern PFN_vkCreateSharedSwapchainsKHR vkCreateSharedSwapchainsKHR;
+#define VK_INSTANCE_FUNCTIONS_1_0(X) \
+    X(vkDestroyInstance) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkGetPhysicalDeviceFeatures) \
+    X(vkGetPhysicalDeviceFormatProperties) \
+    X(vkGetPhysicalDeviceImageFormatProperties) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetDeviceProcAddr) \
+    X(vkCreateDevice) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkEnumerateDeviceLayerProperties) \
+    X(vkGetPhysicalDeviceSparseImageFormatProperties)
+
+#define VK_INSTANCE_FUNCTIONS_1_1(X) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceProperties2)
 
 #ifdef VK_USE_PLATFORM_XLIB_KHR
-// VK_KHR_xlib_surface
-extern PFN_vkCreateXlibSurfaceKHR vkCreateXlibSurfaceKHR;
-extern PFN_vkGetPhysicalDeviceXlibPresentationSupportKHR vkGetPhysicalDeviceXlibPresentationSupportKHR;
+#define VK_XLIB_INSTANCE_FUNCTIONS(X) \
+    X(VK_KHR_XLIB_SURFACE_EXTENSION_NAME, vkCreateXlibSurfaceKHR) \
+    X(VK_KHR_XLIB_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceXlibPresentationSupportKHR)
+#else
+#define VK_XLIB_INSTANCE_FUNCTIONS(X)
 #endif
 
 #ifdef VK_USE_PLATFORM_XCB_KHR
-// VK_KHR_xcb_surface
-extern PFN_vkCreateXcbSurfaceKHR vkCreateXcbSurfaceKHR;
-extern PFN_vkGetPhysicalDeviceXcbPresentationSupportKHR vkGetPhysicalDeviceXcbPresentationSupportKHR;
+#define VK_XCB_INSTANCE_FUNCTIONS(X) \
+    X(VK_KHR_XCB_SURFACE_EXTENSION_NAME, vkCreateXcbSurfaceKHR) \
+    X(VK_KHR_XCB_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceXcbPresentationSupportKHR)
+#else
+#define VK_XCB_INSTANCE_FUNCTIONS(X)
 #endif
 
 #ifdef VK_USE_PLATFORM_WAYLAND_KHR
-// VK_KHR_wayland_surface
-extern PFN_vkCreateWaylandSurfaceKHR vkCreateWaylandSurfaceKHR;
-extern PFN_vkGetPhysicalDeviceWaylandPresentationSupportKHR vkGetPhysicalDeviceWaylandPresentationSupportKHR;
-#endif
-
-#ifdef VK_USE_PLATFORM_MIR_KHR
-// VK_KHR_mir_surface
-extern PFN_vkCreateMirSurfaceKHR vkCreateMirSurfaceKHR;
-extern PFN_vkGetPhysicalDeviceMirPresentationSupportKHR vkGetPhysicalDeviceMirPresentationSupportKHR;
+#define VK_WAYLAND_INSTANCE_FUNCTIONS(X) \
+    X(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME, vkCreateWaylandSurfaceKHR) \
+    X(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceWaylandPresentationSupportKHR)
+#else
+#define VK_WAYLAND_INSTANCE_FUNCTIONS(X)
 #endif
 
 #ifdef VK_USE_PLATFORM_ANDROID_KHR
-// VK_KHR_android_surface
-extern PFN_vkCreateAndroidSurfaceKHR vkCreateAndroidSurfaceKHR;
+#define VK_ANDROID_INSTANCE_FUNCTIONS(X) \
+    X(VK_KHR_ANDROID_SURFACE_EXTENSION_NAME, vkCreateAndroidSurfaceKHR)
+#else
+#define VK_ANDROID_INSTANCE_FUNCTIONS(X)
 #endif
 
 #ifdef VK_USE_PLATFORM_WIN32_KHR
-// VK_KHR_win32_surface
-extern PFN_vkCreateWin32SurfaceKHR vkCreateWin32SurfaceKHR;
-extern PFN_vkGetPhysicalDeviceWin32PresentationSupportKHR vkGetPhysicalDeviceWin32PresentationSupportKHR;
+#define VK_WIN32_INSTANCE_FUNCTIONS(X) \
+    X(VK_KHR_WIN32_SURFACE_EXTENSION_NAME, vkCreateWin32SurfaceKHR) \
+    X(VK_KHR_WIN32_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceWin32PresentationSupportKHR)
+#else
+#define VK_WIN32_INSTANCE_FUNCTIONS(X)
 #endif
 
 #ifdef USE_DEBUG_EXTENTIONS
-#include <vulkan/vk_sdk_platform.h>
-// VK_EXT_debug_report
-extern PFN_vkCreateDebugReportCallbackEXT vkCreateDebugReportCallbackEXT;
-extern PFN_vkDestroyDebugReportCallbackEXT vkDestroyDebugReportCallbackEXT;
-extern PFN_vkDebugReportMessageEXT vkDebugReportMessageEXT;
+#define VK_DEBUG_INSTANCE_FUNCTIONS(X) \
+    X(VK_EXT_DEBUG_REPORT_EXTENSION_NAME, vkCreateDebugReportCallbackEXT) \
+    X(VK_EXT_DEBUG_REPORT_EXTENSION_NAME, vkDestroyDebugReportCallbackEXT) \
+    X(VK_EXT_DEBUG_REPORT_EXTENSION_NAME, vkDebugReportMessageEXT)
+#else
+#define VK_DEBUG_INSTANCE_FUNCTIONS(X)
 #endif
 
+#define VK_INSTANCE_EXTENSION_FUNCTIONS(X) \
+    X(VK_KHR_SURFACE_EXTENSION_NAME, vkDestroySurfaceKHR) \
+    X(VK_KHR_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceSurfaceSupportKHR) \
+    X(VK_KHR_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(VK_KHR_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceSurfaceFormatsKHR) \
+    X(VK_KHR_SURFACE_EXTENSION_NAME, vkGetPhysicalDeviceSurfacePresentModesKHR) \
+    X(VK_KHR_DISPLAY_EXTENSION_NAME, vkGetPhysicalDeviceDisplayPropertiesKHR) \
+    X(VK_KHR_DISPLAY_EXTENSION_NAME, vkGetPhysicalDeviceDisplayPlanePropertiesKHR) \
+    X(VK_KHR_DISPLAY_EXTENSION_NAME, vkGetDisplayPlaneSupportedDisplaysKHR) \
+    X(VK_KHR_DISPLAY_EXTENSION_NAME, vkGetDisplayModePropertiesKHR) \
+    X(VK_KHR_DISPLAY_EXTENSION_NAME, vkCreateDisplayModeKHR) \
+    X(VK_KHR_DISPLAY_EXTENSION_NAME, vkGetDisplayPlaneCapabilitiesKHR) \
+    X(VK_KHR_DISPLAY_EXTENSION_NAME, vkCreateDisplayPlaneSurfaceKHR) \
+    VK_XLIB_INSTANCE_FUNCTIONS(X) \
+    VK_XCB_INSTANCE_FUNCTIONS(X) \
+    VK_WAYLAND_INSTANCE_FUNCTIONS(X) \
+    VK_ANDROID_INSTANCE_FUNCTIONS(X) \
+    VK_WIN32_INSTANCE_FUNCTIONS(X) \
+    VK_DEBUG_INSTANCE_FUNCTIONS(X)
+
+/* Physical device commands of device extensions. They are resolved with the instance whenever the
+ * loader knows them, and may only be called if the physical device supports the extension.
+ */
+#define VK_PHYSICAL_DEVICE_EXTENSION_FUNCTIONS(X) \
+    X(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)
+
+/* Resolved through vkGetDeviceProcAddr these call straight into the driver instead of the loader
+ * trampoline.
+ */
+#define VK_DEVICE_FUNCTIONS_1_0(X) \
+    X(vkDestroyDevice) \
+    X(vkGetDeviceQueue) \
+    X(vkQueueSubmit) \
+    X(vkQueueWaitIdle) \
+    X(vkDeviceWaitIdle) \
+    X(vkAllocateMemory) \
+    X(vkFreeMemory) \
+    X(vkMapMemory) \
+    X(vkUnmapMemory) \
+    X(vkFlushMappedMemoryRanges) \
+    X(vkInvalidateMappedMemoryRanges) \
+    X(vkGetDeviceMemoryCommitment) \
+    X(vkBindBufferMemory) \
+    X(vkBindImageMemory) \
+    X(vkGetBufferMemoryRequirements) \
+    X(vkGetImageMemoryRequirements) \
+    X(vkGetImageSparseMemoryRequirements) \
+    X(vkQueueBindSparse) \
+    X(vkCreateFence) \
+    X(vkDestroyFence) \
+    X(vkResetFences) \
+    X(vkGetFenceStatus) \
+    X(vkWaitForFences) \
+    X(vkCreateSemaphore) \
+    X(vkDestroySemaphore) \
+    X(vkCreateEvent) \
+    X(vkDestroyEvent) \
+    X(vkGetEventStatus) \
+    X(vkSetEvent) \
+    X(vkResetEvent) \
+    X(vkCreateQueryPool) \
+    X(vkDestroyQueryPool) \
+    X(vkGetQueryPoolResults) \
+    X(vkCreateBuffer) \
+    X(vkDestroyBuffer) \
+    X(vkCreateBufferView) \
+    X(vkDestroyBufferView) \
+    X(vkCreateImage) \
+    X(vkDestroyImage) \
+    X(vkGetImageSubresourceLayout) \
+    X(vkCreateImageView) \
+    X(vkDestroyImageView) \
+    X(vkCreateShaderModule) \
+    X(vkDestroyShaderModule) \
+    X(vkCreatePipelineCache) \
+    X(vkDestroyPipelineCache) \
+    X(vkGetPipelineCacheData) \
+    X(vkMergePipelineCaches) \
+    X(vkCreateGraphicsPipelines) \
+    X(vkCreateComputePipelines) \
+    X(vkDestroyPipeline) \
+    X(vkCreatePipelineLayout) \
+    X(vkDestroyPipelineLayout) \
+    X(vkCreateSampler) \
+    X(vkDestroySampler) \
+    X(vkCreateDescriptorSetLayout) \
+    X(vkDestroyDescriptorSetLayout) \
+    X(vkCreateDescriptorPool) \
+    X(vkDestroyDescriptorPool) \
+    X(vkResetDescriptorPool) \
+    X(vkAllocateDescriptorSets) \
+    X(vkFreeDescriptorSets) \
+    X(vkUpdateDescriptorSets) \
+    X(vkCreateFramebuffer) \
+    X(vkDestroyFramebuffer) \
+    X(vkCreateRenderPass) \
+    X(vkDestroyRenderPass) \
+    X(vkGetRenderAreaGranularity) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkResetCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkFreeCommandBuffers) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkResetCommandBuffer) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdSetViewport) \
+    X(vkCmdSetScissor) \
+    X(vkCmdSetLineWidth) \
+    X(vkCmdSetDepthBias) \
+    X(vkCmdSetBlendConstants) \
+    X(vkCmdSetDepthBounds) \
+    X(vkCmdSetStencilCompareMask) \
+    X(vkCmdSetStencilWriteMask) \
+    X(vkCmdSetStencilReference) \
+    X(vkCmdBindDescriptorSets) \
+    X(vkCmdBindIndexBuffer) \
+    X(vkCmdBindVertexBuffers) \
+    X(vkCmdDraw) \
+    X(vkCmdDrawIndexed) \
+    X(vkCmdDrawIndirect) \
+    X(vkCmdDrawIndexedIndirect) \
+    X(vkCmdDispatch) \
+    X(vkCmdDispatchIndirect) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdCopyImage) \
+    X(vkCmdBlitImage) \
+    X(vkCmdCopyBufferToImage) \
+    X(vkCmdCopyImageToBuffer) \
+    X(vkCmdUpdateBuffer) \
+    X(vkCmdFillBuffer) \
+    X(vkCmdClearColorImage) \
+    X(vkCmdClearDepthStencilImage) \
+    X(vkCmdClearAttachments) \
+    X(vkCmdResolveImage) \
+    X(vkCmdSetEvent) \
+    X(vkCmdResetEvent) \
+    X(vkCmdWaitEvents) \
+    X(vkCmdPipelineBarrier) \
+    X(vkCmdBeginQuery) \
+    X(vkCmdEndQuery) \
+    X(vkCmdResetQueryPool) \
+    X(vkCmdWriteTimestamp) \
+    X(vkCmdCopyQueryPoolResults) \
+    X(vkCmdPushConstants) \
+    X(vkCmdBeginRenderPass) \
+    X(vkCmdNextSubpass) \
+    X(vkCmdEndRenderPass) \
+    X(vkCmdExecuteCommands)
+
+#define VK_DEVICE_FUNCTIONS_1_1(X) \
+    X(vkCreateDescriptorUpdateTemplate) \
+    X(vkDestroyDescriptorUpdateTemplate) \
+    X(vkUpdateDescriptorSetWithTemplate)
+
+#define VK_DEVICE_EXTENSION_FUNCTIONS(X) \
+    X(VK_KHR_SWAPCHAIN_EXTENSION_NAME, vkCreateSwapchainKHR) \
+    X(VK_KHR_SWAPCHAIN_EXTENSION_NAME, vkDestroySwapchainKHR) \
+    X(VK_KHR_SWAPCHAIN_EXTENSION_NAME, vkGetSwapchainImagesKHR) \
+    X(VK_KHR_SWAPCHAIN_EXTENSION_NAME, vkAcquireNextImageKHR) \
+    X(VK_KHR_SWAPCHAIN_EXTENSION_NAME, vkQueuePresentKHR) \
+    X(VK_KHR_DISPLAY_SWAPCHAIN_EXTENSION_NAME, vkCreateSharedSwapchainsKHR) \
+    X(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, vkCmdBeginRenderingKHR) \
+    X(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, vkCmdEndRenderingKHR) \
+    X(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME, vkCmdPipelineBarrier2KHR) \
+    X(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, vkGetCalibratedTimestampsEXT) \
+    X(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, vkCreateDescriptorUpdateTemplateKHR) \
+    X(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, vkDestroyDescriptorUpdateTemplateKHR) \
+    X(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, vkUpdateDescriptorSetWithTemplateKHR)
+
+/* Everything except vkGetInstanceProcAddr */
+#define VK_ALL_FUNCTIONS(X, EXTENSION_X) \
+    VK_GLOBAL_FUNCTIONS(X) \
+    VK_INSTANCE_FUNCTIONS_1_0(X) \
+    VK_INSTANCE_FUNCTIONS_1_1(X) \
+    VK_INSTANCE_EXTENSION_FUNCTIONS(EXTENSION_X) \
+    VK_PHYSICAL_DEVICE_EXTENSION_FUNCTIONS(EXTENSION_X) \
+    VK_DEVICE_FUNCTIONS_1_0(X) \
+    VK_DEVICE_FUNCTIONS_1_1(X) \
+    VK_DEVICE_EXTENSION_FUNCTIONS(EXTENSION_X)
+
+#define VK_DECLARE_FUNCTION(name) extern PFN_##name name;
+#define VK_DECLARE_EXTENSION_FUNCTION(extension, name) VK_DECLARE_FUNCTION(name)
+
+extern PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+VK_GLOBAL_FUNCTIONS(VK_DECLARE_FUNCTION)
+VK_INSTANCE_FUNCTIONS_1_0(VK_DECLARE_FUNCTION)
+VK_INSTANCE_FUNCTIONS_1_1(VK_DECLARE_FUNCTION)
+VK_INSTANCE_EXTENSION_FUNCTIONS(VK_DECLARE_EXTENSION_FUNCTION)
+VK_PHYSICAL_DEVICE_EXTENSION_FUNCTIONS(VK_DECLARE_EXTENSION_FUNCTION)
+VK_DEVICE_FUNCTIONS_1_0(VK_DECLARE_FUNCTION)
+VK_DEVICE_FUNCTIONS_1_1(VK_DECLARE_FUNCTION)
+VK_DEVICE_EXTENSION_FUNCTIONS(VK_DECLARE_EXTENSION_FUNCTION)
+
+#define VK_DISPATCH_TABLE_ENTRY(name) PFN_##name name;
+#define VK_DISPATCH_TABLE_EXTENSION_ENTRY(extension, name) VK_DISPATCH_TABLE_ENTRY(name)
+
+/* Entry points of one instance or device. */
+struct VulkanInstanceTable {
+    VK_INSTANCE_FUNCTIONS_1_0(VK_DISPATCH_TABLE_ENTRY)
+    VK_INSTANCE_FUNCTIONS_1_1(VK_DISPATCH_TABLE_ENTRY)
+    VK_INSTANCE_EXTENSION_FUNCTIONS(VK_DISPATCH_TABLE_EXTENSION_ENTRY)
+    VK_PHYSICAL_DEVICE_EXTENSION_FUNCTIONS(VK_DISPATCH_TABLE_EXTENSION_ENTRY)
+};
+
+struct VulkanDeviceTable {
+    VK_DEVICE_FUNCTIONS_1_0(VK_DISPATCH_TABLE_ENTRY)
+    VK_DEVICE_FUNCTIONS_1_1(VK_DISPATCH_TABLE_ENTRY)
+    VK_DEVICE_EXTENSION_FUNCTIONS(VK_DISPATCH_TABLE_EXTENSION_ENTRY)
+};
+
+/* Entry points resolved so far and the time spent on it. Failures are entry points of enabled
+ * core versions or extensions that the driver did not return, unavailable ones were not
+ * requested. Deferred ones are core entry points that were not called yet.
+ */
+struct VulkanLoaderStats {
+    uint32_t resolvedCount;
+    uint32_t failedCount;
+    uint32_t unavailableCount;
+    uint32_t deferredCount;
+    double loadMicroseconds;
+};
+
+/* Load libvulkan and resolve the global entry points. Returns 0 if vulkan is not available,
+ * non-zero if it is available.
+ */
+int InitVulkan(void);
+
+/* Like InitVulkan, with the entry points of a driver other than libvulkan, e.g. the null driver.
+ */
+int InitVulkanFromProcAddr(PFN_vkGetInstanceProcAddr getInstanceProcAddr);
+
+/* Dispatch tables are resolved right away, including the core entry points. */
+void LoadVulkanInstanceTable(VkInstance instance, const VkInstanceCreateInfo* createInfo,
+                             VulkanInstanceTable* table);
+
+/* apiVersion is the version the device supports, at most the one of its instance. On devices
+ * below 1.1 the descriptor update template entry points come from
+ * VK_KHR_descriptor_update_template when it is enabled.
+ */
+void LoadVulkanDeviceTable(VkDevice device, const VkDeviceCreateInfo* createInfo,
+                           uint32_t apiVersion, VulkanDeviceTable* table);
+
+/* Point the instance-level function pointers declared in this header at the instance's own
+ * entry points, the core ones are resolved on their first call. Must be called after
+ * vkCreateInstance, with the same create info.
+ */
+void InitVulkanInstance(VkInstance instance, const VkInstanceCreateInfo* createInfo);
+
+/* Point the device-level function pointers declared in this header at the device's own entry
+ * points, so recording and submission skip the loader. The core ones are resolved on their first
+ * call, which points the function pointer at the entry point unless it was hooked meanwhile. Must
+ * be called after vkCreateDevice with the same physical device and create info, with a single
+ * device. Entry points of core versions above the one of the physical device stay unavailable.
+ */
+void InitVulkanDevice(VkPhysicalDevice gpu, VkDevice device, const VkDeviceCreateInfo* createInfo);
+
+/* Whether a function pointer declared in this header or taken from a dispatch table resolved to
+ * a real entry point, rather than to the stub of an entry point that is not available. A core
+ * entry point that was not called yet is resolved by this.
+ */
+bool IsVulkanEntryPointAvailable(PFN_vkVoidFunction function);
+
+#define VK_IS_AVAILABLE(function) \
+    IsVulkanEntryPointAvailable(reinterpret_cast<PFN_vkVoidFunction>(function))
+
+VulkanLoaderStats GetVulkanLoaderStats(void);
 
-#endif // VULKAN_WRAPPER_H
\ No newline at end of file
+#endif // VULKAN_WRAPPER_H